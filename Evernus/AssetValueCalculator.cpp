@@ -0,0 +1,112 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QElapsedTimer>
+#include <QtDebug>
+
+#include "CachingEveDataProvider.h"
+#include "AssetList.h"
+
+#include "AssetValueCalculator.h"
+
+namespace Evernus
+{
+    AssetValueCalculator::AssetValueCalculator(const CachingEveDataProvider &dataProvider)
+        : mDataProvider{&dataProvider}
+    {
+    }
+
+    AssetValueCalculator::Result AssetValueCalculator::calculate(const EntryList &entries, bool allowMissingPrices) const
+    {
+        Q_ASSERT(mDataProvider != nullptr);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        TypeLocationPairs pairs;
+        for (const auto &entry : entries)
+        {
+            if (!entry.mCustomValue)
+                pairs.emplace(std::make_pair(entry.mTypeId, entry.mLocationId));
+        }
+
+        const auto prices = mDataProvider->getTypeSellPrices(pairs, allowMissingPrices);
+
+        Result result;
+        for (const auto &entry : entries)
+        {
+            auto value = 0.;
+            if (entry.mCustomValue)
+            {
+                value = *entry.mCustomValue;
+            }
+            else
+            {
+                const auto price = prices.find(std::make_pair(entry.mTypeId, entry.mLocationId));
+                if (price == std::end(prices) || CachingEveDataProvider::isPricePlaceholder(price->second))
+                {
+                    result.mComplete = false;
+                    continue;
+                }
+
+                value = price->second->getPrice() * entry.mQuantity;
+            }
+
+            result.mTotalValue += value;
+            result.mLocationValues[entry.mLocationId] += value;
+            result.mTypeValues[entry.mTypeId] += value;
+        }
+
+        qDebug() << "Valued" << entries.size() << "assets with" << pairs.size() << "prices in" << timer.elapsed() << "ms, complete:" << result.mComplete;
+
+        return result;
+    }
+
+    AssetValueCalculator::EntryList AssetValueCalculator::flatten(const AssetList &list, quint64 customLocationId)
+    {
+        EntryList entries;
+        for (const auto &item : list)
+        {
+            const auto locationId = (customLocationId != 0) ? (customLocationId) : (item->getLocationId());
+            if (!locationId)
+                continue;
+
+            flattenItem(*item, *locationId, entries);
+        }
+
+        return entries;
+    }
+
+    void AssetValueCalculator::flattenItem(const Item &item, quint64 locationId, EntryList &entries)
+    {
+        // BPCs have no market value
+        if (item.isBPC())
+            return;
+
+        Entry entry;
+        entry.mTypeId = item.getTypeId();
+        entry.mLocationId = locationId;
+        entry.mQuantity = item.getQuantity();
+        entry.mCustomValue = item.getCustomValue();
+
+        entries.emplace_back(entry);
+
+        // custom value covers the contents as well
+        if (entry.mCustomValue)
+            return;
+
+        for (const auto &child : item)
+            flattenItem(*child, locationId, entries);
+    }
+}
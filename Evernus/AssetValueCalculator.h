@@ -0,0 +1,72 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <optional>
+#include <vector>
+
+#include "EveType.h"
+
+namespace Evernus
+{
+    class CachingEveDataProvider;
+    class AssetList;
+    class Item;
+
+    // values whole asset lists with a single price lookup, instead of one per item
+    class AssetValueCalculator final
+    {
+    public:
+        struct Entry
+        {
+            EveType::IdType mTypeId = EveType::invalidId;
+            quint64 mLocationId = 0;
+            uint mQuantity = 0;
+            std::optional<double> mCustomValue;
+        };
+
+        using EntryList = std::vector<Entry>;
+
+        struct Result
+        {
+            double mTotalValue = 0.;
+            bool mComplete = true;  // false if some prices were missing and skipped
+            std::unordered_map<quint64, double> mLocationValues;
+            std::unordered_map<EveType::IdType, double> mTypeValues;
+        };
+
+        explicit AssetValueCalculator(const CachingEveDataProvider &dataProvider);
+        AssetValueCalculator(const AssetValueCalculator &) = default;
+        AssetValueCalculator(AssetValueCalculator &&) = default;
+        ~AssetValueCalculator() = default;
+
+        // throws ExternalOrderRepository::NotFoundException on missing prices, unless allowMissingPrices is set
+        // in which case they are left out and the result is marked as incomplete
+        // safe to call from worker threads, as long as entries are not shared
+        Result calculate(const EntryList &entries, bool allowMissingPrices) const;
+
+        AssetValueCalculator &operator =(const AssetValueCalculator &) = default;
+        AssetValueCalculator &operator =(AssetValueCalculator &&) = default;
+
+        // items take the location of their top-level parent, unless customLocationId is given
+        static EntryList flatten(const AssetList &list, quint64 customLocationId = 0);
+
+    private:
+        const CachingEveDataProvider *mDataProvider = nullptr;
+
+        static void flattenItem(const Item &item, quint64 locationId, EntryList &entries);
+    };
+}
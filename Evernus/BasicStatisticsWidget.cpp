@@ -457,61 +457,36 @@ namespace Evernus
     void BasicStatisticsWidget::updateJournalData()
     {
         const auto combineStats = mCombineStatsBtn->isChecked();
-        const auto entries = (combineStats) ?
-                             (mJournalRepository.fetchInRange(QDateTime{mJournalPlot->getFrom()},
-                                                              QDateTime{mJournalPlot->getTo().addDays(1)},
-                                                              WalletJournalEntryRepository::EntryType::All)) :
-                             (mJournalRepository.fetchForCharacterInRange(mCharacterId,
-                                                                          QDateTime{mJournalPlot->getFrom()},
-                                                                          QDateTime{mJournalPlot->getTo().addDays(1)},
-                                                                          WalletJournalEntryRepository::EntryType::All));
+        const auto from = mJournalPlot->getFrom();
+        const auto to = mJournalPlot->getTo();
 
         auto totalIncome = 0., totalOutcome = 0.;
 
         QHash<QDate, std::pair<double, double>> values;
-        const auto valueAdder = [&values, &totalIncome, &totalOutcome](const auto &entries) {
-            for (const auto &entry : entries)
+        const auto valueAdder = [&values, &totalIncome, &totalOutcome](const auto &totals) {
+            for (const auto &total : totals)
             {
-                if (entry->isIgnored())
-                    continue;
+                auto &value = values[total.mDay];
+                value.first += total.mOutcome;
+                value.second += total.mIncome;
 
-                auto &value = values[entry->getTimestamp().toLocalTime().date()];
-
-                const auto amount = entry->getAmount();
-                if (Q_UNLIKELY(!amount))
-                    continue;
-
-                if (*amount < 0.)
-                {
-                    totalOutcome -= *amount;
-                    value.first -= *amount;
-                }
-                else
-                {
-                    totalIncome += *amount;
-                    value.second += *amount;
-                }
+                totalOutcome += total.mOutcome;
+                totalIncome += total.mIncome;
             }
         };
 
-        valueAdder(entries);
+        valueAdder((combineStats) ?
+                   (mJournalRepository.fetchDayTotals(from, to)) :
+                   (mJournalRepository.fetchDayTotalsForCharacter(mCharacterId, from, to)));
 
         QSettings settings;
         if (settings.value(StatisticsSettings::combineCorpAndCharPlotsKey, StatisticsSettings::combineCorpAndCharPlotsDefault).toBool())
         {
             try
             {
-                const auto corpId = mCharacterRepository.getCorporationId(mCharacterId);
-                const auto entries = (combineStats) ?
-                                     (mCorpJournalRepository.fetchInRange(QDateTime{mJournalPlot->getFrom()},
-                                                                          QDateTime{mJournalPlot->getTo().addDays(1)},
-                                                                          WalletJournalEntryRepository::EntryType::All)) :
-                                     (mCorpJournalRepository.fetchForCorporationInRange(corpId,
-                                                                                        QDateTime{mJournalPlot->getFrom()},
-                                                                                        QDateTime{mJournalPlot->getTo().addDays(1)},
-                                                                                        WalletJournalEntryRepository::EntryType::All));
-
-                valueAdder(entries);
+                valueAdder((combineStats) ?
+                           (mCorpJournalRepository.fetchDayTotals(from, to)) :
+                           (mCorpJournalRepository.fetchDayTotalsForCorporation(mCharacterRepository.getCorporationId(mCharacterId), from, to)));
             }
             catch (const CharacterRepository::NotFoundException &)
             {
@@ -537,58 +512,36 @@ namespace Evernus
     void BasicStatisticsWidget::updateTransactionData()
     {
         const auto combineStats = mCombineStatsBtn->isChecked();
-        const auto entries = (combineStats) ?
-                             (mTransactionRepository.fetchInRange(QDateTime{mTransactionPlot->getFrom()},
-                                                                  QDateTime{mTransactionPlot->getTo().addDays(1)},
-                                                                  WalletTransactionRepository::EntryType::All)) :
-                             (mTransactionRepository.fetchForCharacterInRange(mCharacterId,
-                                                                              QDateTime{mTransactionPlot->getFrom()},
-                                                                              QDateTime{mTransactionPlot->getTo().addDays(1)},
-                                                                              WalletTransactionRepository::EntryType::All));
+        const auto from = mTransactionPlot->getFrom();
+        const auto to = mTransactionPlot->getTo();
 
         auto totalIncome = 0., totalOutcome = 0.;
 
         QHash<QDate, std::pair<double, double>> values;
-        const auto valueAdder = [&values, &totalIncome, &totalOutcome](const auto &entries) {
-            for (const auto &entry : entries)
+        const auto valueAdder = [&values, &totalIncome, &totalOutcome](const auto &totals) {
+            for (const auto &total : totals)
             {
-                if (entry->isIgnored())
-                    continue;
+                auto &value = values[total.mDay];
+                value.first += total.mBuyValue;
+                value.second += total.mSellValue;
 
-                auto &value = values[entry->getTimestamp().toLocalTime().date()];
-
-                const auto amount = entry->getPrice() * entry->getQuantity();
-                if (entry->getType() == Evernus::WalletTransaction::Type::Buy)
-                {
-                    totalOutcome += amount;
-                    value.first += amount;
-                }
-                else
-                {
-                    totalIncome += amount;
-                    value.second += amount;
-                }
+                totalOutcome += total.mBuyValue;
+                totalIncome += total.mSellValue;
             }
         };
 
-        valueAdder(entries);
+        valueAdder((combineStats) ?
+                   (mTransactionRepository.fetchDayTotals(from, to)) :
+                   (mTransactionRepository.fetchDayTotalsForCharacter(mCharacterId, from, to)));
 
         QSettings settings;
         if (settings.value(StatisticsSettings::combineCorpAndCharPlotsKey, StatisticsSettings::combineCorpAndCharPlotsDefault).toBool())
         {
             try
             {
-                const auto corpId = mCharacterRepository.getCorporationId(mCharacterId);
-                const auto entries = (combineStats) ?
-                                     (mCorpTransactionRepository.fetchInRange(QDateTime{mJournalPlot->getFrom()},
-                                                                              QDateTime{mJournalPlot->getTo().addDays(1)},
-                                                                              WalletTransactionRepository::EntryType::All)) :
-                                     (mCorpTransactionRepository.fetchForCorporationInRange(corpId,
-                                                                                            QDateTime{mJournalPlot->getFrom()},
-                                                                                            QDateTime{mJournalPlot->getTo().addDays(1)},
-                                                                                            WalletTransactionRepository::EntryType::All));
-
-                valueAdder(entries);
+                valueAdder((combineStats) ?
+                           (mCorpTransactionRepository.fetchDayTotals(from, to)) :
+                           (mCorpTransactionRepository.fetchDayTotalsForCorporation(mCharacterRepository.getCorporationId(mCharacterId), from, to)));
             }
             catch (const CharacterRepository::NotFoundException &)
             {
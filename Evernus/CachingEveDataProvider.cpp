@@ -12,21 +12,25 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <queue>
-
 #include <QtDebug>
 
 #include <QStandardPaths>
 #include <QSqlDatabase>
 #include <QDataStream>
+#include <QFileInfo>
 #include <QSqlQuery>
 #include <QSettings>
+#include <QRegExp>
 #include <QFile>
 #include <QDir>
 
+#include <boost/throw_exception.hpp>
+
+#include "EveDatabaseConnectionProvider.h"
 #include "DatabaseConnectionProvider.h"
 #include "EveDataManagerProvider.h"
 #include "MarketOrderRepository.h"
+#include "UpdaterSettings.h"
 #include "UISettings.h"
 
 #include "CachingEveDataProvider.h"
@@ -39,6 +43,8 @@ namespace Evernus
     const QString CachingEveDataProvider::ancestryCacheFileName = "ancestry_names";
 
     const QString CachingEveDataProvider::systemDistanceCacheFileName = "system_distances";
+    const QString CachingEveDataProvider::industryDataCacheFileName = "industry_data";
+    const QString CachingEveDataProvider::staticDataCacheFileName = "static_data";
 
     const QStringList CachingEveDataProvider::oreGroupNames = {
         QStringLiteral("Veldspar"),
@@ -61,22 +67,18 @@ namespace Evernus
     };
 
     CachingEveDataProvider::CachingEveDataProvider(const EveTypeRepository &eveTypeRepository,
-                                                   const MetaGroupRepository &metaGroupRepository,
                                                    const ExternalOrderRepository &externalOrderRepository,
                                                    const MarketOrderRepository &marketOrderRepository,
                                                    const MarketOrderRepository &corpMarketOrderRepository,
-                                                   const MarketGroupRepository &marketGroupRepository,
                                                    const CitadelRepository &citadelRepository,
                                                    const EveDataManagerProvider &dataManagerProvider,
                                                    const DatabaseConnectionProvider &connectionProvider,
                                                    QObject *parent)
         : EveDataProvider{parent}
         , mEveTypeRepository{eveTypeRepository}
-        , mMetaGroupRepository{metaGroupRepository}
         , mExternalOrderRepository{externalOrderRepository}
         , mMarketOrderRepository{marketOrderRepository}
         , mCorpMarketOrderRepository{corpMarketOrderRepository}
-        , mMarketGroupRepository{marketGroupRepository}
         , mCitadelRepository{citadelRepository}
         , mDataManagerProvider{dataManagerProvider}
         , mConnectionProvider{connectionProvider}
@@ -96,7 +98,6 @@ namespace Evernus
             if (dataCacheDir.mkpath(QStringLiteral(".")))
             {
                 cacheWrite(nameCacheFileName, mGenericNameCache);
-                cacheWrite(systemDistanceCacheFileName, mSystemDistances);
                 cacheWrite(raceCacheFileName, mRaceNameCache);
                 cacheWrite(bloodlineCacheFileName, mBloodlineNameCache);
                 cacheWrite(ancestryCacheFileName, mAncestryNameCache);
@@ -109,28 +110,22 @@ namespace Evernus
 
     QString CachingEveDataProvider::getTypeName(EveType::IdType id) const
     {
-        return getEveType(id)->getName();
+        return mStaticData.getTypeName(id);
     }
 
     QString CachingEveDataProvider::getTypeMarketGroupParentName(EveType::IdType id) const
     {
-        const auto type = getEveType(id);
-        const auto marketGroupId = type->getMarketGroupId();
-        return (marketGroupId) ? (getMarketGroupParent(*marketGroupId)->getName()) : (QString{});
+        return mStaticData.getTypeMarketGroupParentName(id);
     }
 
     QString CachingEveDataProvider::getTypeMarketGroupName(EveType::IdType id) const
     {
-        const auto type = getEveType(id);
-        const auto marketGroupId = type->getMarketGroupId();
-        return (marketGroupId) ? (getMarketGroup(*marketGroupId)->getName()) : (QString{});
+        return mStaticData.getTypeMarketGroupName(id);
     }
 
     MarketGroup::IdType CachingEveDataProvider::getTypeMarketGroupParentId(EveType::IdType id) const
     {
-        const auto type = getEveType(id);
-        const auto marketGroupId = type->getMarketGroupId();
-        return (marketGroupId) ? (getMarketGroupParent(*marketGroupId)->getId()) : (MarketGroup::invalidId);
+        return mStaticData.getTypeMarketGroupParentId(id);
     }
 
     const std::unordered_map<EveType::IdType, QString> &CachingEveDataProvider::getAllTradeableTypeNames() const
@@ -162,23 +157,7 @@ namespace Evernus
 
     QString CachingEveDataProvider::getTypeMetaGroupName(EveType::IdType id) const
     {
-        const auto it = mTypeMetaGroupCache.find(id);
-        if (it != std::end(mTypeMetaGroupCache))
-            return it->second->getName();
-
-        MetaGroupRepository::EntityPtr result;
-
-        try
-        {
-            result = mMetaGroupRepository.fetchForType(id);
-        }
-        catch (const MetaGroupRepository::NotFoundException &)
-        {
-            result = std::make_shared<MetaGroup>();
-        }
-
-        mTypeMetaGroupCache.emplace(id, result);
-        return result->getName();
+        return mStaticData.getTypeMetaGroupName(id);
     }
 
     QString CachingEveDataProvider::getGenericName(quint64 id) const
@@ -208,27 +187,24 @@ namespace Evernus
         return mGenericNameCache.contains(id);
     }
 
-    double CachingEveDataProvider::getTypeVolume(EveType::IdType id) const
+    std::vector<quint64> CachingEveDataProvider::findGenericNameIds(const QRegExp &filter) const
     {
-        std::lock_guard<std::mutex> lock{mTypeCacheMutex};
-
-        const auto it = mTypeCache.find(id);
-        if (it != std::end(mTypeCache))
-            return (mUsePackagedVolume) ? (getPackagedVolume(*it->second)) : (it->second->getVolume());
-
-        EveTypeRepository::EntityPtr result;
+        std::vector<quint64> result;
 
-        try
-        {
-            result = mEveTypeRepository.find(id);
-        }
-        catch (const EveTypeRepository::NotFoundException &)
+        std::lock_guard<std::recursive_mutex> lock{mGenericNameCacheMutex};
+        for (auto name = std::begin(mGenericNameCache); name != std::end(mGenericNameCache); ++name)
         {
-            result = std::make_shared<EveType>();
+            if (filter.indexIn(name.value()) != -1)
+                result.emplace_back(name.key());
         }
 
-        mTypeCache.emplace(id, result);
-        return (mUsePackagedVolume) ? (getPackagedVolume(*result)) : (result->getVolume());
+        return result;
+    }
+
+    double CachingEveDataProvider::getTypeVolume(EveType::IdType id) const
+    {
+        const auto volume = mStaticData.getTypeVolume(id);
+        return (mUsePackagedVolume) ? (getPackagedVolume(mStaticData.getTypeGroupId(id), volume)) : (volume);
     }
 
     std::shared_ptr<ExternalOrder> CachingEveDataProvider::getTypeStationSellPrice(EveType::IdType id, quint64 stationId) const
@@ -312,113 +288,84 @@ namespace Evernus
 
     void CachingEveDataProvider::updateExternalOrders(const std::vector<ExternalOrder> &orders)
     {
-        TypeLocationPairs affectedOrders;
-
-        std::vector<std::reference_wrapper<const ExternalOrder>> toStore;
-        for (const auto &order : orders)
-        {
-            toStore.emplace_back(std::cref(order));
-            affectedOrders.emplace(std::make_pair(order.getTypeId(), order.getRegionId()));
-        }
-
         clearExternalOrderCaches();
-
-        mExternalOrderRepository.removeObsolete(affectedOrders);
-        mExternalOrderRepository.batchStore(toStore, true);
+        mExternalOrderRepository.storeChanged(orders);
     }
 
     void CachingEveDataProvider::clearExternalOrders()
     {
         clearExternalOrderCaches();
         mExternalOrderRepository.removeAll();
+
+        ++mExternalOrderClearCount;
     }
 
     void CachingEveDataProvider::clearExternalOrdersForType(EveType::IdType id)
     {
         clearExternalOrderCaches();
         mExternalOrderRepository.removeForType(id);
+
+        ++mExternalOrderClearCount;
+    }
+
+    uint CachingEveDataProvider::getExternalOrderClearCount() const
+    {
+        return mExternalOrderClearCount;
     }
 
     QString CachingEveDataProvider::getLocationName(quint64 id) const
     {
+        QString result;
+        if (id >= 66000000 && id <= 66014933)
+            result = mStaticData.getStationName(id - 6000001);
+        else if (id > 60000000 && id <= 61000000)
+            result = mStaticData.getStationName(id);
+        else
+            result = mStaticData.getMapItemName(id);
+
+        if (!result.isEmpty())
+            return result;
+
+        std::lock_guard<std::mutex> lock{mCitadelLookupMutex};
+
         const auto it = mLocationNameCache.find(id);
         if (it != std::end(mLocationNameCache))
             return it->second;
 
-        QString result;
-        if (id >= 66000000 && id <= 66014933)
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT stationName FROM staStations WHERE stationID = ?"));
-            query.bindValue(0, id - 6000001);
+        // citadel?
+        result = getCitadelName(id);
+        if (result.isEmpty())   // still nothing? give some feedback
+            result = tr("- unknown location -");
 
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                result = query.value(0).toString();
-        }
-        else if (id > 60000000 && id <= 61000000)
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT stationName FROM staStations WHERE stationID = ?"));
-            query.bindValue(0, id);
+        mLocationNameCache.emplace(id, result);
+        return result;
+    }
 
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                result = query.value(0).toString();
-        }
-        else
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT itemName FROM mapDenormalize WHERE itemID = ?"));
-            query.bindValue(0, id);
+    std::vector<quint64> CachingEveDataProvider::findLocationIds(const QRegExp &filter) const
+    {
+        auto result = mStaticData.findLocationIds(filter);
 
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                result = query.value(0).toString();
-        }
+        std::lock_guard<std::mutex> lock{mCitadelLookupMutex};
 
-        if (result.isEmpty())   // citadel?
+        const auto &citadels = getCitadels();
+        for (const auto &citadel : citadels)
         {
-            result = getCitadelName(id);
-            if (result.isEmpty())   // still nothing? give some feedback
-                result = tr("- unknown location -");
+            Q_ASSERT(citadel);
+            if (filter.indexIn(citadel->getName()) != -1)
+                result.emplace_back(citadel->getId());
         }
 
-        mLocationNameCache.emplace(id, result);
         return result;
     }
 
     QString CachingEveDataProvider::getRegionName(uint id) const
     {
-        const auto it = mRegionNameCache.find(id);
-        if (it != std::end(mRegionNameCache))
-            return it->second;
-
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT regionName FROM mapRegions WHERE regionID = ?"));
-        query.bindValue(0, id);
-
-        DatabaseUtils::execQuery(query);
-        query.next();
-
-        return mRegionNameCache.emplace(id, query.value(0).toString()).first->second;
+        return mStaticData.getRegionName(id);
     }
 
     QString CachingEveDataProvider::getSolarSystemName(uint id) const
     {
-        const auto it = mSolarSystemNameCache.find(id);
-        if (it != std::end(mSolarSystemNameCache))
-            return it->second;
-
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT solarSystemName FROM mapSolarSystems WHERE solarSystemID = ?"));
-        query.bindValue(0, id);
-
-        DatabaseUtils::execQuery(query);
-        if (!query.next())
-            return mSolarSystemNameCache.emplace(id, QString{}).first->second;
-
-        return mSolarSystemNameCache.emplace(id, query.value(0).toString()).first->second;
+        return mStaticData.getSolarSystemName(id);
     }
 
     const std::vector<EveDataProvider::MapLocation> &CachingEveDataProvider::getRegions() const
@@ -598,57 +545,20 @@ namespace Evernus
 
     double CachingEveDataProvider::getSolarSystemSecurityStatus(uint solarSystemId) const
     {
-        const auto it = mSecurityStatuses.find(solarSystemId);
-        if (it != std::end(mSecurityStatuses))
-            return it->second;
-
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT security FROM mapSolarSystems WHERE solarSystemID = ?"));
-        query.bindValue(0, solarSystemId);
-
-        DatabaseUtils::execQuery(query);
-
-        if (!query.next())
-            return mSecurityStatuses.emplace(solarSystemId, 0.).first->second;
-
-        return mSecurityStatuses.emplace(solarSystemId, query.value(0).toDouble()).first->second;
+        return mStaticData.getSolarSystemSecurityStatus(solarSystemId);
     }
 
     uint CachingEveDataProvider::getSolarSystemConstellationId(uint solarSystemId) const
     {
-        const auto it = mSolarSystemConstellationCache.find(solarSystemId);
-        if (it != std::end(mSolarSystemConstellationCache))
-            return it->second;
-
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT constellationID FROM mapSolarSystems WHERE solarSystemID = ?"));
-        query.bindValue(0, solarSystemId);
-
-        DatabaseUtils::execQuery(query);
-        query.next();
-
-        const auto constellationId = query.value(0).toUInt();
-
-        mSolarSystemConstellationCache.emplace(solarSystemId, constellationId);
-        return constellationId;
+        return mStaticData.getSolarSystemConstellationId(solarSystemId);
     }
 
     uint CachingEveDataProvider::getStationRegionId(quint64 stationId) const
     {
-        const auto it = mStationRegionCache.find(stationId);
-        if (it != std::end(mStationRegionCache))
-            return it->second;
-
         uint result = 0;
         if (stationId >= 66000000 && stationId <= 66014933)
         {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT regionID FROM staStations WHERE stationID = ?"));
-            query.bindValue(0, stationId - 6000001);
-
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                result = query.value(0).toUInt();
+            result = mStaticData.getStationRegionId(stationId - 6000001);
         }
         else if ((stationId >= 66014934 && stationId <= 67999999) ||
                  (stationId >= 60014861 && stationId <= 60014928) ||
@@ -660,76 +570,38 @@ namespace Evernus
         }
         else if (stationId > 60000000 && stationId <= 61000000)
         {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT regionID FROM staStations WHERE stationID = ?"));
-            query.bindValue(0, stationId);
-
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                result = query.value(0).toUInt();
+            result = mStaticData.getStationRegionId(stationId);
         }
         else
         {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT regionID FROM mapDenormalize WHERE itemID = ?"));
-            query.bindValue(0, stationId);
-
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                result = query.value(0).toUInt();
+            result = mStaticData.getMapItemRegionId(stationId);
         }
 
         if (result == 0)   // citadel?
+        {
+            std::lock_guard<std::mutex> lock{mCitadelLookupMutex};
             result = getCitadelRegionId(stationId);
+        }
 
-        mStationRegionCache.emplace(stationId, result);
         return result;
     }
 
     uint CachingEveDataProvider::getStationSolarSystemId(quint64 stationId) const
     {
-        std::lock_guard<std::mutex> lock{mLocationSolarSystemCacheMutex};
-
-        const auto it = mLocationSolarSystemCache.find(stationId);
-        if (it != std::end(mLocationSolarSystemCache))
-            return it->second;
-
         uint systemId = 0;
         if (stationId >= 66000000 && stationId <= 66014933)
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT solarSystemID FROM staStations WHERE stationID = ?"));
-            query.bindValue(0, stationId - 6000001);
-
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                systemId = query.value(0).toUInt();
-        }
+            systemId = mStaticData.getStationSolarSystemId(stationId - 6000001);
         else if (stationId > 60000000 && stationId <= 61000000)
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT solarSystemID FROM staStations WHERE stationID = ?"));
-            query.bindValue(0, stationId);
-
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                systemId = query.value(0).toUInt();
-        }
+            systemId = mStaticData.getStationSolarSystemId(stationId);
         else
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT solarSystemID FROM mapDenormalize WHERE itemID = ?"));
-            query.bindValue(0, stationId);
-
-            DatabaseUtils::execQuery(query);
-            if (query.next())
-                systemId = query.value(0).toUInt();
-        }
+            systemId = mStaticData.getMapItemSolarSystemId(stationId);
 
         if (systemId == 0)  // citadel?
+        {
+            std::lock_guard<std::mutex> lock{mCitadelLookupMutex};
             systemId = getCitadelSolarSystemId(stationId);
+        }
 
-        mLocationSolarSystemCache.emplace(stationId, systemId);
         return systemId;
     }
 
@@ -759,70 +631,14 @@ namespace Evernus
 
     const CachingEveDataProvider::ReprocessingMap &CachingEveDataProvider::getOreReprocessingInfo() const
     {
-        if (mOreReprocessingInfo.empty())
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral(R"(
-SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM invTypeMaterials m INNER JOIN (
-    SELECT typeID, portionSize, groupID FROM invTypes WHERE groupID IN (
-        SELECT groupID FROM invGroups WHERE groupName IN ('%1')
-    ) AND marketGroupID IS NOT NULL
-) t ON t.typeID = m.typeID
-            )").arg(oreGroupNames.join(QStringLiteral("', '"))));
-
-            DatabaseUtils::execQuery(query);
-
-            while (query.next())
-            {
-                auto &info = mOreReprocessingInfo[query.value(0).value<EveType::IdType>()];
-                info.mPortionSize = query.value(3).toUInt();
-                info.mGroupId = query.value(4).toUInt();
-                info.mMaterials.emplace_back(MaterialInfo{
-                    query.value(1).value<EveType::IdType>(),
-                    query.value(2).toUInt()
-                });
-            }
-        }
-
-        return mOreReprocessingInfo;
+        return mIndustryData.getOreReprocessingInfo();
     }
 
     const CachingEveDataProvider::ReprocessingMap &CachingEveDataProvider::getTypeReprocessingInfo(const TypeList &requestedTypes) const
     {
-        auto reducedTypes = requestedTypes;
-        for (const auto &info : mTypeReprocessingInfo)
-            reducedTypes.erase(info.first);
-
-        if (!reducedTypes.empty())
-        {
-            QStringList typeNames;
-            reducedTypes.reserve(reducedTypes.size());
-
-            for (const auto id : reducedTypes)
-                typeNames << QString::number(id);
-
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral(R"(
-SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM invTypeMaterials m INNER JOIN (
-    SELECT typeID, portionSize, groupID FROM invTypes WHERE typeID IN (%1) AND marketGroupID IS NOT NULL
-) t ON t.typeID = m.typeID
-            )").arg(typeNames.join(", ")));
-
-            DatabaseUtils::execQuery(query);
-
-            while (query.next())
-            {
-                auto &info = mTypeReprocessingInfo[query.value(0).value<EveType::IdType>()];
-                info.mPortionSize = query.value(3).toUInt();
-                info.mGroupId = query.value(4).toUInt();
-                info.mMaterials.emplace_back(MaterialInfo{
-                    query.value(1).value<EveType::IdType>(),
-                    query.value(2).toUInt()
-                });
-            }
-        }
-
-        return mTypeReprocessingInfo;
+        // everything is preloaded
+        Q_UNUSED(requestedTypes);
+        return mIndustryData.getReprocessingInfo();
     }
 
     uint CachingEveDataProvider::getGroupId(const QString &name) const
@@ -864,18 +680,61 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
 
     void CachingEveDataProvider::precacheJumpMap()
     {
+        QSettings settings;
+        const auto sdeVersion = settings.value(UpdaterSettings::sdeVersionKey).toString();
+
+        const auto dataCacheDir = getCacheDir();
+        const auto distanceCacheFileName = dataCacheDir.filePath(systemDistanceCacheFileName);
+
+        if (mSystemDistances.load(distanceCacheFileName, sdeVersion))
+            return;
+
+        SystemDistanceTable::JumpMap jumpMap;
+
         auto query = mConnectionProvider.getConnection().exec(QStringLiteral("SELECT fromRegionID, fromSolarSystemID, toSolarSystemID FROM mapSolarSystemJumps WHERE fromRegionID = toRegionID"));
         while (query.next())
-            mSystemJumpMap[query.value(0).toUInt()].emplace(query.value(1).toUInt(), query.value(2).toUInt());
+            jumpMap[query.value(0).toUInt()].emplace(query.value(1).toUInt(), query.value(2).toUInt());
+
+        mSystemDistances.build(jumpMap);
+
+        if (dataCacheDir.mkpath(QStringLiteral(".")) && !mSystemDistances.save(distanceCacheFileName, sdeVersion))
+            qWarning() << "Error saving distance table:" << distanceCacheFileName;
+    }
+
+    void CachingEveDataProvider::precacheIndustryData()
+    {
+        QSettings settings;
+        const auto sdeVersion = settings.value(UpdaterSettings::sdeVersionKey).toString();
 
         const auto dataCacheDir = getCacheDir();
+        const auto industryCacheFileName = dataCacheDir.filePath(industryDataCacheFileName);
 
-        QFile distanceCache{dataCacheDir.filePath(systemDistanceCacheFileName)};
-        if (distanceCache.open(QIODevice::ReadOnly))
-        {
-            QDataStream cacheStream{&distanceCache};
-            cacheStream >> mSystemDistances;
-        }
+        if (mIndustryData.load(industryCacheFileName, sdeVersion))
+            return;
+
+        mIndustryData.build(mConnectionProvider.getConnection(), mManufacturingActivityId, oreGroupNames);
+
+        if (dataCacheDir.mkpath(QStringLiteral(".")) && !mIndustryData.save(industryCacheFileName, sdeVersion))
+            qWarning() << "Error saving industry data:" << industryCacheFileName;
+    }
+
+    void CachingEveDataProvider::precacheStaticData()
+    {
+        QSettings settings;
+        const auto sdeVersion = settings.value(UpdaterSettings::sdeVersionKey).toString();
+
+        const auto dataCacheDir = getCacheDir();
+        const auto staticDataFileName = dataCacheDir.filePath(staticDataCacheFileName);
+
+        const auto packVersion = getStaticDataVersion(sdeVersion);
+
+        if (mStaticData.load(staticDataFileName, packVersion))
+            return;
+
+        mStaticData.build(mConnectionProvider.getConnection());
+
+        if (dataCacheDir.mkpath(QStringLiteral(".")) && !mStaticData.save(staticDataFileName, packVersion))
+            qWarning() << "Error saving static data pack:" << staticDataFileName;
     }
 
     void CachingEveDataProvider::clearExternalOrderCaches()
@@ -894,6 +753,11 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
 
     void CachingEveDataProvider::clearCitadelCache()
     {
+        // scripts look up citadels from their own thread
+        std::lock_guard<std::mutex> lock{mCitadelLookupMutex};
+
+        // names which weren't found before might be known now
+        mLocationNameCache.clear();
         mCitadelCache.clear();
         mRegionCitadelCache.clear();
         mAllCitadelsCache.clear();
@@ -902,8 +766,6 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
     void CachingEveDataProvider::handleNewPreferences()
     {
         QSettings settings;
-
-        std::lock_guard<std::mutex> lock{mTypeCacheMutex};
         mUsePackagedVolume = settings.value(UISettings::usePackagedVolumeKey, UISettings::usePackagedVolumeDefault).toBool();
     }
 
@@ -914,7 +776,13 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
         const auto key = std::make_pair(id, stationId);
         const auto it = mStationSellPrices.find(key);
         if (it != std::end(mStationSellPrices))
+        {
+            // placeholder left by an earlier call which didn't mind missing prices
+            if (!dontThrow && isPricePlaceholder(it->second))
+                BOOST_THROW_EXCEPTION(ExternalOrderRepository::NotFoundException{});
+
             return it->second;
+        }
 
         std::shared_ptr<ExternalOrder> result;
 
@@ -934,6 +802,52 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
         return result;
     }
 
+    ExternalOrderRepository::TypeLocationPriceMap CachingEveDataProvider::getTypeSellPrices(const TypeLocationPairs &pairs, bool dontThrow) const
+    {
+        std::lock_guard<std::recursive_mutex> lock{mExternalOrderCacheMutex};
+
+        ExternalOrderRepository::TypeLocationPriceMap result;
+        result.reserve(pairs.size());
+
+        // cached placeholders are prices which were missing before
+        auto complete = true;
+
+        TypeLocationPairs missing;
+        for (const auto &pair : pairs)
+        {
+            const auto it = mStationSellPrices.find(pair);
+            if (it == std::end(mStationSellPrices))
+            {
+                missing.emplace(pair);
+            }
+            else
+            {
+                complete = complete && !isPricePlaceholder(it->second);
+                result.emplace(pair, it->second);
+            }
+        }
+
+        if (!missing.empty())
+        {
+            auto found = mExternalOrderRepository.findSellByTypesAndStations(missing, mMarketOrderRepository, mCorpMarketOrderRepository);
+            complete = complete && found.size() == missing.size();
+
+            for (const auto &pair : missing)
+            {
+                const auto it = found.find(pair);
+                const auto order = (it == std::end(found)) ? (std::make_shared<ExternalOrder>()) : (std::move(it->second));
+
+                mStationSellPrices.emplace(pair, order);
+                result.emplace(pair, order);
+            }
+        }
+
+        if (!dontThrow && !complete)
+            BOOST_THROW_EXCEPTION(ExternalOrderRepository::NotFoundException{});
+
+        return result;
+    }
+
     void CachingEveDataProvider::fetchGenericName(quint64 id)
     {
         qDebug() << "Fetching generic name:" << id;
@@ -960,85 +874,9 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
         });
     }
 
-    EveTypeRepository::EntityPtr CachingEveDataProvider::getEveType(EveType::IdType id) const
-    {
-        const auto it = mTypeCache.find(id);
-        if (it != std::end(mTypeCache))
-            return it->second;
-
-        EveTypeRepository::EntityPtr type;
-
-        try
-        {
-            type = mEveTypeRepository.find(id);
-        }
-        catch (const EveTypeRepository::NotFoundException &)
-        {
-            type = std::make_shared<EveType>();
-        }
-
-        return mTypeCache.emplace(id, type).first->second;
-    }
-
-    MarketGroupRepository::EntityPtr CachingEveDataProvider::getMarketGroupParent(MarketGroup::IdType id) const
-    {
-        const auto it = mTypeMarketGroupParentCache.find(id);
-        if (it != std::end(mTypeMarketGroupParentCache))
-            return it->second;
-
-        MarketGroupRepository::EntityPtr result;
-
-        try
-        {
-            result = mMarketGroupRepository.findParent(id);
-        }
-        catch (const MarketGroupRepository::NotFoundException &)
-        {
-            result = std::make_shared<MarketGroup>();
-        }
-
-        return mTypeMarketGroupParentCache.emplace(id, result).first->second;
-    }
-
-    MarketGroupRepository::EntityPtr CachingEveDataProvider::getMarketGroup(MarketGroup::IdType id) const
-    {
-        const auto it = mTypeMarketGroupCache.find(id);
-        if (it != std::end(mTypeMarketGroupCache))
-            return it->second;
-
-        MarketGroupRepository::EntityPtr result;
-
-        try
-        {
-            result = mMarketGroupRepository.find(id);
-        }
-        catch (const MarketGroupRepository::NotFoundException &)
-        {
-            result = std::make_shared<MarketGroup>();
-        }
-
-        return mTypeMarketGroupCache.emplace(id, result).first->second;
-    }
-
     uint CachingEveDataProvider::getSolarSystemRegionId(uint systemId) const
     {
-        std::lock_guard<std::mutex> lock{mSolarSystemRegionCacheMutex};
-
-        const auto it = mSolarSystemRegionCache.find(systemId);
-        if (it != std::end(mSolarSystemRegionCache))
-            return it->second;
-
-        QSqlQuery query{mConnectionProvider.getConnection()};
-        query.prepare(QStringLiteral("SELECT regionID FROM mapSolarSystems WHERE solarSystemID = ?"));
-        query.bindValue(0, systemId);
-
-        DatabaseUtils::execQuery(query);
-        query.next();
-
-        const auto regionId = query.value(0).toUInt();
-
-        mSolarSystemRegionCache.emplace(systemId, regionId);
-        return regionId;
+        return mStaticData.getSolarSystemRegionId(systemId);
     }
 
     const ExternalOrderRepository::EntityList &CachingEveDataProvider::getExternalOrders(EveType::IdType typeId, uint regionId) const
@@ -1057,61 +895,7 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
 
     uint CachingEveDataProvider::getDistance(uint startSystem, uint endSystem) const
     {
-        const auto key = qMakePair(startSystem, endSystem);
-        const auto it = mSystemDistances.find(key);
-        if (it != std::end(mSystemDistances))
-            return it.value();
-
-        const auto makeUnreachable = [=] {
-            const auto value = std::numeric_limits<uint>::max();
-            mSystemDistances[key] = value;
-            mSystemDistances[qMakePair(endSystem, startSystem)] = value;
-
-            return value;
-        };
-
-        const auto regionId = getSolarSystemRegionId(startSystem);
-        if (regionId == 0)
-            return makeUnreachable();
-
-        const auto jIt = mSystemJumpMap.find(regionId);
-        if (jIt == std::end(mSystemJumpMap))
-            return makeUnreachable();
-
-        const auto &jumpMap = jIt->second;
-
-        std::unordered_set<uint> visited;
-        std::queue<std::pair<uint, uint>> candidates;
-
-        visited.emplace(startSystem);
-        candidates.emplace(std::make_pair(startSystem, 0u));
-
-        while (!candidates.empty())
-        {
-            const auto current = candidates.front();
-            candidates.pop();
-
-            const auto depth = current.second;
-            if (current.first == endSystem)
-            {
-                mSystemDistances[key] = depth;
-                mSystemDistances[qMakePair(endSystem, startSystem)] = depth;
-
-                return depth;
-            }
-
-            const auto children = jumpMap.equal_range(current.first);
-            for (auto it = children.first; it != children.second; ++it)
-            {
-                if (visited.find(it->second) == std::end(visited))
-                {
-                    visited.emplace(it->second);
-                    candidates.emplace(std::make_pair(it->second, depth + 1));
-                }
-            }
-        }
-
-        return makeUnreachable();
+        return mSystemDistances.getDistance(startSystem, endSystem);
     }
 
     QString CachingEveDataProvider::getRaceName(uint raceId) const
@@ -1131,73 +915,12 @@ SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID FROM inv
 
     const CachingEveDataProvider::ManufacturingInfo &CachingEveDataProvider::getTypeManufacturingInfo(EveType::IdType typeId) const
     {
-        auto it = mTypeManufacturingInfoCache.find(typeId);
-        if (it == std::end(mTypeManufacturingInfoCache))
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral(R"(
-SELECT m.materialTypeID, m.quantity, p.quantity, a.time, s.skillID FROM industryActivityMaterials m
-    INNER JOIN industryActivityProducts p
-        ON m.typeID = p.typeID AND m.activityID = p.activityID AND p.productTypeID = ? AND p.activityID = ?
-    INNER JOIN industryActivity a
-        ON a.typeID = p.typeID AND a.activityID = m.activityID
-    INNER JOIN industryActivitySkills s
-        ON s.typeID = p.typeID AND s.activityID = m.activityID
-            )"));
-            query.addBindValue(typeId);
-            query.addBindValue(mManufacturingActivityId);
-
-            ManufacturingInfo info{0};
-
-            DatabaseUtils::execQuery(query);
-
-            std::unordered_set<EveType::IdType> usedMaterials;
-
-            while (query.next())
-            {
-                const auto skillId = query.value(4).toUInt();
-                if (skillId != industrySkillId && skillId != advancedIndustrySkillId)
-                    info.mAdditionalsSkills.insert(skillId);
-
-                const auto materialId = query.value(0).value<EveType::IdType>();
-                if (usedMaterials.find(materialId) != std::end(usedMaterials))
-                    continue;
-
-                if (info.mQuantity == 0)
-                {
-                    info.mQuantity = query.value(2).toUInt();
-                    info.mTime = std::chrono::seconds{query.value(3).toUInt()};
-                }
-
-                usedMaterials.emplace(materialId);
-                info.mMaterials.emplace_back(MaterialInfo{materialId, query.value(1).toUInt()});
-            }
-
-            it = mTypeManufacturingInfoCache.emplace(typeId, std::move(info)).first;
-        }
-
-        return it->second;
+        return mIndustryData.getManufacturingInfo(typeId);
     }
 
     EveType::IdType CachingEveDataProvider::getBlueprintOutputType(EveType::IdType blueprintId) const
     {
-        auto type = mBlueprintOutputCache.find(blueprintId);
-        if (type == std::end(mBlueprintOutputCache))
-        {
-            QSqlQuery query{mConnectionProvider.getConnection()};
-            query.prepare(QStringLiteral("SELECT productTypeID FROM industryActivityProducts WHERE typeID = ? AND activityID = ?"));
-            query.addBindValue(blueprintId);
-            query.addBindValue(mManufacturingActivityId);
-
-            DatabaseUtils::execQuery(query);
-
-            if (query.next())
-                type = mBlueprintOutputCache.emplace(blueprintId, query.value(0).value<EveType::IdType>()).first;
-            else
-                type = mBlueprintOutputCache.emplace(blueprintId, EveType::invalidId).first;
-        }
-
-        return type->second;
+        return mIndustryData.getBlueprintOutputType(blueprintId);
     }
 
     QString CachingEveDataProvider::getCitadelName(Citadel::IdType id) const
@@ -1242,11 +965,10 @@ SELECT m.materialTypeID, m.quantity, p.quantity, a.time, s.skillID FROM industry
         return *citadel->second;
     }
 
-    double CachingEveDataProvider::getPackagedVolume(const EveType &type)
+    double CachingEveDataProvider::getPackagedVolume(uint groupId, double volume)
     {
         // https://bitbucket.org/krojew/evernus/issue/30/utilize-packaged-size-for-total-size
         // thank you CCP for this cool and unexpected feature!
-        const auto groupId = type.getGroupId();
         switch (groupId) {
         case 29:
         case 1022:
@@ -1323,15 +1045,15 @@ SELECT m.materialTypeID, m.quantity, p.quantity, a.time, s.skillID FROM industry
         case 1199:
         case 1697:
         case 1698:
-            if (type.getVolume() > 1000.)
+            if (volume > 1000.)
                 return 1000.;
             break;
         case 60:
-            if (type.getVolume() > 2000.)
+            if (volume > 2000.)
                 return 2000.;
         }
 
-        return type.getVolume();
+        return volume;
     }
 
     void CachingEveDataProvider::findManufaturingActivity()
@@ -1368,11 +1090,23 @@ SELECT m.materialTypeID, m.quantity, p.quantity, a.time, s.skillID FROM industry
         }
     }
 
+    bool CachingEveDataProvider::isPricePlaceholder(const std::shared_ptr<ExternalOrder> &order) noexcept
+    {
+        return !order || order->getPrice() <= 0.;
+    }
+
     QDir CachingEveDataProvider::getCacheDir()
     {
         return QDir{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/data")};
     }
 
+    QString CachingEveDataProvider::getStaticDataVersion(const QString &sdeVersion)
+    {
+        // also catch local db replacements, like the ones done by update_sde.sh
+        const QFileInfo dbInfo{EveDatabaseConnectionProvider::getDatabasePath()};
+        return QStringLiteral("%1/%2").arg(sdeVersion).arg(dbInfo.lastModified().toMSecsSinceEpoch());
+    }
+
     ESIManager::Callback<ESIManager::NameMap> CachingEveDataProvider::getFillNameMapCallback(NameMap &target)
     {
         return [&](auto &&data, const auto &error, const auto &expires) {
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <unordered_set>
+#include <atomic>
 #include <mutex>
 
 #include <QStringList>
@@ -23,8 +24,9 @@
 #include <boost/functional/hash.hpp>
 
 #include "ExternalOrderRepository.h"
-#include "MarketGroupRepository.h"
-#include "MetaGroupRepository.h"
+#include "SystemDistanceTable.h"
+#include "IndustryDataTable.h"
+#include "StaticDataPack.h"
 #include "EveTypeRepository.h"
 #include "EveDataProvider.h"
 #include "ESIManager.h"
@@ -45,13 +47,13 @@ namespace Evernus
 
     public:
         static const QString systemDistanceCacheFileName;
+        static const QString industryDataCacheFileName;
+        static const QString staticDataCacheFileName;
 
         CachingEveDataProvider(const EveTypeRepository &eveTypeRepository,
-                               const MetaGroupRepository &metaGroupRepository,
                                const ExternalOrderRepository &externalOrderRepository,
                                const MarketOrderRepository &marketOrderRepository,
                                const MarketOrderRepository &corpMarketOrderRepository,
-                               const MarketGroupRepository &marketGroupRepository,
                                const CitadelRepository &citadelRepository,
                                const EveDataManagerProvider &dataManagerProvider,
                                const DatabaseConnectionProvider &connectionProvider,
@@ -68,6 +70,7 @@ namespace Evernus
         virtual QString getTypeMetaGroupName(EveType::IdType id) const override;
         virtual QString getGenericName(quint64 id) const override;
         virtual bool hasGenericName(quint64 id) const override;
+        virtual std::vector<quint64> findGenericNameIds(const QRegExp &filter) const override;
 
         virtual double getTypeVolume(EveType::IdType id) const override;
         virtual std::shared_ptr<ExternalOrder> getTypeStationSellPrice(EveType::IdType id, quint64 stationId) const override;
@@ -77,8 +80,10 @@ namespace Evernus
         virtual void updateExternalOrders(const std::vector<ExternalOrder> &orders) override;
         virtual void clearExternalOrders() override;
         virtual void clearExternalOrdersForType(EveType::IdType id) override;
+        virtual uint getExternalOrderClearCount() const override;
 
         virtual QString getLocationName(quint64 id) const override;
+        virtual std::vector<quint64> findLocationIds(const QRegExp &filter) const override;
         virtual QString getRegionName(uint id) const override;
         virtual QString getSolarSystemName(uint id) const override;
 
@@ -115,7 +120,9 @@ namespace Evernus
         virtual EveType::IdType getBlueprintOutputType(EveType::IdType blueprintId) const override;
 
         void precacheNames();
+        void precacheStaticData();
         void precacheJumpMap();
+        void precacheIndustryData();
         void precacheRefTypes();
 
         void clearExternalOrderCaches();
@@ -125,8 +132,13 @@ namespace Evernus
         void handleNewPreferences();
 
         std::shared_ptr<ExternalOrder> getTypeSellPrice(EveType::IdType id, quint64 stationId, bool dontThrow) const;
+        // resolves all cache misses with a single query; with dontThrow, missing prices come as placeholders
+        ExternalOrderRepository::TypeLocationPriceMap getTypeSellPrices(const TypeLocationPairs &pairs, bool dontThrow) const;
 
+        static bool isPricePlaceholder(const std::shared_ptr<ExternalOrder> &order) noexcept;
         static QDir getCacheDir();
+        // static data pack is tied to both SDE version and the actual db file
+        static QString getStaticDataVersion(const QString &sdeVersion);
 
     signals:
         void genericNameRequested(quint64 id) const;
@@ -148,10 +160,8 @@ namespace Evernus
         static const QStringList oreGroupNames;
 
         const EveTypeRepository &mEveTypeRepository;
-        const MetaGroupRepository &mMetaGroupRepository;
         const ExternalOrderRepository &mExternalOrderRepository;
         const MarketOrderRepository &mMarketOrderRepository, &mCorpMarketOrderRepository;
-        const MarketGroupRepository &mMarketGroupRepository;
         const CitadelRepository &mCitadelRepository;
 
         const EveDataManagerProvider &mDataManagerProvider;
@@ -161,8 +171,6 @@ namespace Evernus
         mutable std::unordered_map<EveType::IdType, QString> mTradeableTypeNameCache;
         mutable TypeList mTradeableTypeCache;
         mutable TypeList mCitadelTypeCache;
-        mutable std::unordered_map<EveType::IdType, MetaGroupRepository::EntityPtr> mTypeMetaGroupCache;
-        mutable std::unordered_map<EveType::IdType, EveTypeRepository::EntityPtr> mTypeCache;
 
         mutable std::unordered_map<TypeLocationPair, ExternalOrderRepository::EntityPtr, boost::hash<TypeLocationPair>>
         mStationSellPrices;
@@ -174,28 +182,16 @@ namespace Evernus
         mutable std::unordered_map<TypeRegionPair, ExternalOrderRepository::EntityList, boost::hash<TypeRegionPair>>
         mTypeRegionOrderCache;
 
+        // only names which aren't in the static data
         mutable std::unordered_map<quint64, QString> mLocationNameCache;
 
-        mutable std::unordered_map<EveType::IdType, MarketGroupRepository::EntityPtr> mTypeMarketGroupParentCache;
-        mutable std::unordered_map<EveType::IdType, MarketGroupRepository::EntityPtr> mTypeMarketGroupCache;
-
         mutable NameMap mGenericNameCache;
         mutable std::unordered_set<quint64> mPendingNameRequests;
 
-        std::unordered_map<uint, std::unordered_multimap<uint, uint>> mSystemJumpMap;
-
-        mutable std::unordered_map<uint, uint> mSolarSystemRegionCache;
-        mutable std::unordered_map<uint, uint> mSolarSystemConstellationCache;
-        mutable std::unordered_map<quint64, uint> mLocationSolarSystemCache;
-
-        mutable std::mutex mLocationSolarSystemCacheMutex;
-        mutable std::mutex mTypeCacheMutex;
+        mutable std::mutex mCitadelLookupMutex;
         mutable std::recursive_mutex mExternalOrderCacheMutex;
-        mutable std::mutex mSolarSystemRegionCacheMutex;
         mutable std::recursive_mutex mGenericNameCacheMutex;
 
-        mutable std::unordered_map<uint, double> mSecurityStatuses;
-
         mutable std::vector<MapLocation> mRegionCache;
         mutable std::unordered_map<uint, std::vector<MapLocation>> mConstellationCache, mConstellationSolarSystemCache, mRegionSolarSystemCache;
         mutable std::unordered_map<uint, std::vector<Station>> mStationCache;
@@ -206,22 +202,16 @@ namespace Evernus
         mutable std::vector<MapTreeLocation> mAllSolarSystemsCache;
         mutable CitadelRepository::EntityList mAllCitadelsCache;
 
-        mutable std::unordered_map<uint, QString> mRegionNameCache;
-        mutable std::unordered_map<uint, QString> mSolarSystemNameCache;
-
-        mutable std::unordered_map<quint64, uint> mStationRegionCache;
-
         mutable QHash<QString, uint> mGroupIdCache;
 
-        bool mUsePackagedVolume = false;
+        std::atomic_bool mUsePackagedVolume{false};
 
-        mutable QHash<QPair<uint, uint>, uint> mSystemDistances;
+        std::atomic_uint mExternalOrderClearCount{0};
 
-        mutable ReprocessingMap mOreReprocessingInfo;
-        mutable ReprocessingMap mTypeReprocessingInfo;
+        StaticDataPack mStaticData;
+        SystemDistanceTable mSystemDistances;
 
-        mutable std::unordered_map<EveType::IdType, ManufacturingInfo> mTypeManufacturingInfoCache;
-        mutable std::unordered_map<EveType::IdType, EveType::IdType> mBlueprintOutputCache;
+        IndustryDataTable mIndustryData;
 
         NameMap mRaceNameCache;
         NameMap mBloodlineNameCache;
@@ -229,11 +219,6 @@ namespace Evernus
 
         uint mManufacturingActivityId = 1; // 1 - fallback id at the time of writing
 
-        EveTypeRepository::EntityPtr getEveType(EveType::IdType id) const;
-
-        MarketGroupRepository::EntityPtr getMarketGroupParent(MarketGroup::IdType id) const;
-        MarketGroupRepository::EntityPtr getMarketGroup(MarketGroup::IdType id) const;
-
         const ExternalOrderRepository::EntityList &getExternalOrders(EveType::IdType typeId, uint regionId) const;
 
         QString getCitadelName(Citadel::IdType id) const;
@@ -249,6 +234,6 @@ namespace Evernus
 
         static ESIManager::Callback<ESIManager::NameMap> getFillNameMapCallback(NameMap &target);
 
-        static double getPackagedVolume(const EveType &type);
+        static double getPackagedVolume(uint groupId, double volume);
     };
 }
@@ -12,6 +12,11 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <iterator>
+
+#include <QtDebug>
+
 #include "CachingMarketOrderProvider.h"
 
 namespace Evernus
@@ -44,20 +49,9 @@ namespace Evernus
     MarketOrderProvider::OrderList CachingMarketOrderProvider
     ::getArchivedOrders(Character::IdType characterId, const QDateTime &from, const QDateTime &to) const
     {
-        auto it = mArchivedOrders.find(characterId);
-        if (it == std::end(mArchivedOrders))
-            it = mArchivedOrders.emplace(characterId, mOrderRepo.fetchArchivedForCharacter(characterId)).first;
-
-        std::vector<std::shared_ptr<MarketOrder>> result;
-        for (const auto &order : it->second)
-        {
-            const auto lastSeen = order->getLastSeen();
-
-            if (lastSeen >= from && lastSeen <= to)
-                result.emplace_back(order);
-        }
-
-        return result;
+        return getArchivedRange(mArchivedOrders, characterId, from, to, [=](const auto &rangeFrom, const auto &rangeTo) {
+            return mOrderRepo.fetchArchivedForCharacter(characterId, rangeFrom, rangeTo);
+        });
     }
 
     MarketOrderProvider::OrderList CachingMarketOrderProvider::getSellOrdersForCorporation(quint64 corporationId) const
@@ -81,20 +75,9 @@ namespace Evernus
     MarketOrderProvider::OrderList CachingMarketOrderProvider
     ::getArchivedOrdersForCorporation(quint64 corporationId, const QDateTime &from, const QDateTime &to) const
     {
-        auto it = mCorpArchivedOrders.find(corporationId);
-        if (it == std::end(mCorpArchivedOrders))
-            it = mCorpArchivedOrders.emplace(corporationId, mOrderRepo.fetchArchivedForCorporation(corporationId)).first;
-
-        std::vector<std::shared_ptr<MarketOrder>> result;
-        for (const auto &order : it->second)
-        {
-            const auto lastSeen = order->getLastSeen();
-
-            if (lastSeen >= from && lastSeen <= to)
-                result.emplace_back(order);
-        }
-
-        return result;
+        return getArchivedRange(mCorpArchivedOrders, corporationId, from, to, [=](const auto &rangeFrom, const auto &rangeTo) {
+            return mOrderRepo.fetchArchivedForCorporation(corporationId, rangeFrom, rangeTo);
+        });
     }
 
     void CachingMarketOrderProvider::removeOrder(MarketOrder::IdType id)
@@ -137,14 +120,12 @@ namespace Evernus
     {
         mSellOrders.erase(id);
         mBuyOrders.erase(id);
-        mArchivedOrders.erase(id);
     }
 
     void CachingMarketOrderProvider::clearOrdersForCorporation(uint id) const
     {
         mCorpSellOrders.erase(id);
         mCorpBuyOrders.erase(id);
-        mCorpArchivedOrders.erase(id);
     }
 
     void CachingMarketOrderProvider::clearArchived() const
@@ -153,6 +134,13 @@ namespace Evernus
         mCorpArchivedOrders.clear();
     }
 
+    void CachingMarketOrderProvider
+    ::invalidateArchived(Character::IdType characterId, quint64 corporationId, const QDateTime &since) const
+    {
+        invalidateArchivedRange(mArchivedOrders, characterId, since);
+        invalidateArchivedRange(mCorpArchivedOrders, corporationId, since);
+    }
+
     void CachingMarketOrderProvider::clearAll()
     {
         mSellOrders.clear();
@@ -162,4 +150,83 @@ namespace Evernus
         mCorpBuyOrders.clear();
         mCorpArchivedOrders.clear();
     }
+
+    template<class Map, class Fetcher>
+    MarketOrderProvider::OrderList CachingMarketOrderProvider
+    ::getArchivedRange(Map &cache, typename Map::key_type id, const QDateTime &from, const QDateTime &to, Fetcher fetcher)
+    {
+        if (from > to)
+            return OrderList{};
+
+        auto it = cache.find(id);
+        if (it == std::end(cache) || to < it->second.mFrom.addMSecs(-1) || from > it->second.mTo.addMSecs(1))
+        {
+            // nothing to extend - replace whatever was there, so we only hold what was asked for
+            auto &range = cache[id];
+            range.mFrom = from;
+            range.mTo = to;
+            range.mOrders = fetcher(from, to);
+
+            qDebug() << "Loaded" << range.mOrders.size() << "archived orders for" << id << "from" << from << "to" << to;
+
+            return range.mOrders;
+        }
+
+        auto &range = it->second;
+
+        // load only the missing edges
+        if (from < range.mFrom)
+        {
+            auto orders = fetcher(from, range.mFrom.addMSecs(-1));
+            orders.insert(std::end(orders),
+                          std::make_move_iterator(std::begin(range.mOrders)),
+                          std::make_move_iterator(std::end(range.mOrders)));
+
+            range.mOrders = std::move(orders);
+            range.mFrom = from;
+        }
+        if (to > range.mTo)
+        {
+            auto orders = fetcher(range.mTo.addMSecs(1), to);
+            range.mOrders.insert(std::end(range.mOrders),
+                                 std::make_move_iterator(std::begin(orders)),
+                                 std::make_move_iterator(std::end(orders)));
+
+            range.mTo = to;
+        }
+
+        const auto first = std::lower_bound(std::begin(range.mOrders), std::end(range.mOrders), from, [](const auto &order, const auto &dt) {
+            return order->getLastSeen() < dt;
+        });
+        const auto last = std::upper_bound(first, std::end(range.mOrders), to, [](const auto &dt, const auto &order) {
+            return dt < order->getLastSeen();
+        });
+
+        return OrderList{first, last};
+    }
+
+    template<class Map>
+    void CachingMarketOrderProvider::invalidateArchivedRange(Map &cache, typename Map::key_type id, const QDateTime &since)
+    {
+        const auto it = cache.find(id);
+        if (it == std::end(cache))
+            return;
+
+        auto &range = it->second;
+        if (range.mTo < since)
+            return;
+
+        if (range.mFrom >= since)
+        {
+            cache.erase(it);
+            return;
+        }
+
+        const auto first = std::lower_bound(std::begin(range.mOrders), std::end(range.mOrders), since, [](const auto &order, const auto &dt) {
+            return order->getLastSeen() < dt;
+        });
+
+        range.mOrders.erase(first, std::end(range.mOrders));
+        range.mTo = since.addMSecs(-1);
+    }
 }
@@ -48,24 +48,40 @@ namespace Evernus
         void clearOrdersForCharacter(Character::IdType id) const;
         void clearOrdersForCorporation(uint id) const;
         void clearArchived() const;
+        // drops cached archived orders last seen at or after given time, keeping older ones
+        void invalidateArchived(Character::IdType characterId, quint64 corporationId, const QDateTime &since) const;
 
     signals:
         void orderChanged();
 
     private:
+        // contiguous, inclusive last seen range loaded from the db, with orders sorted by last seen
+        struct ArchiveRange
+        {
+            QDateTime mFrom, mTo;
+            OrderList mOrders;
+        };
+
         typedef std::unordered_map<Character::IdType, OrderList> MarketOrderMap;
         typedef std::unordered_map<quint64, OrderList> CorpMarketOrderMap;
+        typedef std::unordered_map<Character::IdType, ArchiveRange> ArchiveMap;
+        typedef std::unordered_map<quint64, ArchiveRange> CorpArchiveMap;
 
         const MarketOrderRepository &mOrderRepo;
 
         mutable MarketOrderMap mSellOrders;
         mutable MarketOrderMap mBuyOrders;
-        mutable MarketOrderMap mArchivedOrders;
+        mutable ArchiveMap mArchivedOrders;
 
         mutable CorpMarketOrderMap mCorpSellOrders;
         mutable CorpMarketOrderMap mCorpBuyOrders;
-        mutable CorpMarketOrderMap mCorpArchivedOrders;
+        mutable CorpArchiveMap mCorpArchivedOrders;
 
         void clearAll();
+
+        template<class Map, class Fetcher>
+        static OrderList getArchivedRange(Map &cache, typename Map::key_type id, const QDateTime &from, const QDateTime &to, Fetcher fetcher);
+        template<class Map>
+        static void invalidateArchivedRange(Map &cache, typename Map::key_type id, const QDateTime &since);
     };
 }
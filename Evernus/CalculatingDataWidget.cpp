@@ -14,6 +14,7 @@
  */
 #include <QProgressBar>
 #include <QVBoxLayout>
+#include <QPushButton>
 #include <QLabel>
 
 #include "CalculatingDataWidget.h"
@@ -30,8 +31,24 @@ namespace Evernus
         waitingLayout->addWidget(waitingLabel);
         waitingLabel->setAlignment(Qt::AlignCenter);
 
-        const auto waitingProgress = new QProgressBar{this};
-        waitingLayout->addWidget(waitingProgress);
-        waitingProgress->setRange(0, 0);
+        mProgress = new QProgressBar{this};
+        waitingLayout->addWidget(mProgress);
+        mProgress->setRange(0, 0);
+
+        mCancelBtn = new QPushButton{tr("Cancel"), this};
+        waitingLayout->addWidget(mCancelBtn, 0, Qt::AlignCenter);
+        mCancelBtn->setVisible(false);
+        connect(mCancelBtn, &QPushButton::clicked, this, &CalculatingDataWidget::cancelled);
+    }
+
+    void CalculatingDataWidget::setProgress(int done, int total)
+    {
+        mProgress->setRange(0, total);
+        mProgress->setValue(done);
+    }
+
+    void CalculatingDataWidget::setCancellable(bool flag)
+    {
+        mCancelBtn->setVisible(flag);
     }
 }
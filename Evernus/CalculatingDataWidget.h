@@ -16,6 +16,9 @@
 
 #include <QWidget>
 
+class QProgressBar;
+class QPushButton;
+
 namespace Evernus
 {
     class CalculatingDataWidget
@@ -29,9 +32,18 @@ namespace Evernus
         CalculatingDataWidget(CalculatingDataWidget &&) = default;
         virtual ~CalculatingDataWidget() = default;
 
-
+        // total of 0 means unknown progress
+        void setProgress(int done, int total);
+        void setCancellable(bool flag);
 
         CalculatingDataWidget &operator =(const CalculatingDataWidget &) = default;
         CalculatingDataWidget &operator =(CalculatingDataWidget &&) = default;
+
+    signals:
+        void cancelled();
+
+    private:
+        QProgressBar *mProgress = nullptr;
+        QPushButton *mCancelBtn = nullptr;
     };
 }
@@ -13,15 +13,20 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <algorithm>
+#include <cstdint>
+#include <chrono>
 
 #include <boost/range/adaptor/reversed.hpp>
 
 #include <QtDebug>
 
 #include <QStandardPaths>
+#include <QElapsedTimer>
 #include <QCollator>
 #include <QDir>
 
+#include "LogCategories.h"
+
 #include "ChainableFileLogger.h"
 
 namespace Evernus
@@ -30,56 +35,166 @@ namespace Evernus
 
     const QString ChainableFileLogger::fileNameBase = "main.log";
 
-    ChainableFileLogger::ChainableFileLogger(std::size_t maxLogSize, uint maxLogFiles)
-        : mMaxLogSize{maxLogSize}
-        , mMaxLogFiles{maxLogFiles}
+    ChainableFileLogger::ChainableFileLogger(const Settings &settings)
+        : mSettings{settings}
         , mLogFile{getLogDir() + fileNameBase}
     {
         QDir{}.mkpath(getLogDir());
 
         if (!openLog())
+        {
             qWarning() << "Error opening main.log file at:" << getLogDir();
-        else
-            mPrevHandler = qInstallMessageHandler(&ChainableFileLogger::handleMessage);
+            return;
+        }
+
+        if (mSettings.mAsync)
+        {
+            mQueue = std::make_unique<Slot[]>(queueSize);
+            for (auto i = 0u; i < queueSize; ++i)
+                mQueue[i].mSequence.store(i, std::memory_order_relaxed);
+
+            mWriter = std::thread{&ChainableFileLogger::runWriter, this};
+            mAsync = true;
+        }
+
+        mPrevHandler = qInstallMessageHandler(&ChainableFileLogger::handleMessage);
     }
 
     ChainableFileLogger::~ChainableFileLogger()
     {
         qInstallMessageHandler(mPrevHandler);
+
+        stopWriter();
+
+        if (!mLogFile.isOpen())
+            return;
+
+        const auto count = mMessageCount.load();
+
+        std::lock_guard<std::mutex> lock{mStreamMutex};
+
+        reportLostMessages();
+        writeLogLine(QtInfoMsg, QStringLiteral("Logger stats (%1): %2 messages, avg. %3 ns per call, %4 dropped, %5 suppressed.")
+            .arg((mSettings.mAsync) ? (QStringLiteral("async")) : (QStringLiteral("sync")))
+            .arg(count)
+            .arg(mCallerTime.load() / std::max(count, Q_UINT64_C(1)))
+            .arg(mDroppedCount.load())
+            .arg(getSuppressedCount()));
+
+        mStream.flush();
     }
 
-    void ChainableFileLogger::initialize(std::size_t maxLogSize, uint maxLogFiles)
+    void ChainableFileLogger::initialize(const Settings &settings)
     {
         Q_ASSERT(instance == nullptr);
 
-        static ChainableFileLogger instance{maxLogSize, maxLogFiles};
+        static ChainableFileLogger instance{settings};
         ChainableFileLogger::instance = &instance;
     }
 
     void ChainableFileLogger::writeMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg)
     {
+        QElapsedTimer timer;
+        timer.start();
+
+        if (isRateLimited(type, context))
+            return;
+
         if (mPrevHandler != nullptr)
             mPrevHandler(type, context, msg);
 
-        const auto log = qFormatLogMessage(type, context, msg);
+        auto log = qFormatLogMessage(type, context, msg);
         if (Q_LIKELY(!log.isEmpty()))
         {
-            std::lock_guard<std::mutex> lock{mStreamMutex};
-
-            if (Q_UNLIKELY(mCurrentLogCheckCount == 0))
+            if (mAsync.load(std::memory_order_acquire))
             {
-                if (Q_UNLIKELY(static_cast<std::size_t>(mLogFile.size()) > mMaxLogSize))
-                    rotateLogs();
+                const auto important = type != QtDebugMsg && type != QtInfoMsg;
+                if (important)
+                {
+                    // don't lose warnings - wait for the writer to make room, unless we are the writer
+                    const auto isWriter = std::this_thread::get_id() == mWriter.get_id();
+                    while (!enqueue(log))
+                    {
+                        if (isWriter)
+                        {
+                            ++mDroppedCount;
+                            break;
+                        }
 
-                mCurrentLogCheckCount = logCheckCount;
+                        mWakeWriter = true;
+                        mWriterCondition.notify_one();
+
+                        std::this_thread::yield();
+                    }
+
+                    if (type == QtFatalMsg)
+                    {
+                        // we're about to abort
+                        stopWriter();
+                    }
+                    else
+                    {
+                        mWakeWriter = true;
+                        mWriterCondition.notify_one();
+                    }
+                }
+                else if (!enqueue(std::move(log)))
+                {
+                    ++mDroppedCount;
+                }
             }
             else
             {
-                --mCurrentLogCheckCount;
+                std::lock_guard<std::mutex> lock{mStreamMutex};
+
+                writeLog(log);
+                mStream.flush();
             }
+        }
+
+        ++mMessageCount;
+        mCallerTime += timer.nsecsElapsed();
+    }
+
+    void ChainableFileLogger::writeLog(const QString &log)
+    {
+        if (Q_UNLIKELY(mCurrentLogCheckCount == 0))
+        {
+            if (Q_UNLIKELY(static_cast<std::size_t>(mLogFile.size()) > mSettings.mMaxLogSize))
+                rotateLogs();
+
+            mCurrentLogCheckCount = logCheckCount;
 
+            reportLostMessages();
+        }
+        else
+        {
+            --mCurrentLogCheckCount;
+        }
+
+        mStream << log << '\n';
+    }
+
+    void ChainableFileLogger::writeLogLine(QtMsgType type, const QString &msg)
+    {
+        const auto log = qFormatLogMessage(type, QMessageLogContext{}, msg);
+        if (!log.isEmpty())
             mStream << log << '\n';
-            mStream.flush();
+    }
+
+    void ChainableFileLogger::reportLostMessages()
+    {
+        const auto dropped = mDroppedCount.load();
+        const auto suppressed = getSuppressedCount();
+
+        if (dropped != mReportedDropped || suppressed != mReportedSuppressed)
+        {
+            writeLogLine(QtWarningMsg, QStringLiteral("Lost log messages: %1 dropped (queue full), %2 suppressed (rate limit/sampling).")
+                .arg(dropped - mReportedDropped)
+                .arg(suppressed - mReportedSuppressed));
+
+            mReportedDropped = dropped;
+            mReportedSuppressed = suppressed;
         }
     }
 
@@ -106,7 +221,7 @@ namespace Evernus
 
             ++number;
 
-            if (number >= mMaxLogFiles && number >= mRotationCount)
+            if (number >= mSettings.mMaxLogFiles && number >= mRotationCount)
                 dir.remove(file);
             else
                 dir.rename(file, QStringLiteral("%1.%2").arg(fileNameBase).arg(number));
@@ -123,6 +238,152 @@ namespace Evernus
         }
     }
 
+    bool ChainableFileLogger::enqueue(QString log)
+    {
+        // bounded MPMC queue (D. Vyukov), used here with a single consumer
+        auto pos = mEnqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto &slot = mQueue[pos & (queueSize - 1)];
+
+            const auto sequence = slot.mSequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.mMessage = std::move(log);
+                    slot.mSequence.store(pos + 1, std::memory_order_release);
+
+                    if (Q_UNLIKELY((pos & (writeBatchSize - 1)) == writeBatchSize - 1))
+                    {
+                        mWakeWriter = true;
+                        mWriterCondition.notify_one();
+                    }
+
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void ChainableFileLogger::runWriter()
+    {
+        while (!mStopWriter.load(std::memory_order_acquire))
+        {
+            {
+                std::unique_lock<std::mutex> lock{mWriterMutex};
+                mWriterCondition.wait_for(lock, std::chrono::milliseconds{50}, [this] {
+                    return mWakeWriter.load() || mStopWriter.load();
+                });
+            }
+
+            mWakeWriter = false;
+            drainQueue();
+        }
+
+        drainQueue();
+    }
+
+    void ChainableFileLogger::stopWriter()
+    {
+        if (!mWriter.joinable() || mStopWriter.exchange(true))
+            return;
+
+        mWriterCondition.notify_one();
+
+        if (std::this_thread::get_id() != mWriter.get_id())
+        {
+            mWriter.join();
+
+            mAsync = false;
+            drainQueue();
+        }
+    }
+
+    std::size_t ChainableFileLogger::drainQueue()
+    {
+        std::lock_guard<std::mutex> lock{mStreamMutex};
+
+        std::size_t written = 0;
+        while (true)
+        {
+            auto &slot = mQueue[mDequeuePos & (queueSize - 1)];
+
+            const auto sequence = slot.mSequence.load(std::memory_order_acquire);
+            if (static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(mDequeuePos + 1) < 0)
+                break;
+
+            writeLog(slot.mMessage);
+            slot.mMessage.clear();
+
+            slot.mSequence.store(mDequeuePos + queueSize, std::memory_order_release);
+
+            ++mDequeuePos;
+            ++written;
+        }
+
+        // one flush per batch instead of per message
+        if (written > 0)
+            mStream.flush();
+
+        return written;
+    }
+
+    bool ChainableFileLogger::isRateLimited(QtMsgType type, const QMessageLogContext &context)
+    {
+        if ((type != QtDebugMsg && type != QtInfoMsg) || context.category == nullptr)
+            return false;
+
+        if (qstrcmp(context.category, sqlLog().categoryName()) == 0)
+            return isRateLimited(mSqlLimit);
+        if (qstrcmp(context.category, esiLog().categoryName()) == 0)
+            return isRateLimited(mESILimit);
+
+        return false;
+    }
+
+    bool ChainableFileLogger::isRateLimited(CategoryLimit &limit)
+    {
+        const auto seen = limit.mSeen++;
+        if (mSettings.mSampling > 1 && seen % mSettings.mSampling != 0)
+        {
+            ++limit.mSuppressed;
+            return true;
+        }
+
+        if (mSettings.mRateLimit == 0)
+            return false;
+
+        const auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        auto windowStart = limit.mWindowStart.load(std::memory_order_relaxed);
+        if (windowStart != now && limit.mWindowStart.compare_exchange_strong(windowStart, now))
+            limit.mWindowCount = 0;
+
+        if (++limit.mWindowCount > mSettings.mRateLimit)
+        {
+            ++limit.mSuppressed;
+            return true;
+        }
+
+        return false;
+    }
+
+    quint64 ChainableFileLogger::getSuppressedCount() const noexcept
+    {
+        return mSqlLimit.mSuppressed.load() + mESILimit.mSuppressed.load();
+    }
+
     bool ChainableFileLogger::openLog()
     {
         return mLogFile.open(QIODevice::Append | QIODevice::Text);
@@ -14,6 +14,10 @@
  */
 #pragma once
 
+#include <condition_variable>
+#include <memory>
+#include <atomic>
+#include <thread>
 #include <mutex>
 
 #include <QTextStream>
@@ -21,25 +25,51 @@
 
 namespace Evernus
 {
+    // by default messages are pushed into a bounded lock-free queue and written in batches by a background thread
+    // debug messages of high-volume categories (SQL, ESI) can be rate limited and sampled
     class ChainableFileLogger final
     {
     public:
+        struct Settings
+        {
+            std::size_t mMaxLogSize = 10 * 1024 * 1024;
+            uint mMaxLogFiles = 3;
+            bool mAsync = true;
+            uint mRateLimit = 0;    // per category per second, 0 = unlimited
+            uint mSampling = 1;     // keep every n-th message
+        };
+
         ChainableFileLogger(const ChainableFileLogger &) = delete;
         ChainableFileLogger(ChainableFileLogger &&) = delete;
 
         ChainableFileLogger &operator =(const ChainableFileLogger &) = delete;
         ChainableFileLogger &operator =(ChainableFileLogger &&) = delete;
 
-        static void initialize(std::size_t maxLogSize, uint maxLogFiles);
+        static void initialize(const Settings &settings);
 
     private:
+        struct Slot
+        {
+            std::atomic<std::size_t> mSequence{0};
+            QString mMessage;
+        };
+
+        struct CategoryLimit
+        {
+            std::atomic<quint64> mSeen{0};
+            std::atomic<qint64> mWindowStart{0};
+            std::atomic<uint> mWindowCount{0};
+            std::atomic<quint64> mSuppressed{0};
+        };
+
         static ChainableFileLogger *instance;
 
         static const uint logCheckCount = 100;
+        static const std::size_t queueSize = 16384;  // must be a power of 2
+        static const std::size_t writeBatchSize = 256;   // wake the writer each time this many messages are queued
         static const QString fileNameBase;
 
-        std::size_t mMaxLogSize = 10 * 1024 * 1024;
-        uint mMaxLogFiles = 3;
+        Settings mSettings;
 
         QFile mLogFile;
         QTextStream mStream{&mLogFile};
@@ -50,12 +80,46 @@ namespace Evernus
 
         std::mutex mStreamMutex;
 
-        ChainableFileLogger(std::size_t maxLogSize, uint maxLogFiles);
+        std::unique_ptr<Slot[]> mQueue;
+        alignas(64) std::atomic<std::size_t> mEnqueuePos{0};
+        alignas(64) std::size_t mDequeuePos = 0;
+
+        std::thread mWriter;
+        std::mutex mWriterMutex;
+        std::condition_variable mWriterCondition;
+        std::atomic_bool mWakeWriter{false};
+        std::atomic_bool mStopWriter{false};
+        std::atomic_bool mAsync{false};
+
+        CategoryLimit mSqlLimit;
+        CategoryLimit mESILimit;
+
+        std::atomic<quint64> mMessageCount{0};
+        std::atomic<quint64> mCallerTime{0};    // ns spent in logging calls
+        std::atomic<quint64> mDroppedCount{0};
+
+        quint64 mReportedDropped = 0;
+        quint64 mReportedSuppressed = 0;
+
+        explicit ChainableFileLogger(const Settings &settings);
         ~ChainableFileLogger();
 
         void writeMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+        void writeLog(const QString &log);
+        void writeLogLine(QtMsgType type, const QString &msg);
+        void reportLostMessages();
         void rotateLogs();
 
+        bool enqueue(QString log);
+        void runWriter();
+        void stopWriter();
+        std::size_t drainQueue();
+
+        bool isRateLimited(QtMsgType type, const QMessageLogContext &context);
+        bool isRateLimited(CategoryLimit &limit);
+
+        quint64 getSuppressedCount() const noexcept;
+
         bool openLog();
 
         static void handleMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg);
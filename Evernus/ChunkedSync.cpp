@@ -0,0 +1,347 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdexcept>
+#include <array>
+
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QIODevice>
+#include <QtDebug>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+
+#include <boost/throw_exception.hpp>
+
+#include "SyncStorage.h"
+
+#include "ChunkedSync.h"
+
+namespace Evernus
+{
+    namespace
+    {
+        const auto manifestVersion = 1;
+
+        // gear table for the rolling hash - must never change, or every chunk boundary moves
+        std::array<quint64, 256> makeGearTable() noexcept
+        {
+            std::array<quint64, 256> table;
+
+            // splitmix64
+            auto state = Q_UINT64_C(0x45766572e6e75735);
+            for (auto &value : table)
+            {
+                state += Q_UINT64_C(0x9e3779b97f4a7c15);
+
+                auto z = state;
+                z = (z ^ (z >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+                z = (z ^ (z >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+                value = z ^ (z >> 31);
+            }
+
+            return table;
+        }
+
+        QByteArray hashChunk(const QByteArray &data)
+        {
+            return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+        }
+
+        [[noreturn]] void throwError(const char *message)
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error{QCoreApplication::translate("ChunkedSync", message).toStdString()});
+        }
+    }
+
+    ChunkedSync::ChunkedSync(SyncStorage &storage, QString manifestPath, QString chunkDirectory)
+        : mStorage{storage}
+        , mManifestPath{std::move(manifestPath)}
+        , mChunkDirectory{std::move(chunkDirectory)}
+    {
+    }
+
+    void ChunkedSync::setProgressCallback(ProgressCallback callback)
+    {
+        mProgressCallback = std::move(callback);
+    }
+
+    std::optional<ChunkedSync::Manifest> ChunkedSync::fetchManifest() const
+    {
+        const auto data = mStorage.read(mManifestPath);
+        if (!data)
+            return std::nullopt;
+
+        return fromJson(*data);
+    }
+
+    bool ChunkedSync::upload(const QString &localPath, const Manifest &remoteManifest) const
+    {
+        QFile file{localPath};
+        if (!file.open(QIODevice::ReadOnly))
+            throwError(QT_TRANSLATE_NOOP("ChunkedSync", "Couldn't open local file!"));
+
+        const auto manifest = split(file);
+        if (mCancelled)
+            return false;
+
+        QSet<QByteArray> remoteChunks;
+        for (const auto &chunk : remoteManifest)
+            remoteChunks << chunk.mHash;
+
+        QSet<QByteArray> pendingChunks;
+        qint64 total = 0;
+
+        for (const auto &chunk : manifest)
+        {
+            if (!remoteChunks.contains(chunk.mHash) && !pendingChunks.contains(chunk.mHash))
+            {
+                pendingChunks << chunk.mHash;
+                total += chunk.mSize;
+            }
+        }
+
+        qDebug() << "Uploading" << pendingChunks.size() << "of" << manifest.size() << "chunks," << total << "bytes.";
+
+        qint64 offset = 0, uploaded = 0;
+        reportProgress(uploaded, total);
+
+        for (const auto &chunk : manifest)
+        {
+            if (mCancelled)
+                return false;
+
+            if (pendingChunks.remove(chunk.mHash))
+            {
+                file.seek(offset);
+
+                // the chunk is stored under its hash, so it must be exactly what was hashed
+                const auto data = file.read(chunk.mSize);
+                if (data.size() != chunk.mSize || hashChunk(data) != chunk.mHash)
+                    throwError(QT_TRANSLATE_NOOP("ChunkedSync", "Local file changed during synchronization!"));
+
+                mStorage.write(getChunkPath(chunk.mHash), qCompress(data, compressionLevel));
+
+                uploaded += chunk.mSize;
+                reportProgress(uploaded, total);
+            }
+
+            offset += chunk.mSize;
+        }
+
+        mStorage.write(mManifestPath, toJson(manifest));
+
+        // the new manifest is in place, so chunks only the old one referred to can go
+        QSet<QByteArray> usedChunks;
+        for (const auto &chunk : manifest)
+            usedChunks << chunk.mHash;
+
+        for (const auto &hash : remoteChunks)
+        {
+            if (usedChunks.contains(hash))
+                continue;
+
+            try
+            {
+                mStorage.remove(getChunkPath(hash));
+            }
+            catch (const std::exception &e)
+            {
+                // stale chunks only waste space
+                qWarning() << "Error removing unused chunk:" << hash << e.what();
+            }
+        }
+
+        return true;
+    }
+
+    bool ChunkedSync::download(const Manifest &manifest, const QString &currentPath, QIODevice &output) const
+    {
+        // whatever we already have locally doesn't need to be fetched
+        QHash<QByteArray, qint64> localChunks;
+
+        QFile current{currentPath};
+        if (current.open(QIODevice::ReadOnly))
+        {
+            const auto localManifest = split(current);
+
+            qint64 offset = 0;
+            for (const auto &chunk : localManifest)
+            {
+                localChunks.insert(chunk.mHash, offset);
+                offset += chunk.mSize;
+            }
+        }
+
+        if (mCancelled)
+            return false;
+
+        qint64 total = 0;
+        for (const auto &chunk : manifest)
+        {
+            if (!localChunks.contains(chunk.mHash))
+                total += chunk.mSize;
+        }
+
+        qDebug() << "Downloading" << total << "bytes," << localChunks.size() << "chunks available locally.";
+
+        qint64 downloaded = 0;
+        reportProgress(downloaded, total);
+
+        for (const auto &chunk : manifest)
+        {
+            if (mCancelled)
+                return false;
+
+            QByteArray data;
+
+            const auto localChunk = localChunks.constFind(chunk.mHash);
+            if (localChunk != localChunks.constEnd())
+            {
+                current.seek(*localChunk);
+                data = current.read(chunk.mSize);
+            }
+            else
+            {
+                const auto compressed = mStorage.read(getChunkPath(chunk.mHash));
+                if (!compressed)
+                    throwError(QT_TRANSLATE_NOOP("ChunkedSync", "Remote data is incomplete!"));
+
+                data = qUncompress(*compressed);
+
+                downloaded += chunk.mSize;
+                reportProgress(downloaded, total);
+            }
+
+            if (data.size() != chunk.mSize || hashChunk(data) != chunk.mHash)
+                throwError(QT_TRANSLATE_NOOP("ChunkedSync", "Synchronized data is corrupted!"));
+
+            if (output.write(data) != data.size())
+                throwError(QT_TRANSLATE_NOOP("ChunkedSync", "Couldn't write destination file!"));
+        }
+
+        return true;
+    }
+
+    void ChunkedSync::cancel() noexcept
+    {
+        mCancelled = true;
+    }
+
+    ChunkedSync::Manifest ChunkedSync::split(QIODevice &device)
+    {
+        static const auto gear = makeGearTable();
+
+        Manifest manifest;
+
+        QCryptographicHash hash{QCryptographicHash::Sha1};
+        QByteArray buffer{static_cast<int>(readBufferSize), Qt::Uninitialized};
+
+        quint64 fingerprint = 0;
+        qint64 chunkSize = 0;
+
+        while (true)
+        {
+            const auto read = device.read(buffer.data(), buffer.size());
+            if (read < 0)
+                throwError(QT_TRANSLATE_NOOP("ChunkedSync", "Error reading local file!"));
+            if (read == 0)
+                break;
+
+            const auto data = reinterpret_cast<const uchar *>(buffer.constData());
+            auto chunkStart = 0;
+
+            for (auto i = 0; i < read; ++i)
+            {
+                fingerprint = (fingerprint << 1) + gear[data[i]];
+                ++chunkSize;
+
+                if ((chunkSize >= minChunkSize && (fingerprint & chunkMask) == 0) || chunkSize >= maxChunkSize)
+                {
+                    hash.addData(buffer.constData() + chunkStart, i + 1 - chunkStart);
+                    manifest.emplace_back(Chunk{hash.result().toHex(), chunkSize});
+
+                    hash.reset();
+                    fingerprint = 0;
+                    chunkSize = 0;
+                    chunkStart = i + 1;
+                }
+            }
+
+            hash.addData(buffer.constData() + chunkStart, read - chunkStart);
+        }
+
+        if (chunkSize > 0)
+            manifest.emplace_back(Chunk{hash.result().toHex(), chunkSize});
+
+        return manifest;
+    }
+
+    QString ChunkedSync::getChunkPath(const QByteArray &hash) const
+    {
+        return mChunkDirectory + QLatin1Char('/') + QString::fromLatin1(hash);
+    }
+
+    void ChunkedSync::reportProgress(qint64 current, qint64 total) const
+    {
+        if (mProgressCallback)
+            mProgressCallback(current, total);
+    }
+
+    QByteArray ChunkedSync::toJson(const Manifest &manifest)
+    {
+        QJsonArray chunks;
+        for (const auto &chunk : manifest)
+        {
+            chunks.append(QJsonObject{
+                { QStringLiteral("hash"), QString::fromLatin1(chunk.mHash) },
+                { QStringLiteral("size"), chunk.mSize },
+            });
+        }
+
+        const QJsonObject object{
+            { QStringLiteral("version"), manifestVersion },
+            { QStringLiteral("chunks"), chunks },
+        };
+
+        return QJsonDocument{object}.toJson(QJsonDocument::Compact);
+    }
+
+    ChunkedSync::Manifest ChunkedSync::fromJson(const QByteArray &data)
+    {
+        const auto object = QJsonDocument::fromJson(data).object();
+        if (object.value(QStringLiteral("version")).toInt() != manifestVersion)
+            throwError(QT_TRANSLATE_NOOP("ChunkedSync", "Unsupported synchronization data version!"));
+
+        const auto chunks = object.value(QStringLiteral("chunks")).toArray();
+
+        Manifest manifest;
+        manifest.reserve(chunks.size());
+
+        for (const auto &value : chunks)
+        {
+            const auto chunk = value.toObject();
+            manifest.emplace_back(Chunk{
+                chunk.value(QStringLiteral("hash")).toString().toLatin1(),
+                static_cast<qint64>(chunk.value(QStringLiteral("size")).toDouble())
+            });
+        }
+
+        return manifest;
+    }
+}
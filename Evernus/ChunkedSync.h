@@ -0,0 +1,89 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <atomic>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+class QIODevice;
+
+namespace Evernus
+{
+    class SyncStorage;
+
+    // block-level file sync: the file is split into content-defined chunks, each stored compressed under its hash,
+    // and a manifest lists the chunks in order; only chunks missing on the other side are transferred
+    class ChunkedSync final
+    {
+    public:
+        struct Chunk
+        {
+            QByteArray mHash;
+            qint64 mSize = 0;
+        };
+
+        using Manifest = std::vector<Chunk>;
+        using ProgressCallback = std::function<void (qint64 current, qint64 total)>;
+
+        ChunkedSync(SyncStorage &storage, QString manifestPath, QString chunkDirectory);
+        ChunkedSync(const ChunkedSync &) = delete;
+        ChunkedSync(ChunkedSync &&) = delete;
+        ~ChunkedSync() = default;
+
+        void setProgressCallback(ProgressCallback callback);
+
+        std::optional<Manifest> fetchManifest() const;
+
+        // both return false when cancelled and throw on errors
+        bool upload(const QString &localPath, const Manifest &remoteManifest) const;
+        bool download(const Manifest &manifest, const QString &currentPath, QIODevice &output) const;
+
+        void cancel() noexcept;
+
+        ChunkedSync &operator =(const ChunkedSync &) = delete;
+        ChunkedSync &operator =(ChunkedSync &&) = delete;
+
+        static Manifest split(QIODevice &device);
+
+    private:
+        // boundaries land where the low bits of the rolling hash are zero, giving ~512 KiB chunks on average
+        static const quint64 chunkMask = (Q_UINT64_C(1) << 19) - 1;
+        static const qint64 minChunkSize = 128 * 1024;
+        static const qint64 maxChunkSize = 2 * 1024 * 1024;
+        static const qint64 readBufferSize = 64 * 1024;
+        static const int compressionLevel = 6;
+
+        SyncStorage &mStorage;
+
+        QString mManifestPath;
+        QString mChunkDirectory;
+
+        ProgressCallback mProgressCallback;
+
+        std::atomic_bool mCancelled{false};
+
+        QString getChunkPath(const QByteArray &hash) const;
+
+        void reportProgress(qint64 current, qint64 total) const;
+
+        static QByteArray toJson(const Manifest &manifest);
+        static Manifest fromJson(const QByteArray &data);
+    };
+}
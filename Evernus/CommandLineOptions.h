@@ -24,5 +24,8 @@ namespace Evernus::CommandLineOptions
     const auto clientSecretArg = QStringLiteral("client-secret");
     const auto maxLogFileSizeArg = QStringLiteral("max-log-file-size");
     const auto maxLogFilesArg = QStringLiteral("max-log-files");
+    const auto syncLogArg = QStringLiteral("sync-log");
+    const auto logRateLimitArg = QStringLiteral("log-rate-limit");
+    const auto logSamplingArg = QStringLiteral("log-sampling");
     const auto forceSDEUpdateArg = QStringLiteral("force-sde-update");
 }
@@ -14,6 +14,10 @@
  */
 #pragma once
 
+#include <QSqlQuery>
+#include <QString>
+#include <QHash>
+
 class QSqlDatabase;
 
 namespace Evernus
@@ -21,12 +25,21 @@ namespace Evernus
     class DatabaseConnectionProvider
     {
     public:
+        // query -> statement prepared on a single connection
+        using StatementCache = QHash<QString, QSqlQuery>;
+
         DatabaseConnectionProvider() = default;
         DatabaseConnectionProvider(const DatabaseConnectionProvider &) = default;
         DatabaseConnectionProvider(DatabaseConnectionProvider &&) = default;
         virtual ~DatabaseConnectionProvider() = default;
 
         virtual QSqlDatabase getConnection() const = 0;
+        // connection which can only read committed data - not suitable inside write transactions
+        virtual QSqlDatabase getReadOnlyConnection() const = 0;
+
+        // statements kept along with the calling thread's connections and dropped together with them
+        virtual StatementCache &getStatementCache() const = 0;
+        virtual StatementCache &getReadOnlyStatementCache() const = 0;
 
         DatabaseConnectionProvider &operator =(const DatabaseConnectionProvider &) = default;
         DatabaseConnectionProvider &operator =(DatabaseConnectionProvider &&) = default;
@@ -21,9 +21,12 @@
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QFileInfo>
 #include <QtDebug>
 #include <QFile>
 
+#include "LogCategories.h"
+
 #include "DatabaseUtils.h"
 
 namespace Evernus::DatabaseUtils
@@ -40,7 +43,7 @@ namespace Evernus::DatabaseUtils
 
     void execQuery(QSqlQuery &query)
     {
-        qDebug() << "SQL:" << query.lastQuery();
+        qCDebug(sqlLog) << "SQL:" << query.lastQuery();
         if (!query.exec())
         {
             auto error = query.lastError();
@@ -52,6 +55,7 @@ namespace Evernus::DatabaseUtils
 
     QString backupDatabase(const QSqlDatabase &db)
     {
+        checkpointDatabase(db);
         return backupDatabase(db.databaseName());
     }
 
@@ -62,6 +66,85 @@ namespace Evernus::DatabaseUtils
         QFile::remove(dbBak);
         QFile::copy(dbPath, dbBak);
 
+        // not yet checkpointed changes live in the log, which SQLite picks up by name
+        const auto walSuffix = QStringLiteral("-wal");
+
+        QFile::remove(dbBak + walSuffix);
+        if (QFile::exists(dbPath + walSuffix))
+            QFile::copy(dbPath + walSuffix, dbBak + walSuffix);
+
         return dbBak;
     }
+
+    bool checkpointDatabase(const QSqlDatabase &db)
+    {
+        auto query = db.exec(QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)"));
+        if (!query.next() || query.value(0).toInt() != 0)
+        {
+            qWarning() << "Database checkpoint incomplete - other connections are busy:" << db.databaseName();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool snapshotDatabase(const QSqlDatabase &db, const QString &snapshotPath)
+    {
+        if (!checkpointDatabase(db))
+            return false;
+
+        // an open read transaction which started on an empty log keeps checkpoints from writing into the file
+        auto connection = db;
+        if (!connection.transaction())
+            return false;
+
+        auto query = connection.exec(QStringLiteral("SELECT COUNT(*) FROM sqlite_master"));
+        query.finish();
+
+        const auto dbPath = db.databaseName();
+        const QFileInfo log{dbPath + QStringLiteral("-wal")};
+
+        auto copied = false;
+        if (!log.exists() || log.size() == 0)
+        {
+            QFile::remove(snapshotPath);
+            copied = QFile::copy(dbPath, snapshotPath);
+        }
+        else
+        {
+            qWarning() << "Database changed before taking a snapshot:" << dbPath;
+        }
+
+        connection.rollback();
+        return copied;
+    }
+
+    QString wildcardToLikePattern(const QString &wildcard)
+    {
+        QString pattern;
+        pattern.reserve(wildcard.size() + 2);
+        pattern += QLatin1Char('%');
+
+        for (const auto ch : wildcard)
+        {
+            switch (ch.unicode()) {
+            case '*':
+                pattern += QLatin1Char('%');
+                break;
+            case '?':
+                pattern += QLatin1Char('_');
+                break;
+            case '%':
+            case '_':
+            case '\\':
+                pattern += QLatin1Char('\\');
+                [[fallthrough]];
+            default:
+                pattern += ch;
+            }
+        }
+
+        pattern += QLatin1Char('%');
+        return pattern;
+    }
 }
@@ -29,6 +29,17 @@ namespace Evernus::DatabaseUtils
     void execQuery(QSqlQuery &query);
     QString backupDatabase(const QSqlDatabase &db);
     QString backupDatabase(const QString &dbPath);
+    // moves write-ahead log contents into the database file, so it can be copied on its own; false if other connections
+    // kept some of it in the log
+    bool checkpointDatabase(const QSqlDatabase &db);
+    // consistent copy of the database file, taken while no checkpoint can touch it; false if it couldn't be made
+    bool snapshotDatabase(const QSqlDatabase &db, const QString &snapshotPath);
+    // text filter wildcard (matching anywhere, like QRegExp::Wildcard with indexIn) as a LIKE pattern escaped with backslashes
+    QString wildcardToLikePattern(const QString &wildcard);
+
+    // for IN (...) lists, which are too long to bind
+    template<class T>
+    QString joinIds(const T &ids);
 
     template<class T>
     std::unordered_set<T> decodeRawSet(const QSqlRecord &record, const QString &name);
@@ -15,6 +15,7 @@
 #include <algorithm>
 
 #include <QDataStream>
+#include <QStringList>
 #include <QSqlRecord>
 #include <QVariant>
 
@@ -50,4 +51,16 @@ namespace Evernus::DatabaseUtils
 
         return data;
     }
+
+    template<class T>
+    QString joinIds(const T &ids)
+    {
+        QStringList list;
+        list.reserve(static_cast<int>(ids.size()));
+
+        for (const auto id : ids)
+            list << QString::number(id);
+
+        return list.join(QLatin1Char(','));
+    }
 }
@@ -21,7 +21,11 @@ namespace Evernus
     namespace DbSettings
     {
         const auto synchronousDefault = 0;
+        const auto cacheSizeDefault = 32u;
+        const auto mmapSizeDefault = 256u;
 
         const auto synchronousKey = QStringLiteral("db/synchronous");
+        const auto cacheSizeKey = QStringLiteral("db/cacheSize");
+        const auto mmapSizeKey = QStringLiteral("db/mmapSize");
     }
 }
@@ -0,0 +1,110 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <exception>
+#include <stdexcept>
+
+#include <QThread>
+
+#include <boost/throw_exception.hpp>
+
+#include "qdropbox2file.h"
+#include "qdropbox2.h"
+
+#include "DropboxSyncStorage.h"
+
+namespace Evernus
+{
+    DropboxSyncStorage::DropboxSyncStorage(QDropbox2 &dropbox, QObject *parent)
+        : QObject{parent}
+        , mDropbox{dropbox}
+    {
+    }
+
+    std::optional<QByteArray> DropboxSyncStorage::read(const QString &path)
+    {
+        std::optional<QByteArray> result;
+
+        runInOwnerThread([&] {
+            QDropbox2File file{path, &mDropbox};
+
+            file.metadata();
+            if (file.error() == QDropbox2::Error::FileNotFound)
+                return;
+
+            if (!file.open(QIODevice::ReadOnly))
+                throwError(file);
+
+            result = file.readAll();
+        });
+
+        return result;
+    }
+
+    void DropboxSyncStorage::write(const QString &path, const QByteArray &data)
+    {
+        runInOwnerThread([&] {
+            QDropbox2File file{path, &mDropbox};
+            file.setOverwrite(true);
+
+            if (!file.open(QIODevice::WriteOnly))
+                throwError(file);
+
+            file.write(data);
+            file.close();
+
+            if (file.error() != QDropbox2::Error::NoError)
+                throwError(file);
+        });
+    }
+
+    void DropboxSyncStorage::remove(const QString &path)
+    {
+        runInOwnerThread([&] {
+            QDropbox2File file{path, &mDropbox};
+            if (!file.remove() && file.error() != QDropbox2::Error::FileNotFound)
+                throwError(file);
+        });
+    }
+
+    template<class T>
+    void DropboxSyncStorage::runInOwnerThread(T &&func)
+    {
+        if (QThread::currentThread() == thread())
+        {
+            func();
+            return;
+        }
+
+        std::exception_ptr exception;
+        QMetaObject::invokeMethod(this, [&] {
+            try
+            {
+                func();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+        }, Qt::BlockingQueuedConnection);
+
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    void DropboxSyncStorage::throwError(QDropbox2File &file)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error{file.errorString().toStdString()});
+    }
+}
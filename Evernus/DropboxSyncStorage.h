@@ -0,0 +1,49 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+#include "SyncStorage.h"
+
+class QDropbox2File;
+class QDropbox2;
+
+namespace Evernus
+{
+    // Dropbox access is bound to the owning thread, so calls from other threads block until it serves them
+    class DropboxSyncStorage
+        : public QObject
+        , public SyncStorage
+    {
+        Q_OBJECT
+
+    public:
+        explicit DropboxSyncStorage(QDropbox2 &dropbox, QObject *parent = nullptr);
+        virtual ~DropboxSyncStorage() = default;
+
+        virtual std::optional<QByteArray> read(const QString &path) override;
+        virtual void write(const QString &path, const QByteArray &data) override;
+        virtual void remove(const QString &path) override;
+
+    private:
+        QDropbox2 &mDropbox;
+
+        template<class T>
+        void runInOwnerThread(T &&func);
+
+        [[noreturn]] static void throwError(QDropbox2File &file);
+    };
+}
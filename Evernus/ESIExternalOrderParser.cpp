@@ -0,0 +1,460 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iterator>
+#include <cstring>
+
+#include <QString>
+#include <QDate>
+#include <QTime>
+
+#include "ESIExternalOrderParser.h"
+
+namespace Evernus
+{
+    bool ESIExternalOrderParser::Token::operator ==(const char *str) const noexcept
+    {
+        const auto length = std::strlen(str);
+        return static_cast<std::size_t>(mEnd - mBegin) == length && std::memcmp(mBegin, str, length) == 0;
+    }
+
+    ESIExternalOrderParser::ESIExternalOrderParser(const QByteArray &data) noexcept
+        : mCurrent{data.constData()}
+        , mEnd{data.constData() + data.size()}
+    {
+    }
+
+    bool ESIExternalOrderParser::parse(uint regionId, const QDateTime &updateTime, std::vector<ExternalOrder> &orders)
+    {
+        const auto initialSize = orders.size();
+        const auto fail = [&] {
+            orders.erase(std::next(std::begin(orders), initialSize), std::end(orders));
+            return false;
+        };
+
+        skipWhitespace();
+        if (!consume('['))
+            return false;
+
+        skipWhitespace();
+        if (consume(']'))
+            return true;
+
+        do
+        {
+            ExternalOrder order;
+            order.setRegionId(regionId);
+            order.setUpdateTime(updateTime);
+
+            if (!parseOrder(order))
+                return fail();
+
+            orders.emplace_back(std::move(order));
+
+            skipWhitespace();
+        } while (consume(','));
+
+        if (!consume(']'))
+            return fail();
+
+        return true;
+    }
+
+    bool ESIExternalOrderParser::parseOrder(ExternalOrder &order)
+    {
+        skipWhitespace();
+        if (!consume('{'))
+            return false;
+
+        skipWhitespace();
+        if (consume('}'))
+            return true;
+
+        do
+        {
+            skipWhitespace();
+
+            Token key;
+            if (!parseString(key))
+                return false;
+
+            skipWhitespace();
+            if (!consume(':'))
+                return false;
+
+            skipWhitespace();
+
+            Token value;
+            if (key == "order_id")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setId(toUInt(value));
+            }
+            else if (key == "is_buy_order")
+            {
+                auto buy = false;
+                if (!parseBool(buy))
+                    return false;
+
+                order.setType((buy) ? (ExternalOrder::Type::Buy) : (ExternalOrder::Type::Sell));
+            }
+            else if (key == "type_id")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setTypeId(toUInt(value));
+            }
+            else if (key == "location_id")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setStationId(toUInt(value));
+            }
+            else if (key == "system_id")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setSolarSystemId(toUInt(value));
+            }
+            else if (key == "range")
+            {
+                if (!parseString(value))
+                    return false;
+
+                order.setRange(toRange(value));
+            }
+            else if (key == "price")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setPrice(toDouble(value));
+            }
+            else if (key == "volume_total")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setVolumeEntered(toUInt(value));
+            }
+            else if (key == "volume_remain")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setVolumeRemaining(toUInt(value));
+            }
+            else if (key == "min_volume")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setMinVolume(toUInt(value));
+            }
+            else if (key == "issued")
+            {
+                if (!parseString(value))
+                    return false;
+
+                order.setIssued(toDateTime(value));
+            }
+            else if (key == "duration")
+            {
+                if (!parseNumber(value))
+                    return false;
+
+                order.setDuration(toUInt(value));
+            }
+            else if (!skipValue())
+            {
+                return false;
+            }
+
+            skipWhitespace();
+        } while (consume(','));
+
+        return consume('}');
+    }
+
+    void ESIExternalOrderParser::skipWhitespace() noexcept
+    {
+        while (mCurrent != mEnd && (*mCurrent == ' ' || *mCurrent == '\n' || *mCurrent == '\r' || *mCurrent == '\t'))
+            ++mCurrent;
+    }
+
+    bool ESIExternalOrderParser::consume(char c) noexcept
+    {
+        if (mCurrent == mEnd || *mCurrent != c)
+            return false;
+
+        ++mCurrent;
+        return true;
+    }
+
+    bool ESIExternalOrderParser::parseString(Token &token) noexcept
+    {
+        if (!consume('"'))
+            return false;
+
+        token.mBegin = mCurrent;
+
+        // escapes are only skipped - none of the values we read can contain them
+        while (mCurrent != mEnd && *mCurrent != '"')
+        {
+            if (*mCurrent == '\\' && ++mCurrent == mEnd)
+                return false;
+
+            ++mCurrent;
+        }
+
+        token.mEnd = mCurrent;
+        return consume('"');
+    }
+
+    bool ESIExternalOrderParser::parseNumber(Token &token) noexcept
+    {
+        token.mBegin = mCurrent;
+
+        while (mCurrent != mEnd)
+        {
+            const auto c = *mCurrent;
+            if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E')
+                break;
+
+            ++mCurrent;
+        }
+
+        token.mEnd = mCurrent;
+        return token.mBegin != token.mEnd;
+    }
+
+    bool ESIExternalOrderParser::parseBool(bool &value) noexcept
+    {
+        const auto matches = [&](const char *literal) {
+            const auto length = std::strlen(literal);
+            if (static_cast<std::size_t>(mEnd - mCurrent) < length || std::memcmp(mCurrent, literal, length) != 0)
+                return false;
+
+            mCurrent += length;
+            return true;
+        };
+
+        if (matches("true"))
+        {
+            value = true;
+            return true;
+        }
+
+        if (matches("false"))
+        {
+            value = false;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool ESIExternalOrderParser::skipValue() noexcept
+    {
+        if (mCurrent == mEnd)
+            return false;
+
+        Token token;
+        switch (*mCurrent) {
+        case '"':
+            return parseString(token);
+        case 't':
+        case 'f':
+            {
+                auto value = false;
+                return parseBool(value);
+            }
+        case 'n':
+            if (mEnd - mCurrent < 4 || std::memcmp(mCurrent, "null", 4) != 0)
+                return false;
+
+            mCurrent += 4;
+            return true;
+        case '{':
+        case '[':
+            {
+                auto depth = 0;
+                do
+                {
+                    if (mCurrent == mEnd)
+                        return false;
+
+                    const auto c = *mCurrent;
+                    if (c == '"')
+                    {
+                        if (!parseString(token))
+                            return false;
+
+                        continue;
+                    }
+
+                    if (c == '{' || c == '[')
+                        ++depth;
+                    else if (c == '}' || c == ']')
+                        --depth;
+
+                    ++mCurrent;
+                } while (depth > 0);
+            }
+            return true;
+        default:
+            return parseNumber(token);
+        }
+    }
+
+    quint64 ESIExternalOrderParser::toUInt(const Token &token) noexcept
+    {
+        quint64 result = 0;
+        for (auto it = token.mBegin; it != token.mEnd && *it >= '0' && *it <= '9'; ++it)
+            result = result * 10 + (*it - '0');
+
+        return result;
+    }
+
+    double ESIExternalOrderParser::toDouble(const Token &token)
+    {
+        // exact powers of 10 representable as double
+        static const double powers[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        const auto maxExactMantissa = Q_UINT64_C(1) << 53;
+        const auto maxMantissaDigits = 19;
+
+        auto it = token.mBegin;
+
+        const auto negative = it != token.mEnd && *it == '-';
+        if (negative)
+            ++it;
+
+        quint64 mantissa = 0;
+        auto digits = 0;
+        auto exponent = 0;
+
+        const auto addDigit = [&](char c, bool fraction) {
+            if (mantissa == 0 && c == '0')
+            {
+                if (fraction)
+                    --exponent;
+
+                return;
+            }
+
+            if (digits < maxMantissaDigits)
+            {
+                mantissa = mantissa * 10 + (c - '0');
+                ++digits;
+
+                if (fraction)
+                    --exponent;
+            }
+            else if (!fraction)
+            {
+                ++exponent;
+            }
+        };
+
+        for (; it != token.mEnd && *it >= '0' && *it <= '9'; ++it)
+            addDigit(*it, false);
+
+        if (it != token.mEnd && *it == '.')
+        {
+            for (++it; it != token.mEnd && *it >= '0' && *it <= '9'; ++it)
+                addDigit(*it, true);
+        }
+
+        if (it != token.mEnd && (*it == 'e' || *it == 'E'))
+        {
+            ++it;
+
+            const auto negativeExponent = it != token.mEnd && *it == '-';
+            if (it != token.mEnd && (*it == '-' || *it == '+'))
+                ++it;
+
+            auto value = 0;
+            for (; it != token.mEnd && *it >= '0' && *it <= '9' && value < 1000; ++it)
+                value = value * 10 + (*it - '0');
+
+            exponent += (negativeExponent) ? (-value) : (value);
+        }
+
+        // when both the mantissa and the power of 10 are exact, a single multiplication or division is correctly rounded;
+        // anything else goes through the regular conversion
+        if (it == token.mEnd && mantissa <= maxExactMantissa && exponent >= -22 && exponent <= 22)
+        {
+            auto result = static_cast<double>(mantissa);
+            result = (exponent < 0) ? (result / powers[-exponent]) : (result * powers[exponent]);
+
+            return (negative) ? (-result) : (result);
+        }
+
+        return QByteArray::fromRawData(token.mBegin, static_cast<int>(token.mEnd - token.mBegin)).toDouble();
+    }
+
+    short ESIExternalOrderParser::toRange(const Token &token) noexcept
+    {
+        if (token == "station")
+            return ExternalOrder::rangeStation;
+        if (token == "solarsystem" || token == "system")
+            return ExternalOrder::rangeSystem;
+        if (token == "region")
+            return ExternalOrder::rangeRegion;
+
+        return static_cast<short>(toUInt(token));
+    }
+
+    QDateTime ESIExternalOrderParser::toDateTime(const Token &token)
+    {
+        // ESI always uses yyyy-MM-ddTHH:mm:ssZ, so read the fields directly
+        const auto get = [&](auto offset, auto length) {
+            auto result = 0;
+            for (auto it = token.mBegin + offset; it != token.mBegin + offset + length; ++it)
+            {
+                if (*it < '0' || *it > '9')
+                    return -1;
+
+                result = result * 10 + (*it - '0');
+            }
+
+            return result;
+        };
+
+        if (token.mEnd - token.mBegin >= 19)
+        {
+            const QDate date{get(0, 4), get(5, 2), get(8, 2)};
+            const QTime time{get(11, 2), get(14, 2), get(17, 2)};
+
+            if (date.isValid() && time.isValid())
+                return QDateTime{date, time, Qt::UTC};
+        }
+
+        auto dt = QDateTime::fromString(QString::fromLatin1(token.mBegin, static_cast<int>(token.mEnd - token.mBegin)), Qt::ISODate);
+        if (Q_UNLIKELY(!dt.isValid()))
+            dt = QDateTime::currentDateTimeUtc();   // just to be safe
+        else
+            dt.setTimeSpec(Qt::UTC);
+
+        return dt;
+    }
+}
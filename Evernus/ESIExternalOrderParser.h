@@ -0,0 +1,71 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+#include <QByteArray>
+#include <QDateTime>
+
+#include "ExternalOrder.h"
+
+namespace Evernus
+{
+    // single pass reader for ESI market order pages (region and structure endpoints)
+    // orders are decoded straight from reply bytes - no json document and no per-key strings are created
+    // the parser only points into given data, so it must outlive the parser
+    class ESIExternalOrderParser final
+    {
+    public:
+        explicit ESIExternalOrderParser(const QByteArray &data) noexcept;
+        ESIExternalOrderParser(const ESIExternalOrderParser &) = default;
+        ESIExternalOrderParser(ESIExternalOrderParser &&) = default;
+        ~ESIExternalOrderParser() = default;
+
+        // appends parsed orders; solar system is left as 0 if the page doesn't have it (structure orders)
+        // returns false on malformed input, in which case appended orders are removed
+        bool parse(uint regionId, const QDateTime &updateTime, std::vector<ExternalOrder> &orders);
+
+        ESIExternalOrderParser &operator =(const ESIExternalOrderParser &) = default;
+        ESIExternalOrderParser &operator =(ESIExternalOrderParser &&) = default;
+
+    private:
+        struct Token
+        {
+            const char *mBegin = nullptr;
+            const char *mEnd = nullptr;
+
+            bool operator ==(const char *str) const noexcept;
+        };
+
+        const char *mCurrent = nullptr;
+        const char *mEnd = nullptr;
+
+        bool parseOrder(ExternalOrder &order);
+
+        void skipWhitespace() noexcept;
+        bool consume(char c) noexcept;
+
+        bool parseString(Token &token) noexcept;
+        bool parseNumber(Token &token) noexcept;
+        bool parseBool(bool &value) noexcept;
+        bool skipValue() noexcept;
+
+        static quint64 toUInt(const Token &token) noexcept;
+        static double toDouble(const Token &token);
+        static short toRange(const Token &token) noexcept;
+        static QDateTime toDateTime(const Token &token);
+    };
+}
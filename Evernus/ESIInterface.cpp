@@ -23,14 +23,17 @@
 #include <QJsonObject>
 #include <QStringList>
 #include <QJsonArray>
+#include <QElapsedTimer>
 #include <QUrlQuery>
 #include <QThread>
 #include <QUrl>
 
 #include "ESIInterfaceErrorLimiter.h"
+#include "MarketImportPlanner.h"
 #include "CitadelAccessCache.h"
 #include "NetworkSettings.h"
 #include "CallbackEvent.h"
+#include "LogCategories.h"
 #include "ReplyTimeout.h"
 #include "ESIOAuth.h"
 #include "ESIUrls.h"
@@ -42,6 +45,7 @@ namespace Evernus
     struct ESIInterface::PaginatedContext
     {
         uint mFetchedPages = 0;
+        QElapsedTimer mFirstPageTimer;  // started when the first page request is sent
     };
 
     ESIInterface::ErrorInfo::operator QString() const
@@ -53,8 +57,9 @@ namespace Evernus
     struct ESIInterface::TaggedInvoke<ESIInterface::JsonTag>
     {
         template<class T>
-        static inline void invoke(const QByteArray &data, const QNetworkReply &reply, const T &callback)
+        static inline void invoke(const QByteArray &data, const QNetworkReply &reply, const T &callback, bool notModified = false)
         {
+            Q_UNUSED(notModified);
             callback(QJsonDocument::fromJson(data), QString{}, getExpireTime(reply));
         }
 
@@ -75,8 +80,9 @@ namespace Evernus
     struct ESIInterface::TaggedInvoke<ESIInterface::PaginatedJsonTag>
     {
         template<class T>
-        static inline void invoke(const QByteArray &data, const QNetworkReply &reply, const T &callback)
+        static inline void invoke(const QByteArray &data, const QNetworkReply &reply, const T &callback, bool notModified = false)
         {
+            Q_UNUSED(notModified);
             callback(QJsonDocument::fromJson(data), QString{}, getExpireTime(reply), getPageCount(reply));
         }
 
@@ -93,12 +99,36 @@ namespace Evernus
         }
     };
 
+    template<>
+    struct ESIInterface::TaggedInvoke<ESIInterface::PaginatedRawTag>
+    {
+        // raw pages are the ones worth not parsing again, so only they get to know about 304s
+        template<class T>
+        static inline void invoke(const QByteArray &data, const QNetworkReply &reply, const T &callback, bool notModified = false)
+        {
+            callback(QByteArray{data}, QString{}, getExpireTime(reply), getPageCount(reply), notModified);
+        }
+
+        template<class T>
+        static inline void invoke(const QString &error, const QNetworkReply &reply, const T &callback)
+        {
+            callback(QByteArray{}, error, getExpireTime(reply), getPageCount(reply), false);
+        }
+
+        template<class T>
+        static inline void invoke(const QString &error, const T &callback)
+        {
+            callback(QByteArray{}, error, QDateTime{}, 1u, false);
+        }
+    };
+
     template<>
     struct ESIInterface::TaggedInvoke<ESIInterface::StringTag>
     {
         template<class T>
-        static inline void invoke(const QByteArray &data, const QNetworkReply &reply, const T &callback)
+        static inline void invoke(const QByteArray &data, const QNetworkReply &reply, const T &callback, bool notModified = false)
         {
+            Q_UNUSED(notModified);
             callback(QString::fromUtf8(data), QString{}, getExpireTime(reply));
         }
 
@@ -116,54 +146,106 @@ namespace Evernus
     };
 
     ESIInterface::ESIInterface(CitadelAccessCache &citadelAccessCache,
+                               ESIResponseCache &responseCache,
                                ESIInterfaceErrorLimiter &errorLimiter,
+                               MarketImportPlanner &importPlanner,
                                ESIOAuth &oauth,
                                QObject *parent)
         : QObject{parent}
         , mCitadelAccessCache{citadelAccessCache}
+        , mResponseCache{responseCache}
         , mErrorLimiter{errorLimiter}
+        , mImportPlanner{importPlanner}
         , mOAuth{oauth}
+        , mScheduler{mSettings.value(NetworkSettings::maxConcurrentESIRequestsKey, NetworkSettings::maxConcurrentESIRequestsDefault).toUInt()}
     {
         QSettings settings;
         mLogReplies = settings.value(NetworkSettings::logESIRepliesKey, mLogReplies).toBool();
     }
 
-    void ESIInterface::fetchMarketOrders(uint regionId, EveType::IdType typeId, const PaginatedCallback &callback) const
+    ESIRequestScheduler::Stats ESIInterface::getSchedulerStats() const
+    {
+        return mScheduler.getStats();
+    }
+
+    ESIResponseCache::Stats ESIInterface::getResponseCacheStats() const
+    {
+        return mResponseCache.getStats();
+    }
+
+    void ESIInterface::fetchMarketOrders(uint regionId, EveType::IdType typeId, const PaginatedRawCallback &callback) const
     {
-        qDebug() << "Fetching market orders for" << regionId << "and" << typeId;
-        fetchPaginatedData(QStringLiteral("/v1/markets/%1/orders/").arg(regionId), { { QStringLiteral("type_id"), typeId } }, 1, callback, std::make_shared<PaginatedContext>());
+        qCDebug(esiLog) << "Fetching market orders for" << regionId << "and" << typeId;
+
+        const auto context = std::make_shared<PaginatedContext>();
+
+        const PaginatedRawCallback recordingCallback = [=, recorded = std::make_shared<bool>(false)](auto &&data, auto atEnd, const auto &error, const auto &expires, auto notModified) {
+            if (error.isEmpty() && !*recorded)
+            {
+                *recorded = true;
+                mImportPlanner.recordTypeImport(regionId, context->mFirstPageTimer.elapsed());
+            }
+
+            callback(std::move(data), atEnd, error, expires, notModified);
+        };
+
+        fetchPaginatedData<const PaginatedRawCallback &, PaginatedRawTag>(QStringLiteral("/v1/markets/%1/orders/").arg(regionId), { { QStringLiteral("type_id"), typeId } }, 1, recordingCallback, context);
     }
 
-    void ESIInterface::fetchMarketOrders(uint regionId, const PaginatedCallback &callback) const
+    void ESIInterface::fetchMarketOrders(uint regionId, const PaginatedRawCallback &callback) const
     {
         qDebug() << "Fetching whole market for" << regionId;
-        fetchPaginatedData(QStringLiteral("/v1/markets/%1/orders/").arg(regionId), {}, 1, callback, std::make_shared<PaginatedContext>());
+
+        struct ImportState
+        {
+            qint64 mFirstPageLatency = 0;
+            uint mPages = 0;
+        };
+
+        const auto state = std::make_shared<ImportState>();
+        const auto context = std::make_shared<PaginatedContext>();
+
+        // every page ends up in the callback once, so this gives X-Pages without digging into the replies
+        const PaginatedRawCallback recordingCallback = [=](auto &&data, auto atEnd, const auto &error, const auto &expires, auto notModified) {
+            if (error.isEmpty())
+            {
+                if (state->mPages++ == 0)
+                    state->mFirstPageLatency = context->mFirstPageTimer.elapsed();
+
+                if (atEnd)
+                    mImportPlanner.recordRegionImport(regionId, state->mPages, state->mFirstPageLatency);
+            }
+
+            callback(std::move(data), atEnd, error, expires, notModified);
+        };
+
+        fetchPaginatedData<const PaginatedRawCallback &, PaginatedRawTag>(QStringLiteral("/v1/markets/%1/orders/").arg(regionId), {}, 1, recordingCallback, context);
     }
 
     void ESIInterface::fetchMarketHistory(uint regionId, EveType::IdType typeId, const JsonCallback &callback) const
     {
         qDebug() << "Fetching market history for" << regionId << "and" << typeId;
-        get(QStringLiteral("/v1/markets/%1/history/").arg(regionId), { { QStringLiteral("type_id"), typeId } }, callback, getNumRetries());
+        get(QStringLiteral("/v1/markets/%1/history/").arg(regionId), { { QStringLiteral("type_id"), typeId } }, callback, getNumRetries(), ESIRequestScheduler::Priority::Bulk);
     }
 
-    void ESIInterface::fetchCitadelMarketOrders(quint64 citadelId, Character::IdType charId, const PaginatedCallback &callback) const
+    void ESIInterface::fetchCitadelMarketOrders(quint64 citadelId, Character::IdType charId, const PaginatedRawCallback &callback) const
     {
         qDebug() << "Fetching orders from citadel" << citadelId;
 
         if (Q_UNLIKELY(charId == Character::invalidId))
         {
-            callback({}, true, tr("Cannot fetch citadels with no character selected."), {});
+            callback({}, true, tr("Cannot fetch citadels with no character selected."), {}, false);
             return;
         }
 
         if (!mCitadelAccessCache.isAvailable(charId, citadelId))
         {
             qDebug() << "Citadel blacklisted:" << charId << citadelId;
-            callback({}, true, {}, {});
+            callback({}, true, {}, {}, false);
             return;
         }
 
-        fetchPaginatedData(charId, QStringLiteral("/v1/markets/structures/%1/").arg(citadelId), 1, callback, std::make_shared<PaginatedContext>(), true, citadelId);
+        fetchPaginatedData<const PaginatedRawCallback &, PaginatedRawTag>(charId, QStringLiteral("/v1/markets/structures/%1/").arg(citadelId), 1, callback, std::make_shared<PaginatedContext>(), true, citadelId);
     }
 
     void ESIInterface::fetchCharacterAssets(Character::IdType charId, const PaginatedCallback &callback) const
@@ -552,10 +634,10 @@ namespace Evernus
     auto ESIInterface::createPaginatedCallback(uint page, T continuation, U fetchNext, std::shared_ptr<PaginatedContext> context)
     {
         return [=, continuation = std::move(continuation), fetchNext = std::move(fetchNext), context = std::move(context)]
-               (auto &&response, const auto &error, const auto &expires, auto pages) {
+               (auto &&response, const auto &error, const auto &expires, auto pages, auto ...notModified) {
             if (Q_UNLIKELY(!error.isEmpty()))
             {
-                continuation({}, true, error, expires);
+                continuation({}, true, error, expires, notModified...);
                 return;
             }
 
@@ -566,15 +648,15 @@ namespace Evernus
             {
                 if (page == 1)
                 {
-                    qDebug() << "Got number of pages for paginated request:" << pages;
+                    qCDebug(esiLog) << "Got number of pages for paginated request:" << pages;
 
                     if (pages == 1)
                     {
-                        continuation(std::move(response), true, QString{}, expires);
+                        continuation(std::move(response), true, QString{}, expires, notModified...);
                     }
                     else
                     {
-                        continuation(std::move(response), false, QString{}, expires);
+                        continuation(std::move(response), false, QString{}, expires, notModified...);
 
                         for (auto nextPage = 2u; nextPage <= pages; ++nextPage)
                             fetchNext(nextPage);
@@ -582,46 +664,53 @@ namespace Evernus
                 }
                 else if (context->mFetchedPages >= pages)
                 {
-                    continuation(std::move(response), true, QString{}, expires);
+                    continuation(std::move(response), true, QString{}, expires, notModified...);
                 }
                 else
                 {
-                    continuation(std::move(response), false, QString{}, expires);
+                    continuation(std::move(response), false, QString{}, expires, notModified...);
                 }
             }
             else
             {
-                const auto array = response.array();
-                if (array.isEmpty())
+                if (isEmptyPage(response))
                 {
-                    continuation(std::move(response), true, QString{}, expires);
+                    continuation(std::move(response), true, QString{}, expires, notModified...);
                 }
                 else
                 {
-                    continuation(std::move(response), false, QString{}, expires);
+                    continuation(std::move(response), false, QString{}, expires, notModified...);
                     fetchNext(page + 1);
                 }
             }
         };
     }
 
-    template<class T>
+    template<class T, class ResultTag>
     void ESIInterface::fetchPaginatedData(const QString &url, QVariantMap parameters, uint page, T &&continuation, const std::shared_ptr<PaginatedContext> &context) const
     {
         const auto callback = createPaginatedCallback(
             page,
             continuation,
             [=](auto nextPage) {
-                fetchPaginatedData(url, parameters, nextPage, continuation, context);
+                fetchPaginatedData<T, ResultTag>(url, parameters, nextPage, continuation, context);
             },
             context
         );
 
+        std::function<void ()> sentCallback;
+        if (page == 1)
+        {
+            sentCallback = [=] {
+                context->mFirstPageTimer.start();
+            };
+        }
+
         parameters[QStringLiteral("page")] = page;
-        get<decltype(callback), PaginatedJsonTag>(url, parameters, callback, getNumRetries());
+        get<decltype(callback), ResultTag>(url, parameters, callback, getNumRetries(), ESIRequestScheduler::Priority::Bulk, sentCallback);
     }
 
-    template<class T>
+    template<class T, class ResultTag>
     void ESIInterface::fetchPaginatedData(Character::IdType charId,
                                           const QString &url,
                                           uint page,
@@ -634,36 +723,51 @@ namespace Evernus
             page,
             continuation,
             [=](auto nextPage) {
-                fetchPaginatedData(charId, url, nextPage, continuation, context, importingCitadels, citadelId);
+                fetchPaginatedData<T, ResultTag>(charId, url, nextPage, continuation, context, importingCitadels, citadelId);
             },
             context
         );
 
-        get<decltype(callback), PaginatedJsonTag>(
+        get<decltype(callback), ResultTag>(
             charId,
             url,
             { { QStringLiteral("page"), page } },
             callback,
             getNumRetries(),
             importingCitadels,
-            citadelId
+            citadelId,
+            ESIRequestScheduler::Priority::Bulk
         );
     }
 
     template<class T, class ResultTag>
-    void ESIInterface::get(const QString &url, const QVariantMap &parameters, const T &continuation, uint retries) const
+    void ESIInterface::get(const QString &url,
+                           const QVariantMap &parameters,
+                           const T &continuation,
+                           uint retries,
+                           ESIRequestScheduler::Priority priority,
+                           const std::function<void ()> &sentCallback) const
     {
-        runNowOrLater([=] {
-            auto reply = mOAuth.get(ESIUrls::esiUrl + url, parameters);
+        runScheduled(priority, [=] {
+            QElapsedTimer timer;
+            timer.start();
+
+            const auto cacheKey = ESIResponseCache::getKey(url, parameters);
+
+            auto reply = mOAuth.get(ESIUrls::esiUrl + url, parameters, mResponseCache.getETag(cacheKey));
             Q_ASSERT(reply != nullptr);
 
-            qDebug() << "ESI request:" << reply << "" << url << ":" << parameters;
-            qDebug() << "Retries" << retries;
+            qCDebug(esiLog) << "ESI request:" << reply << "" << url << ":" << parameters;
+            qCDebug(esiLog) << "Retries" << retries;
+
+            if (sentCallback)
+                sentCallback();
 
             new ReplyTimeout{*reply};
 
             connect(reply, &QNetworkReply::finished, this, [=] {
                 reply->deleteLater();
+                mScheduler.finish(reply, timer.elapsed());
 
                 showReplyDebugInfo(*reply);
 
@@ -678,23 +782,32 @@ namespace Evernus
                     if (shouldThrottle(httpStatus))  // error limit reached?
                     {
                         schedulePostErrorLimitRequest([=] {
-                            get<T, ResultTag>(url, parameters, continuation, retries);
+                            get<T, ResultTag>(url, parameters, continuation, retries, priority, sentCallback);
                         }, *reply);
                     }
                     else
                     {
                         if (retries > 0)
-                            get<T, ResultTag>(url, parameters, continuation, retries - 1);
+                            get<T, ResultTag>(url, parameters, continuation, retries - 1, priority, sentCallback);
                         else
                             TaggedInvoke<ResultTag>::invoke(errorInfo, *reply, continuation);
                     }
                 }
+                else if (isNotModified(*reply))
+                {
+                    const auto data = mResponseCache.getData(cacheKey);
+                    if (Q_LIKELY(data))
+                        TaggedInvoke<ResultTag>::invoke(*data, *reply, continuation, true);
+                    else
+                        get<T, ResultTag>(url, parameters, continuation, retries, priority, sentCallback);    // cache entry is gone by now, so this won't be conditional
+                }
                 else
                 {
                     const auto data = reply->readAll();
                     if (mLogReplies)
-                        qDebug() << reply << data;
+                        qCDebug(esiLog) << reply << data;
 
+                    mResponseCache.store(cacheKey, reply->rawHeader(QByteArrayLiteral("ETag")), data);
                     TaggedInvoke<ResultTag>::invoke(data, *reply, continuation);
                 }
             });
@@ -708,12 +821,32 @@ namespace Evernus
                            const T &continuation,
                            uint retries,
                            bool importingCitadels,
-                           quint64 citadelId) const
+                           quint64 citadelId,
+                           ESIRequestScheduler::Priority priority) const
     {
-        runNowOrLater([=] {
+        runScheduled(priority, [=] {
+            if (!mOAuth.hasToken(charId))
+            {
+                // logging in can take a while - don't hold the slot meanwhile
+                mScheduler.release();
+                mOAuth.waitForToken(charId, [=] {
+                    get<T, ResultTag>(charId, url, parameters, continuation, retries, importingCitadels, citadelId, priority);
+                }, [=](const auto &error) {
+                    TaggedInvoke<ResultTag>::invoke(error, continuation);
+                });
+
+                return;
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+
+            // character data stays out of the response cache, so no conditional requests here
             mOAuth.get(charId, ESIUrls::esiUrl + url, parameters, [=](auto &reply) {
-                qDebug() << "ESI request:" << url << ":" << parameters;
-                qDebug() << "Retries" << retries;
+                mScheduler.finish(&reply, timer.elapsed());
+
+                qCDebug(esiLog) << "ESI request:" << url << ":" << parameters;
+                qCDebug(esiLog) << "Retries" << retries;
 
                 showReplyDebugInfo(reply);
 
@@ -728,7 +861,7 @@ namespace Evernus
                     if (shouldThrottle(httpStatus))  // error limit reached?
                     {
                         schedulePostErrorLimitRequest([=] {
-                            get<T, ResultTag>(charId, url, parameters, continuation, retries, importingCitadels, citadelId);
+                            get<T, ResultTag>(charId, url, parameters, continuation, retries, importingCitadels, citadelId, priority);
                         }, reply);
                     }
                     else
@@ -752,7 +885,7 @@ namespace Evernus
                         }
                         else if (retries > 0)
                         {
-                            get<T, ResultTag>(charId, url, parameters, continuation, retries - 1, importingCitadels, citadelId);
+                            get<T, ResultTag>(charId, url, parameters, continuation, retries - 1, importingCitadels, citadelId, priority);
                         }
                         else
                         {
@@ -764,11 +897,12 @@ namespace Evernus
                 {
                     const auto data = reply.readAll();
                     if (mLogReplies)
-                        qDebug() << url << data;
+                        qCDebug(esiLog) << url << data;
 
                     TaggedInvoke<ResultTag>::invoke(data, reply, continuation);
                 }
             }, [=](const auto &error) {
+                mScheduler.finish(nullptr, timer.elapsed());
                 TaggedInvoke<ResultTag>::invoke(error, continuation);
             });
         });
@@ -777,9 +911,26 @@ namespace Evernus
     template<class T>
     void ESIInterface::post(Character::IdType charId, const QString &url, const QVariant &data, T &&errorCallback) const
     {
-        runNowOrLater([=] {
+        // posts are UI actions, so they go before anything else
+        runScheduled(ESIRequestScheduler::Priority::Interactive, [=] {
+            if (!mOAuth.hasToken(charId))
+            {
+                // logging in can take a while - don't hold the slot meanwhile
+                mScheduler.release();
+                mOAuth.waitForToken(charId, [=] {
+                    post(charId, url, data, errorCallback);
+                }, errorCallback);
+
+                return;
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+
             mOAuth.post(charId, ESIUrls::esiUrl + url, data, [=](auto &reply) {
-                qDebug() << "ESI request:" << url << ":" << data;
+                mScheduler.finish(&reply, timer.elapsed());
+
+                qCDebug(esiLog) << "ESI request:" << url << ":" << data;
 
                 showReplyDebugInfo(reply);
 
@@ -794,7 +945,7 @@ namespace Evernus
                     if (shouldThrottle(httpStatus))  // error limit reached?
                     {
                         schedulePostErrorLimitRequest([=] {
-                            post(charId, url, data, std::move(errorCallback));
+                            post(charId, url, data, errorCallback);
                         }, reply);
                     }
                     else
@@ -806,13 +957,14 @@ namespace Evernus
                 {
                     const auto data = reply.readAll();
                     if (mLogReplies)
-                        qDebug() << url << data;
+                        qCDebug(esiLog) << url << data;
 
                     const auto error = getError(data);
                     if (!error.mMessage.isEmpty())
                         errorCallback(error);
                 }
             }, [=](const auto &error) {
+                mScheduler.finish(nullptr, timer.elapsed());
                 errorCallback(error);
             });
         });
@@ -821,16 +973,20 @@ namespace Evernus
     template<class T>
     void ESIInterface::post(const QString &url, const QVariant &data, ErrorCallback errorCallback, T &&resultCallback) const
     {
-        runNowOrLater([=] {
+        runScheduled(ESIRequestScheduler::Priority::Normal, [=] {
+            QElapsedTimer timer;
+            timer.start();
+
             auto reply = mOAuth.post(ESIUrls::esiUrl + url, data);
             Q_ASSERT(reply != nullptr);
 
-            qDebug() << "ESI request" << reply << ":" << url << ":" << data;
+            qCDebug(esiLog) << "ESI request" << reply << ":" << url << ":" << data;
 
             new ReplyTimeout{*reply};
 
             connect(reply, &QNetworkReply::finished, this, [=] {
                 reply->deleteLater();
+                mScheduler.finish(reply, timer.elapsed());
 
                 showReplyDebugInfo(*reply);
 
@@ -857,7 +1013,7 @@ namespace Evernus
                 {
                     const auto resultText = reply->readAll();
                     if (mLogReplies)
-                        qDebug() << url << resultText;
+                        qCDebug(esiLog) << url << resultText;
 
                     const auto error = getError(resultText);
                     if (!error.mMessage.isEmpty())
@@ -918,6 +1074,28 @@ namespace Evernus
         }
     }
 
+    template<class T>
+    void ESIInterface::runScheduled(ESIRequestScheduler::Priority priority, T callback) const
+    {
+        runNowOrLater([=] {
+            mScheduler.schedule(priority, callback);
+        });
+    }
+
+    bool ESIInterface::isEmptyPage(const QJsonDocument &page)
+    {
+        return page.array().isEmpty();
+    }
+
+    bool ESIInterface::isEmptyPage(const QByteArray &page)
+    {
+        const auto trimmed = page.trimmed();
+        if (!trimmed.startsWith('['))
+            return true;
+
+        return trimmed.mid(1, trimmed.size() - 2).trimmed().isEmpty();
+    }
+
     ESIInterface::ErrorInfo ESIInterface::getError(const QByteArray &reply)
     {
         // try to get ESI error
@@ -951,11 +1129,16 @@ namespace Evernus
 
     void ESIInterface::showReplyDebugInfo(const QNetworkReply &reply)
     {
-        qDebug() << "X-Esi-Ab-Test:" << reply.rawHeader(QByteArrayLiteral("X-Esi-Ab-Test"));
+        qCDebug(esiLog) << "X-Esi-Ab-Test:" << reply.rawHeader(QByteArrayLiteral("X-Esi-Ab-Test"));
     }
 
     bool ESIInterface::shouldThrottle(int httpStatus)
     {
         return httpStatus == errorLimitCode || httpStatus == requestThrottledCode;
     }
+
+    bool ESIInterface::isNotModified(const QNetworkReply &reply)
+    {
+        return reply.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == notModifiedCode;
+    }
 }
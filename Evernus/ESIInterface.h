@@ -25,19 +25,23 @@
 #include <QString>
 
 #include "WalletJournalEntry.h"
+#include "ESIRequestScheduler.h"
 #include "WalletTransaction.h"
+#include "ESIResponseCache.h"
 #include "Character.h"
 #include "Contract.h"
 #include "EveType.h"
 
 class QNetworkRequest;
 class QJsonDocument;
+class QByteArray;
 class QNetworkReply;
 class QUrlQuery;
 
 namespace Evernus
 {
     class ESIInterfaceErrorLimiter;
+    class MarketImportPlanner;
     class CitadelAccessCache;
     class ESIOAuth;
 
@@ -51,23 +55,27 @@ namespace Evernus
         using PersistentCallback = std::function<void (T &&data, const QString &error)>;
         using JsonCallback = std::function<void (QJsonDocument &&data, const QString &error, const QDateTime &expires)>;
         using PaginatedCallback = std::function<void (QJsonDocument &&data, bool atEnd, const QString &error, const QDateTime &expires)>;
+        // notModified is set for pages which came from the response cache
+        using PaginatedRawCallback = std::function<void (QByteArray &&data, bool atEnd, const QString &error, const QDateTime &expires, bool notModified)>;
         using ErrorCallback = std::function<void (const QString &error)>;
         using StringCallback = std::function<void (QString &&data, const QString &error, const QDateTime &expires)>;  // https://bugreports.qt.io/browse/QTBUG-62502
         using PersistentStringCallback = PersistentCallback<QString>;
         using PersistentJsonCallback = PersistentCallback<QJsonDocument>;
 
         ESIInterface(CitadelAccessCache &citadelAccessCache,
+                     ESIResponseCache &responseCache,
                      ESIInterfaceErrorLimiter &errorLimiter,
+                     MarketImportPlanner &importPlanner,
                      ESIOAuth &oauth,
                      QObject *parent = nullptr);
         ESIInterface(const ESIInterface &) = default;
         ESIInterface(ESIInterface &&) = default;
         virtual ~ESIInterface() = default;
 
-        void fetchMarketOrders(uint regionId, EveType::IdType typeId, const PaginatedCallback &callback) const;
-        void fetchMarketOrders(uint regionId, const PaginatedCallback &callback) const;
+        void fetchMarketOrders(uint regionId, EveType::IdType typeId, const PaginatedRawCallback &callback) const;
+        void fetchMarketOrders(uint regionId, const PaginatedRawCallback &callback) const;
         void fetchMarketHistory(uint regionId, EveType::IdType typeId, const JsonCallback &callback) const;
-        void fetchCitadelMarketOrders(quint64 citadelId, Character::IdType charId, const PaginatedCallback &callback) const;
+        void fetchCitadelMarketOrders(quint64 citadelId, Character::IdType charId, const PaginatedRawCallback &callback) const;
         void fetchCharacterAssets(Character::IdType charId, const PaginatedCallback &callback) const;
         void fetchCorporationAssets(Character::IdType charId, quint64 corpId, const PaginatedCallback &callback) const;
         void fetchCharacter(Character::IdType charId, const JsonCallback &callback) const;
@@ -109,6 +117,9 @@ namespace Evernus
 
         void setDestination(quint64 locationId, Character::IdType charId, const ErrorCallback &errorCallback) const;
 
+        ESIRequestScheduler::Stats getSchedulerStats() const;
+        ESIResponseCache::Stats getResponseCacheStats() const;
+
         ESIInterface &operator =(const ESIInterface &) = default;
         ESIInterface &operator =(ESIInterface &&) = default;
 
@@ -126,6 +137,7 @@ namespace Evernus
 
         struct JsonTag {};
         struct PaginatedJsonTag {};
+        struct PaginatedRawTag {};
         struct StringTag {};
 
         template<class Tag>
@@ -133,11 +145,14 @@ namespace Evernus
 
         struct PaginatedContext;
 
+        static const int notModifiedCode = 304;
         static const int errorLimitCode = 420;
         static const int requestThrottledCode = 429;
 
         CitadelAccessCache &mCitadelAccessCache;
+        ESIResponseCache &mResponseCache;
         ESIInterfaceErrorLimiter &mErrorLimiter;
+        MarketImportPlanner &mImportPlanner;
         ESIOAuth &mOAuth;
 
         bool mLogReplies = false;
@@ -146,9 +161,11 @@ namespace Evernus
 
         QSettings mSettings;
 
-        template<class T>
+        mutable ESIRequestScheduler mScheduler;
+
+        template<class T, class ResultTag = PaginatedJsonTag>
         void fetchPaginatedData(const QString &url, QVariantMap parameters, uint page, T &&continuation, const std::shared_ptr<PaginatedContext> &context) const;
-        template<class T>
+        template<class T, class ResultTag = PaginatedJsonTag>
         void fetchPaginatedData(Character::IdType charId,
                                 const QString &url,
                                 uint page,
@@ -157,8 +174,14 @@ namespace Evernus
                                 bool importingCitadels = false,
                                 quint64 citadelId = 0) const;
 
+        // sentCallback is called each time the request actually goes out, i.e. after it leaves the scheduler queue
         template<class T, class ResultTag = JsonTag>
-        void get(const QString &url, const QVariantMap &parameters, const T &continuation, uint retries) const;
+        void get(const QString &url,
+                 const QVariantMap &parameters,
+                 const T &continuation,
+                 uint retries,
+                 ESIRequestScheduler::Priority priority = ESIRequestScheduler::Priority::Normal,
+                 const std::function<void ()> &sentCallback = {}) const;
         template<class T, class ResultTag = JsonTag>
         void get(Character::IdType charId,
                  const QString &url,
@@ -166,7 +189,8 @@ namespace Evernus
                  const T &continuation,
                  uint retries,
                  bool importingCitadels = false,
-                 quint64 citadelId = 0) const;
+                 quint64 citadelId = 0,
+                 ESIRequestScheduler::Priority priority = ESIRequestScheduler::Priority::Normal) const;
 
         template<class T>
         void post(Character::IdType charId, const QString &url, const QVariant &data, T &&errorCallback) const;
@@ -180,10 +204,15 @@ namespace Evernus
 
         template<class T>
         void runNowOrLater(T callback) const;
+        template<class T>
+        void runScheduled(ESIRequestScheduler::Priority priority, T callback) const;
 
         template<class T, class U>
         static auto createPaginatedCallback(uint page, T continuation, U fetchNext, std::shared_ptr<PaginatedContext> context);
 
+        static bool isEmptyPage(const QJsonDocument &page);
+        static bool isEmptyPage(const QByteArray &page);
+
         static ErrorInfo getError(const QByteArray &reply);
         static ErrorInfo getError(const QString &url, const QVariantMap &parameters, QNetworkReply &reply);
         static QDateTime getExpireTime(const QNetworkReply &reply);
@@ -192,5 +221,6 @@ namespace Evernus
         static void showReplyDebugInfo(const QNetworkReply &reply);
 
         static bool shouldThrottle(int httpStatus);
+        static bool isNotModified(const QNetworkReply &reply);
     };
 }
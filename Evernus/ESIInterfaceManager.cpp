@@ -14,10 +14,12 @@
  */
 #include <QStandardPaths>
 #include <QDataStream>
+#include <QSaveFile>
 #include <QSettings>
 #include <QFile>
 #include <QDir>
 
+#include "NetworkSettings.h"
 #include "ImportSettings.h"
 
 #include "ESIInterfaceManager.h"
@@ -32,12 +34,21 @@ namespace Evernus
         : QObject{parent}
         , mClientId{clientId}
         , mClientSecret{clientSecret}
+        , mResponseCache{
+            getResponseCachePath(),
+            QSettings{}.value(NetworkSettings::esiCacheSizeKey, NetworkSettings::esiCacheSizeDefault).toULongLong() * 1024 * 1024
+        }
         , mOAuth{std::move(clientId), std::move(clientSecret), characterRepo, dataProvider}
-        , mInterface{mCitadelAccessCache, mErrorLimiter, mOAuth}
+        , mInterface{mCitadelAccessCache, mResponseCache, mErrorLimiter, mImportPlanner, mOAuth}
     {
         connect(&mOAuth, &ESIOAuth::ssoAuthRequested, this, &ESIInterfaceManager::ssoAuthRequested);
 
         readCitadelAccessCache();
+        readMarketImportStats();
+        mResponseCache.readIndex();
+
+        connect(&mMarketImportStatsTimer, &QTimer::timeout, this, &ESIInterfaceManager::writeMarketImportStats);
+        mMarketImportStatsTimer.start(marketImportStatsSaveInterval);
     }
 
     ESIInterfaceManager::~ESIInterfaceManager()
@@ -45,6 +56,8 @@ namespace Evernus
         try
         {
             writeCitadelAccessCache();
+            writeMarketImportStats();
+            mResponseCache.writeIndex();
         }
         catch (...)
         {
@@ -86,6 +99,11 @@ namespace Evernus
         return mCitadelAccessCache;
     }
 
+    const MarketImportPlanner &ESIInterfaceManager::getMarketImportPlanner() const noexcept
+    {
+        return mImportPlanner;
+    }
+
     QString ESIInterfaceManager::getClientId() const
     {
         return mClientId;
@@ -121,8 +139,39 @@ namespace Evernus
             stream << mCitadelAccessCache;
     }
 
+    void ESIInterfaceManager::readMarketImportStats()
+    {
+        QFile statsFile{getMarketImportStatsPath()};
+        QDataStream stream{&statsFile};
+
+        if (statsFile.open(QIODevice::ReadOnly))
+            stream >> mImportPlanner;
+    }
+
+    void ESIInterfaceManager::writeMarketImportStats()
+    {
+        QSaveFile statsFile{getMarketImportStatsPath()};
+        QDataStream stream{&statsFile};
+
+        if (statsFile.open(QIODevice::WriteOnly))
+        {
+            stream << mImportPlanner;
+            statsFile.commit();
+        }
+    }
+
     QString ESIInterfaceManager::getCachePath()
     {
         return QDir{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/data")}.filePath(QStringLiteral("citadel_access"));
     }
+
+    QString ESIInterfaceManager::getMarketImportStatsPath()
+    {
+        return QDir{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/data")}.filePath(QStringLiteral("market_import_stats"));
+    }
+
+    QString ESIInterfaceManager::getResponseCachePath()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/esi");
+    }
 }
@@ -17,10 +17,13 @@
 #include <QDateTime>
 #include <QObject>
 #include <QString>
+#include <QTimer>
 
 #include "QObjectDeleteLaterDeleter.h"
 #include "ESIInterfaceErrorLimiter.h"
+#include "MarketImportPlanner.h"
 #include "CitadelAccessCache.h"
+#include "ESIResponseCache.h"
 #include "ESIInterface.h"
 #include "Character.h"
 #include "ESIOAuth.h"
@@ -60,6 +63,8 @@ namespace Evernus
         const CitadelAccessCache &getCitadelAccessCache() const noexcept;
         CitadelAccessCache &getCitadelAccessCache() noexcept;
 
+        const MarketImportPlanner &getMarketImportPlanner() const noexcept;
+
         QString getClientId() const;
         QString getClientSecret() const;
 
@@ -70,18 +75,29 @@ namespace Evernus
         void ssoAuthRequested(Character::IdType charId, const QUrl &url);
 
     private:
+        // don't lose latency stats on a crash
+        static const int marketImportStatsSaveInterval = 5 * 60 * 1000;
+
         QString mClientId;
         QString mClientSecret;
 
         CitadelAccessCache mCitadelAccessCache;
+        ESIResponseCache mResponseCache;
         ESIInterfaceErrorLimiter mErrorLimiter;
+        MarketImportPlanner mImportPlanner;
         ESIOAuth mOAuth;
 
         ESIInterface mInterface;
 
+        QTimer mMarketImportStatsTimer;
+
         void readCitadelAccessCache();
         void writeCitadelAccessCache();
+        void readMarketImportStats();
+        void writeMarketImportStats();
 
         static QString getCachePath();
+        static QString getMarketImportStatsPath();
+        static QString getResponseCachePath();
     };
 }
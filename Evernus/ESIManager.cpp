@@ -34,6 +34,7 @@
 #include <boost/scope_exit.hpp>
 
 #include "SovereigntyStructure.h"
+#include "ESIExternalOrderParser.h"
 #include "ESIInterfaceManager.h"
 #include "EveDataProvider.h"
 #include "NetworkSettings.h"
@@ -109,10 +110,10 @@ namespace Evernus
         });
     }
 
-    void ESIManager::fetchMarketOrders(uint regionId, const MarketOrderCallback &callback) const
+    void ESIManager::fetchMarketOrders(uint regionId, const MarketOrderCallback &callback, bool skipUnchanged) const
     {
         qDebug() << "Started market order import at" << QDateTime::currentDateTime();
-        getInterface().fetchMarketOrders(regionId, getMarketOrderCallback(regionId, callback));
+        getInterface().fetchMarketOrders(regionId, getMarketOrderCallback(regionId, callback, skipUnchanged));
     }
 
     void ESIManager::fetchCitadelMarketOrders(quint64 citadelId, uint regionId, Character::IdType charId, const MarketOrderCallback &callback) const
@@ -854,35 +855,85 @@ namespace Evernus
         return order;
     }
 
-    ESIInterface::PaginatedCallback ESIManager::getMarketOrderCallback(uint regionId, const MarketOrderCallback &callback) const
+    ESIInterface::PaginatedRawCallback ESIManager::getMarketOrderCallback(uint regionId, const MarketOrderCallback &callback, bool skipUnchanged) const
     {
-        auto orders = std::make_shared<std::vector<ExternalOrder>>();
-        return [=, orders = std::move(orders)](auto &&data, auto atEnd, const auto &error, const auto &expires) {
+        struct ImportState
+        {
+            ExternalOrderList mOrders;
+            // cached pages wait here until we know if they're needed at all
+            std::vector<QByteArray> mUnchangedPages;
+            bool mModified = false;
+        };
+
+        auto state = std::make_shared<ImportState>();
+        return [=, state = std::move(state)](auto &&data, auto atEnd, const auto &error, const auto &expires, auto notModified) {
             if (Q_UNLIKELY(!error.isEmpty()))
             {
                 callback({}, error, expires);
                 return;
             }
 
-            const auto items = data.array();
-            const auto curSize = orders->size();
-            orders->resize(curSize + items.size());
-
             const auto updateTime = QDateTime::currentDateTimeUtc();
+            const auto parseUnchangedPages = [&] {
+                for (const auto &page : state->mUnchangedPages)
+                    parseMarketOrderPage(regionId, page, updateTime, state->mOrders);
 
-            std::atomic_size_t nextIndex{curSize};
-
-            const auto parseItem = [&](const auto &item) {
-                (*orders)[nextIndex++] = getExternalOrderFromJson(item.toObject(), regionId, updateTime);
+                state->mUnchangedPages.clear();
             };
 
-            QtConcurrent::blockingMap(items, parseItem);
+            if (!notModified && !state->mModified)
+            {
+                state->mModified = true;
+                parseUnchangedPages();
+            }
 
-            if (atEnd)
-                callback(std::move(*orders), {}, expires);
+            if (state->mModified)
+                parseMarketOrderPage(regionId, data, updateTime, state->mOrders);
+            else
+                state->mUnchangedPages.emplace_back(std::move(data));
+
+            if (!atEnd)
+                return;
+
+            if (!state->mModified)
+            {
+                if (skipUnchanged)
+                {
+                    qDebug() << "Market orders for region" << regionId << "not modified.";
+
+                    callback({}, {}, expires);
+                    return;
+                }
+
+                parseUnchangedPages();
+            }
+
+            callback(std::move(state->mOrders), {}, expires);
         };
     }
 
+    void ESIManager::parseMarketOrderPage(uint regionId, const QByteArray &data, const QDateTime &updateTime, ExternalOrderList &orders) const
+    {
+        const auto curSize = orders.size();
+
+        ESIExternalOrderParser parser{data};
+        if (Q_UNLIKELY(!parser.parse(regionId, updateTime, orders)))
+        {
+            qWarning() << "Unexpected market order page format, falling back to generic JSON parsing for region" << regionId;
+
+            const auto items = QJsonDocument::fromJson(data).array();
+            for (const auto &item : items)
+                orders.emplace_back(getExternalOrderFromJson(item.toObject(), regionId, updateTime));
+        }
+
+        // structure orders come without solar system
+        for (auto order = std::next(std::begin(orders), curSize); order != std::end(orders); ++order)
+        {
+            if (order->getSolarSystemId() == 0)
+                order->setSolarSystemId(mDataProvider.getStationSolarSystemId(order->getStationId()));
+        }
+    }
+
     ESIInterface::JsonCallback ESIManager::getMarketOrdersCallback(Character::IdType charId, const MarketOrdersCallback &callback) const
     {
         return [=](auto &&data, const auto &error, const auto &expires) {
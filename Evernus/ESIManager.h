@@ -95,7 +95,8 @@ namespace Evernus
         void fetchMarketHistory(uint regionId,
                                 EveType::IdType typeId,
                                 const Callback<HistoryMap> &callback) const;
-        void fetchMarketOrders(uint regionId, const MarketOrderCallback &callback) const;
+        // with skipUnchanged, a region which hasn't changed since it was last fetched comes back empty and unparsed
+        void fetchMarketOrders(uint regionId, const MarketOrderCallback &callback, bool skipUnchanged = false) const;
         void fetchCitadelMarketOrders(quint64 citadelId,
                                       uint regionId,
                                       Character::IdType charId,
@@ -170,7 +171,8 @@ namespace Evernus
                                                 const WalletTransactionsCallback &callback) const;
 
         ExternalOrder getExternalOrderFromJson(const QJsonObject &object, uint regionId, const QDateTime &updateTime) const;
-        ESIInterface::PaginatedCallback getMarketOrderCallback(uint regionId, const MarketOrderCallback &callback) const;
+        ESIInterface::PaginatedRawCallback getMarketOrderCallback(uint regionId, const MarketOrderCallback &callback, bool skipUnchanged = false) const;
+        void parseMarketOrderPage(uint regionId, const QByteArray &data, const QDateTime &updateTime, ExternalOrderList &orders) const;
         ESIInterface::JsonCallback getMarketOrdersCallback(Character::IdType charId, const MarketOrdersCallback &callback) const;
         ESIInterface::PaginatedCallback getAssetListCallback(Character::IdType charId, const AssetCallback &callback) const;
         ESIInterface::JsonCallback getContractCallback(const ContractCallback &callback) const;
@@ -68,17 +68,12 @@ namespace Evernus
         });
     }
 
-    QNetworkReply *ESIOAuth::get(QUrl url, QVariantMap parameters)
+    QNetworkReply *ESIOAuth::get(QUrl url, QVariantMap parameters, const QByteArray &etag)
     {
         prepareParameters(parameters);
+        setQuery(url, parameters);
 
-        QUrlQuery query{url.query()};
-        for (auto param = std::begin(parameters); param != std::end(parameters); ++param)
-            query.addQueryItem(param.key(), param.value().toString());
-
-        url.setQuery(query);
-
-        const auto reply = mUnauthNetworkAccessManager.get(prepareRequest(url));
+        const auto reply = mUnauthNetworkAccessManager.get(prepareRequest(url, etag));
         connect(reply, &QNetworkReply::sslErrors, this, &ESIOAuth::processSslErrors);
 
         return reply;
@@ -97,6 +92,28 @@ namespace Evernus
         return reply;
     }
 
+    void ESIOAuth::waitForToken(Character::IdType charId, std::function<void ()> callback, AuthErrorCallback errorCallback)
+    {
+        auto &auth = getOAuth(charId);
+        const auto status = auth.status();
+
+        if (status == QAbstractOAuth::Status::Granted)
+        {
+            callback();
+            return;
+        }
+
+        mPendingRequests[charId].emplace_back(std::move(callback), std::move(errorCallback));
+
+        if (status == QAbstractOAuth::Status::NotAuthenticated)
+            grantOrRefresh(auth);
+    }
+
+    bool ESIOAuth::hasToken(Character::IdType charId)
+    {
+        return getOAuth(charId).status() == QAbstractOAuth::Status::Granted;
+    }
+
     void ESIOAuth::clearRefreshTokens()
     {
         mRefreshTokens.clear();
@@ -212,6 +229,15 @@ namespace Evernus
         url.setQuery(query);
     }
 
+    void ESIOAuth::setQuery(QUrl &url, const QVariantMap &parameters)
+    {
+        QUrlQuery query{url.query()};
+        for (auto param = std::begin(parameters); param != std::end(parameters); ++param)
+            query.addQueryItem(param.key(), param.value().toString());
+
+        url.setQuery(query);
+    }
+
     template<class T>
     void ESIOAuth::makeRequest(Character::IdType charId, const QUrl &url, NetworkReplyCallback callback, AuthErrorCallback errorCallback, T replyCreator)
     {
@@ -310,11 +336,14 @@ namespace Evernus
         }
     }
 
-    QNetworkRequest ESIOAuth::prepareRequest(const QUrl &url)
+    QNetworkRequest ESIOAuth::prepareRequest(const QUrl &url, const QByteArray &etag)
     {
         QNetworkRequest request{url};
         request.setHeader(QNetworkRequest::UserAgentHeader, getUserAgent());
 
+        if (!etag.isEmpty())
+            request.setRawHeader(QByteArrayLiteral("If-None-Match"), etag);
+
         return request;
     }
 
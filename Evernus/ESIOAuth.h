@@ -19,6 +19,7 @@
 #include <vector>
 
 #include <QAbstractOAuth>
+#include <QByteArray>
 #include <QVariant>
 #include <QList>
 
@@ -26,7 +27,6 @@
 #include "SimpleCrypt.h"
 #include "Character.h"
 
-class QByteArray;
 class QSslError;
 
 namespace Evernus
@@ -54,10 +54,15 @@ namespace Evernus
         virtual ~ESIOAuth() = default;
 
         void get(Character::IdType charId, const QUrl &url, QVariantMap parameters, NetworkReplyCallback callback, AuthErrorCallback errorCallback);
-        QNetworkReply *get(QUrl url, QVariantMap parameters = {});
+        // non-empty etag makes the request conditional
+        QNetworkReply *get(QUrl url, QVariantMap parameters = {}, const QByteArray &etag = {});
         QNetworkReply *post(QUrl url, const QVariant &data = {});
         void post(Character::IdType charId, QUrl url, const QVariant &data, NetworkReplyCallback callback, AuthErrorCallback errorCallback);
 
+        // calls back right away when the character has a token, otherwise once authorization finishes
+        void waitForToken(Character::IdType charId, std::function<void ()> callback, AuthErrorCallback errorCallback);
+        bool hasToken(Character::IdType charId);
+
         void clearRefreshTokens();
 
         void processSSOAuthorizationCode(Character::IdType charId, const QByteArray &rawQuery);
@@ -105,6 +110,8 @@ namespace Evernus
         void prepareParameters(QVariantMap &parameters);
         void prepareUrl(QUrl &url);
 
+        static void setQuery(QUrl &url, const QVariantMap &parameters);
+
         template<class T>
         void makeRequest(Character::IdType charId, const QUrl &url, NetworkReplyCallback callback, AuthErrorCallback errorCallback, T replyCreator);
         template<class T>
@@ -116,7 +123,7 @@ namespace Evernus
 
         void saveRefreshToken(Character::IdType charId);
 
-        static QNetworkRequest prepareRequest(const QUrl &url);
+        static QNetworkRequest prepareRequest(const QUrl &url, const QByteArray &etag = {});
 
         static void grantOrRefresh(ESIOAuth2CharacterAuthorizationCodeFlow &oauth);
     };
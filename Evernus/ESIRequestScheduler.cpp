@@ -0,0 +1,181 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+
+#include <QNetworkReply>
+#include <QtDebug>
+
+#include "ESIRequestScheduler.h"
+
+namespace Evernus
+{
+    ESIRequestScheduler::ESIRequestScheduler(uint maxInFlight, QObject *parent)
+        : QObject{parent}
+        , mMaxInFlight{std::max(maxInFlight, 1u)}
+    {
+        mResumeTimer.setSingleShot(true);
+        connect(&mResumeTimer, &QTimer::timeout, this, &ESIRequestScheduler::resume);
+    }
+
+    void ESIRequestScheduler::schedule(Priority priority, Request request)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mStateMutex};
+
+            PendingRequest pending{std::move(request), {}};
+            pending.mQueueTimer.start();
+
+            mQueues[static_cast<std::size_t>(priority)].emplace_back(std::move(pending));
+        }
+
+        dispatch();
+    }
+
+    void ESIRequestScheduler::finish(const QNetworkReply *reply, qint64 latency)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mStateMutex};
+
+            Q_ASSERT(mInFlight > 0);
+            --mInFlight;
+
+            ++mCompleted;
+            mTotalLatency += latency;
+
+            const auto remainHeader = QByteArrayLiteral("X-Esi-Error-Limit-Remain");
+            if (reply != nullptr && reply->hasRawHeader(remainHeader))
+            {
+                mErrorLimitRemain = reply->rawHeader(remainHeader).toInt();
+                if (mErrorLimitRemain <= errorLimitPauseThreshold && !mPaused)
+                {
+                    auto reset = reply->rawHeader(QByteArrayLiteral("X-Esi-Error-Limit-Reset")).toInt();
+                    if (reset <= 0)
+                        reset = 60;
+
+                    qWarning() << "ESI error limit almost reached, holding bulk requests for" << reset << "s.";
+
+                    mPaused = true;
+                    mResumeTimer.start(reset * 1000);
+                }
+            }
+
+            if (mInFlight == 0 && !hasPendingRequests())
+            {
+                qDebug() << "ESI request queue drained:"
+                         << mCompleted << "requests, avg. wait" << (mTotalWaitTime / std::max(mDispatched, Q_UINT64_C(1)))
+                         << "ms, avg. latency" << (mTotalLatency / std::max(mCompleted, Q_UINT64_C(1))) << "ms.";
+            }
+        }
+
+        dispatch();
+    }
+
+    void ESIRequestScheduler::release()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mStateMutex};
+
+            Q_ASSERT(mInFlight > 0);
+            --mInFlight;
+        }
+
+        dispatch();
+    }
+
+    ESIRequestScheduler::Stats ESIRequestScheduler::getStats() const
+    {
+        std::lock_guard<std::mutex> lock{mStateMutex};
+
+        Stats stats;
+        std::transform(std::begin(mQueues), std::end(mQueues), std::begin(stats.mQueued), [](const auto &queue) {
+            return queue.size();
+        });
+
+        stats.mInFlight = mInFlight;
+        stats.mMaxInFlight = getCurrentLimit();
+        stats.mCompleted = mCompleted;
+        stats.mAvgWaitTime = mTotalWaitTime / std::max(mDispatched, Q_UINT64_C(1));
+        stats.mAvgLatency = mTotalLatency / std::max(mCompleted, Q_UINT64_C(1));
+        stats.mErrorLimitRemain = mErrorLimitRemain;
+
+        return stats;
+    }
+
+    void ESIRequestScheduler::resume()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mStateMutex};
+
+            // error window has been reset by now
+            mPaused = false;
+            mErrorLimitRemain = -1;
+        }
+
+        qDebug() << "Resuming ESI requests.";
+        dispatch();
+    }
+
+    void ESIRequestScheduler::dispatch()
+    {
+        while (true)
+        {
+            Request request;
+
+            {
+                std::lock_guard<std::mutex> lock{mStateMutex};
+
+                if (mInFlight >= getCurrentLimit())
+                    return;
+
+                // only interactive requests pass when we're close to the error limit
+                const auto lastQueue = (mPaused) ? (std::next(std::begin(mQueues))) : (std::end(mQueues));
+                const auto queue = std::find_if(std::begin(mQueues), lastQueue, [](const auto &queue) {
+                    return !queue.empty();
+                });
+
+                if (queue == lastQueue)
+                    return;
+
+                auto &pending = queue->front();
+
+                mTotalWaitTime += pending.mQueueTimer.elapsed();
+                request = std::move(pending.mRequest);
+
+                queue->pop_front();
+
+                ++mInFlight;
+                ++mDispatched;
+            }
+
+            request();
+        }
+    }
+
+    uint ESIRequestScheduler::getCurrentLimit() const noexcept
+    {
+        // scale concurrency down as errors pile up
+        if (mErrorLimitRemain < 0 || mErrorLimitRemain >= errorLimitSlowdownThreshold)
+            return mMaxInFlight;
+
+        return std::max(1u, mMaxInFlight * static_cast<uint>(mErrorLimitRemain) / errorLimitSlowdownThreshold);
+    }
+
+    bool ESIRequestScheduler::hasPendingRequests() const noexcept
+    {
+        return std::any_of(std::begin(mQueues), std::end(mQueues), [](const auto &queue) {
+            return !queue.empty();
+        });
+    }
+}
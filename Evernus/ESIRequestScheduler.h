@@ -0,0 +1,109 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <array>
+#include <deque>
+#include <mutex>
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QNetworkReply;
+
+namespace Evernus
+{
+    // limits the number of ESI requests in flight and orders waiting ones by priority
+    // dispatching is paced by ESI error limit headers, before 420s start coming back
+    // must only be used from the thread owning the ESI interface
+    class ESIRequestScheduler final
+        : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        enum class Priority
+        {
+            Interactive,
+            Normal,
+            Bulk,
+        };
+
+        using Request = std::function<void ()>;
+
+        struct Stats
+        {
+            std::array<std::size_t, 3> mQueued = {};
+            uint mInFlight = 0;
+            uint mMaxInFlight = 0;
+            quint64 mCompleted = 0;
+            qint64 mAvgWaitTime = 0;
+            qint64 mAvgLatency = 0;
+            int mErrorLimitRemain = -1;
+        };
+
+        explicit ESIRequestScheduler(uint maxInFlight, QObject *parent = nullptr);
+        ESIRequestScheduler(const ESIRequestScheduler &) = delete;
+        ESIRequestScheduler(ESIRequestScheduler &&) = delete;
+        virtual ~ESIRequestScheduler() = default;
+
+        void schedule(Priority priority, Request request);
+
+        // every dispatched request must be finished exactly once; reply is null when no request was made
+        void finish(const QNetworkReply *reply, qint64 latency);
+        // gives back the slot of a dispatched request which is going to wait (e.g. for SSO) instead of finishing; it has to be scheduled again
+        void release();
+
+        Stats getStats() const;
+
+        ESIRequestScheduler &operator =(const ESIRequestScheduler &) = delete;
+        ESIRequestScheduler &operator =(ESIRequestScheduler &&) = delete;
+
+    private slots:
+        void resume();
+
+    private:
+        // ESI allows 100 errors per window
+        static const int errorLimitSlowdownThreshold = 50;
+        static const int errorLimitPauseThreshold = 10;
+
+        struct PendingRequest
+        {
+            Request mRequest;
+            QElapsedTimer mQueueTimer;
+        };
+
+        std::array<std::deque<PendingRequest>, 3> mQueues;
+
+        uint mMaxInFlight = 1;
+        uint mInFlight = 0;
+
+        int mErrorLimitRemain = -1;
+        bool mPaused = false;
+        QTimer mResumeTimer;
+
+        quint64 mCompleted = 0;
+        quint64 mDispatched = 0;
+        qint64 mTotalWaitTime = 0;
+        qint64 mTotalLatency = 0;
+
+        mutable std::mutex mStateMutex;
+
+        void dispatch();
+        uint getCurrentLimit() const noexcept;
+        bool hasPendingRequests() const noexcept;
+    };
+}
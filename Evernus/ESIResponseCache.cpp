@@ -0,0 +1,329 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <vector>
+
+#include <QCryptographicHash>
+#include <QtConcurrent>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QtDebug>
+#include <QFile>
+#include <QDir>
+
+#include "ESIResponseCache.h"
+
+namespace Evernus
+{
+    ESIResponseCache::ESIResponseCache(QString directory, quint64 maxSize)
+        : mDirectory{std::move(directory)}
+        , mMaxSize{maxSize}
+    {
+        mWriterPool.setMaxThreadCount(1);
+    }
+
+    ESIResponseCache::~ESIResponseCache()
+    {
+        mWriterPool.waitForDone();
+    }
+
+    QByteArray ESIResponseCache::getETag(const QByteArray &key) const
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        const auto entry = mEntries.constFind(key);
+        return (entry == mEntries.constEnd()) ? (QByteArray{}) : (entry->mETag);
+    }
+
+    std::optional<QByteArray> ESIResponseCache::getData(const QByteArray &key)
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        const auto entry = mEntries.find(key);
+        if (entry == mEntries.end())
+            return std::nullopt;
+
+        entry->mLastUsed = QDateTime::currentDateTimeUtc();
+
+        const auto pending = mPendingWrites.constFind(key);
+        if (pending != mPendingWrites.constEnd())
+        {
+            if (++mHits % statsLogInterval == 0)
+                logStats();
+
+            return *pending;
+        }
+
+        QFile file{getFilePath(key)};
+        if (Q_UNLIKELY(!file.open(QIODevice::ReadOnly)))
+        {
+            qWarning() << "Missing ESI cache file:" << file.fileName();
+
+            removeEntry(key);
+            return std::nullopt;
+        }
+
+        if (++mHits % statsLogInterval == 0)
+            logStats();
+
+        return file.readAll();
+    }
+
+    void ESIResponseCache::store(const QByteArray &key, const QByteArray &etag, const QByteArray &data)
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        if (++mMisses % statsLogInterval == 0)
+            logStats();
+
+        if (mMaxSize == 0)
+            return;
+
+        if (etag.isEmpty() || static_cast<quint64>(data.size()) > mMaxSize)
+        {
+            removeEntry(key);
+            return;
+        }
+
+        auto &entry = mEntries[key];
+        mSize -= entry.mSize;
+
+        entry.mETag = etag;
+        entry.mSize = data.size();
+        entry.mLastUsed = QDateTime::currentDateTimeUtc();
+        entry.mVersion = ++mNextVersion;
+
+        mSize += entry.mSize;
+
+        // until the file is there, 304s are answered from memory
+        mPendingWrites[key] = data;
+        QtConcurrent::run(&mWriterPool, [=, version = entry.mVersion] {
+            writeFile(key, data, version);
+        });
+
+        if (mSize > mMaxSize)
+            evict();
+
+        if (++mChangesSinceIndexWrite >= indexWriteInterval)
+            scheduleIndexWrite();
+    }
+
+    void ESIResponseCache::remove(const QByteArray &key)
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+        removeEntry(key);
+    }
+
+    void ESIResponseCache::readIndex()
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        QDir{}.mkpath(mDirectory);
+
+        mEntries.clear();
+        mSize = 0;
+
+        QFile indexFile{getIndexPath()};
+        if (indexFile.open(QIODevice::ReadOnly))
+        {
+            QDataStream stream{&indexFile};
+
+            quint32 count = 0;
+            stream >> count;
+
+            for (auto i = 0u; i < count && stream.status() == QDataStream::Ok; ++i)
+            {
+                QByteArray key;
+                Entry entry;
+
+                stream >> key >> entry.mETag >> entry.mSize >> entry.mLastUsed;
+
+                // trust the file, not the index
+                const QFileInfo info{getFilePath(key)};
+                if (!info.exists())
+                    continue;
+
+                entry.mSize = info.size();
+                mSize += entry.mSize;
+
+                mEntries.insert(key, entry);
+            }
+        }
+
+        // bodies written after the last index save have no ETag to go with them
+        const auto files = QDir{mDirectory}.entryList(QDir::Files);
+        for (const auto &file : files)
+        {
+            if (file != QFileInfo{getIndexPath()}.fileName() && !mEntries.contains(file.toLatin1()))
+                QFile::remove(QDir{mDirectory}.filePath(file));
+        }
+
+        if (mSize > mMaxSize)
+            evict();
+
+        qDebug() << "ESI response cache:" << mEntries.size() << "entries," << mSize << "bytes.";
+    }
+
+    void ESIResponseCache::writeIndex() const
+    {
+        // let pending bodies reach the disk first, so the index doesn't point at missing files
+        mWriterPool.waitForDone();
+
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        writeIndex(mEntries);
+        logStats();
+    }
+
+    ESIResponseCache::Stats ESIResponseCache::getStats() const
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        Stats stats;
+        stats.mHits = mHits;
+        stats.mMisses = mMisses;
+        stats.mSize = mSize;
+        stats.mEntries = mEntries.size();
+
+        return stats;
+    }
+
+    double ESIResponseCache::getHitRate() const
+    {
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        const auto total = mHits + mMisses;
+        return (total == 0) ? (0.) : (static_cast<double>(mHits) / total);
+    }
+
+    QByteArray ESIResponseCache::getKey(const QString &url, const QVariantMap &parameters)
+    {
+        // QVariantMap is ordered, so equal requests give equal keys
+        QCryptographicHash hash{QCryptographicHash::Sha1};
+        hash.addData(url.toUtf8());
+
+        for (auto param = std::begin(parameters); param != std::end(parameters); ++param)
+        {
+            hash.addData("&");
+            hash.addData(param.key().toUtf8());
+            hash.addData("=");
+            hash.addData(param.value().toString().toUtf8());
+        }
+
+        return hash.result().toHex();
+    }
+
+    void ESIResponseCache::writeFile(const QByteArray &key, const QByteArray &data, quint64 version)
+    {
+        QFile file{getFilePath(key)};
+        const auto written = file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+        if (Q_UNLIKELY(!written))
+            qWarning() << "Error writing ESI cache file:" << file.fileName() << file.errorString();
+
+        file.close();
+
+        std::lock_guard<std::mutex> lock{mCacheMutex};
+
+        const auto entry = mEntries.constFind(key);
+        if (entry == mEntries.constEnd())
+        {
+            // removed while we were writing
+            file.remove();
+            return;
+        }
+
+        // a newer body is queued behind us - it takes care of the rest
+        if (entry->mVersion != version)
+            return;
+
+        mPendingWrites.remove(key);
+
+        if (Q_UNLIKELY(!written))
+            removeEntry(key);
+    }
+
+    void ESIResponseCache::scheduleIndexWrite()
+    {
+        mChangesSinceIndexWrite = 0;
+
+        // queued after the bodies stored so far, so the snapshot never refers to files which aren't written yet
+        QtConcurrent::run(&mWriterPool, [=, entries = mEntries] {
+            writeIndex(entries);
+        });
+    }
+
+    void ESIResponseCache::writeIndex(const QHash<QByteArray, Entry> &entries) const
+    {
+        QSaveFile indexFile{getIndexPath()};
+        if (!indexFile.open(QIODevice::WriteOnly))
+            return;
+
+        QDataStream stream{&indexFile};
+        stream << static_cast<quint32>(entries.size());
+
+        for (auto entry = entries.constBegin(); entry != entries.constEnd(); ++entry)
+            stream << entry.key() << entry->mETag << entry->mSize << entry->mLastUsed;
+
+        if (stream.status() == QDataStream::Ok)
+            indexFile.commit();
+    }
+
+    void ESIResponseCache::removeEntry(const QByteArray &key)
+    {
+        const auto entry = mEntries.find(key);
+        if (entry == mEntries.end())
+            return;
+
+        mSize -= entry->mSize;
+        mEntries.erase(entry);
+        mPendingWrites.remove(key);
+
+        QFile::remove(getFilePath(key));
+    }
+
+    void ESIResponseCache::evict()
+    {
+        // drop least recently used entries until we're comfortably below the limit
+        std::vector<std::pair<QDateTime, QByteArray>> entries;
+        entries.reserve(mEntries.size());
+
+        for (auto entry = mEntries.constBegin(); entry != mEntries.constEnd(); ++entry)
+            entries.emplace_back(entry->mLastUsed, entry.key());
+
+        std::sort(std::begin(entries), std::end(entries));
+
+        const auto targetSize = mMaxSize / 10 * 9;
+        for (auto entry = std::begin(entries); entry != std::end(entries) && mSize > targetSize; ++entry)
+            removeEntry(entry->second);
+    }
+
+    void ESIResponseCache::logStats() const
+    {
+        const auto total = mHits + mMisses;
+        qDebug() << "ESI response cache hit rate:" << ((total == 0) ? (0.) : (100. * mHits / total))
+                 << "% (" << mHits << "/" << total << ")," << mSize << "bytes.";
+    }
+
+    QString ESIResponseCache::getFilePath(const QByteArray &key) const
+    {
+        return QDir{mDirectory}.filePath(QString::fromLatin1(key));
+    }
+
+    QString ESIResponseCache::getIndexPath() const
+    {
+        return QDir{mDirectory}.filePath(QStringLiteral("index"));
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <optional>
+#include <mutex>
+
+#include <QThreadPool>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QVariant>
+#include <QString>
+
+namespace Evernus
+{
+    // disk cache of ESI GET replies, keyed by request and validated with ETags
+    // bodies are kept in separate files, the index (key -> ETag) in memory
+    // only public data goes here - character replies are never written to disk
+    class ESIResponseCache final
+    {
+    public:
+        struct Stats
+        {
+            quint64 mHits = 0;
+            quint64 mMisses = 0;
+            quint64 mSize = 0;
+            std::size_t mEntries = 0;
+        };
+
+        ESIResponseCache(QString directory, quint64 maxSize);
+        ESIResponseCache(const ESIResponseCache &) = delete;
+        ESIResponseCache(ESIResponseCache &&) = delete;
+        ~ESIResponseCache();
+
+        // empty if nothing is cached for given key
+        QByteArray getETag(const QByteArray &key) const;
+        // returns cached body for a 304 reply and counts it as a hit; empty optional means the entry is gone
+        std::optional<QByteArray> getData(const QByteArray &key);
+
+        // stores a 200 reply and counts it as a miss; the file is written in the background
+        void store(const QByteArray &key, const QByteArray &etag, const QByteArray &data);
+        void remove(const QByteArray &key);
+
+        void readIndex();
+        void writeIndex() const;
+
+        Stats getStats() const;
+        double getHitRate() const;
+
+        ESIResponseCache &operator =(const ESIResponseCache &) = delete;
+        ESIResponseCache &operator =(ESIResponseCache &&) = delete;
+
+        static QByteArray getKey(const QString &url, const QVariantMap &parameters);
+
+    private:
+        struct Entry
+        {
+            QByteArray mETag;
+            quint64 mSize = 0;
+            QDateTime mLastUsed;
+            quint64 mVersion = 0;
+        };
+
+        static const quint64 statsLogInterval = 1000;
+        static const quint64 indexWriteInterval = 500;
+
+        QString mDirectory;
+        quint64 mMaxSize = 0;
+        quint64 mSize = 0;
+
+        QHash<QByteArray, Entry> mEntries;
+        // bodies not on disk yet
+        QHash<QByteArray, QByteArray> mPendingWrites;
+
+        quint64 mHits = 0;
+        quint64 mMisses = 0;
+
+        quint64 mNextVersion = 0;
+        quint64 mChangesSinceIndexWrite = 0;
+
+        mutable std::mutex mCacheMutex;
+
+        // single thread, so writes for the same key land in order
+        mutable QThreadPool mWriterPool;
+
+        void writeFile(const QByteArray &key, const QByteArray &data, quint64 version);
+        void scheduleIndexWrite();
+        void writeIndex(const QHash<QByteArray, Entry> &entries) const;
+
+        void removeEntry(const QByteArray &key);
+        void evict();
+        void logStats() const;
+
+        QString getFilePath(const QByteArray &key) const;
+        QString getIndexPath() const;
+    };
+}
@@ -66,23 +66,47 @@ namespace Evernus
         QSettings settings;
         const auto importCitadels = settings.value(OrderSettings::importFromCitadelsKey, OrderSettings::importFromCitadelsDefault).toBool();
 
+        const auto clearCount = mDataProvider.getExternalOrderClearCount();
+        if (clearCount != mImportedClearCount)
+        {
+            mImportedTypes.clear();
+            mImportedClearCount = clearCount;
+        }
+
         for (const auto region : regions)
         {
+            CitadelRepository::EntityList citadels;
+            if (importCitadels)
+            {
+                citadels = mDataProvider.getCitadelsForRegion(region);
+                citadels.erase(std::remove_if(std::begin(citadels), std::end(citadels), [](const auto &citadel) {
+                    Q_ASSERT(citadel);
+                    return !citadel->canImportMarket();
+                }), std::end(citadels));
+            }
+
             mManager.fetchMarketOrders(region, [=](auto &&orders, const auto &error, const auto &expires) {
                 Q_UNUSED(expires);
+
+                if (error.isEmpty() && !orders.empty())
+                {
+                    auto &types = mImportedTypes[region];
+                    types.clear();
+
+                    for (const auto &pair : mCurrentTarget)
+                    {
+                        if (pair.second == region)
+                            types.insert(pair.first);
+                    }
+                }
+
                 processResult(std::move(orders), error);
-            });
+            }, canSkipUnchanged(region, !citadels.empty()));
 
             if (importCitadels)
             {
-                const auto citadels = mDataProvider.getCitadelsForRegion(region);
                 for (const auto &citadel : citadels)
                 {
-                    Q_ASSERT(citadel);
-
-                    if (!citadel->canImportMarket())
-                        continue;
-
                     mCounter.incCount();
                     mManager.fetchCitadelMarketOrders(citadel->getId(), region, id, [=](auto &&orders, const auto &error, const auto &expires) {
                         Q_UNUSED(expires);
@@ -105,6 +129,21 @@ namespace Evernus
         }
     }
 
+    bool ESIWholeExternalOrderImporter::canSkipUnchanged(uint regionId, bool hasCitadels) const
+    {
+        // citadel orders share the type/region scope when stored, so leaving out the station ones would remove them
+        if (hasCitadels)
+            return false;
+
+        const auto types = mImportedTypes.find(regionId);
+        if (types == std::end(mImportedTypes))
+            return false;
+
+        return std::all_of(std::begin(mCurrentTarget), std::end(mCurrentTarget), [&](const auto &pair) {
+            return pair.second != regionId || types->second.find(pair.first) != std::end(types->second);
+        });
+    }
+
     void ESIWholeExternalOrderImporter::filterOrders(std::vector<ExternalOrder> &orders) const
     {
         orders.erase(std::remove_if(std::begin(orders), std::end(orders), [=](const auto &order) {
@@ -14,7 +14,11 @@
  */
 #pragma once
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "ESIExternalOrderImporter.h"
+#include "EveType.h"
 
 namespace Evernus
 {
@@ -34,6 +38,12 @@ namespace Evernus
 
         mutable TypeLocationPairs mCurrentTarget;
 
+        // types handed over from the last full fetch of each region - unchanged regions don't need to be stored again
+        mutable std::unordered_map<uint, std::unordered_set<EveType::IdType>> mImportedTypes;
+        mutable uint mImportedClearCount = 0;
+
+        bool canSkipUnchanged(uint regionId, bool hasCitadels) const;
+
         virtual void filterOrders(std::vector<ExternalOrder> &orders) const override;
     };
 }
@@ -29,6 +29,8 @@
 #include "MetaGroup.h"
 #include "EveType.h"
 
+class QRegExp;
+
 namespace Evernus
 {
     class ExternalOrder;
@@ -89,6 +91,8 @@ namespace Evernus
         virtual QString getTypeMetaGroupName(EveType::IdType id) const = 0;
         virtual QString getGenericName(quint64 id) const = 0;
         virtual bool hasGenericName(quint64 id) const = 0;
+        // only names which are already known are searched
+        virtual std::vector<quint64> findGenericNameIds(const QRegExp &filter) const = 0;
 
         virtual double getTypeVolume(EveType::IdType id) const = 0;
         virtual std::shared_ptr<ExternalOrder> getTypeStationSellPrice(EveType::IdType id, quint64 stationId) const = 0;
@@ -98,8 +102,11 @@ namespace Evernus
         virtual void updateExternalOrders(const std::vector<ExternalOrder> &orders) = 0;
         virtual void clearExternalOrders() = 0;
         virtual void clearExternalOrdersForType(EveType::IdType id) = 0;
+        // changes every time orders are removed by the user, so importers know what they stored before is gone
+        virtual uint getExternalOrderClearCount() const = 0;
 
         virtual QString getLocationName(quint64 id) const = 0;
+        virtual std::vector<quint64> findLocationIds(const QRegExp &filter) const = 0;
         virtual QString getRegionName(uint id) const = 0;
         virtual QString getSolarSystemName(uint id) const = 0;
 
@@ -13,8 +13,6 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdexcept>
-#include <sstream>
-#include <thread>
 
 #include <boost/throw_exception.hpp>
 
@@ -25,38 +23,61 @@
 
 #include <QtDebug>
 
+#include "ThreadDatabaseConnection.h"
+
 #include "EveDatabaseConnectionProvider.h"
 
 namespace Evernus
 {
+    namespace
+    {
+        thread_local ThreadDatabaseConnection threadConnection;
+    }
+
     QSqlDatabase EveDatabaseConnectionProvider::getConnection() const
     {
-        std::ostringstream tid;
-        tid << std::this_thread::get_id();
+        if (Q_LIKELY(threadConnection.isOpen()))
+            return threadConnection.getDatabase();
 
-        const auto connName = QStringLiteral("eve-%1").arg(QString::fromStdString(tid.str()));
+        auto eveDbPath = getDatabasePath();
+        qDebug() << "Eve DB path:" << eveDbPath;
 
-        auto db = QSqlDatabase::database(connName, false);
-        if (!db.isValid())
-        {
-            db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        if (!QFile::exists(eveDbPath))
+            BOOST_THROW_EXCEPTION(std::runtime_error{"Cannot find Eve DB!"});
 
-            auto eveDbPath = getDatabasePath();
-            qDebug() << "Eve DB path:" << eveDbPath;
+        const auto connName = ThreadDatabaseConnection::getUniqueConnectionName(QStringLiteral("eve"));
 
-            if (!QFile::exists(eveDbPath))
-                BOOST_THROW_EXCEPTION(std::runtime_error{"Cannot find Eve DB!"});
+        auto db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        db.setDatabaseName(eveDbPath);
+        db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
 
-            db.setDatabaseName(eveDbPath);
-            db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+        if (!db.open())
+        {
+            db = QSqlDatabase{};
+            QSqlDatabase::removeDatabase(connName);
 
-            if (!db.open())
-                BOOST_THROW_EXCEPTION(std::runtime_error{QCoreApplication::translate("MainDatabaseConnectionProvider", "Error opening DB!").toStdString()});
+            BOOST_THROW_EXCEPTION(std::runtime_error{QCoreApplication::translate("MainDatabaseConnectionProvider", "Error opening DB!").toStdString()});
         }
 
+        threadConnection.setDatabase(db);
         return db;
     }
 
+    QSqlDatabase EveDatabaseConnectionProvider::getReadOnlyConnection() const
+    {
+        return getConnection();
+    }
+
+    DatabaseConnectionProvider::StatementCache &EveDatabaseConnectionProvider::getStatementCache() const
+    {
+        return threadConnection.getStatementCache();
+    }
+
+    DatabaseConnectionProvider::StatementCache &EveDatabaseConnectionProvider::getReadOnlyStatementCache() const
+    {
+        return getStatementCache();
+    }
+
     QString EveDatabaseConnectionProvider::getDatabasePath()
     {
         return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/resources/eve.db";
@@ -28,6 +28,10 @@ namespace Evernus
         virtual ~EveDatabaseConnectionProvider() = default;
 
         virtual QSqlDatabase getConnection() const override;
+        virtual QSqlDatabase getReadOnlyConnection() const override;
+
+        virtual StatementCache &getStatementCache() const override;
+        virtual StatementCache &getReadOnlyStatementCache() const override;
 
         EveDatabaseConnectionProvider &operator =(const EveDatabaseConnectionProvider &) = default;
         EveDatabaseConnectionProvider &operator =(EveDatabaseConnectionProvider &&) = default;
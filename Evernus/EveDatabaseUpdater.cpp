@@ -16,16 +16,21 @@
 #include <QDesktopWidget>
 #include <QNetworkReply>
 #include <QJsonDocument>
+#include <QElapsedTimer>
 #include <QApplication>
+#include <QSqlDatabase>
 #include <QJsonObject>
 #include <QMessageBox>
+#include <QSqlError>
 #include <QSettings>
 #include <QFile>
 
 #include <QtDebug>
 
 #include "EveDatabaseConnectionProvider.h"
+#include "CachingEveDataProvider.h"
 #include "UpdaterSettings.h"
+#include "StaticDataPack.h"
 #include "ReplyTimeout.h"
 #include "FileDownload.h"
 
@@ -95,6 +100,8 @@ namespace Evernus
                 QSettings settings;
                 settings.setValue(UpdaterSettings::sdeVersionKey, latestVersion);
 
+                compileStaticData(latestVersion);
+
                 QCoreApplication::exit();
             }
         });
@@ -133,4 +140,39 @@ namespace Evernus
         else
             QCoreApplication::exit();
     }
+
+    void EveDatabaseUpdater::compileStaticData(const QString &sdeVersion)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto connectionName = QStringLiteral("sde-compile");
+
+        {
+            auto db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+            db.setDatabaseName(EveDatabaseConnectionProvider::getDatabasePath());
+            db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+
+            if (db.open())
+            {
+                StaticDataPack pack;
+                pack.build(db);
+
+                const auto cacheDir = CachingEveDataProvider::getCacheDir();
+                const auto fileName = cacheDir.filePath(CachingEveDataProvider::staticDataCacheFileName);
+
+                if (!cacheDir.mkpath(QStringLiteral(".")) || !pack.save(fileName, CachingEveDataProvider::getStaticDataVersion(sdeVersion)))
+                    qWarning() << "Error saving static data pack:" << fileName;
+                else
+                    qDebug() << "Compiled static data pack in" << timer.elapsed() << "ms.";
+            }
+            else
+            {
+                // not fatal - the application will compile it on start
+                qWarning() << "Error opening Eve DB to compile static data:" << db.lastError().text();
+            }
+        }
+
+        QSqlDatabase::removeDatabase(connectionName);
+    }
 }
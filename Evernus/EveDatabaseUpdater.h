@@ -54,5 +54,7 @@ namespace Evernus
 
         void doUpdate(const QString &latestVersion);
         void checkUpdate(QNetworkReply &reply);
+
+        static void compileStaticData(const QString &sdeVersion);
     };
 }
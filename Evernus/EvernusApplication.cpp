@@ -15,6 +15,7 @@
 #include <unordered_set>
 #include <stdexcept>
 #include <algorithm>
+#include <optional>
 #include <future>
 
 #include <boost/range/algorithm/transform.hpp>
@@ -48,6 +49,7 @@
 #include "StandardExceptionQtWrapperException.h"
 #include "ExternalOrderImporterNames.h"
 #include "LanguageSelectDialog.h"
+#include "AssetValueCalculator.h"
 #include "SovereigntyStructure.h"
 #include "StatisticsSettings.h"
 #include "UpdaterSettings.h"
@@ -122,6 +124,8 @@ namespace Evernus
 
         setProxySettings();
 
+        mShareItemCosts = settings.value(PriceSettings::shareCostsKey, PriceSettings::shareCostsDefault).toBool();
+
 #ifdef EVERNUS_DROPBOX_ENABLED
         if (settings.value(SyncSettings::enabledOnStartupKey, SyncSettings::enabledOnStartupDefault).toBool())
         {
@@ -164,11 +168,9 @@ namespace Evernus
         mCorpContractProvider = std::make_unique<CachingContractProvider>(*mCorpContractRepository);
 
         mDataProvider = std::make_unique<CachingEveDataProvider>(*mEveTypeRepository,
-                                                                 *mMetaGroupRepository,
                                                                  *mExternalOrderRepository,
                                                                  *mMarketOrderRepository,
                                                                  *mCorpMarketOrderRepository,
-                                                                 *mMarketGroupRepository,
                                                                  *mCitadelRepository,
                                                                  *this,
                                                                  mEveDatabaseConnectionProvider);
@@ -182,9 +184,15 @@ namespace Evernus
         precacheCacheTimers();
         precacheUpdateTimers();
 
+        showSplashMessage(tr("Precaching static data..."), splash);
+        mDataProvider->precacheStaticData();
+
         showSplashMessage(tr("Precaching jump map..."), splash);
         mDataProvider->precacheJumpMap();
 
+        showSplashMessage(tr("Precaching industry data..."), splash);
+        mDataProvider->precacheIndustryData();
+
         showSplashMessage(tr("Clearing old wallet entries..."), splash);
         deleteOldWalletEntries();
 
@@ -201,6 +209,15 @@ namespace Evernus
                                            &mHttpSessionManager,
                                            this};
 
+        // rendered pages are cached until anything they show changes
+        connect(mCharacterOrderProvider.get(), &CachingMarketOrderProvider::orderChanged, httpService, &HttpService::clearCache);
+        connect(mCorpOrderProvider.get(), &CachingMarketOrderProvider::orderChanged, httpService, &HttpService::clearCache);
+        connect(this, &EvernusApplication::characterMarketOrdersChanged, httpService, &HttpService::clearCache);
+        connect(this, &EvernusApplication::corpMarketOrdersChanged, httpService, &HttpService::clearCache);
+        connect(this, &EvernusApplication::externalOrdersChanged, httpService, &HttpService::clearCache);
+        connect(this, &EvernusApplication::itemCostsChanged, httpService, &HttpService::clearCache);
+        connect(this, &EvernusApplication::charactersChanged, httpService, &HttpService::clearCache);
+
         mHttpSessionManager.setPort(settings.value(HttpSettings::portKey, HttpSettings::portDefault).value<quint16>());
         mHttpSessionManager.setStaticContentService(httpService);
         mHttpSessionManager.setConnector(QxtHttpSessionManager::HttpServer);
@@ -257,6 +274,7 @@ namespace Evernus
         connect(importer.get(), &ExternalOrderImporter::statusChanged, this, &EvernusApplication::showPriceImportStatus, Qt::QueuedConnection);
         connect(importer.get(), &ExternalOrderImporter::genericError, this, &EvernusApplication::ssoError, Qt::QueuedConnection);
         connect(importer.get(), &ExternalOrderImporter::externalOrdersChanged, this, &EvernusApplication::finishExternalOrderImport, Qt::QueuedConnection);
+        connect(importer.get(), &ExternalOrderImporter::externalOrdersUpdated, this, &EvernusApplication::updateExternalOrdersAndAssetValue, Qt::QueuedConnection);
         mExternalOrderImporters.emplace(name, std::move(importer));
     }
 
@@ -300,47 +318,11 @@ namespace Evernus
 
     std::shared_ptr<ItemCost> EvernusApplication::fetchForCharacterAndType(Character::IdType characterId, EveType::IdType typeId) const
     {
-        const auto it = mCharacterItemCostCache.find(std::make_pair(characterId, typeId));
-        if (it != std::end(mCharacterItemCostCache))
-            return it->second;
-
-        ItemCostRepository::EntityPtr cost;
-
-        try
-        {
-            cost = mItemCostRepository->fetchForCharacterAndType(characterId, typeId);
-        }
-        catch (const ItemCostRepository::NotFoundException &)
-        {
-            QSettings settings;
-            if (settings.value(PriceSettings::shareCostsKey, PriceSettings::shareCostsDefault).toBool())
-            {
-                const auto it = mTypeItemCostCache.find(typeId);
-                if (it != std::end(mTypeItemCostCache))
-                {
-                    mCharacterItemCostCache.emplace(std::make_pair(characterId, typeId), it->second);
-                    return it->second;
-                }
-
-                try
-                {
-                    cost = mItemCostRepository->fetchLatestForType(typeId);
-                }
-                catch (const ItemCostRepository::NotFoundException &)
-                {
-                    cost = std::make_shared<ItemCost>();
-                }
-
-                mTypeItemCostCache.emplace(typeId, cost);
-            }
-            else
-            {
-                cost = std::make_shared<ItemCost>();
-            }
-        }
+        auto cost = mItemCostIndex->find(characterId, typeId);
+        if (!cost && mShareItemCosts)
+            cost = mItemCostIndex->findShared(typeId);
 
-        mCharacterItemCostCache.emplace(std::make_pair(characterId, typeId), cost);
-        return cost;
+        return (cost) ? (cost) : (std::make_shared<ItemCost>());
     }
 
     ItemCostProvider::CostList EvernusApplication::fetchForCharacter(Character::IdType characterId) const
@@ -350,15 +332,28 @@ namespace Evernus
 
     void EvernusApplication::setForCharacterAndType(Character::IdType characterId, EveType::IdType typeId, double value)
     {
-        auto cost = std::make_shared<ItemCost>();
-        cost->setCharacterId(characterId);
-        cost->setTypeId(typeId);
-        cost->setCost(value);
+        setForCharacterAndTypes(characterId, { { typeId, value } });
+    }
 
-        mItemCostRepository->store(*cost);
+    void EvernusApplication::setForCharacterAndTypes(Character::IdType characterId, const std::unordered_map<EveType::IdType, double> &values)
+    {
+        if (values.empty())
+            return;
+
+        CostList costs;
+        costs.reserve(values.size());
 
-        mCharacterItemCostCache[std::make_pair(characterId, typeId)] = cost;
-        mTypeItemCostCache[typeId] = cost;
+        for (const auto &value : values)
+        {
+            auto cost = std::make_shared<ItemCost>();
+            cost->setCharacterId(characterId);
+            cost->setTypeId(value.first);
+            cost->setCost(value.second);
+
+            costs.emplace_back(std::move(cost));
+        }
+
+        persistItemCosts(costs);
 
         if (!mItemCostUpdateScheduled)
         {
@@ -375,8 +370,7 @@ namespace Evernus
     void EvernusApplication::removeItemCost(ItemCost::IdType id) const
     {
         mItemCostRepository->remove(id);
-        mCharacterItemCostCache.clear();
-        mTypeItemCostCache.clear();
+        mItemCostIndex->remove(id);
 
         emit itemCostsChanged();
     }
@@ -385,10 +379,28 @@ namespace Evernus
     {
         mItemCostRepository->store(cost);
 
-        auto sharedCost = std::make_shared<ItemCost>(cost);
+        mItemCostIndex->store(std::make_shared<ItemCost>(cost));
 
-        mCharacterItemCostCache[std::make_pair(cost.getCharacterId(), cost.getTypeId())] = sharedCost;
-        mTypeItemCostCache[cost.getTypeId()] = sharedCost;
+        emit itemCostsChanged();
+    }
+
+    void EvernusApplication::storeItemCosts(std::vector<ItemCost> &costs) const
+    {
+        if (costs.empty())
+            return;
+
+        CostList stored;
+        stored.reserve(costs.size());
+
+        for (const auto &cost : costs)
+            stored.emplace_back(std::make_shared<ItemCost>(cost));
+
+        persistItemCosts(stored);
+
+        // give the caller assigned ids back
+        std::transform(std::begin(stored), std::end(stored), std::begin(costs), [](const auto &cost) {
+            return *cost;
+        });
 
         emit itemCostsChanged();
     }
@@ -396,8 +408,7 @@ namespace Evernus
     void EvernusApplication::removeAllItemCosts(Character::IdType characterId) const
     {
         mItemCostRepository->removeForCharacter(characterId);
-        mCharacterItemCostCache.clear();
-        mTypeItemCostCache.clear();
+        mItemCostIndex->removeForCharacter(characterId);
 
         emit itemCostsChanged();
     }
@@ -552,6 +563,11 @@ namespace Evernus
         return *mMiningLedgerRepository;
     }
 
+    const MarketHistoryRepository &EvernusApplication::getMarketHistoryRepository() const noexcept
+    {
+        return *mMarketHistoryRepository;
+    }
+
     std::vector<std::shared_ptr<LMeveTask>> EvernusApplication::getTasks(Character::IdType characterId) const
     {
         const auto it = mLMeveTaskCache.find(characterId);
@@ -1076,7 +1092,7 @@ namespace Evernus
                         asyncBatchStore(*mCorpWalletSnapshotRepository, std::move(snapshots), false);
                     }
 
-                    asyncBatchStore(*mCorpWalletJournalEntryRepository, std::move(data), true, [=] {
+                    asyncBatchStoreWithRollups(*mCorpWalletJournalEntryRepository, std::move(data), [=] {
                         setUtcCacheTimer(id, TimerType::CorpWalletJournal, expires);
                         saveUpdateTimer(TimerType::CorpWalletJournal, mUpdateTimes[TimerType::CorpWalletJournal], id);
 
@@ -1126,7 +1142,7 @@ namespace Evernus
 
                 if (error.isEmpty())
                 {
-                    asyncBatchStore(*mCorpWalletTransactionRepository, std::move(data), true, [=] {
+                    asyncBatchStoreWithRollups(*mCorpWalletTransactionRepository, std::move(data), [=] {
                         setUtcCacheTimer(id, TimerType::CorpWalletTransactions, expires);
                         saveUpdateTimer(TimerType::CorpWalletTransactions, mUpdateTimes[TimerType::CorpWalletTransactions], id);
 
@@ -1324,9 +1340,12 @@ namespace Evernus
         if (settings.value(HttpSettings::enabledKey, HttpSettings::enabledDefault).toBool())
             mHttpSessionManager.start();
 
-        mCharacterItemCostCache.clear();
+        mShareItemCosts = settings.value(PriceSettings::shareCostsKey, PriceSettings::shareCostsDefault).toBool();
         mDataProvider->handleNewPreferences();
 
+        for (const auto &importer : mExternalOrderImporters)
+            importer.second->handleNewPreferences();
+
         setSmtpSettings();
 
         emit itemCostsChanged();
@@ -1662,6 +1681,7 @@ namespace Evernus
         mMarketOrderRepository.reset(new MarketOrderRepository{false, mMainDatabaseConnectionProvider});
         mCorpMarketOrderRepository.reset(new MarketOrderRepository{true, mMainDatabaseConnectionProvider});
         mItemCostRepository.reset(new ItemCostRepository{mMainDatabaseConnectionProvider});
+        mItemCostIndex = std::make_unique<ItemCostIndex>(*mItemCostRepository);
         mMarketOrderValueSnapshotRepository.reset(new MarketOrderValueSnapshotRepository{mMainDatabaseConnectionProvider});
         mCorpMarketOrderValueSnapshotRepository.reset(new CorpMarketOrderValueSnapshotRepository{mMainDatabaseConnectionProvider});
         mFilterTextRepository.reset(new FilterTextRepository{mMainDatabaseConnectionProvider});
@@ -1681,6 +1701,7 @@ namespace Evernus
         mRegionStationPresetRepository.reset(new RegionStationPresetRepository{mMainDatabaseConnectionProvider});
         mIndustryManufacturingSetupRepository.reset(new IndustryManufacturingSetupRepository{mMainDatabaseConnectionProvider});
         mMiningLedgerRepository.reset(new MiningLedgerRepository{mMainDatabaseConnectionProvider});
+        mMarketHistoryRepository.reset(new MarketHistoryRepository{mMainDatabaseConnectionProvider});
     }
 
     void EvernusApplication::createDbSchema()
@@ -1720,6 +1741,7 @@ namespace Evernus
         mRegionStationPresetRepository->create();
         mIndustryManufacturingSetupRepository->create();
         mMiningLedgerRepository->create(*mCharacterRepository);
+        mMarketHistoryRepository->create();
     }
 
     void EvernusApplication::precacheCacheTimers()
@@ -1975,11 +1997,17 @@ namespace Evernus
 
             const auto curDt = QDateTime::currentDateTimeUtc();
 
+            // earliest last seen this import touches - cached archive before that stays valid
+            auto archivedSince = curDt;
+
             for (auto &order : orders)
             {
                 const auto cIt = curStates.find(order.getId());
                 if (cIt != std::end(curStates))
                 {
+                    if (!cIt->second.mLastSeen.isNull())
+                        archivedSince = std::min(archivedSince, cIt->second.mLastSeen);
+
                     order.setDelta(order.getVolumeRemaining() - cIt->second.mVolumeRemaining);
                     order.setFirstSeen(cIt->second.mFirstSeen);
                     order.setCustomStationId(cIt->second.mCustomStation);
@@ -2017,6 +2045,9 @@ namespace Evernus
                         order.setCustomStationId(defaultCustomStation);
                 }
 
+                if (order.getState() != MarketOrder::State::Active && !order.getLastSeen().isNull())
+                    archivedSince = std::min(archivedSince, order.getLastSeen());
+
                 order.setCorporationId(corpId); // TODO: move up after 0.5
 
                 if (autoSetCosts && order.getType() == MarketOrder::Type::Buy && order.getDelta() != 0 && order.getState() == MarketOrder::State::Fulfilled)
@@ -2034,6 +2065,7 @@ namespace Evernus
                     if (order.second.mExpiry < curDt)
                     {
                         toArchive.emplace_back(order.first);
+                        archivedSince = std::min(archivedSince, order.second.mExpiry);
                     }
                     else
                     {
@@ -2048,6 +2080,11 @@ namespace Evernus
             if (!toFulfill.empty())
                 orderRepo.fulfill(toFulfill);
 
+            if (corp)
+                mCorpOrderProvider->invalidateArchived(id, corpId, archivedSince);
+            else
+                mCharacterOrderProvider->invalidateArchived(id, corpId, archivedSince);
+
             auto future = asyncBatchStore(orderRepo, orders, true);
 
             if (!corp)
@@ -2173,35 +2210,36 @@ namespace Evernus
          emit taskEnded(task, info);
     }
 
-    void EvernusApplication::computeAssetListSellValueSnapshot(const AssetList &list) const
+    void EvernusApplication::computeAssetListSellValueSnapshot(const AssetList &list)
     {
-        try
-        {
+        const auto characterId = list.getCharacterId();
+        computeAssetListSellValue(list, [=](auto value) {
             AssetValueSnapshot snapshot;
             snapshot.setTimestamp(QDateTime::currentDateTimeUtc());
-            snapshot.setBalance(getTotalAssetListValue(list));
-            snapshot.setCharacterId(list.getCharacterId());
+            snapshot.setBalance(value);
+            snapshot.setCharacterId(characterId);
 
             mAssetValueSnapshotRepository->store(snapshot);
-        }
-        catch (const ExternalOrderRepository::NotFoundException &)
-        {
-        }
+
+            emit snapshotsTaken();
+        });
     }
 
-    void EvernusApplication::computeCorpAssetListSellValueSnapshot(const AssetList &list) const
+    void EvernusApplication::computeCorpAssetListSellValueSnapshot(const AssetList &list)
     {
         try
         {
-            CorpAssetValueSnapshot snapshot;
-            snapshot.setTimestamp(QDateTime::currentDateTimeUtc());
-            snapshot.setBalance(getTotalAssetListValue(list));
-            snapshot.setCorporationId(mCharacterRepository->getCorporationId(list.getCharacterId()));
+            const auto corporationId = mCharacterRepository->getCorporationId(list.getCharacterId());
+            computeAssetListSellValue(list, [=](auto value) {
+                CorpAssetValueSnapshot snapshot;
+                snapshot.setTimestamp(QDateTime::currentDateTimeUtc());
+                snapshot.setBalance(value);
+                snapshot.setCorporationId(corporationId);
 
-            mCorpAssetValueSnapshotRepository->store(snapshot);
-        }
-        catch (const ExternalOrderRepository::NotFoundException &)
-        {
+                mCorpAssetValueSnapshotRepository->store(snapshot);
+
+                emit snapshotsTaken();
+            });
         }
         catch (const CharacterRepository::NotFoundException &)
         {
@@ -2316,7 +2354,7 @@ namespace Evernus
             asyncBatchStore(*mWalletSnapshotRepository, std::move(snapshots), false);
         }
 
-        asyncBatchStore(*mWalletJournalEntryRepository, std::move(data), true, [=] {
+        asyncBatchStoreWithRollups(*mWalletJournalEntryRepository, std::move(data), [=] {
             saveUpdateTimer(TimerType::WalletJournal, mUpdateTimes[TimerType::WalletJournal], id);
 
             emit characterWalletJournalChanged();
@@ -2326,7 +2364,7 @@ namespace Evernus
 
     void EvernusApplication::updateCharacterWalletTransactions(Character::IdType id, WalletTransactions data, uint task)
     {
-        asyncBatchStore(*mWalletTransactionRepository, std::move(data), true, [=] {
+        asyncBatchStoreWithRollups(*mWalletTransactionRepository, std::move(data), [=] {
             saveUpdateTimer(TimerType::WalletTransactions, mUpdateTimes[TimerType::WalletTransactions], id);
 
             QSettings settings;
@@ -2349,48 +2387,6 @@ namespace Evernus
         });
     }
 
-    double EvernusApplication::getTotalAssetListValue(const AssetList &list) const
-    {
-        QSettings settings;
-        const auto customLocationId = (settings.value(ImportSettings::useCustomAssetStationKey, ImportSettings::useCustomAssetStationDefault).toBool()) ?
-                                      (EveDataProvider::getStationIdFromPath(settings.value(ImportSettings::customAssetStationKey).toList())) :
-                                      (0);
-
-        auto value = 0.;
-        for (const auto &item : list)
-        {
-            const auto locationId = (customLocationId != 0) ? (customLocationId) : (item->getLocationId());
-            if (!locationId)
-                continue;
-
-            value += getTotalItemSellValue(*item, *locationId);
-        }
-
-        return value;
-    }
-
-    double EvernusApplication::getTotalItemSellValue(const Item &item, quint64 locationId) const
-    {
-        // return 0 for BPC
-        if (item.isBPC())
-            return 0.;
-
-        const auto customValue = item.getCustomValue();
-        if (customValue)
-            return *customValue;
-
-        QSettings settings;
-        const auto throwOnUnavailable
-            = settings.value(ImportSettings::updateOnlyFullAssetValueKey, ImportSettings::updateOnlyFullAssetValueDefault).toBool();
-
-        auto price
-            = mDataProvider->getTypeSellPrice(item.getTypeId(), locationId, !throwOnUnavailable)->getPrice() * item.getQuantity();
-        for (const auto &child : item)
-            price += getTotalItemSellValue(*child, locationId);
-
-        return price;
-    }
-
     void EvernusApplication::saveUpdateTimer(TimerType timer, CharacterTimerMap &map, Character::IdType characterId) const
     {
         const auto time = QDateTime::currentDateTimeUtc();
@@ -2442,11 +2438,35 @@ namespace Evernus
         }
 
 
+        std::unordered_map<EveType::IdType, double> values;
         for (const auto &cost : newItemCosts)
         {
             if (cost.second.mQuantity > 0)
-                setForCharacterAndType(characterId, cost.first, cost.second.mPrice / cost.second.mQuantity);
+                values.emplace(cost.first, cost.second.mPrice / cost.second.mQuantity);
+        }
+
+        setForCharacterAndTypes(characterId, values);
+    }
+
+    void EvernusApplication::persistItemCosts(const CostList &costs) const
+    {
+        auto db = mItemCostRepository->getDatabase();
+        db.transaction();
+
+        try
+        {
+            for (const auto &cost : costs)
+                mItemCostRepository->store(*cost);
+        }
+        catch (...)
+        {
+            db.rollback();
+            throw;
         }
+
+        db.commit();
+
+        mItemCostIndex->store(costs);
     }
 
     void EvernusApplication::setSmtpSettings()
@@ -2625,14 +2645,81 @@ namespace Evernus
     template<class T, class Data, class Callback>
     void EvernusApplication::asyncBatchStore(const T &repo, Data data, bool hasId, Callback callback)
     {
-        auto watcher = new QFutureWatcher<void>{this};
-        connect(watcher, &QFutureWatcher<void>::finished, this, callback);
-        connect(watcher, &QFutureWatcher<void>::finished, watcher, &QFutureWatcher<void>::deleteLater);
-        connect(watcher, &QFutureWatcher<void>::canceled, this, [=] {
+        watchAsync(asyncBatchStore(repo, std::move(data), hasId), callback);
+    }
+
+    template<class T, class Data, class Callback>
+    void EvernusApplication::asyncBatchStoreWithRollups(const T &repo, Data data, Callback callback)
+    {
+        watchAsync(asyncExecute([&repo, data = std::move(data)] {
+            // rollups must never see entries which didn't make it
+            auto db = repo.getDatabase();
+            db.transaction();
+
+            try
+            {
+                repo.batchStore(data, true, false);
+                repo.updateDailyRollups(data, false);
+            }
+            catch (...)
+            {
+                db.rollback();
+                throw;
+            }
+
+            db.commit();
+        }), callback);
+    }
+
+    template<class Callback>
+    void EvernusApplication::computeAssetListSellValue(const AssetList &list, Callback callback)
+    {
+        QSettings settings;
+        const auto customLocationId = (settings.value(ImportSettings::useCustomAssetStationKey, ImportSettings::useCustomAssetStationDefault).toBool()) ?
+                                      (EveDataProvider::getStationIdFromPath(settings.value(ImportSettings::customAssetStationKey).toList())) :
+                                      (0);
+        const auto allowMissingPrices
+            = !settings.value(ImportSettings::updateOnlyFullAssetValueKey, ImportSettings::updateOnlyFullAssetValueDefault).toBool();
+
+        // the list can change before the valuation runs, so take what we need now; prices are resolved in the background
+        auto entries = AssetValueCalculator::flatten(list, customLocationId);
+        const AssetValueCalculator calculator{*mDataProvider};
+
+        using Watcher = QFutureWatcher<std::optional<double>>;
+
+        auto watcher = new Watcher{this};
+        connect(watcher, &Watcher::finished, this, [=] {
+            if (!watcher->isCanceled())
+            {
+                const auto value = watcher->result();
+                if (value)
+                    callback(*value);
+            }
+        });
+        connect(watcher, &Watcher::finished, watcher, &Watcher::deleteLater);
+        connect(watcher, &Watcher::canceled, this, [=] {
             watcher->waitForFinished(); // rethrow exception, if present
         });
 
-        watcher->setFuture(asyncBatchStore(repo, std::move(data), hasId));
+        watcher->setFuture(QtConcurrent::run([=, entries = std::move(entries)]() -> std::optional<double> {
+            try
+            {
+                const auto result = calculator.calculate(entries, allowMissingPrices);
+                if (!allowMissingPrices && !result.mComplete)
+                    return std::nullopt;
+
+                return result.mTotalValue;
+            }
+            catch (const ExternalOrderRepository::NotFoundException &)
+            {
+                // not all prices are available and only full values are wanted
+                return std::nullopt;
+            }
+            catch (...)
+            {
+                throw StandardExceptionQtWrapperException{std::current_exception()};
+            }
+        }));
     }
 
     template<class Func>
@@ -2652,6 +2739,19 @@ namespace Evernus
         });
     }
 
+    template<class Callback>
+    void EvernusApplication::watchAsync(QFuture<void> future, Callback callback)
+    {
+        auto watcher = new QFutureWatcher<void>{this};
+        connect(watcher, &QFutureWatcher<void>::finished, this, callback);
+        connect(watcher, &QFutureWatcher<void>::finished, watcher, &QFutureWatcher<void>::deleteLater);
+        connect(watcher, &QFutureWatcher<void>::canceled, this, [=] {
+            watcher->waitForFinished(); // rethrow exception, if present
+        });
+
+        watcher->setFuture(future);
+    }
+
     void EvernusApplication::fetchStationTypeIds()
     {
         // get all ids from group 15, and hope it never changes...
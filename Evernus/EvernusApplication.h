@@ -17,6 +17,7 @@
 #include <unordered_set>
 #include <functional>
 #include <memory>
+#include <atomic>
 
 #include <boost/functional/hash.hpp>
 
@@ -43,6 +44,7 @@
 #include "WalletSnapshotRepository.h"
 #include "ExternalOrderRepository.h"
 #include "CachingContractProvider.h"
+#include "MarketHistoryRepository.h"
 #include "EveDataManagerProvider.h"
 #include "FavoriteItemRepository.h"
 #include "CachingEveDataProvider.h"
@@ -72,6 +74,7 @@
 #include "ItemCostProvider.h"
 #include "LMeveAPIManager.h"
 #include "CitadelManager.h"
+#include "ItemCostIndex.h"
 #include "ItemRepository.h"
 #include "TaskConstants.h"
 #include "WalletJournal.h"
@@ -119,10 +122,12 @@ namespace Evernus
         virtual std::shared_ptr<ItemCost> fetchForCharacterAndType(Character::IdType characterId, EveType::IdType typeId) const override;
         virtual CostList fetchForCharacter(Character::IdType characterId) const override;
         virtual void setForCharacterAndType(Character::IdType characterId, EveType::IdType typeId, double value) override;
+        virtual void setForCharacterAndTypes(Character::IdType characterId, const std::unordered_map<EveType::IdType, double> &values) override;
 
         virtual std::shared_ptr<ItemCost> findItemCost(ItemCost::IdType id) const override;
         virtual void removeItemCost(ItemCost::IdType id) const override;
         virtual void storeItemCost(ItemCost &cost) const override;
+        virtual void storeItemCosts(std::vector<ItemCost> &costs) const override;
         virtual void removeAllItemCosts(Character::IdType characterId) const override;
 
         virtual const CharacterRepository &getCharacterRepository() const noexcept override;
@@ -155,6 +160,7 @@ namespace Evernus
         virtual const RegionStationPresetRepository &getRegionStationPresetRepository() const noexcept override;
         virtual const IndustryManufacturingSetupRepository &getIndustryManufacturingSetupRepository() const noexcept override;
         virtual const MiningLedgerRepository &getMiningLedgerRepository() const noexcept override;
+        virtual const MarketHistoryRepository &getMarketHistoryRepository() const noexcept override;
 
         virtual std::vector<std::shared_ptr<LMeveTask>> getTasks(Character::IdType characterId) const override;
 
@@ -272,7 +278,6 @@ namespace Evernus
         void showMailError(int mailID, int errorCode, const QByteArray &message);
 
     private:
-        using CharacterTypePair = std::pair<Character::IdType, EveType::IdType>;
         using CharacterTimerMap = std::unordered_map<Character::IdType, QDateTime>;
         using TypedCharacterTimerMap = std::unordered_map<TimerType, CharacterTimerMap>;
         using TransactionFetcher = std::function<WalletTransactionRepository::EntityList (const QDateTime &, const QDateTime &, EveType::IdType)>;
@@ -311,6 +316,7 @@ namespace Evernus
         std::unique_ptr<RegionStationPresetRepository> mRegionStationPresetRepository;
         std::unique_ptr<IndustryManufacturingSetupRepository> mIndustryManufacturingSetupRepository;
         std::unique_ptr<MiningLedgerRepository> mMiningLedgerRepository;
+        std::unique_ptr<MarketHistoryRepository> mMarketHistoryRepository;
 
         std::unique_ptr<ESIInterfaceManager> mESIInterfaceManager;
 
@@ -340,9 +346,8 @@ namespace Evernus
 
         std::unique_ptr<CachingContractProvider> mCharacterContractProvider, mCorpContractProvider;
 
-        mutable std::unordered_map<CharacterTypePair, ItemCostRepository::EntityPtr, boost::hash<CharacterTypePair>>
-        mCharacterItemCostCache;
-        mutable std::unordered_map<EveType::IdType, ItemCostRepository::EntityPtr> mTypeItemCostCache;
+        std::unique_ptr<ItemCostIndex> mItemCostIndex;
+        std::atomic_bool mShareItemCosts{false};
 
         QTranslator mTranslator, mQtTranslator, mQtBaseTranslator, mQtScriptTranslator;
 
@@ -381,23 +386,23 @@ namespace Evernus
 
         void finishExternalOrderImportTask(const QString &info);
 
-        void computeAssetListSellValueSnapshot(const AssetList &list) const;
-        void computeCorpAssetListSellValueSnapshot(const AssetList &list) const;
+        void computeAssetListSellValueSnapshot(const AssetList &list);
+        void computeCorpAssetListSellValueSnapshot(const AssetList &list);
 
         void updateCharacterAssets(Character::IdType id, AssetList &list);
         void updateCharacter(Character &character);
         void updateCharacterWalletJournal(Character::IdType id, WalletJournal data, uint task);
         void updateCharacterWalletTransactions(Character::IdType id, WalletTransactions data, uint task);
 
-        double getTotalAssetListValue(const AssetList &list) const;
-        double getTotalItemSellValue(const Item &item, quint64 locationId) const;
-
         void saveUpdateTimer(TimerType timer, CharacterTimerMap &map, Character::IdType characterId) const;
 
         void computeAutoCosts(Character::IdType characterId,
                               const MarketOrderProvider::OrderList &orders,
                               const TransactionFetcher &transFetcher);
 
+        // one transaction and one index update for all
+        void persistItemCosts(const CostList &costs) const;
+
         void setSmtpSettings();
 
         void createWalletSnapshot(Character::IdType characterId, double balance);
@@ -420,9 +425,17 @@ namespace Evernus
         QFuture<void> asyncBatchStore(const T &repo, Data data, bool hasId);
         template<class T, class Data, class Callback>
         void asyncBatchStore(const T &repo, Data data, bool hasId, Callback callback);
+        // wallet entries go along with the daily rollups they touch
+        template<class T, class Data, class Callback>
+        void asyncBatchStoreWithRollups(const T &repo, Data data, Callback callback);
 
         template<class Func>
         QFuture<void> asyncExecute(Func func);
+        template<class Callback>
+        void watchAsync(QFuture<void> future, Callback callback);
+
+        template<class Callback>
+        void computeAssetListSellValue(const AssetList &list, Callback callback);
 
         void fetchStationTypeIds();
 
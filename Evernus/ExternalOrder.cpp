@@ -16,6 +16,69 @@
 
 namespace Evernus
 {
+    namespace
+    {
+        inline const QString &toString(const QString &value)
+        {
+            return value;
+        }
+
+        inline QString toString(const QStringRef &value)
+        {
+            return value.toString();
+        }
+
+        template<class T>
+        ExternalOrder parseLogValues(const T &values)
+        {
+            const auto eveDateFormat = "yyyy-MM-dd HH:mm:ss.zzz";
+
+            const auto priceColumn = 0;
+            const auto volRemainingColumn = 1;
+            const auto typeColumn = 2;
+            const auto rangeColumn = 3;
+            const auto idColumn = 4;
+            const auto volEnteredColumn = 5;
+            const auto minVolColumn = 6;
+            const auto bidColumn = 7;
+            const auto issuedColumn = 8;
+            const auto durationColumn = 9;
+            const auto stationColumn = 10;
+            const auto regionColumn = 11;
+            const auto systemColumn = 12;
+
+            ExternalOrder order{values[idColumn].toULongLong()};
+            order.setStationId(values[stationColumn].toULongLong());
+            order.setSolarSystemId(values[systemColumn].toUInt());
+            order.setRegionId(values[regionColumn].toUInt());
+            order.setRange(values[rangeColumn].toShort());
+            order.setType((values[bidColumn] == QLatin1String{"True"}) ? (ExternalOrder::Type::Buy) : (ExternalOrder::Type::Sell));
+            order.setTypeId(values[typeColumn].toULongLong());
+            order.setPrice(values[priceColumn].toDouble());
+            order.setVolumeEntered(values[volEnteredColumn].toUInt());
+            order.setVolumeRemaining(values[volRemainingColumn].toDouble());
+            order.setMinVolume(values[minVolColumn].toUInt());
+            order.setDuration(values[durationColumn].toShort());
+
+            auto dt = QDateTime::fromString(toString(values[issuedColumn]), eveDateFormat);
+            if (!dt.isValid())
+            {
+                const auto altEveDateFormat = "yyyy-MM-dd";
+                dt = QDateTime::fromString(toString(values[issuedColumn]), altEveDateFormat);
+                if (!dt.isValid())
+                {
+                    // thank CCP
+                    dt = QDateTime::currentDateTimeUtc();
+                }
+            }
+            dt.setTimeSpec(Qt::UTC);
+
+            order.setIssued(dt);
+
+            return order;
+        }
+    }
+
     ExternalOrder::Type ExternalOrder::getType() const noexcept
     {
         return mType;
@@ -147,51 +210,12 @@ namespace Evernus
 
     ExternalOrder ExternalOrder::parseLogLine(const QStringList &values)
     {
-        const auto eveDateFormat = "yyyy-MM-dd HH:mm:ss.zzz";
-
-        const auto priceColumn = 0;
-        const auto volRemainingColumn = 1;
-        const auto typeColumn = 2;
-        const auto rangeColumn = 3;
-        const auto idColumn = 4;
-        const auto volEnteredColumn = 5;
-        const auto minVolColumn = 6;
-        const auto bidColumn = 7;
-        const auto issuedColumn = 8;
-        const auto durationColumn = 9;
-        const auto stationColumn = 10;
-        const auto regionColumn = 11;
-        const auto systemColumn = 12;
-
-        ExternalOrder order{values[idColumn].toULongLong()};
-        order.setStationId(values[stationColumn].toULongLong());
-        order.setSolarSystemId(values[systemColumn].toUInt());
-        order.setRegionId(values[regionColumn].toUInt());
-        order.setRange(values[rangeColumn].toShort());
-        order.setType((values[bidColumn] == "True") ? (ExternalOrder::Type::Buy) : (ExternalOrder::Type::Sell));
-        order.setTypeId(values[typeColumn].toULongLong());
-        order.setPrice(values[priceColumn].toDouble());
-        order.setVolumeEntered(values[volEnteredColumn].toUInt());
-        order.setVolumeRemaining(values[volRemainingColumn].toDouble());
-        order.setMinVolume(values[minVolColumn].toUInt());
-        order.setDuration(values[durationColumn].toShort());
-
-        auto dt = QDateTime::fromString(values[issuedColumn], eveDateFormat);
-        if (!dt.isValid())
-        {
-            const auto altEveDateFormat = "yyyy-MM-dd";
-            dt = QDateTime::fromString(values[issuedColumn], altEveDateFormat);
-            if (!dt.isValid())
-            {
-                // thank CCP
-                dt = QDateTime::currentDateTimeUtc();
-            }
-        }
-        dt.setTimeSpec(Qt::UTC);
-
-        order.setIssued(dt);
+        return parseLogValues(values);
+    }
 
-        return order;
+    ExternalOrder ExternalOrder::parseLogLine(const QVector<QStringRef> &values)
+    {
+        return parseLogValues(values);
     }
 
     std::shared_ptr<ExternalOrder> ExternalOrder::nullOrder()
@@ -18,6 +18,7 @@
 
 #include <QStringList>
 #include <QDateTime>
+#include <QVector>
 
 #include "PriceType.h"
 #include "ItemData.h"
@@ -102,6 +103,8 @@ namespace Evernus
         ExternalOrder &operator =(ExternalOrder &&) = default;
 
         static ExternalOrder parseLogLine(const QStringList &values);
+        // same as above, but without copying the values out of the line
+        static ExternalOrder parseLogLine(const QVector<QStringRef> &values);
 
         static std::shared_ptr<ExternalOrder> nullOrder();
 
@@ -0,0 +1,267 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+#include <QElapsedTimer>
+#include <QtDebug>
+
+#include "ExternalOrderBook.h"
+
+namespace Evernus
+{
+    ExternalOrderBook::OrderRef::OrderRef(const ExternalOrderBook &book, std::size_t index) noexcept
+        : mBook{&book}
+        , mIndex{index}
+    {
+    }
+
+    const ExternalOrderBook::OrderRef &ExternalOrderBook::OrderRef::get() const noexcept
+    {
+        return *this;
+    }
+
+    ExternalOrder::Type ExternalOrderBook::OrderRef::getType() const noexcept
+    {
+        return mBook->mTypes[mIndex];
+    }
+
+    ExternalOrder::TypeIdType ExternalOrderBook::OrderRef::getTypeId() const noexcept
+    {
+        return mBook->mTypeIds[mIndex];
+    }
+
+    uint ExternalOrderBook::OrderRef::getRegionId() const noexcept
+    {
+        return mBook->mRegionIds[mIndex];
+    }
+
+    uint ExternalOrderBook::OrderRef::getSolarSystemId() const noexcept
+    {
+        return mBook->mSolarSystemIds[mIndex];
+    }
+
+    quint64 ExternalOrderBook::OrderRef::getStationId() const noexcept
+    {
+        return mBook->mStationIds[mIndex];
+    }
+
+    double ExternalOrderBook::OrderRef::getPrice() const noexcept
+    {
+        return mBook->mPrices[mIndex];
+    }
+
+    uint ExternalOrderBook::OrderRef::getVolumeRemaining() const noexcept
+    {
+        return mBook->mVolumes[mIndex];
+    }
+
+    uint ExternalOrderBook::OrderRef::getMinVolume() const noexcept
+    {
+        return mBook->mMinVolumes[mIndex];
+    }
+
+    short ExternalOrderBook::OrderRef::getRange() const noexcept
+    {
+        return mBook->mRanges[mIndex];
+    }
+
+    ExternalOrderBook::Iterator::Iterator(const ExternalOrderBook &book, std::size_t index) noexcept
+        : mCurrent{book, index}
+    {
+    }
+
+    ExternalOrderBook::Iterator::reference ExternalOrderBook::Iterator::operator *() const noexcept
+    {
+        return mCurrent;
+    }
+
+    ExternalOrderBook::Iterator::pointer ExternalOrderBook::Iterator::operator ->() const noexcept
+    {
+        return &mCurrent;
+    }
+
+    ExternalOrderBook::Iterator &ExternalOrderBook::Iterator::operator ++() noexcept
+    {
+        ++mCurrent.mIndex;
+        return *this;
+    }
+
+    ExternalOrderBook::Iterator ExternalOrderBook::Iterator::operator ++(int) noexcept
+    {
+        auto result = *this;
+        ++mCurrent.mIndex;
+        return result;
+    }
+
+    bool ExternalOrderBook::Iterator::operator ==(const Iterator &other) const noexcept
+    {
+        return mCurrent.mIndex == other.mCurrent.mIndex;
+    }
+
+    bool ExternalOrderBook::Iterator::operator !=(const Iterator &other) const noexcept
+    {
+        return mCurrent.mIndex != other.mCurrent.mIndex;
+    }
+
+    ExternalOrderBook::Slice::Slice(const ExternalOrderBook &book, std::size_t begin, std::size_t end) noexcept
+        : mBook{&book}
+        , mBegin{begin}
+        , mEnd{end}
+    {
+    }
+
+    ExternalOrderBook::Iterator ExternalOrderBook::Slice::begin() const noexcept
+    {
+        return Iterator{*mBook, mBegin};
+    }
+
+    ExternalOrderBook::Iterator ExternalOrderBook::Slice::end() const noexcept
+    {
+        return Iterator{*mBook, mEnd};
+    }
+
+    std::size_t ExternalOrderBook::Slice::size() const noexcept
+    {
+        return mEnd - mBegin;
+    }
+
+    bool ExternalOrderBook::Slice::empty() const noexcept
+    {
+        return mBegin == mEnd;
+    }
+
+    ExternalOrderBook::ExternalOrderBook(const std::vector<ExternalOrder> &orders)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        // sort an index instead of the orders themselves - they're heavy to move around
+        std::vector<std::size_t> order(orders.size());
+        std::iota(std::begin(order), std::end(order), 0);
+
+        std::sort(std::begin(order), std::end(order), [&](auto a, auto b) {
+            const auto &left = orders[a];
+            const auto &right = orders[b];
+
+            const auto leftKey = std::make_tuple(left.getTypeId(), getSideIndex(left.getType()), left.getRegionId());
+            const auto rightKey = std::make_tuple(right.getTypeId(), getSideIndex(right.getType()), right.getRegionId());
+
+            if (leftKey != rightKey)
+                return leftKey < rightKey;
+
+            return (left.getType() == ExternalOrder::Type::Buy) ? (left.getPrice() > right.getPrice()) : (left.getPrice() < right.getPrice());
+        });
+
+        const auto size = orders.size();
+
+        mTypeIds.reserve(size);
+        mRegionIds.reserve(size);
+        mSolarSystemIds.reserve(size);
+        mStationIds.reserve(size);
+        mPrices.reserve(size);
+        mVolumes.reserve(size);
+        mMinVolumes.reserve(size);
+        mRanges.reserve(size);
+        mTypes.reserve(size);
+
+        for (const auto index : order)
+        {
+            const auto &source = orders[index];
+            const auto row = mTypeIds.size();
+            const auto typeId = source.getTypeId();
+            const auto side = getSideIndex(source.getType());
+
+            if (row == 0 || mTypeIds.back() != typeId)
+                mUniqueTypeIds.emplace_back(typeId);
+
+            auto &range = mTypeRanges[typeId];
+            if (range.mBegin[side] == range.mEnd[side])
+                range.mBegin[side] = row;
+
+            range.mEnd[side] = row + 1;
+
+            mTypeIds.emplace_back(typeId);
+            mRegionIds.emplace_back(source.getRegionId());
+            mSolarSystemIds.emplace_back(source.getSolarSystemId());
+            mStationIds.emplace_back(source.getStationId());
+            mPrices.emplace_back(source.getPrice());
+            mVolumes.emplace_back(source.getVolumeRemaining());
+            mMinVolumes.emplace_back(source.getMinVolume());
+            mRanges.emplace_back(source.getRange());
+            mTypes.emplace_back(source.getType());
+        }
+
+        mUniqueRegionIds = mRegionIds;
+        std::sort(std::begin(mUniqueRegionIds), std::end(mUniqueRegionIds));
+        mUniqueRegionIds.erase(std::unique(std::begin(mUniqueRegionIds), std::end(mUniqueRegionIds)), std::end(mUniqueRegionIds));
+
+        qDebug() << "Built order book for" << size << "orders," << mUniqueTypeIds.size() << "types in" << timer.elapsed() << "ms.";
+    }
+
+    std::size_t ExternalOrderBook::size() const noexcept
+    {
+        return mTypeIds.size();
+    }
+
+    bool ExternalOrderBook::empty() const noexcept
+    {
+        return mTypeIds.empty();
+    }
+
+    const std::vector<EveType::IdType> &ExternalOrderBook::getTypeIds() const noexcept
+    {
+        return mUniqueTypeIds;
+    }
+
+    const std::vector<uint> &ExternalOrderBook::getRegionIds() const noexcept
+    {
+        return mUniqueRegionIds;
+    }
+
+    ExternalOrderBook::Slice ExternalOrderBook::getOrders(EveType::IdType typeId, ExternalOrder::Type type) const noexcept
+    {
+        const auto range = mTypeRanges.find(typeId);
+        if (range == std::end(mTypeRanges))
+            return Slice{*this, 0, 0};
+
+        const auto side = getSideIndex(type);
+        return Slice{*this, range->second.mBegin[side], range->second.mEnd[side]};
+    }
+
+    ExternalOrderBook::Slice ExternalOrderBook::getOrders(EveType::IdType typeId, ExternalOrder::Type type, uint regionId) const noexcept
+    {
+        const auto range = mTypeRanges.find(typeId);
+        if (range == std::end(mTypeRanges))
+            return Slice{*this, 0, 0};
+
+        const auto side = getSideIndex(type);
+        const auto first = std::next(std::begin(mRegionIds), range->second.mBegin[side]);
+        const auto last = std::next(std::begin(mRegionIds), range->second.mEnd[side]);
+
+        const auto regionRange = std::equal_range(first, last, regionId);
+        return Slice{
+            *this,
+            static_cast<std::size_t>(std::distance(std::begin(mRegionIds), regionRange.first)),
+            static_cast<std::size_t>(std::distance(std::begin(mRegionIds), regionRange.second))
+        };
+    }
+
+    std::size_t ExternalOrderBook::getSideIndex(ExternalOrder::Type type) noexcept
+    {
+        return (type == ExternalOrder::Type::Buy) ? (0) : (1);
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <iterator>
+#include <vector>
+
+#include "ExternalOrder.h"
+#include "EveType.h"
+
+namespace Evernus
+{
+    // columnar, read-only view of a set of external orders, shared by the market analysis models
+    // orders are sorted once by (type, side, region, price) - sell orders from the lowest price,
+    // buy orders from the highest, so every (type, side, region) slice is already in percentile order
+    class ExternalOrderBook final
+    {
+    public:
+        class Iterator;
+
+        // mimics std::reference_wrapper<const ExternalOrder>, so generic order algorithms work on slices
+        class OrderRef final
+        {
+        public:
+            OrderRef(const ExternalOrderBook &book, std::size_t index) noexcept;
+            OrderRef(const OrderRef &) = default;
+            OrderRef(OrderRef &&) = default;
+            ~OrderRef() = default;
+
+            const OrderRef &get() const noexcept;
+
+            ExternalOrder::Type getType() const noexcept;
+            ExternalOrder::TypeIdType getTypeId() const noexcept;
+            uint getRegionId() const noexcept;
+            uint getSolarSystemId() const noexcept;
+            quint64 getStationId() const noexcept;
+            double getPrice() const noexcept;
+            uint getVolumeRemaining() const noexcept;
+            uint getMinVolume() const noexcept;
+            short getRange() const noexcept;
+
+            OrderRef &operator =(const OrderRef &) = default;
+            OrderRef &operator =(OrderRef &&) = default;
+
+        private:
+            friend class ExternalOrderBook::Iterator;
+
+            const ExternalOrderBook *mBook = nullptr;
+            std::size_t mIndex = 0;
+        };
+
+        class Iterator final
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = OrderRef;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const OrderRef *;
+            using reference = const OrderRef &;
+
+            Iterator(const ExternalOrderBook &book, std::size_t index) noexcept;
+
+            reference operator *() const noexcept;
+            pointer operator ->() const noexcept;
+
+            Iterator &operator ++() noexcept;
+            Iterator operator ++(int) noexcept;
+
+            bool operator ==(const Iterator &other) const noexcept;
+            bool operator !=(const Iterator &other) const noexcept;
+
+        private:
+            OrderRef mCurrent;
+        };
+
+        class Slice final
+        {
+        public:
+            Slice(const ExternalOrderBook &book, std::size_t begin, std::size_t end) noexcept;
+
+            Iterator begin() const noexcept;
+            Iterator end() const noexcept;
+
+            std::size_t size() const noexcept;
+            bool empty() const noexcept;
+
+        private:
+            const ExternalOrderBook *mBook = nullptr;
+            std::size_t mBegin = 0, mEnd = 0;
+        };
+
+        ExternalOrderBook() = default;
+        explicit ExternalOrderBook(const std::vector<ExternalOrder> &orders);
+        ExternalOrderBook(const ExternalOrderBook &) = default;
+        ExternalOrderBook(ExternalOrderBook &&) = default;
+        ~ExternalOrderBook() = default;
+
+        std::size_t size() const noexcept;
+        bool empty() const noexcept;
+
+        const std::vector<EveType::IdType> &getTypeIds() const noexcept;
+        const std::vector<uint> &getRegionIds() const noexcept;
+
+        // all orders for given type and side, grouped by region
+        Slice getOrders(EveType::IdType typeId, ExternalOrder::Type type) const noexcept;
+        // orders for given type and side in a region, best price first
+        Slice getOrders(EveType::IdType typeId, ExternalOrder::Type type, uint regionId) const noexcept;
+
+        // calls func(regionId, slice) for every region having orders of given type and side
+        template<class Func>
+        void forEachRegion(EveType::IdType typeId, ExternalOrder::Type type, Func func) const;
+
+        ExternalOrderBook &operator =(const ExternalOrderBook &) = default;
+        ExternalOrderBook &operator =(ExternalOrderBook &&) = default;
+
+    private:
+        struct TypeRange
+        {
+            std::size_t mBegin[2] = { 0, 0 };
+            std::size_t mEnd[2] = { 0, 0 };
+        };
+
+        std::vector<EveType::IdType> mTypeIds;
+        std::vector<uint> mRegionIds;
+        std::vector<uint> mSolarSystemIds;
+        std::vector<quint64> mStationIds;
+        std::vector<double> mPrices;
+        std::vector<uint> mVolumes;
+        std::vector<uint> mMinVolumes;
+        std::vector<short> mRanges;
+        std::vector<ExternalOrder::Type> mTypes;
+
+        std::unordered_map<EveType::IdType, TypeRange> mTypeRanges;
+
+        std::vector<EveType::IdType> mUniqueTypeIds;
+        std::vector<uint> mUniqueRegionIds;
+
+        static std::size_t getSideIndex(ExternalOrder::Type type) noexcept;
+    };
+
+    template<class Func>
+    void ExternalOrderBook::forEachRegion(EveType::IdType typeId, ExternalOrder::Type type, Func func) const
+    {
+        const auto range = mTypeRanges.find(typeId);
+        if (range == std::end(mTypeRanges))
+            return;
+
+        const auto side = getSideIndex(type);
+        const auto end = range->second.mEnd[side];
+
+        auto begin = range->second.mBegin[side];
+        while (begin != end)
+        {
+            const auto regionId = mRegionIds[begin];
+
+            auto regionEnd = begin + 1;
+            while (regionEnd != end && mRegionIds[regionEnd] == regionId)
+                ++regionEnd;
+
+            func(regionId, Slice{*this, begin, regionEnd});
+            begin = regionEnd;
+        }
+    }
+}
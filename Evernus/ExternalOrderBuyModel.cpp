@@ -161,25 +161,27 @@ namespace Evernus
 
     void ExternalOrderBuyModel::reset()
     {
-        beginResetModel();
+        const auto prevMedianPrice = mMedianPrice;
 
         mMinPrice = std::numeric_limits<double>::max();
         mMedianPrice = mTotalPrice = mMaxPrice = mTotalSize = 0.;
         mTotalVolume = 0;
 
+        std::vector<std::shared_ptr<ExternalOrder>> orders;
+
         if (mStationId != 0)
-            mOrders = mOrderRepo.fetchBuyByTypeAndStation(mTypeId, mStationId);
+            orders = mOrderRepo.fetchBuyByTypeAndStation(mTypeId, mStationId);
         else if (mSolarSystemId != 0)
-            mOrders = mOrderRepo.fetchBuyByTypeAndSolarSystem(mTypeId, mSolarSystemId);
+            orders = mOrderRepo.fetchBuyByTypeAndSolarSystem(mTypeId, mSolarSystemId);
         else if (mRegionId != 0)
-            mOrders = mOrderRepo.fetchBuyByTypeAndRegion(mTypeId, mRegionId);
+            orders = mOrderRepo.fetchBuyByTypeAndRegion(mTypeId, mRegionId);
         else
-            mOrders = mOrderRepo.fetchBuyByType(mTypeId);
+            orders = mOrderRepo.fetchBuyByType(mTypeId);
 
         std::vector<double> prices;
-        prices.reserve(mOrders.size());
+        prices.reserve(orders.size());
 
-        for (const auto &order : mOrders)
+        for (const auto &order : orders)
         {
             const auto price = order->getPrice();
             if (price < mMinPrice)
@@ -205,10 +207,7 @@ namespace Evernus
         if (mMinPrice == std::numeric_limits<double>::max())
             mMinPrice = 0.;
 
-        if (mGrouping != Grouping::None)
-            refreshGroupedData();
-
-        endResetModel();
+        updateOrders(std::move(orders), mMedianPrice != prevMedianPrice);
     }
 
     double ExternalOrderBuyModel::getPrice(const QModelIndex &index) const
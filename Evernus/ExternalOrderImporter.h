@@ -36,8 +36,12 @@ namespace Evernus
 
         virtual void fetchExternalOrders(Character::IdType id, const TypeLocationPairs &target) const = 0;
 
+        virtual void handleNewPreferences() {}
+
     signals:
         void externalOrdersChanged(const QString &info, const std::vector<ExternalOrder> &orders) const;
+        // orders which came in outside of fetchExternalOrders(), e.g. from watched sources
+        void externalOrdersUpdated(const std::vector<ExternalOrder> &orders) const;
         void genericError(const QString &info) const;
         void statusChanged(const QString &status) const;
     };
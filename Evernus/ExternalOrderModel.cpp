@@ -12,14 +12,17 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <functional>
+
 #include "EveDataProvider.h"
+#include "ExternalOrder.h"
 
 #include "ExternalOrderModel.h"
 
 namespace Evernus
 {
     ExternalOrderModel::ExternalOrderModel(const EveDataProvider &dataProvider, QObject *parent)
-        : QAbstractItemModel{parent}
+        : IncrementalItemModel{parent}
         , mDataProvider{dataProvider}
     {
     }
@@ -157,6 +160,55 @@ namespace Evernus
         endResetModel();
     }
 
+    bool ExternalOrderModel::GroupedData::operator ==(const GroupedData &other) const noexcept
+    {
+        return mId == other.mId &&
+               mLowestPrice == other.mLowestPrice &&
+               mMedianPrice == other.mMedianPrice &&
+               mHighestPrice == other.mHighestPrice &&
+               mVolumeEntered == other.mVolumeEntered &&
+               mVolumeRemaining == other.mVolumeRemaining &&
+               mCount == other.mCount &&
+               mTotalSize == other.mTotalSize &&
+               mTotalCost == other.mTotalCost;
+    }
+
+    void ExternalOrderModel::updateOrders(std::vector<std::shared_ptr<ExternalOrder>> &&orders, bool medianPriceChanged)
+    {
+        if (mGrouping == Grouping::None)
+        {
+            updateRows(mOrders, std::move(orders), [](const auto &order) {
+                return order->getId();
+            }, [](const auto &a, const auto &b) {
+                return a->getPrice() == b->getPrice() &&
+                       a->getVolumeRemaining() == b->getVolumeRemaining() &&
+                       a->getVolumeEntered() == b->getVolumeEntered() &&
+                       a->getIssued() == b->getIssued() &&
+                       a->getDuration() == b->getDuration() &&
+                       a->getUpdateTime() == b->getUpdateTime();
+            });
+
+            // deviation is relative to the median or best price, which might have moved for all orders
+            const auto deviationChanged
+                = (mDeviationType == DeviationSourceType::Median && medianPriceChanged) || mDeviationType == DeviationSourceType::Best;
+            if (deviationChanged && !mOrders.empty())
+                emit dataChanged(index(0, 0), index(static_cast<int>(mOrders.size()) - 1, columnCount() - 1));
+        }
+        else
+        {
+            mOrders = std::move(orders);
+
+            // fill new groups and swap back current ones to compare against
+            auto groupedData = std::move(mGroupedData);
+            refreshGroupedData();
+            groupedData.swap(mGroupedData);
+
+            updateRows(mGroupedData, std::move(groupedData), [](const auto &data) {
+                return data.mId;
+            }, std::equal_to<>{});
+        }
+    }
+
     QVariant ExternalOrderModel::getStationGroupedData(int column, int role, const GroupedData &data) const
     {
         if (column == groupByColumn)
@@ -20,6 +20,7 @@
 
 #include <QAbstractItemModel>
 
+#include "IncrementalItemModel.h"
 #include "Character.h"
 #include "EveType.h"
 
@@ -29,7 +30,7 @@ namespace Evernus
     class ExternalOrder;
 
     class ExternalOrderModel
-        : public QAbstractItemModel
+        : public IncrementalItemModel<QAbstractItemModel>
     {
     public:
         enum class DeviationSourceType
@@ -107,6 +108,8 @@ namespace Evernus
                 double mTotalCost = 0.;
                 double mTotalProfit;
             };
+
+            bool operator ==(const GroupedData &other) const noexcept;
         };
 
         static const int groupByColumn = 0;
@@ -131,6 +134,9 @@ namespace Evernus
         std::vector<std::shared_ptr<ExternalOrder>> mOrders;
         std::vector<GroupedData> mGroupedData;
 
+        // replaces orders, notifying only about changed rows; aggregates should be updated beforehand
+        void updateOrders(std::vector<std::shared_ptr<ExternalOrder>> &&orders, bool medianPriceChanged);
+
     private:
         QVariant getStationGroupedData(int column, int role, const GroupedData &data) const;
         QVariant getSystemGroupedData(int column, int role, const GroupedData &data) const;
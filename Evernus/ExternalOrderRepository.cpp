@@ -12,10 +12,15 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <iterator>
+
 #include <boost/throw_exception.hpp>
 
+#include <QElapsedTimer>
 #include <QSqlRecord>
 #include <QSqlQuery>
+#include <QtDebug>
 
 #include "MarketOrder.h"
 #include "Citadel.h"
@@ -96,7 +101,7 @@ namespace Evernus
                                                                                          const Repository<MarketOrder> &orderRepo,
                                                                                          const Repository<MarketOrder> &corpOrderRepo) const
     {
-        auto query = prepare(QStringLiteral(
+        auto query = prepareCachedReadOnly(QStringLiteral(
             "SELECT * FROM %1 WHERE type = ? AND type_id = ? AND location_id = ? AND id NOT IN "
             "(SELECT id FROM %2 WHERE state = ? UNION SELECT id FROM %3 WHERE state = ?) "
             "ORDER BY value ASC LIMIT 1")
@@ -111,7 +116,100 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return populate(query.record());
+        const auto order = populate(query.record());
+        query.finish();
+
+        return order;
+    }
+
+    ExternalOrderRepository::TypeLocationPriceMap ExternalOrderRepository::findSellByTypesAndStations(const TypeLocationPairs &pairs,
+                                                                                                      const Repository<MarketOrder> &orderRepo,
+                                                                                                      const Repository<MarketOrder> &corpOrderRepo) const
+    {
+        TypeLocationPriceMap result;
+        if (pairs.empty())
+            return result;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto scopeTable = getTableName() + QStringLiteral("_price_scope");
+
+        // temp tables live per connection, so they have to be checked every time
+        exec(QStringLiteral("CREATE TEMP TABLE IF NOT EXISTS %1 ("
+            "type_id INTEGER NOT NULL,"
+            "location_id INTEGER NOT NULL,"
+            "PRIMARY KEY (type_id, location_id)"
+        ")").arg(scopeTable));
+
+        auto db = getDatabase();
+
+        db.transaction();
+
+        try
+        {
+            exec(QStringLiteral("DELETE FROM %1").arg(scopeTable));
+
+            const auto maxPairsPerInsert = maxSqliteBoundVariables / 2;
+            for (auto first = std::begin(pairs); first != std::end(pairs);)
+            {
+                const auto last = std::next(first, std::min<std::size_t>(maxPairsPerInsert, std::distance(first, std::end(pairs))));
+
+                QStringList rowBindings;
+                for (auto it = first; it != last; ++it)
+                    rowBindings << QStringLiteral("(?, ?)");
+
+                const auto queryStr = QStringLiteral("INSERT INTO %1 (type_id, location_id) VALUES %2")
+                    .arg(scopeTable)
+                    .arg(rowBindings.join(QStringLiteral(", ")));
+                auto query = (static_cast<std::size_t>(rowBindings.size()) == maxPairsPerInsert) ? (prepareCached(queryStr)) : (prepare(queryStr));
+
+                for (auto it = first; it != last; ++it)
+                {
+                    query.addBindValue(it->first);
+                    query.addBindValue(it->second);
+                }
+
+                DatabaseUtils::execQuery(query);
+
+                first = last;
+            }
+
+            // CROSS JOIN keeps the scope as the outer loop, so every pair is a single index lookup
+            // bare columns with MIN() come from the row holding the minimum
+            auto query = prepareCached(QStringLiteral(R"(
+    SELECT e.*, MIN(e.value) FROM %1 s CROSS JOIN %2 e ON e.type = ? AND e.type_id = s.type_id AND e.location_id = s.location_id
+    WHERE e.id NOT IN (SELECT id FROM %3 WHERE state = ? UNION SELECT id FROM %4 WHERE state = ?)
+    GROUP BY e.type_id, e.location_id
+            )").arg(scopeTable).arg(getTableName()).arg(orderRepo.getTableName()).arg(corpOrderRepo.getTableName()));
+            query.addBindValue(static_cast<int>(ExternalOrder::Type::Sell));
+            query.addBindValue(static_cast<int>(MarketOrder::State::Active));
+            query.addBindValue(static_cast<int>(MarketOrder::State::Active));
+
+            DatabaseUtils::execQuery(query);
+
+            result.reserve(pairs.size());
+            while (query.next())
+            {
+                auto order = populate(query.record());
+                const auto key = std::make_pair(order->getTypeId(), order->getStationId());
+
+                result.emplace(key, std::move(order));
+            }
+
+            query.finish();
+        }
+        catch (...)
+        {
+            db.rollback();
+            throw;
+        }
+
+        db.commit();
+
+        qDebug() << "Found" << result.size() << "sell prices for" << pairs.size() << "type/station pairs in" << timer.elapsed() << "ms.";
+
+        return result;
     }
 
     ExternalOrderRepository::EntityPtr ExternalOrderRepository::findSellByTypeAndRegion(ExternalOrder::TypeIdType typeId,
@@ -119,7 +217,7 @@ namespace Evernus
                                                                                         const Repository<MarketOrder> &orderRepo,
                                                                                         const Repository<MarketOrder> &corpOrderRepo) const
     {
-        auto query = prepare(QStringLiteral(
+        auto query = prepareCachedReadOnly(QStringLiteral(
             "SELECT * FROM %1 WHERE type = ? AND type_id = ? AND region_id = ? AND id NOT IN "
             "(SELECT id FROM %2 WHERE state = ? UNION SELECT id FROM %3 WHERE state = ?) "
             "ORDER BY value ASC LIMIT 1")
@@ -134,7 +232,10 @@ namespace Evernus
         if (!query.next())
             BOOST_THROW_EXCEPTION(NotFoundException{});
 
-        return populate(query.record());
+        const auto order = populate(query.record());
+        query.finish();
+
+        return order;
     }
 
     ExternalOrderRepository::EntityList ExternalOrderRepository::findBuyByTypeAndRegion(ExternalOrder::TypeIdType typeId,
@@ -142,7 +243,7 @@ namespace Evernus
                                                                                         const Repository<MarketOrder> &orderRepo,
                                                                                         const Repository<MarketOrder> &corpOrderRepo) const
     {
-        auto query = prepare(QStringLiteral(
+        auto query = prepareCachedReadOnly(QStringLiteral(
             "SELECT * FROM %1 WHERE type = ? AND type_id = ? AND region_id = ? AND id NOT IN "
             "(SELECT id FROM %2 WHERE state = ? UNION SELECT id FROM %3 WHERE state = ?)"
             ).arg(getTableName()).arg(orderRepo.getTableName()).arg(corpOrderRepo.getTableName()));
@@ -229,7 +330,7 @@ namespace Evernus
 
         std::vector<uint> result;
 
-        auto query = prepare(QStringLiteral("SELECT DISTINCT solar_system_id FROM %1 WHERE region_id = ?").arg(getTableName()));
+        auto query = prepareCachedReadOnly(QStringLiteral("SELECT DISTINCT solar_system_id FROM %1 WHERE region_id = ?").arg(getTableName()));
         query.bindValue(0, regionId);
 
         DatabaseUtils::execQuery(query);
@@ -253,7 +354,7 @@ namespace Evernus
     {
         std::vector<quint64> result;
 
-        auto query = prepare(QStringLiteral("SELECT DISTINCT location_id FROM %1 WHERE region_id = ?").arg(getTableName()));
+        auto query = prepareCachedReadOnly(QStringLiteral("SELECT DISTINCT location_id FROM %1 WHERE region_id = ?").arg(getTableName()));
         query.bindValue(0, regionId);
 
         DatabaseUtils::execQuery(query);
@@ -272,7 +373,7 @@ namespace Evernus
     {
         std::vector<quint64> result;
 
-        auto query = prepare(QStringLiteral("SELECT DISTINCT location_id FROM %1 WHERE solar_system_id = ?").arg(getTableName()));
+        auto query = prepareCachedReadOnly(QStringLiteral("SELECT DISTINCT location_id FROM %1 WHERE solar_system_id = ?").arg(getTableName()));
         query.bindValue(0, solarSystemId);
 
         DatabaseUtils::execQuery(query);
@@ -287,66 +388,129 @@ namespace Evernus
         return result;
     }
 
-    void ExternalOrderRepository::removeObsolete(const TypeLocationPairs &set) const
+    void ExternalOrderRepository::storeChanged(const std::vector<ExternalOrder> &orders) const
     {
-        if (set.empty())
+        if (orders.empty())
             return;
 
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto incomingTable = getTableName() + QStringLiteral("_incoming");
+        const auto scopeTable = getTableName() + QStringLiteral("_scope");
+
+        // temp tables live per connection, so they have to be checked every time
+        exec(QStringLiteral("CREATE TEMP TABLE IF NOT EXISTS %1 AS SELECT * FROM %2 LIMIT 0").arg(incomingTable).arg(getTableName()));
+        exec(QStringLiteral("CREATE UNIQUE INDEX IF NOT EXISTS temp.%1_id ON %1(id)").arg(incomingTable));
+        exec(QStringLiteral("CREATE TEMP TABLE IF NOT EXISTS %1 ("
+            "type_id INTEGER NOT NULL,"
+            "region_id INTEGER NOT NULL,"
+            "PRIMARY KEY (type_id, region_id)"
+        ")").arg(scopeTable));
+
         auto db = getDatabase();
 
         db.transaction();
 
+        auto changed = 0;
+        auto removed = 0;
+        auto refreshed = 0;
+
         try
         {
-            const auto baseQuery = QStringLiteral("DELETE FROM %1 WHERE %2").arg(getTableName());
-            const auto baseWhere = QStringLiteral("(type_id = ? AND region_id = ?)");
-
-            const auto batchSize = 300;
-            const auto batches = set.size() / batchSize;
+            exec(QStringLiteral("DELETE FROM %1").arg(incomingTable));
+            exec(QStringLiteral("DELETE FROM %1").arg(scopeTable));
 
-            auto it = std::begin(set);
+            const auto columns = getColumns();
 
-            QStringList batchWhere;
-            for (auto i = 0; i < batchSize; ++i)
-                batchWhere << baseWhere;
+            QStringList columnBindings;
+            for (auto i = 0; i < columns.size(); ++i)
+                columnBindings << QStringLiteral("?");
 
-            const auto batchQuery = baseQuery.arg(batchWhere.join(QStringLiteral(" OR ")));
+            const auto rowBinding = QStringLiteral("(") + columnBindings.join(QStringLiteral(", ")) + QStringLiteral(")");
+            const auto maxOrdersPerInsert = maxSqliteBoundVariables / columns.size();
 
-            for (auto i = 0u; i < batches; ++i)
+            // the same order can come in twice if it moved between pages during import, hence REPLACE
+            for (auto first = std::begin(orders); first != std::end(orders);)
             {
-                auto query = prepare(batchQuery);
+                const auto last = std::next(first, std::min<std::size_t>(maxOrdersPerInsert, std::distance(first, std::end(orders))));
 
-                for (auto j = 0; j < batchSize; ++j)
-                {
-                    query.addBindValue(it->first);
-                    query.addBindValue(it->second);
+                QStringList rowBindings;
+                for (auto it = first; it != last; ++it)
+                    rowBindings << rowBinding;
 
-                    ++it;
-                }
+                const auto queryStr = QStringLiteral("REPLACE INTO %1 (%2) VALUES %3")
+                    .arg(incomingTable)
+                    .arg(columns.join(QStringLiteral(", ")))
+                    .arg(rowBindings.join(QStringLiteral(", ")));
+                auto query = (static_cast<std::size_t>(rowBindings.size()) == maxOrdersPerInsert) ? (prepareCached(queryStr)) : (prepare(queryStr));
+
+                for (auto it = first; it != last; ++it)
+                    bindPositionalValues(*it, query);
 
                 DatabaseUtils::execQuery(query);
+
+                first = last;
             }
 
-            const auto reminder = set.size() % batchSize;
-            if (reminder == 0)
-                return;
+            TypeLocationPairs scope;
+            for (const auto &order : orders)
+                scope.emplace(std::make_pair(order.getTypeId(), order.getRegionId()));
+
+            const auto maxPairsPerInsert = maxSqliteBoundVariables / 2;
+            for (auto first = std::begin(scope); first != std::end(scope);)
+            {
+                const auto last = std::next(first, std::min<std::size_t>(maxPairsPerInsert, std::distance(first, std::end(scope))));
 
-            QStringList reminderWhere;
-            for (auto i = 0u; i < reminder; ++i)
-                reminderWhere << baseWhere;
+                QStringList rowBindings;
+                for (auto it = first; it != last; ++it)
+                    rowBindings << QStringLiteral("(?, ?)");
 
-            const auto reminderQuery = baseQuery.arg(reminderWhere.join(QStringLiteral(" OR ")));
-            auto query = prepare(reminderQuery);
+                const auto queryStr = QStringLiteral("INSERT INTO %1 (type_id, region_id) VALUES %2")
+                    .arg(scopeTable)
+                    .arg(rowBindings.join(QStringLiteral(", ")));
+                auto query = (static_cast<std::size_t>(rowBindings.size()) == maxPairsPerInsert) ? (prepareCached(queryStr)) : (prepare(queryStr));
 
-            for (auto i = 0u; i < reminder; ++i)
-            {
-                query.addBindValue(it->first);
-                query.addBindValue(it->second);
+                for (auto it = first; it != last; ++it)
+                {
+                    query.addBindValue(it->first);
+                    query.addBindValue(it->second);
+                }
 
-                ++it;
+                DatabaseUtils::execQuery(query);
+
+                first = last;
             }
 
-            DatabaseUtils::execQuery(query);
+            // orders of imported type/region pairs which are not there anymore
+            auto query = exec(QStringLiteral(R"(
+    DELETE FROM %1 WHERE id IN (
+        SELECT e.id FROM %3 s INNER JOIN %1 e ON e.type_id = s.type_id AND e.region_id = s.region_id
+        WHERE NOT EXISTS (SELECT 1 FROM %2 i WHERE i.id = e.id)
+    )
+            )").arg(getTableName()).arg(incomingTable).arg(scopeTable));
+            removed = query.numRowsAffected();
+
+            // new orders and orders modified since last import
+            QStringList incomingColumns;
+            for (const auto &column : columns)
+                incomingColumns << QStringLiteral("i.") + column;
+
+            query = exec(QStringLiteral(R"(
+    REPLACE INTO %1 (%3) SELECT %4 FROM %2 i LEFT JOIN %1 e ON e.id = i.id
+    WHERE e.id IS NULL OR e.value <> i.value OR e.volume_remaining <> i.volume_remaining OR e.issued <> i.issued
+            )").arg(getTableName()).arg(incomingTable).arg(columns.join(QStringLiteral(", "))).arg(incomingColumns.join(QStringLiteral(", "))));
+            changed = query.numRowsAffected();
+
+            // unchanged orders only need to be marked as seen now, which touches a single index
+            query = exec(QStringLiteral(R"(
+    UPDATE %1 SET update_time = (SELECT i.update_time FROM %2 i WHERE i.id = %1.id)
+    WHERE id IN (SELECT i.id FROM %2 i INNER JOIN %1 e ON e.id = i.id WHERE e.update_time <> i.update_time)
+            )").arg(getTableName()).arg(incomingTable));
+            refreshed = query.numRowsAffected();
+
+            exec(QStringLiteral("DELETE FROM %1").arg(incomingTable));
+            exec(QStringLiteral("DELETE FROM %1").arg(scopeTable));
         }
         catch (...)
         {
@@ -355,11 +519,14 @@ namespace Evernus
         }
 
         db.commit();
+
+        qDebug() << "Stored" << orders.size() << "external orders:"
+                 << changed << "new or changed," << removed << "removed," << refreshed << "refreshed in" << timer.elapsed() << "ms.";
     }
 
     void ExternalOrderRepository::removeForType(ExternalOrder::TypeIdType typeId) const
     {
-        auto query = prepare(QStringLiteral("DELETE FROM %1 WHERE type_id = ?").arg(getTableName()));
+        auto query = prepareCached(QStringLiteral("DELETE FROM %1 WHERE type_id = ?").arg(getTableName()));
         query.bindValue(0, typeId);
 
         DatabaseUtils::execQuery(query);
@@ -444,7 +611,7 @@ namespace Evernus
     ExternalOrderRepository::EntityList ExternalOrderRepository::fetchByType(ExternalOrder::TypeIdType typeId,
                                                                              ExternalOrder::Type type) const
     {
-        auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ?").arg(getTableName()));
+        auto query = prepareCachedReadOnly(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ?").arg(getTableName()));
         query.addBindValue(static_cast<int>(type));
         query.addBindValue(typeId);
 
@@ -466,7 +633,7 @@ namespace Evernus
                                                                                        quint64 stationId,
                                                                                        ExternalOrder::Type type) const
     {
-        auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND location_id = ?").arg(getTableName()));
+        auto query = prepareCachedReadOnly(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND location_id = ?").arg(getTableName()));
         query.addBindValue(static_cast<int>(type));
         query.addBindValue(typeId);
         query.addBindValue(stationId);
@@ -489,7 +656,7 @@ namespace Evernus
                                                                                            uint solarSystemId,
                                                                                            ExternalOrder::Type type) const
     {
-        auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND solar_system_id = ?").arg(getTableName()));
+        auto query = prepareCachedReadOnly(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND solar_system_id = ?").arg(getTableName()));
         query.addBindValue(static_cast<int>(type));
         query.addBindValue(typeId);
         query.addBindValue(solarSystemId);
@@ -512,7 +679,7 @@ namespace Evernus
                                                                                       uint regionId,
                                                                                       ExternalOrder::Type type) const
     {
-        auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND region_id = ?").arg(getTableName()));
+        auto query = prepareCachedReadOnly(QStringLiteral("SELECT * FROM %1 WHERE type = ? AND type_id = ? AND region_id = ?").arg(getTableName()));
         query.addBindValue(static_cast<int>(type));
         query.addBindValue(typeId);
         query.addBindValue(regionId);
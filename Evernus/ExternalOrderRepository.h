@@ -14,6 +14,10 @@
  */
 #pragma once
 
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
 #include "ExternalOrderImporter.h"
 #include "ExternalOrder.h"
 #include "Repository.h"
@@ -27,6 +31,8 @@ namespace Evernus
         : public Repository<ExternalOrder>
     {
     public:
+        using TypeLocationPriceMap = std::unordered_map<TypeLocationPair, EntityPtr, boost::hash<TypeLocationPair>>;
+
         using Repository::Repository;
         virtual ~ExternalOrderRepository() = default;
 
@@ -41,6 +47,10 @@ namespace Evernus
                                            quint64 stationId,
                                            const Repository<MarketOrder> &orderRepo,
                                            const Repository<MarketOrder> &corpOrderRepo) const;
+        // lowest sell orders for all given type/station pairs at once; pairs without orders are not in the result
+        TypeLocationPriceMap findSellByTypesAndStations(const TypeLocationPairs &pairs,
+                                                        const Repository<MarketOrder> &orderRepo,
+                                                        const Repository<MarketOrder> &corpOrderRepo) const;
         EntityPtr findSellByTypeAndRegion(ExternalOrder::TypeIdType typeId,
                                           uint regionId,
                                           const Repository<MarketOrder> &orderRepo,
@@ -73,7 +83,8 @@ namespace Evernus
         std::vector<quint64> fetchUniqueStationsByRegion(uint regionId) const;
         std::vector<quint64> fetchUniqueStationsBySolarSystem(uint solarSystemId) const;
 
-        void removeObsolete(const TypeLocationPairs &set) const;
+        // replaces stored orders of incoming type/region pairs, writing only rows which have changed
+        void storeChanged(const std::vector<ExternalOrder> &orders) const;
         void removeForType(ExternalOrder::TypeIdType typeId) const;
         void removeAll() const;
 
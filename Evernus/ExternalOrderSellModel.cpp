@@ -158,18 +158,19 @@ namespace Evernus
 
     void ExternalOrderSellModel::reset()
     {
-        beginResetModel();
+        std::vector<std::shared_ptr<ExternalOrder>> orders;
 
         if (mStationId != 0)
-            mOrders = mOrderRepo.fetchSellByTypeAndStation(mTypeId, mStationId);
+            orders = mOrderRepo.fetchSellByTypeAndStation(mTypeId, mStationId);
         else if (mSolarSystemId != 0)
-            mOrders = mOrderRepo.fetchSellByTypeAndSolarSystem(mTypeId, mSolarSystemId);
+            orders = mOrderRepo.fetchSellByTypeAndSolarSystem(mTypeId, mSolarSystemId);
         else if (mRegionId != 0)
-            mOrders = mOrderRepo.fetchSellByTypeAndRegion(mTypeId, mRegionId);
+            orders = mOrderRepo.fetchSellByTypeAndRegion(mTypeId, mRegionId);
         else
-            mOrders = mOrderRepo.fetchSellByType(mTypeId);
+            orders = mOrderRepo.fetchSellByType(mTypeId);
 
-        const auto aggrData = MathUtils::calcAggregates(mOrders, mDataProvider);
+        const auto aggrData = MathUtils::calcAggregates(orders, mDataProvider);
+        const auto medianPriceChanged = mMedianPrice != aggrData.mMedianPrice;
 
         mTotalPrice = aggrData.mTotalPrice;
         mMinPrice = aggrData.mMinPrice;
@@ -178,10 +179,7 @@ namespace Evernus
         mTotalVolume = aggrData.mTotalVolume;
         mTotalSize = aggrData.mTotalSize;
 
-        if (mGrouping != Grouping::None)
-            refreshGroupedData();
-
-        endResetModel();
+        updateOrders(std::move(orders), medianPriceChanged);
     }
 
     double ExternalOrderSellModel::getPrice(const QModelIndex &index) const
@@ -20,6 +20,7 @@
 #include <QComboBox>
 #include <QSettings>
 #include <QSqlQuery>
+#include <QSpinBox>
 #include <QLabel>
 
 #include "LanguageComboBox.h"
@@ -124,6 +125,21 @@ namespace Evernus
         mDbSynchronousEdit->setCurrentIndex(mDbSynchronousEdit->findData(
             settings.value(DbSettings::synchronousKey, DbSettings::synchronousDefault).toInt()));
 
+        mDbCacheSizeEdit = new QSpinBox{this};
+        generalFormLayout->addRow(tr("Database cache size (requires restart):"), mDbCacheSizeEdit);
+        mDbCacheSizeEdit->setRange(1, 4096);
+        mDbCacheSizeEdit->setSuffix(QStringLiteral(" MB"));
+        mDbCacheSizeEdit->setToolTip(tr("Page cache size of each database connection."));
+        mDbCacheSizeEdit->setValue(settings.value(DbSettings::cacheSizeKey, DbSettings::cacheSizeDefault).toInt());
+
+        mDbMmapSizeEdit = new QSpinBox{this};
+        generalFormLayout->addRow(tr("Database memory map size (requires restart):"), mDbMmapSizeEdit);
+        mDbMmapSizeEdit->setRange(0, 65536);
+        mDbMmapSizeEdit->setSuffix(QStringLiteral(" MB"));
+        mDbMmapSizeEdit->setSpecialValueText(tr("disabled"));
+        mDbMmapSizeEdit->setToolTip(tr("How much of the database file can be memory mapped for reading."));
+        mDbMmapSizeEdit->setValue(settings.value(DbSettings::mmapSizeKey, DbSettings::mmapSizeDefault).toInt());
+
         mainLayout->addStretch();
     }
 
@@ -146,5 +162,7 @@ namespace Evernus
         settings.setValue(UISettings::applyDateFormatToGraphsKey, mApplyDateFormatToGraphsBtn->isChecked());
         settings.setValue(UISettings::columnDelimiterKey, mColumnDelimiterEdit->currentData().value<char>());
         settings.setValue(DbSettings::synchronousKey, synchronousFlag);
+        settings.setValue(DbSettings::cacheSizeKey, mDbCacheSizeEdit->value());
+        settings.setValue(DbSettings::mmapSizeKey, mDbMmapSizeEdit->value());
     }
 }
@@ -20,6 +20,7 @@
 class QCheckBox;
 class QLineEdit;
 class QComboBox;
+class QSpinBox;
 
 namespace Evernus
 {
@@ -52,5 +53,7 @@ namespace Evernus
         QCheckBox *mApplyDateFormatToGraphsBtn = nullptr;
         QComboBox *mColumnDelimiterEdit = nullptr;
         QComboBox *mDbSynchronousEdit = nullptr;
+        QSpinBox *mDbCacheSizeEdit = nullptr;
+        QSpinBox *mDbMmapSizeEdit = nullptr;
     };
 }
@@ -12,12 +12,19 @@
  *  You should have received a copy of the GNU Http Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <iterator>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
 #include <QSettings>
 #include <QUrlQuery>
 #include <QLocale>
 #include <QColor>
 
 #include "CharacterRepository.h"
+#include "MarketOrderProvider.h"
+#include "EveDataProvider.h"
 #include "HttpSettings.h"
 
 #include "qxthttpsessionmanager.h"
@@ -38,6 +45,9 @@ namespace Evernus
                              QxtHttpSessionManager *sm,
                              QObject *parent)
         : QxtWebSlotService(sm, parent)
+        , mOrderProvider(orderProvider)
+        , mCorpOrderProvider(corpOrderProvider)
+        , mDataProvider(dataProvider)
         , mCharacterRepo(characterRepo)
         , mCrypt(HttpSettings::cryptKey)
         , mSellModel(orderProvider, dataProvider, itemCostProvider, cacheTimerProvider, characterRepo, false)
@@ -110,6 +120,9 @@ namespace Evernus
 
     void HttpService::index(QxtWebRequestEvent *event)
     {
+        if (postCached(event))
+            return;
+
         auto query = mCharacterRepo.getEnabledQuery();
 
         QStringList options;
@@ -126,6 +139,9 @@ namespace Evernus
 
     void HttpService::characterOrders(QxtWebRequestEvent *event)
     {
+        if (postCached(event))
+            return;
+
         const auto characterId = getCharacterId(event);
 
         mSellModel.setCharacter(characterId);
@@ -136,6 +152,9 @@ namespace Evernus
 
     void HttpService::corporationOrders(QxtWebRequestEvent *event)
     {
+        if (postCached(event))
+            return;
+
         const auto characterId = getCharacterId(event);
 
         mCorpSellModel.setCharacter(characterId);
@@ -144,6 +163,23 @@ namespace Evernus
         renderOrders(event, mCorpBuyModelProxy, mCorpSellModelProxy, mCorpOrdersTemplate);
     }
 
+    void HttpService::characterOrdersJson(QxtWebRequestEvent *event)
+    {
+        if (!postCached(event))
+            renderOrdersJson(event, false);
+    }
+
+    void HttpService::corporationOrdersJson(QxtWebRequestEvent *event)
+    {
+        if (!postCached(event))
+            renderOrdersJson(event, true);
+    }
+
+    void HttpService::clearCache()
+    {
+        mPageCache.clear();
+    }
+
     void HttpService::pageRequestedEvent(QxtWebRequestEvent *event)
     {
         auto authHeader = event->headers.value("Authorization");
@@ -203,34 +239,39 @@ namespace Evernus
             const auto columns = model.columnCount(QModelIndex{});
             const auto rows = model.rowCount(QModelIndex{});
 
-            QStringList orders;
+            // rough guess to avoid reallocations on big tables
+            const auto approxCellSize = 64;
+
+            QString orders;
+            orders.reserve(rows * columns * approxCellSize);
+
             for (auto row = 0; row < rows; ++row)
             {
-                orders << "<tr>";
+                orders += QLatin1String{"<tr>"};
 
                 for (auto column = 0; column < columns; ++column)
                 {
                     const auto index = model.index(row, column);
 
+                    orders += QLatin1String{"<td style='color: "};
+                    orders += model.data(index, Qt::ForegroundRole).template value<QColor>().name();
 
-                    orders
-                        << "<td style='color: "
-                        << model.data(index, Qt::ForegroundRole).template value<QColor>().name();
-
-                    auto background = model.data(index, Qt::BackgroundRole).template value<QColor>();
+                    const auto background = model.data(index, Qt::BackgroundRole).template value<QColor>();
                     if (background.isValid())
-                        orders << "; background: " << background.name();
-
-                    orders
-                        << ";'>"
-                        << model.data(index).toString()
-                        << "</td>";
+                    {
+                        orders += QLatin1String{"; background: "};
+                        orders += background.name();
+                    }
+
+                    orders += QLatin1String{";'>"};
+                    orders += model.data(index).toString();
+                    orders += QLatin1String{"</td>"};
                 }
 
-                orders << "</tr>";
+                orders += QLatin1String{"</tr>"};
             }
 
-            return orders.join(QString{});
+            return orders;
         };
 
         htmlTemplate["sell-orders"] = renderer(sellModel);
@@ -264,10 +305,143 @@ namespace Evernus
         renderContent(event, htmlTemplate.render());
     }
 
+    void HttpService::renderOrdersJson(QxtWebRequestEvent *event, bool corp)
+    {
+        const auto characterId = getCharacterId(event);
+
+        MarketOrderProvider::OrderList sellOrders, buyOrders;
+        if (corp)
+        {
+            quint64 corporationId = 0;
+
+            try
+            {
+                corporationId = mCharacterRepo.getCorporationId(characterId);
+            }
+            catch (const CharacterRepository::NotFoundException &)
+            {
+                postEvent(new QxtWebErrorEvent{event->sessionID, event->requestID, 404, "Not Found"});
+                return;
+            }
+
+            sellOrders = mCorpOrderProvider.getSellOrdersForCorporation(corporationId);
+            buyOrders = mCorpOrderProvider.getBuyOrdersForCorporation(corporationId);
+        }
+        else
+        {
+            sellOrders = mOrderProvider.getSellOrders(characterId);
+            buyOrders = mOrderProvider.getBuyOrders(characterId);
+        }
+
+        const auto serializer = [&](const auto &orders) {
+            QJsonArray result;
+            for (const auto &order : orders)
+            {
+                // 64-bit ids don't survive JavaScript numbers
+                QJsonObject object;
+                object[QStringLiteral("id")] = QString::number(order->getId());
+                object[QStringLiteral("characterId")] = QString::number(order->getCharacterId());
+                object[QStringLiteral("corporationId")] = QString::number(order->getCorporationId());
+                object[QStringLiteral("stationId")] = QString::number(order->getEffectiveStationId());
+                object[QStringLiteral("stationName")] = mDataProvider.getLocationName(order->getEffectiveStationId());
+                object[QStringLiteral("typeId")] = static_cast<qint64>(order->getTypeId());
+                object[QStringLiteral("typeName")] = mDataProvider.getTypeName(order->getTypeId());
+                object[QStringLiteral("state")] = static_cast<int>(order->getState());
+                object[QStringLiteral("volumeEntered")] = static_cast<qint64>(order->getVolumeEntered());
+                object[QStringLiteral("volumeRemaining")] = static_cast<qint64>(order->getVolumeRemaining());
+                object[QStringLiteral("minVolume")] = static_cast<qint64>(order->getMinVolume());
+                object[QStringLiteral("delta")] = order->getDelta();
+                object[QStringLiteral("range")] = order->getRange();
+                object[QStringLiteral("duration")] = order->getDuration();
+                object[QStringLiteral("escrow")] = order->getEscrow();
+                object[QStringLiteral("price")] = order->getPrice();
+                object[QStringLiteral("issued")] = order->getIssued().toString(Qt::ISODate);
+                object[QStringLiteral("firstSeen")] = order->getFirstSeen().toString(Qt::ISODate);
+                object[QStringLiteral("lastSeen")] = order->getLastSeen().toString(Qt::ISODate);
+
+                result.append(object);
+            }
+
+            return result;
+        };
+
+        QJsonObject result;
+        result[QStringLiteral("sellOrders")] = serializer(sellOrders);
+        result[QStringLiteral("buyOrders")] = serializer(buyOrders);
+
+        postContent(event, QJsonDocument{result}.toJson(QJsonDocument::Compact), "application/json");
+    }
+
     void HttpService::renderContent(QxtWebRequestEvent *event, const QString &content)
     {
         mMainTemplate["content"] = content;
-        postEvent(new QxtWebPageEvent{event->sessionID, event->requestID, mMainTemplate.render().toUtf8()});
+        postContent(event, mMainTemplate.render().toUtf8(), "text/html");
+    }
+
+    void HttpService::postContent(QxtWebRequestEvent *event, const QByteArray &content, const QByteArray &contentType)
+    {
+        const auto key = getCacheKey(event);
+        if (!mPageCache.contains(key))
+            makeCacheRoom();
+
+        auto &page = mPageCache[key];
+        page.mContent = content;
+        page.mContentType = contentType;
+        page.mAge.start();
+
+        postPage(event, content, contentType);
+    }
+
+    void HttpService::postPage(QxtWebRequestEvent *event, const QByteArray &content, const QByteArray &contentType)
+    {
+        auto pageEvent = new QxtWebPageEvent{event->sessionID, event->requestID, content};
+        pageEvent->contentType = contentType;
+        pageEvent->chunked = content.size() > chunkedResponseThreshold;
+
+        postEvent(pageEvent);
+    }
+
+    bool HttpService::postCached(QxtWebRequestEvent *event)
+    {
+        const auto page = mPageCache.find(getCacheKey(event));
+        if (page == mPageCache.end())
+            return false;
+
+        if (page->mAge.hasExpired(maxCachedPageAge))
+        {
+            mPageCache.erase(page);
+            return false;
+        }
+
+        postPage(event, page->mContent, page->mContentType);
+        return true;
+    }
+
+    void HttpService::makeCacheRoom()
+    {
+        if (mPageCache.size() < maxCachedPages)
+            return;
+
+        for (auto it = mPageCache.begin(); it != mPageCache.end();)
+        {
+            if (it->mAge.hasExpired(maxCachedPageAge))
+                it = mPageCache.erase(it);
+            else
+                ++it;
+        }
+
+        if (mPageCache.size() < maxCachedPages)
+            return;
+
+        // everything is fresh - drop the oldest page
+        auto oldest = mPageCache.begin();
+        for (auto it = std::next(oldest); it != mPageCache.end(); ++it)
+        {
+            if (it->mAge.elapsed() > oldest->mAge.elapsed())
+                oldest = it;
+        }
+
+        mPageCache.erase(oldest);
     }
 
     void HttpService::postUnauthorized(QxtWebRequestEvent *event)
@@ -314,6 +488,11 @@ namespace Evernus
         return result;
     }
 
+    QString HttpService::getCacheKey(QxtWebRequestEvent *event)
+    {
+        return event->url.toString();
+    }
+
     void HttpService
     ::fillTableTemplate(QxtHtmlTemplate &htmlTemplate, const MarketOrderSellModel &sellModel, const MarketOrderBuyModel &buyModel)
     {
@@ -14,6 +14,10 @@
  */
 #pragma once
 
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QHash>
+
 #include "MarketOrderFilterProxyModel.h"
 #include "MarketOrderSellModel.h"
 #include "MarketOrderBuyModel.h"
@@ -52,6 +56,10 @@ namespace Evernus
         void index(QxtWebRequestEvent *event);
         void characterOrders(QxtWebRequestEvent *event);
         void corporationOrders(QxtWebRequestEvent *event);
+        void characterOrdersJson(QxtWebRequestEvent *event);
+        void corporationOrdersJson(QxtWebRequestEvent *event);
+
+        void clearCache();
 
     protected:
         virtual void pageRequestedEvent(QxtWebRequestEvent *event) override;
@@ -59,8 +67,24 @@ namespace Evernus
     private:
         typedef std::pair<MarketOrderFilterProxyModel::StatusFilters, MarketOrderFilterProxyModel::PriceStatusFilters> FilterPair;
 
+        struct CachedPage
+        {
+            QByteArray mContent;
+            QByteArray mContentType;
+            QElapsedTimer mAge;
+        };
+
         static const QString characterIdName;
 
+        // some content depends on time, e.g. price data age, so don't keep pages forever
+        static const qint64 maxCachedPageAge = 60 * 1000;
+        // query strings are part of the key, so the number of pages needs a limit
+        static const int maxCachedPages = 64;
+        // larger responses are sent in chunks
+        static const int chunkedResponseThreshold = 64 * 1024;
+
+        const MarketOrderProvider &mOrderProvider, &mCorpOrderProvider;
+        const EveDataProvider &mDataProvider;
         const CharacterRepository &mCharacterRepo;
 
         SimpleCrypt mCrypt;
@@ -72,17 +96,27 @@ namespace Evernus
 
         MarketOrderFilterProxyModel mSellModelProxy, mBuyModelProxy, mCorpSellModelProxy, mCorpBuyModelProxy;
 
+        QHash<QString, CachedPage> mPageCache;
+
         void renderOrders(QxtWebRequestEvent *event,
                           MarketOrderFilterProxyModel &buyModel,
                           MarketOrderFilterProxyModel &sellModel,
                           QxtHtmlTemplate &htmlTemplate);
+        void renderOrdersJson(QxtWebRequestEvent *event, bool corp);
 
         void renderContent(QxtWebRequestEvent *event, const QString &content);
+        void postContent(QxtWebRequestEvent *event, const QByteArray &content, const QByteArray &contentType);
+        void postPage(QxtWebRequestEvent *event, const QByteArray &content, const QByteArray &contentType);
         void postUnauthorized(QxtWebRequestEvent *event);
 
+        // posts cached page for given request, if there's a fresh one
+        bool postCached(QxtWebRequestEvent *event);
+        void makeCacheRoom();
+
         static bool isIndexAction(QxtWebRequestEvent *event);
         static Character::IdType getCharacterId(QxtWebRequestEvent *event);
         static FilterPair getFilters(QxtWebRequestEvent *event);
+        static QString getCacheKey(QxtWebRequestEvent *event);
 
         static void fillTableTemplate(QxtHtmlTemplate &htmlTemplate,
                                       const MarketOrderSellModel &sellModel,
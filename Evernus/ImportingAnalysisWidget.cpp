@@ -276,7 +276,7 @@ namespace Evernus
         if (history == nullptr)
             return;
 
-        const auto orders = mMarketDataProvider.getOrders();
+        const auto orders = mMarketDataProvider.getOrderBook();
         if (orders == nullptr)
             return;
 
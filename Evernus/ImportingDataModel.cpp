@@ -13,10 +13,9 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <type_traits>
-#include <future>
 #include <cmath>
 #include <mutex>
-#include <set>
+#include <iterator>
 
 #include <QCoreApplication>
 #include <QSettings>
@@ -30,13 +29,12 @@
 #include <boost/accumulators/statistics/mean.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/range/adaptor/reversed.hpp>
-#include <boost/range/adaptor/filtered.hpp>
 #include <boost/scope_exit.hpp>
 
 #include "MarketAnalysisSettings.h"
 #include "EveDataProvider.h"
 #include "PriceSettings.h"
-#include "ExternalOrder.h"
+#include "ExternalOrderBook.h"
 #include "PriceUtils.h"
 #include "TextUtils.h"
 #include "MathUtils.h"
@@ -229,7 +227,7 @@ namespace Evernus
         return mData[index.row()].mId;
     }
 
-    void ImportingDataModel::setOrderData(const std::vector<ExternalOrder> &orders,
+    void ImportingDataModel::setOrderData(const ExternalOrderBook &orders,
                                           const HistoryRegionMap &history,
                                           quint64 srcStation,
                                           quint64 dstStation,
@@ -268,68 +266,35 @@ namespace Evernus
             quint64 mDstOrderCount = 0;
         };
 
-        TypeMap<TypeMapData> typeMap;
-        TypeMap<quint64> srcVolumes, dstVolumes, dstSellVolumes;
-        TypeMap<std::multiset<std::reference_wrapper<const ExternalOrder>, ExternalOrder::LowToHigh>> dstOrders;
-        TypeMap<std::multiset<std::reference_wrapper<const ExternalOrder>, ExternalOrder::HighToLow>> srcOrders;
-
-        // gather prices and volumes from dst orders - we need those to calculate percentile dst price
-        auto dstFuture = std::async(std::launch::async, [&] {
-            const auto dstOrderFilter = [=](const auto &order) {
-                return order.getStationId() == dstStation;
-            };
+        const auto dstRegionId = dstHistory->first;
+        const auto srcRegionId = srcHistory->first;
 
-            for (const auto &order : orders | boost::adaptors::filtered(dstOrderFilter))
-            {
-                const auto typeId = order.getTypeId();
-                const auto type = order.getType();
-
-                if (dstPriceType == type)
-                {
-                    dstOrders[typeId].emplace(std::cref(order));
-                    dstVolumes[typeId] += order.getVolumeRemaining();
-                }
-
-                if (type == ExternalOrder::Type::Sell)
-                    dstSellVolumes[typeId] += order.getVolumeRemaining();
-            }
-        });
-
-        // gather prices and volumes from src orders - we need those to calculate percentile src price
-        auto srcFuture = std::async(std::launch::async, [&] {
-            const auto srcOrderFilter = [=](const auto &order) {
-                return order.getStationId() == srcStation && srcPriceType == order.getType();
-            };
-
-            for (const auto &order : orders | boost::adaptors::filtered(srcOrderFilter))
-            {
-                const auto typeId = order.getTypeId();
-                srcOrders[typeId].emplace(std::cref(order));
-                srcVolumes[typeId] += order.getVolumeRemaining();
-            }
-        });
+        TypeMap<TypeMapData> typeMap;
+        TypeMap<quint64> dstSellVolumes;
 
         const auto historyLimit = QDate::currentDate().addDays(-analysisDays + 1);
 
-        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-
-        dstFuture.get();
-        srcFuture.get();
-
         QSettings settings;
 
         const auto volumePercentile = 0.05;
         const auto preferredMargin
             = settings.value(PriceSettings::preferredMarginKey, PriceSettings::preferredMarginDefault).toDouble() / 100.;
 
+        // book slices are sorted best price first for both sides, so station orders can be taken as they are
+        std::vector<ExternalOrderBook::OrderRef> typeSrcOrders, typeDstOrders;
+
+        const auto gatherStationOrders = [&](auto &result, EveType::IdType typeId, PriceType type, uint regionId, quint64 stationId) {
+            const auto regionOrders = orders.getOrders(typeId, type, regionId);
+
+            result.clear();
+            std::copy_if(std::begin(regionOrders), std::end(regionOrders), std::back_inserter(result), [=](const auto &order) {
+                return order.getStationId() == stationId;
+            });
+        };
+
         // fill our type map with order data
-        for (const auto &order : orders)
+        for (const auto typeId : orders.getTypeIds())
         {
-            const auto typeId = order.getTypeId();
-            const auto type = typeMap.find(typeId);
-            if (type != std::end(typeMap))
-                continue;
-
             auto &data = typeMap[typeId];
 
             accumulator_set<double, stats<tag::mean>> dstPriceAcc;
@@ -369,48 +334,28 @@ namespace Evernus
                 }
             }
 
-            const auto &typeSrcOrders = srcOrders[typeId];
-            const auto &typeDstOrders = dstOrders[typeId];
+            gatherStationOrders(typeSrcOrders, typeId, srcPriceType, srcRegionId, srcStation);
+            gatherStationOrders(typeDstOrders, typeId, dstPriceType, dstRegionId, dstStation);
 
             data.mSrcOrderCount = typeSrcOrders.size();
             data.mDstOrderCount = typeDstOrders.size();
 
-            // dst orders are by default sorted from lowest price, which means we need to reverse them if we
-            // want to sell to buy orders, which are highest first
-            if (dstPriceType == PriceType::Sell)
-            {
-                data.mDstPrice = MathUtils::calcPercentile(typeDstOrders,
-                                                           dstVolumes[typeId] * volumePercentile,
-                                                           mean(dstPriceAcc),
-                                                           mDiscardBogusOrders,
-                                                           mBogusOrderThreshold);
-            }
-            else
-            {
-                data.mDstPrice = MathUtils::calcPercentile(boost::adaptors::reverse(typeDstOrders),
-                                                           dstVolumes[typeId] * volumePercentile,
-                                                           mean(dstPriceAcc),
-                                                           mDiscardBogusOrders,
-                                                           mBogusOrderThreshold);
-            }
-
-            // same logic for src orders
-            if (srcPriceType == PriceType::Buy)
-            {
-                data.mSrcPrice = MathUtils::calcPercentile(typeSrcOrders,
-                                                           srcVolumes[typeId] * volumePercentile,
-                                                           mean(srcPriceAcc),
-                                                           mDiscardBogusOrders,
-                                                           mBogusOrderThreshold);
-            }
-            else
-            {
-                data.mSrcPrice = MathUtils::calcPercentile(boost::adaptors::reverse(typeSrcOrders),
-                                                           srcVolumes[typeId] * volumePercentile,
-                                                           mean(srcPriceAcc),
-                                                           mDiscardBogusOrders,
-                                                           mBogusOrderThreshold);
-            }
+            data.mDstPrice = MathUtils::calcPercentile(typeDstOrders,
+                                                       MathUtils::calcTotalVolume(typeDstOrders) * volumePercentile,
+                                                       mean(dstPriceAcc),
+                                                       mDiscardBogusOrders,
+                                                       mBogusOrderThreshold);
+            data.mSrcPrice = MathUtils::calcPercentile(typeSrcOrders,
+                                                       MathUtils::calcTotalVolume(typeSrcOrders) * volumePercentile,
+                                                       mean(srcPriceAcc),
+                                                       mDiscardBogusOrders,
+                                                       mBogusOrderThreshold);
+
+            // dst volume always comes from sell orders
+            if (dstPriceType != PriceType::Sell)
+                gatherStationOrders(typeDstOrders, typeId, PriceType::Sell, dstRegionId, dstStation);
+
+            dstSellVolumes[typeId] = MathUtils::calcTotalVolume(typeDstOrders);
 
             // check if this was traded at all
             if (qFuzzyIsNull(data.mDstPrice))
@@ -30,7 +30,7 @@
 namespace Evernus
 {
     class EveDataProvider;
-    class ExternalOrder;
+    class ExternalOrderBook;
 
     class ImportingDataModel
         : public QAbstractTableModel
@@ -82,7 +82,7 @@ namespace Evernus
 
         virtual EveType::IdType getTypeId(const QModelIndex &index) const override;
 
-        void setOrderData(const std::vector<ExternalOrder> &orders,
+        void setOrderData(const ExternalOrderBook &orders,
                           const HistoryRegionMap &history,
                           quint64 srcStation,
                           quint64 dstStation,
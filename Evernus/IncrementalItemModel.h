@@ -0,0 +1,62 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <QModelIndex>
+
+namespace Evernus
+{
+    // item model which can bring its rows up to date without a reset, so views keep their selection and sorting
+    template<class Base>
+    class IncrementalItemModel
+        : public Base
+    {
+    public:
+        using Base::Base;
+        virtual ~IncrementalItemModel() = default;
+
+    protected:
+        struct MoveAssign
+        {
+            template<class T>
+            void operator ()(T &row, T &&newRow) const
+            {
+                row = std::move(newRow);
+            }
+        };
+
+        // replaces rows with new ones matched by key - missing rows are removed, new ones appended
+        // and kept ones assigned in place, with dataChanged emitted only for those which are not equal
+        // falls back to a reset when most of the rows are replaced anyway or new keys are not unique; nested updates
+        // (e.g. children updated from assign of an outer update) must not reset the model, so they can replace all rows
+        // with a remove and an insert instead
+        template<class T, class KeyFunc, class EqualFunc, class AssignFunc = MoveAssign>
+        void updateRows(std::vector<T> &rows,
+                        std::vector<T> &&newRows,
+                        KeyFunc getKey,
+                        EqualFunc isEqual,
+                        const QModelIndex &parent = QModelIndex{},
+                        AssignFunc assign = AssignFunc{},
+                        bool allowReset = true);
+
+    private:
+        static const std::size_t maxRemovedRanges = 1000;
+    };
+}
+
+#include "IncrementalItemModel.inl"
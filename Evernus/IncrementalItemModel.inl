@@ -0,0 +1,184 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <unordered_map>
+#include <type_traits>
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QtDebug>
+
+#include <boost/functional/hash.hpp>
+
+namespace Evernus
+{
+    template<class Base>
+    template<class T, class KeyFunc, class EqualFunc, class AssignFunc>
+    void IncrementalItemModel<Base>::updateRows(std::vector<T> &rows,
+                                                std::vector<T> &&newRows,
+                                                KeyFunc getKey,
+                                                EqualFunc isEqual,
+                                                const QModelIndex &parent,
+                                                AssignFunc assign,
+                                                bool allowReset)
+    {
+        using Key = std::decay_t<decltype(getKey(std::declval<const T &>()))>;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto resetRows = [&] {
+            if (allowReset)
+            {
+                this->beginResetModel();
+                rows = std::move(newRows);
+                this->endResetModel();
+            }
+            else
+            {
+                if (!rows.empty())
+                {
+                    this->beginRemoveRows(parent, 0, static_cast<int>(rows.size()) - 1);
+                    rows.clear();
+                    this->endRemoveRows();
+                }
+
+                if (!newRows.empty())
+                {
+                    this->beginInsertRows(parent, 0, static_cast<int>(newRows.size()) - 1);
+                    rows = std::move(newRows);
+                    this->endInsertRows();
+                }
+            }
+
+            qDebug() << "Replaced" << rows.size() << "model rows in" << timer.elapsed() << "ms.";
+        };
+
+        std::unordered_map<Key, std::size_t, boost::hash<Key>> newIndexes;
+        newIndexes.reserve(newRows.size());
+
+        for (auto i = 0u; i < newRows.size(); ++i)
+        {
+            if (Q_UNLIKELY(!newIndexes.emplace(getKey(newRows[i]), i).second))
+            {
+                // rows can't be matched by key, so just take them as they are
+                qWarning() << "Duplicate model row keys, resetting.";
+
+                resetRows();
+                return;
+            }
+        }
+
+        std::vector<bool> kept(newRows.size(), false);
+        std::vector<bool> removed(rows.size(), false);
+        std::size_t removedCount = 0, removedRanges = 0;
+
+        for (auto i = 0u; i < rows.size(); ++i)
+        {
+            // every new row can take the place of one old row only - duplicates left by a reset go away
+            const auto newIndex = newIndexes.find(getKey(rows[i]));
+            if (newIndex != std::end(newIndexes) && !kept[newIndex->second])
+            {
+                kept[newIndex->second] = true;
+                continue;
+            }
+
+            removed[i] = true;
+            ++removedCount;
+
+            if (i == 0 || !removed[i - 1])
+                ++removedRanges;
+        }
+
+        const auto keptCount = rows.size() - removedCount;
+        const auto insertedCount = newRows.size() - keptCount;
+
+        // selection is mostly gone in such cases anyway and a reset is cheaper for proxies
+        if (removedRanges > maxRemovedRanges || (removedCount + insertedCount) > std::max(rows.size(), newRows.size()) / 2)
+        {
+            resetRows();
+            return;
+        }
+
+        // remove back to front, so indexes of remaining ranges stay valid
+        for (auto last = static_cast<int>(rows.size()) - 1; last >= 0; --last)
+        {
+            if (!removed[last])
+                continue;
+
+            auto first = last;
+            while (first > 0 && removed[first - 1])
+                --first;
+
+            this->beginRemoveRows(parent, first, last);
+            rows.erase(std::next(std::begin(rows), first), std::next(std::begin(rows), last + 1));
+            this->endRemoveRows();
+
+            last = first;
+        }
+
+        const auto lastColumn = this->columnCount(parent) - 1;
+        const auto emitChanged = [&](int first, int last) {
+            emit this->dataChanged(this->index(first, 0, parent), this->index(last, lastColumn, parent));
+        };
+
+        auto changedFirst = -1;
+        std::size_t changedCount = 0;
+
+        for (auto row = 0u; row < rows.size(); ++row)
+        {
+            const auto newIndex = newIndexes[getKey(rows[row])];
+
+            if (isEqual(rows[row], newRows[newIndex]))
+            {
+                if (changedFirst >= 0)
+                {
+                    emitChanged(changedFirst, row - 1);
+                    changedFirst = -1;
+                }
+            }
+            else
+            {
+                if (changedFirst < 0)
+                    changedFirst = row;
+
+                ++changedCount;
+            }
+
+            assign(rows[row], std::move(newRows[newIndex]));
+        }
+
+        if (changedFirst >= 0)
+            emitChanged(changedFirst, static_cast<int>(rows.size()) - 1);
+
+        if (insertedCount > 0)
+        {
+            const auto first = static_cast<int>(rows.size());
+
+            this->beginInsertRows(parent, first, first + static_cast<int>(insertedCount) - 1);
+
+            rows.reserve(rows.size() + insertedCount);
+            for (auto i = 0u; i < newRows.size(); ++i)
+            {
+                if (!kept[i])
+                    rows.emplace_back(std::move(newRows[i]));
+            }
+
+            this->endInsertRows();
+        }
+
+        qDebug() << "Updated model rows:" << removedCount << "removed," << changedCount << "changed,"
+                 << insertedCount << "inserted in" << timer.elapsed() << "ms.";
+    }
+}
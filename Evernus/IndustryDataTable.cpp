@@ -0,0 +1,346 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <unordered_set>
+
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QSqlQuery>
+#include <QtDebug>
+#include <QFile>
+
+#include "DatabaseUtils.h"
+
+#include "IndustryDataTable.h"
+
+namespace Evernus
+{
+    void IndustryDataTable::build(const QSqlDatabase &db, uint manufacturingActivityId, const QStringList &oreGroupNames)
+    {
+        clear();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        // the first blueprint wins when more than one produces given type
+        QSqlQuery query{db};
+        query.prepare(QStringLiteral(R"(
+SELECT p.productTypeID, p.typeID, p.quantity, a.time FROM industryActivityProducts p
+    INNER JOIN industryActivity a
+        ON a.typeID = p.typeID AND a.activityID = p.activityID
+    WHERE p.activityID = ?
+    ORDER BY p.typeID
+        )"));
+        query.addBindValue(manufacturingActivityId);
+
+        DatabaseUtils::execQuery(query);
+
+        std::unordered_map<EveType::IdType, EveType::IdType> productBlueprints;
+        while (query.next())
+        {
+            const auto productId = query.value(0).value<EveType::IdType>();
+            const auto blueprintId = query.value(1).value<EveType::IdType>();
+
+            mBlueprintOutputs.emplace(blueprintId, productId);
+
+            if (!productBlueprints.emplace(productId, blueprintId).second)
+                continue;
+
+            auto &info = mManufacturingInfo[productId];
+            info.mQuantity = query.value(2).toUInt();
+            info.mTime = std::chrono::seconds{query.value(3).toUInt()};
+        }
+
+        const auto isProductBlueprint = [&](auto productId, auto blueprintId) {
+            const auto blueprint = productBlueprints.find(productId);
+            return blueprint != std::end(productBlueprints) && blueprint->second == blueprintId;
+        };
+
+        query.prepare(QStringLiteral(R"(
+SELECT p.productTypeID, m.typeID, m.materialTypeID, m.quantity FROM industryActivityMaterials m
+    INNER JOIN industryActivityProducts p
+        ON m.typeID = p.typeID AND m.activityID = p.activityID
+    WHERE p.activityID = ?
+        )"));
+        query.addBindValue(manufacturingActivityId);
+
+        DatabaseUtils::execQuery(query);
+
+        std::unordered_map<EveType::IdType, std::unordered_set<EveType::IdType>> usedMaterials;
+        while (query.next())
+        {
+            const auto productId = query.value(0).value<EveType::IdType>();
+            if (!isProductBlueprint(productId, query.value(1).value<EveType::IdType>()))
+                continue;
+
+            const auto materialId = query.value(2).value<EveType::IdType>();
+            if (!usedMaterials[productId].emplace(materialId).second)
+                continue;
+
+            mManufacturingInfo[productId].mMaterials.emplace_back(EveDataProvider::MaterialInfo{materialId, query.value(3).toUInt()});
+        }
+
+        query.prepare(QStringLiteral(R"(
+SELECT p.productTypeID, s.typeID, s.skillID FROM industryActivitySkills s
+    INNER JOIN industryActivityProducts p
+        ON s.typeID = p.typeID AND s.activityID = p.activityID
+    WHERE p.activityID = ?
+        )"));
+        query.addBindValue(manufacturingActivityId);
+
+        DatabaseUtils::execQuery(query);
+
+        while (query.next())
+        {
+            const auto productId = query.value(0).value<EveType::IdType>();
+            if (!isProductBlueprint(productId, query.value(1).value<EveType::IdType>()))
+                continue;
+
+            const auto skillId = query.value(2).toUInt();
+            if (skillId != EveDataProvider::industrySkillId && skillId != EveDataProvider::advancedIndustrySkillId)
+                mManufacturingInfo[productId].mAdditionalsSkills.insert(skillId);
+        }
+
+        query.prepare(QStringLiteral(R"(
+SELECT m.typeID, m.materialTypeID, m.quantity, t.portionSize, t.groupID, g.groupName FROM invTypeMaterials m
+    INNER JOIN invTypes t
+        ON t.typeID = m.typeID
+    INNER JOIN invGroups g
+        ON g.groupID = t.groupID
+    WHERE t.marketGroupID IS NOT NULL
+        )"));
+
+        DatabaseUtils::execQuery(query);
+
+        while (query.next())
+        {
+            const auto typeId = query.value(0).value<EveType::IdType>();
+            const EveDataProvider::MaterialInfo material{query.value(1).value<EveType::IdType>(), query.value(2).toUInt()};
+
+            const auto fillInfo = [&](auto &info) {
+                info.mPortionSize = query.value(3).toUInt();
+                info.mGroupId = query.value(4).toUInt();
+                info.mMaterials.emplace_back(material);
+            };
+
+            fillInfo(mReprocessingInfo[typeId]);
+
+            if (oreGroupNames.contains(query.value(5).toString()))
+                fillInfo(mOreReprocessingInfo[typeId]);
+        }
+
+        qDebug() << "Built industry data for" << mManufacturingInfo.size() << "products and"
+                 << mReprocessingInfo.size() << "reprocessable types in" << timer.elapsed() << "ms.";
+    }
+
+    bool IndustryDataTable::load(const QString &fileName, const QString &sdeVersion)
+    {
+        clear();
+
+        QFile file{fileName};
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        QDataStream stream{&file};
+        stream.setVersion(QDataStream::Qt_5_12);
+
+        quint32 magic = 0, version = 0;
+        stream >> magic >> version;
+
+        if (magic != fileMagic || version != fileVersion)
+        {
+            qDebug() << "Ignoring industry data with unknown format:" << fileName;
+            return false;
+        }
+
+        QString fileSdeVersion;
+        stream >> fileSdeVersion;
+
+        if (fileSdeVersion != sdeVersion)
+        {
+            qDebug() << "Ignoring industry data for SDE version" << fileSdeVersion;
+            return false;
+        }
+
+        quint32 productCount = 0;
+        stream >> productCount;
+
+        mManufacturingInfo.reserve(productCount);
+        for (auto i = 0u; i < productCount && stream.status() == QDataStream::Ok; ++i)
+        {
+            quint32 productId = 0, quantity = 0, time = 0, materialCount = 0, skillCount = 0;
+            stream >> productId >> quantity >> time >> materialCount;
+
+            auto &info = mManufacturingInfo[productId];
+            info.mQuantity = quantity;
+            info.mTime = std::chrono::seconds{time};
+
+            info.mMaterials.reserve(materialCount);
+            for (auto j = 0u; j < materialCount; ++j)
+            {
+                quint32 materialId = 0, materialQuantity = 0;
+                stream >> materialId >> materialQuantity;
+
+                info.mMaterials.emplace_back(EveDataProvider::MaterialInfo{materialId, materialQuantity});
+            }
+
+            stream >> skillCount;
+            for (auto j = 0u; j < skillCount; ++j)
+            {
+                quint32 skillId = 0;
+                stream >> skillId;
+
+                info.mAdditionalsSkills.insert(skillId);
+            }
+        }
+
+        quint32 blueprintCount = 0;
+        stream >> blueprintCount;
+
+        mBlueprintOutputs.reserve(blueprintCount);
+        for (auto i = 0u; i < blueprintCount && stream.status() == QDataStream::Ok; ++i)
+        {
+            quint32 blueprintId = 0, productId = 0;
+            stream >> blueprintId >> productId;
+
+            mBlueprintOutputs.emplace(blueprintId, productId);
+        }
+
+        readReprocessingMap(stream, mReprocessingInfo);
+        readReprocessingMap(stream, mOreReprocessingInfo);
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            qWarning() << "Corrupted industry data:" << fileName;
+            clear();
+            return false;
+        }
+
+        qDebug() << "Loaded industry data for" << mManufacturingInfo.size() << "products.";
+        return true;
+    }
+
+    bool IndustryDataTable::save(const QString &fileName, const QString &sdeVersion) const
+    {
+        // a half-written table would be picked up on next start, so replace it only when complete
+        QSaveFile file{fileName};
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        QDataStream stream{&file};
+        stream.setVersion(QDataStream::Qt_5_12);
+
+        stream << fileMagic << fileVersion << sdeVersion;
+
+        stream << static_cast<quint32>(mManufacturingInfo.size());
+        for (const auto &info : mManufacturingInfo)
+        {
+            stream << static_cast<quint32>(info.first)
+                   << static_cast<quint32>(info.second.mQuantity)
+                   << static_cast<quint32>(info.second.mTime.count());
+
+            stream << static_cast<quint32>(info.second.mMaterials.size());
+            for (const auto &material : info.second.mMaterials)
+                stream << static_cast<quint32>(material.mMaterialId) << static_cast<quint32>(material.mQuantity);
+
+            stream << static_cast<quint32>(info.second.mAdditionalsSkills.size());
+            for (const auto skill : info.second.mAdditionalsSkills)
+                stream << static_cast<quint32>(skill);
+        }
+
+        stream << static_cast<quint32>(mBlueprintOutputs.size());
+        for (const auto &output : mBlueprintOutputs)
+            stream << static_cast<quint32>(output.first) << static_cast<quint32>(output.second);
+
+        writeReprocessingMap(stream, mReprocessingInfo);
+        writeReprocessingMap(stream, mOreReprocessingInfo);
+
+        return stream.status() == QDataStream::Ok && file.commit();
+    }
+
+    const IndustryDataTable::ManufacturingInfo &IndustryDataTable::getManufacturingInfo(EveType::IdType typeId) const noexcept
+    {
+        static const ManufacturingInfo emptyInfo{0, std::chrono::seconds{0}, {}, {}};
+
+        const auto info = mManufacturingInfo.find(typeId);
+        return (info == std::end(mManufacturingInfo)) ? (emptyInfo) : (info->second);
+    }
+
+    EveType::IdType IndustryDataTable::getBlueprintOutputType(EveType::IdType blueprintId) const noexcept
+    {
+        const auto output = mBlueprintOutputs.find(blueprintId);
+        return (output == std::end(mBlueprintOutputs)) ? (EveType::invalidId) : (output->second);
+    }
+
+    const IndustryDataTable::ReprocessingMap &IndustryDataTable::getReprocessingInfo() const noexcept
+    {
+        return mReprocessingInfo;
+    }
+
+    const IndustryDataTable::ReprocessingMap &IndustryDataTable::getOreReprocessingInfo() const noexcept
+    {
+        return mOreReprocessingInfo;
+    }
+
+    void IndustryDataTable::clear()
+    {
+        mManufacturingInfo.clear();
+        mBlueprintOutputs.clear();
+        mReprocessingInfo.clear();
+        mOreReprocessingInfo.clear();
+    }
+
+    void IndustryDataTable::writeReprocessingMap(QDataStream &stream, const ReprocessingMap &map)
+    {
+        stream << static_cast<quint32>(map.size());
+        for (const auto &info : map)
+        {
+            stream << static_cast<quint32>(info.first)
+                   << static_cast<quint32>(info.second.mPortionSize)
+                   << static_cast<quint32>(info.second.mGroupId);
+
+            stream << static_cast<quint32>(info.second.mMaterials.size());
+            for (const auto &material : info.second.mMaterials)
+                stream << static_cast<quint32>(material.mMaterialId) << static_cast<quint32>(material.mQuantity);
+        }
+    }
+
+    void IndustryDataTable::readReprocessingMap(QDataStream &stream, ReprocessingMap &map)
+    {
+        quint32 count = 0;
+        stream >> count;
+
+        map.reserve(count);
+        for (auto i = 0u; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            quint32 typeId = 0, portionSize = 0, groupId = 0, materialCount = 0;
+            stream >> typeId >> portionSize >> groupId >> materialCount;
+
+            auto &info = map[typeId];
+            info.mPortionSize = portionSize;
+            info.mGroupId = groupId;
+
+            info.mMaterials.reserve(materialCount);
+            for (auto j = 0u; j < materialCount; ++j)
+            {
+                quint32 materialId = 0, quantity = 0;
+                stream >> materialId >> quantity;
+
+                info.mMaterials.emplace_back(EveDataProvider::MaterialInfo{materialId, quantity});
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+
+#include <QStringList>
+
+#include "EveDataProvider.h"
+
+class QSqlDatabase;
+class QDataStream;
+
+namespace Evernus
+{
+    // manufacturing and reprocessing graphs for the whole SDE, filled with a handful of bulk queries
+    // once built or loaded, the table is read-only, so lookups don't need any locking
+    class IndustryDataTable final
+    {
+    public:
+        using ManufacturingInfo = EveDataProvider::ManufacturingInfo;
+        using ReprocessingMap = EveDataProvider::ReprocessingMap;
+
+        IndustryDataTable() = default;
+        IndustryDataTable(const IndustryDataTable &) = delete;
+        IndustryDataTable(IndustryDataTable &&) = delete;
+        ~IndustryDataTable() = default;
+
+        void build(const QSqlDatabase &db, uint manufacturingActivityId, const QStringList &oreGroupNames);
+
+        bool load(const QString &fileName, const QString &sdeVersion);
+        bool save(const QString &fileName, const QString &sdeVersion) const;
+
+        // empty info for types which can't be manufactured
+        const ManufacturingInfo &getManufacturingInfo(EveType::IdType typeId) const noexcept;
+        EveType::IdType getBlueprintOutputType(EveType::IdType blueprintId) const noexcept;
+
+        const ReprocessingMap &getReprocessingInfo() const noexcept;
+        const ReprocessingMap &getOreReprocessingInfo() const noexcept;
+
+        IndustryDataTable &operator =(const IndustryDataTable &) = delete;
+        IndustryDataTable &operator =(IndustryDataTable &&) = delete;
+
+    private:
+        static constexpr quint32 fileMagic = 0x45494e44; // EIND - Evernus INDustry
+        static constexpr quint32 fileVersion = 1;
+
+        std::unordered_map<EveType::IdType, ManufacturingInfo> mManufacturingInfo;
+        std::unordered_map<EveType::IdType, EveType::IdType> mBlueprintOutputs;
+
+        ReprocessingMap mReprocessingInfo;
+        ReprocessingMap mOreReprocessingInfo;
+
+        void clear();
+
+        static void writeReprocessingMap(QDataStream &stream, const ReprocessingMap &map);
+        static void readReprocessingMap(QDataStream &stream, ReprocessingMap &map);
+    };
+}
@@ -133,7 +133,15 @@ namespace Evernus
         mInterRegionDataStack = new QStackedWidget{this};
         mainLayout->addWidget(mInterRegionDataStack);
 
-        mInterRegionDataStack->addWidget(new CalculatingDataWidget{this});
+        mCalculatingDataWidget = new CalculatingDataWidget{this};
+        mInterRegionDataStack->addWidget(mCalculatingDataWidget);
+        mCalculatingDataWidget->setCancellable(true);
+        connect(mCalculatingDataWidget, &CalculatingDataWidget::cancelled, this, &InterRegionAnalysisWidget::cancelCalculation);
+
+        connect(&mInterRegionDataModel, &InterRegionMarketDataModel::calculationProgress,
+                mCalculatingDataWidget, &CalculatingDataWidget::setProgress);
+        connect(&mInterRegionDataModel, &InterRegionMarketDataModel::calculationFinished,
+                this, &InterRegionAnalysisWidget::showCalculatedData);
 
         mInterRegionViewProxy.setSortRole(Qt::UserRole);
         mInterRegionViewProxy.setSourceModel(&mInterRegionDataModel);
@@ -194,11 +202,6 @@ namespace Evernus
         mRefreshedInterRegionData = false;
     }
 
-    void InterRegionAnalysisWidget::clearData()
-    {
-        mInterRegionDataModel.reset();
-    }
-
     void InterRegionAnalysisWidget::applyInterRegionFilter()
     {
         const auto srcRegions = mSelectWidget->getSrcSelectedRegionList();
@@ -227,11 +230,8 @@ namespace Evernus
 
         mInterRegionTypeDataView->horizontalHeader()->resizeSections(QHeaderView::ResizeToContents);
 
-        if (!mRefreshedInterRegionData)
-        {
-            mInterRegionDataStack->setCurrentWidget(mInterRegionTypeDataView);
-            mRefreshedInterRegionData = true;
-        }
+        // data view is shown when the calculation finishes
+        mRefreshedInterRegionData = true;
     }
 
     void InterRegionAnalysisWidget::showDetails(const QModelIndex &item)
@@ -290,6 +290,19 @@ namespace Evernus
             return;
 
         recalculateInterRegionData();
+    }
+
+    void InterRegionAnalysisWidget::showCalculatedData()
+    {
+        mInterRegionTypeDataView->horizontalHeader()->resizeSections(QHeaderView::ResizeToContents);
+        mInterRegionDataStack->setCurrentWidget(mInterRegionTypeDataView);
+    }
+
+    void InterRegionAnalysisWidget::cancelCalculation()
+    {
+        mInterRegionDataModel.cancelCalculation();
+        mRefreshedInterRegionData = false;
+
         mInterRegionDataStack->setCurrentWidget(mInterRegionTypeDataView);
     }
 
@@ -309,12 +322,12 @@ namespace Evernus
         if (history == nullptr)
             return;
 
-        const auto orders = mMarketDataProvider.getOrders();
+        const auto orders = mMarketDataProvider.getOrderBook();
         if (orders == nullptr)
             return;
 
+        mCalculatingDataWidget->setProgress(0, 0);
         mInterRegionDataStack->setCurrentIndex(waitingLabelIndex);
-        mInterRegionDataStack->repaint();
 
         mInterRegionDataModel.setOrderData(*orders,
                                            *history,
@@ -34,6 +34,7 @@ class QLineEdit;
 namespace Evernus
 {
     class SourceDestinationSelectWidget;
+    class CalculatingDataWidget;
     class RegionStationPresetRepository;
     class AdjustableTableView;
     class MarketDataProvider;
@@ -60,7 +61,8 @@ namespace Evernus
 
         void recalculateAllData();
         void completeImport();
-        void clearData();
+        // current rows stay until the next recalculation replaces them
+        void cancelCalculation();
 
     signals:
         void preferencesChanged();
@@ -75,6 +77,8 @@ namespace Evernus
 
         void changeStations(const QVariantList &srcPath, const QVariantList &dstPath);
 
+        void showCalculatedData();
+
     private:
         static const auto waitingLabelIndex = 0;
 
@@ -89,6 +93,7 @@ namespace Evernus
         QLineEdit *mMinInterRegionMarginEdit = nullptr;
         QLineEdit *mMaxInterRegionMarginEdit = nullptr;
         QStackedWidget *mInterRegionDataStack = nullptr;
+        CalculatingDataWidget *mCalculatingDataWidget = nullptr;
         AdjustableTableView *mInterRegionTypeDataView = nullptr;
 
         InterRegionMarketDataModel mInterRegionDataModel;
@@ -12,10 +12,17 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <set>
-
-#include <QEventLoop>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <atomic>
+
+#include <QElapsedTimer>
+#include <QtConcurrent>
 #include <QSettings>
+#include <QtDebug>
 #include <QLocale>
 #include <QColor>
 #include <QIcon>
@@ -27,7 +34,7 @@
 
 #include "MarketAnalysisSettings.h"
 #include "EveDataProvider.h"
-#include "ExternalOrder.h"
+#include "ExternalOrderBook.h"
 #include "PriceUtils.h"
 #include "MathUtils.h"
 #include "TextUtils.h"
@@ -38,11 +45,33 @@ using namespace boost::accumulators;
 
 namespace Evernus
 {
+    struct InterRegionMarketDataModel::CalculationParams
+    {
+        quint64 mSrcStation = 0;
+        quint64 mDstStation = 0;
+        uint mSrcRegionId = 0;
+        uint mDstRegionId = 0;
+        bool mDiscardBogusOrders = true;
+        double mBogusOrderThreshold = 0.9;
+        bool mUseSkillsForDifference = false;
+        PriceUtils::Taxes mTaxes;
+    };
+
     InterRegionMarketDataModel::InterRegionMarketDataModel(const EveDataProvider &dataProvider, QObject *parent)
-        : QAbstractTableModel{parent}
+        : IncrementalItemModel{parent}
         , ModelWithTypes{}
         , mDataProvider{dataProvider}
     {
+        // single thread drives the calculation, the actual work goes to the global pool
+        mCalculationPool.setMaxThreadCount(1);
+
+        connect(&mCalculationWatcher, &QFutureWatcher<CalculationResult>::finished,
+                this, &InterRegionMarketDataModel::applyCalculatedData);
+    }
+
+    InterRegionMarketDataModel::~InterRegionMarketDataModel()
+    {
+        cancelCalculation();
     }
 
     int InterRegionMarketDataModel::columnCount(const QModelIndex &parent) const
@@ -190,178 +219,65 @@ namespace Evernus
         return (parent.isValid()) ? (0) : (static_cast<int>(mData.size()));
     }
 
-    void InterRegionMarketDataModel::setOrderData(const std::vector<ExternalOrder> &orders,
+    void InterRegionMarketDataModel::setOrderData(const ExternalOrderBook &orders,
                                                   const HistoryRegionMap &history,
                                                   quint64 srcStation,
                                                   quint64 dstStation,
                                                   PriceType srcType,
                                                   PriceType dstType)
     {
-        beginResetModel();
-
-        mData.clear();
-
-        mSrcPriceType = srcType;
-        mDstPriceType = dstType;
-
-        RegionMap<TypeMap<std::multiset<std::reference_wrapper<const ExternalOrder>, ExternalOrder::LowToHigh>>> sellOrders;
-        RegionMap<TypeMap<std::multiset<std::reference_wrapper<const ExternalOrder>, ExternalOrder::HighToLow>>> buyOrders;
-
-        RegionMap<TypeMap<quint64>> sellVolumes, buyVolumes;
+        cancelCalculation();
 
-        QEventLoop loop;
-
-        const auto srcRegionId = (srcStation == 0) ? (0u) : (mDataProvider.getStationRegionId(srcStation));
-        const auto dstRegionId = (dstStation == 0) ? (0u) : (mDataProvider.getStationRegionId(dstStation));
-
-        for (const auto &order : orders)
+        // current rows stay until new ones are ready, unless price columns switch meaning
+        if (mSrcPriceType != srcType || mDstPriceType != dstType)
         {
-            const auto typeId = order.getTypeId();
-            const auto regionId = order.getRegionId();
-            const auto stationId = order.getStationId();
-
-            if ((srcRegionId != 0 && srcRegionId == regionId && stationId != srcStation) ||
-                (dstRegionId != 0 && dstRegionId == regionId && stationId != dstStation))
-            {
-                continue;
-            }
-
-            if (order.getType() == ExternalOrder::Type::Buy)
-            {
-                buyOrders[regionId][typeId].insert(std::cref(order));
-                buyVolumes[regionId][typeId] += order.getVolumeRemaining();
-            }
-            else
-            {
-                sellOrders[regionId][typeId].insert(std::cref(order));
-                sellVolumes[regionId][typeId] += order.getVolumeRemaining();
-            }
+            beginResetModel();
 
-            loop.processEvents(QEventLoop::ExcludeUserInputEvents);
-        }
-
-        const auto historyLimit = QDate::currentDate().addDays(-30);
-
-        struct AggrTypeData
-        {
-            double mBuyPrice = 0.;
-            double mSellPrice = 0.;
-            quint64 mVolume = 0;
-            quint64 mBuyOrderCount = 0;
-            quint64 mSellOrderCount = 0;
-        };
-
-        RegionMap<TypeMap<AggrTypeData>> aggrTypeData;
-
-        for (const auto regionHistory : history)
-        {
-            for (const auto type : regionHistory.second)
-            {
-                AggrTypeData data;
-
-                accumulator_set<double, stats<tag::mean>> priceAcc;
-
-                for (const auto &timePoint : boost::adaptors::reverse(type.second))
-                {
-                    if (Q_UNLIKELY(timePoint.first < historyLimit))
-                        break;
-
-                    data.mVolume += timePoint.second.mVolume;
-                    priceAcc(timePoint.second.mAvgPrice);
-                }
-
-                const auto avgPrice30 = mean(priceAcc);
+            mData.clear();
 
-                const auto &typeBuyOrders = buyOrders[regionHistory.first][type.first];
-                const auto &typeSellOrders = sellOrders[regionHistory.first][type.first];
+            mSrcPriceType = srcType;
+            mDstPriceType = dstType;
 
-                data.mVolume /= 30;
-                data.mBuyOrderCount = typeBuyOrders.size();
-                data.mSellOrderCount = typeSellOrders.size();
-                data.mBuyPrice = MathUtils::calcPercentile(typeBuyOrders,
-                                                           buyVolumes[regionHistory.first][type.first] * 0.05,
-                                                           avgPrice30,
-                                                           mDiscardBogusOrders,
-                                                           mBogusOrderThreshold);
-                data.mSellPrice = MathUtils::calcPercentile(typeSellOrders,
-                                                            sellVolumes[regionHistory.first][type.first] * 0.05,
-                                                            avgPrice30,
-                                                            mDiscardBogusOrders,
-                                                            mBogusOrderThreshold);
-
-                aggrTypeData[regionHistory.first].emplace(type.first, std::move(data));
-
-                loop.processEvents(QEventLoop::ExcludeUserInputEvents);
-            }
+            endResetModel();
         }
 
-        PriceUtils::Taxes taxes;
+        CalculationParams params;
+        params.mSrcStation = srcStation;
+        params.mDstStation = dstStation;
+        params.mSrcRegionId = (srcStation == 0) ? (0u) : (mDataProvider.getStationRegionId(srcStation));
+        params.mDstRegionId = (dstStation == 0) ? (0u) : (mDataProvider.getStationRegionId(dstStation));
+        params.mDiscardBogusOrders = mDiscardBogusOrders;
+        params.mBogusOrderThreshold = mBogusOrderThreshold;
 
         QSettings settings;
-        const auto useSkillsForDifference = mCharacter && settings.value(
+        params.mUseSkillsForDifference = mCharacter && settings.value(
             MarketAnalysisSettings::useSkillsForDifferenceKey, MarketAnalysisSettings::useSkillsForDifferenceDefault).toBool();
 
-        if (useSkillsForDifference)
-            taxes = PriceUtils::calculateTaxes(*mCharacter);
-
-        for (const auto srcRegion : aggrTypeData)
-        {
-            if (srcRegionId != 0 && srcRegion.first != srcRegionId)
-                continue;
+        if (params.mUseSkillsForDifference)
+            params.mTaxes = PriceUtils::calculateTaxes(*mCharacter);
 
-            for (const auto type : srcRegion.second)
-            {
-                for (const auto dstRegion : aggrTypeData)
-                {
-                    if ((dstRegionId != 0 && dstRegion.first != dstRegionId) || (dstRegion.first == srcRegion.first))
-                        continue;
+        const auto generation = ++mCalculationGeneration;
 
-                    const auto dstData = dstRegion.second.find(type.first);
-                    if (Q_UNLIKELY(dstData == std::end(dstRegion.second)))
-                        continue;
-
-                    // if we're buying from sell orders, we need to either have at least one, or have an average (will be strictly 0.)
-                    if (Q_UNLIKELY(srcType == PriceType::Sell && type.second.mBuyPrice == 0.))
-                        continue;
-
-                    TypeData data;
-                    data.mId = type.first;
-                    data.mSrcBuyPrice = type.second.mBuyPrice;
-                    data.mSrcSellPrice = type.second.mSellPrice;
-                    data.mSrcBuyOrderCount = type.second.mBuyOrderCount;
-                    data.mSrcSellOrderCount = type.second.mSellOrderCount;
-                    data.mDstBuyPrice = dstData->second.mBuyPrice;
-                    data.mDstSellPrice = dstData->second.mSellPrice;
-                    data.mDstBuyOrderCount = dstData->second.mBuyOrderCount;
-                    data.mDstSellOrderCount = dstData->second.mSellOrderCount;
-                    data.mVolume = std::min(type.second.mVolume, dstData->second.mVolume);
-                    data.mSrcRegion = srcRegion.first;
-                    data.mDstRegion = dstRegion.first;
-
-                    auto realSellPrice = getDstPrice(data);
-                    auto realBuyPrice = getSrcPrice(data);
+        mCancelCalculation = false;
+        mCalculationWatcher.setFuture(QtConcurrent::run(&mCalculationPool, [=, &orders, &history] {
+            auto result = calculateData(orders, history, params);
+            result.mGeneration = generation;
 
-                    if (useSkillsForDifference)
-                    {
-                        realSellPrice = (mDstPriceType == PriceType::Buy) ? (PriceUtils::getSellPrice(realSellPrice, taxes, false)) : (PriceUtils::getSellPrice(realSellPrice, taxes));
-                        realBuyPrice = (mSrcPriceType == PriceType::Buy) ? (PriceUtils::getBuyPrice(realBuyPrice, taxes)) : (PriceUtils::getBuyPrice(realBuyPrice, taxes, false));
-                    }
-
-                    data.mDifference = realSellPrice - realBuyPrice;
-                    data.mMargin = (qFuzzyIsNull(realSellPrice)) ? (0.) : (100. * data.mDifference / realSellPrice);
-
-                    mData.emplace_back(std::move(data));
-
-                    loop.processEvents(QEventLoop::ExcludeUserInputEvents);
-                }
-            }
-        }
+            return result;
+        }));
+    }
 
-        endResetModel();
+    void InterRegionMarketDataModel::cancelCalculation()
+    {
+        mCancelCalculation = true;
+        mCalculationWatcher.waitForFinished();
     }
 
     void InterRegionMarketDataModel::setCharacter(const std::shared_ptr<Character> &character)
     {
+        cancelCalculation();
+        ++mCalculationGeneration;
+
         beginResetModel();
         mCharacter = character;
         mData.clear();
@@ -409,6 +325,9 @@ namespace Evernus
 
     void InterRegionMarketDataModel::reset()
     {
+        cancelCalculation();
+        ++mCalculationGeneration;
+
         beginResetModel();
         mData.clear();
         endResetModel();
@@ -434,6 +353,221 @@ namespace Evernus
         return marginColumn;
     }
 
+    void InterRegionMarketDataModel::applyCalculatedData()
+    {
+        // cancelling doesn't discard data which managed to finish - only newer data does
+        auto result = mCalculationWatcher.result();
+        if (!result.mComplete || result.mGeneration != mCalculationGeneration)
+            return;
+
+        updateRows(mData, std::move(result.mData), [](const auto &data) {
+            return std::make_pair(data.mId, (static_cast<quint64>(data.mSrcRegion) << 32) | data.mDstRegion);
+        }, std::equal_to<>{});
+
+        emit calculationFinished();
+    }
+
+    InterRegionMarketDataModel::CalculationResult InterRegionMarketDataModel
+    ::calculateData(const ExternalOrderBook &orders, const HistoryRegionMap &history, const CalculationParams &params)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto isExcluded = [&](const auto &order) {
+            const auto regionId = order.getRegionId();
+            const auto stationId = order.getStationId();
+
+            return (params.mSrcRegionId != 0 && params.mSrcRegionId == regionId && stationId != params.mSrcStation) ||
+                   (params.mDstRegionId != 0 && params.mDstRegionId == regionId && stationId != params.mDstStation);
+        };
+
+        const auto historyLimit = QDate::currentDate().addDays(-30);
+
+        struct RegionData
+        {
+            uint mRegionId = 0;
+            const HistoryTypeMap *mHistory = nullptr;
+            TypeMap<AggrTypeData> mTypes;
+        };
+
+        std::vector<RegionData> regions;
+        regions.reserve(history.size());
+
+        for (const auto &regionHistory : history)
+        {
+            RegionData region;
+            region.mRegionId = regionHistory.first;
+            region.mHistory = &regionHistory.second;
+
+            regions.emplace_back(std::move(region));
+        }
+
+        // every region is visited twice - once for aggregation and once as a source for pairing
+        const auto totalSteps = static_cast<int>(regions.size() * 2);
+        std::atomic_int doneSteps{0};
+
+        const auto reportStep = [&] {
+            emit calculationProgress(++doneSteps, totalSteps);
+        };
+
+        // regions are independent of each other, so aggregate them in parallel
+        QtConcurrent::blockingMap(regions, [&](auto &region) {
+            const auto regionId = region.mRegionId;
+            const auto filterStations = (params.mSrcRegionId != 0 && params.mSrcRegionId == regionId) ||
+                                        (params.mDstRegionId != 0 && params.mDstRegionId == regionId);
+
+            std::vector<ExternalOrderBook::OrderRef> filteredBuyOrders, filteredSellOrders;
+
+            region.mTypes.reserve(region.mHistory->size());
+
+            for (const auto &type : *region.mHistory)
+            {
+                if (Q_UNLIKELY(mCancelCalculation))
+                    return;
+
+                AggrTypeData data;
+
+                accumulator_set<double, stats<tag::mean>> priceAcc;
+
+                for (const auto &timePoint : boost::adaptors::reverse(type.second))
+                {
+                    if (Q_UNLIKELY(timePoint.first < historyLimit))
+                        break;
+
+                    data.mVolume += timePoint.second.mVolume;
+                    priceAcc(timePoint.second.mAvgPrice);
+                }
+
+                const auto avgPrice30 = mean(priceAcc);
+
+                const auto fillPrices = [&](const auto &typeBuyOrders, const auto &typeSellOrders) {
+                    data.mBuyOrderCount = typeBuyOrders.size();
+                    data.mSellOrderCount = typeSellOrders.size();
+                    data.mBuyPrice = MathUtils::calcPercentile(typeBuyOrders,
+                                                               MathUtils::calcTotalVolume(typeBuyOrders) * 0.05,
+                                                               avgPrice30,
+                                                               params.mDiscardBogusOrders,
+                                                               params.mBogusOrderThreshold);
+                    data.mSellPrice = MathUtils::calcPercentile(typeSellOrders,
+                                                                MathUtils::calcTotalVolume(typeSellOrders) * 0.05,
+                                                                avgPrice30,
+                                                                params.mDiscardBogusOrders,
+                                                                params.mBogusOrderThreshold);
+                };
+
+                const auto typeBuyOrders = orders.getOrders(type.first, PriceType::Buy, regionId);
+                const auto typeSellOrders = orders.getOrders(type.first, PriceType::Sell, regionId);
+
+                if (filterStations)
+                {
+                    filteredBuyOrders.clear();
+                    filteredSellOrders.clear();
+
+                    std::remove_copy_if(std::begin(typeBuyOrders), std::end(typeBuyOrders), std::back_inserter(filteredBuyOrders), isExcluded);
+                    std::remove_copy_if(std::begin(typeSellOrders), std::end(typeSellOrders), std::back_inserter(filteredSellOrders), isExcluded);
+
+                    fillPrices(filteredBuyOrders, filteredSellOrders);
+                }
+                else
+                {
+                    fillPrices(typeBuyOrders, typeSellOrders);
+                }
+
+                data.mVolume /= 30;
+
+                region.mTypes.emplace(type.first, std::move(data));
+            }
+
+            reportStep();
+        });
+
+        if (mCancelCalculation)
+            return {};
+
+        // pairing is quadratic in regions, so split it by source region
+        std::vector<std::vector<TypeData>> pairs(regions.size());
+        std::vector<std::size_t> srcIndexes(regions.size());
+        std::iota(std::begin(srcIndexes), std::end(srcIndexes), 0);
+
+        QtConcurrent::blockingMap(srcIndexes, [&](auto srcIndex) {
+            const auto &srcRegion = regions[srcIndex];
+            if (params.mSrcRegionId != 0 && srcRegion.mRegionId != params.mSrcRegionId)
+            {
+                reportStep();
+                return;
+            }
+
+            auto &result = pairs[srcIndex];
+
+            for (const auto &type : srcRegion.mTypes)
+            {
+                if (Q_UNLIKELY(mCancelCalculation))
+                    return;
+
+                // if we're buying from sell orders, we need to either have at least one, or have an average (will be strictly 0.)
+                if (Q_UNLIKELY(mSrcPriceType == PriceType::Sell && type.second.mBuyPrice == 0.))
+                    continue;
+
+                for (const auto &dstRegion : regions)
+                {
+                    if ((params.mDstRegionId != 0 && dstRegion.mRegionId != params.mDstRegionId) || (dstRegion.mRegionId == srcRegion.mRegionId))
+                        continue;
+
+                    const auto dstData = dstRegion.mTypes.find(type.first);
+                    if (Q_UNLIKELY(dstData == std::end(dstRegion.mTypes)))
+                        continue;
+
+                    TypeData data;
+                    data.mId = type.first;
+                    data.mSrcBuyPrice = type.second.mBuyPrice;
+                    data.mSrcSellPrice = type.second.mSellPrice;
+                    data.mSrcBuyOrderCount = type.second.mBuyOrderCount;
+                    data.mSrcSellOrderCount = type.second.mSellOrderCount;
+                    data.mDstBuyPrice = dstData->second.mBuyPrice;
+                    data.mDstSellPrice = dstData->second.mSellPrice;
+                    data.mDstBuyOrderCount = dstData->second.mBuyOrderCount;
+                    data.mDstSellOrderCount = dstData->second.mSellOrderCount;
+                    data.mVolume = std::min(type.second.mVolume, dstData->second.mVolume);
+                    data.mSrcRegion = srcRegion.mRegionId;
+                    data.mDstRegion = dstRegion.mRegionId;
+
+                    auto realSellPrice = getDstPrice(data);
+                    auto realBuyPrice = getSrcPrice(data);
+
+                    if (params.mUseSkillsForDifference)
+                    {
+                        realSellPrice = (mDstPriceType == PriceType::Buy) ? (PriceUtils::getSellPrice(realSellPrice, params.mTaxes, false)) : (PriceUtils::getSellPrice(realSellPrice, params.mTaxes));
+                        realBuyPrice = (mSrcPriceType == PriceType::Buy) ? (PriceUtils::getBuyPrice(realBuyPrice, params.mTaxes)) : (PriceUtils::getBuyPrice(realBuyPrice, params.mTaxes, false));
+                    }
+
+                    data.mDifference = realSellPrice - realBuyPrice;
+                    data.mMargin = (qFuzzyIsNull(realSellPrice)) ? (0.) : (100. * data.mDifference / realSellPrice);
+
+                    result.emplace_back(std::move(data));
+                }
+            }
+
+            reportStep();
+        });
+
+        if (mCancelCalculation)
+            return {};
+
+        CalculationResult result;
+        result.mData.reserve(std::accumulate(std::begin(pairs), std::end(pairs), std::size_t{0}, [](auto total, const auto &regionPairs) {
+            return total + regionPairs.size();
+        }));
+
+        for (auto &regionPairs : pairs)
+            std::move(std::begin(regionPairs), std::end(regionPairs), std::back_inserter(result.mData));
+
+        result.mComplete = true;
+
+        qDebug() << "Inter-region data for" << regions.size() << "regions," << result.mData.size() << "pairs in" << timer.elapsed() << "ms.";
+
+        return result;
+    }
+
     double InterRegionMarketDataModel::getSrcPrice(const TypeData &data) const noexcept
     {
         return (mSrcPriceType == PriceType::Buy) ? (data.mSrcBuyPrice) : (data.mSrcSellPrice);
@@ -443,4 +577,22 @@ namespace Evernus
     {
         return (mDstPriceType == PriceType::Buy) ? (data.mDstBuyPrice) : (data.mDstSellPrice);
     }
+
+    bool InterRegionMarketDataModel::TypeData::operator ==(const TypeData &other) const noexcept
+    {
+        return mId == other.mId &&
+               mSrcBuyPrice == other.mSrcBuyPrice &&
+               mSrcSellPrice == other.mSrcSellPrice &&
+               mDstBuyPrice == other.mDstBuyPrice &&
+               mDstSellPrice == other.mDstSellPrice &&
+               mDifference == other.mDifference &&
+               mVolume == other.mVolume &&
+               mSrcRegion == other.mSrcRegion &&
+               mDstRegion == other.mDstRegion &&
+               mMargin == other.mMargin &&
+               mSrcBuyOrderCount == other.mSrcBuyOrderCount &&
+               mSrcSellOrderCount == other.mSrcSellOrderCount &&
+               mDstBuyOrderCount == other.mDstBuyOrderCount &&
+               mDstSellOrderCount == other.mDstSellOrderCount;
+    }
 }
@@ -16,12 +16,16 @@
 
 #include <unordered_map>
 #include <memory>
+#include <atomic>
 #include <vector>
 #include <map>
 
 #include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QThreadPool>
 #include <QDate>
 
+#include "IncrementalItemModel.h"
 #include "ModelWithTypes.h"
 #include "MarketHistory.h"
 #include "Character.h"
@@ -33,10 +37,10 @@ class QColor;
 namespace Evernus
 {
     class EveDataProvider;
-    class ExternalOrder;
+    class ExternalOrderBook;
 
     class InterRegionMarketDataModel
-        : public QAbstractTableModel
+        : public IncrementalItemModel<QAbstractTableModel>
         , public ModelWithTypes
     {
         Q_OBJECT
@@ -50,19 +54,21 @@ namespace Evernus
         using HistoryRegionMap = RegionMap<HistoryTypeMap>;
 
         explicit InterRegionMarketDataModel(const EveDataProvider &dataProvider, QObject *parent = nullptr);
-        virtual ~InterRegionMarketDataModel() = default;
+        virtual ~InterRegionMarketDataModel();
 
         virtual int columnCount(const QModelIndex &parent = QModelIndex{}) const override;
         virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
         virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
         virtual int rowCount(const QModelIndex &parent = QModelIndex{}) const override;
 
-        void setOrderData(const std::vector<ExternalOrder> &orders,
+        // calculation runs in background; given data must stay alive until it finishes or is cancelled
+        void setOrderData(const ExternalOrderBook &orders,
                           const HistoryRegionMap &history,
                           quint64 srcStation,
                           quint64 dstStation,
                           PriceType srcType,
                           PriceType dstType);
+        void cancelCalculation();
         void setCharacter(const std::shared_ptr<Character> &character);
         void discardBogusOrders(bool flag) noexcept;
         void setBogusOrderThreshold(double value) noexcept;
@@ -79,6 +85,13 @@ namespace Evernus
         static int getVolumeColumn();
         static int getMarginColumn();
 
+    signals:
+        void calculationProgress(int done, int total);
+        void calculationFinished();
+
+    private slots:
+        void applyCalculatedData();
+
     private:
         enum
         {
@@ -115,8 +128,28 @@ namespace Evernus
             quint64 mSrcSellOrderCount = 0;
             quint64 mDstBuyOrderCount = 0;
             quint64 mDstSellOrderCount = 0;
+
+            bool operator ==(const TypeData &other) const noexcept;
+        };
+
+        struct AggrTypeData
+        {
+            double mBuyPrice = 0.;
+            double mSellPrice = 0.;
+            quint64 mVolume = 0;
+            quint64 mBuyOrderCount = 0;
+            quint64 mSellOrderCount = 0;
         };
 
+        struct CalculationResult
+        {
+            uint mGeneration = 0;
+            bool mComplete = false; // cancelled calculations end early with partial data
+            std::vector<TypeData> mData;
+        };
+
+        struct CalculationParams;
+
         const EveDataProvider &mDataProvider;
 
         std::vector<TypeData> mData;
@@ -129,6 +162,14 @@ namespace Evernus
         PriceType mSrcPriceType = PriceType::Buy;
         PriceType mDstPriceType = PriceType::Sell;
 
+        QThreadPool mCalculationPool;
+        QFutureWatcher<CalculationResult> mCalculationWatcher;
+        std::atomic_bool mCancelCalculation{false};
+        // bumped whenever current data stops matching what a running or finished calculation was given
+        uint mCalculationGeneration = 0;
+
+        CalculationResult calculateData(const ExternalOrderBook &orders, const HistoryRegionMap &history, const CalculationParams &params);
+
         double getSrcPrice(const TypeData &data) const noexcept;
         double getDstPrice(const TypeData &data) const noexcept;
     };
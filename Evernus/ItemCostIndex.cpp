@@ -0,0 +1,273 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <iterator>
+
+#include <QElapsedTimer>
+#include <QtDebug>
+
+#include "ItemCostRepository.h"
+
+#include "ItemCostIndex.h"
+
+namespace Evernus
+{
+    namespace
+    {
+        const auto typeLess = [](const auto &entry, auto typeId) {
+            return entry.first < typeId;
+        };
+    }
+
+    ItemCostIndex::ItemCostIndex(const ItemCostRepository &costRepo)
+        : mCostRepo{costRepo}
+        , mSnapshot{std::make_shared<Snapshot>()}
+    {
+    }
+
+    ItemCostIndex::CostPtr ItemCostIndex::find(Character::IdType characterId, EveType::IdType typeId) const
+    {
+        return find(*getCharacterCosts(characterId), typeId);
+    }
+
+    ItemCostIndex::CostPtr ItemCostIndex::findShared(EveType::IdType typeId) const
+    {
+        return find(*getSharedCosts(), typeId);
+    }
+
+    void ItemCostIndex::store(const CostPtr &cost)
+    {
+        Q_ASSERT(cost);
+        store(std::vector<CostPtr>{cost});
+    }
+
+    void ItemCostIndex::store(const std::vector<CostPtr> &costs)
+    {
+        if (costs.empty())
+            return;
+
+        auto sortedCosts = costs;
+        std::stable_sort(std::begin(sortedCosts), std::end(sortedCosts), [](const auto &a, const auto &b) {
+            Q_ASSERT(a && b);
+            return a->getTypeId() < b->getTypeId();
+        });
+
+        std::unordered_map<Character::IdType, std::vector<CostPtr>> characterCosts;
+        for (const auto &cost : sortedCosts)
+            characterCosts[cost->getCharacterId()].emplace_back(cost);
+
+        std::lock_guard<std::mutex> lock{mWriteMutex};
+
+        const auto current = getSnapshot();
+        auto snapshot = std::make_shared<Snapshot>(*current);
+
+        for (const auto &newCosts : characterCosts)
+        {
+            const auto list = snapshot->mCharacterCosts.find(newCosts.first);
+            if (list != std::end(snapshot->mCharacterCosts))
+            {
+                list->second = withCosts(*list->second, newCosts.second, [](const auto &, const auto &) {
+                    return true;
+                });
+            }
+        }
+
+        if (snapshot->mSharedCosts)
+        {
+            snapshot->mSharedCosts = withCosts(*snapshot->mSharedCosts, sortedCosts, [](const auto &latest, const auto &cost) {
+                return latest->getId() <= cost->getId();
+            });
+        }
+
+        publish(std::move(snapshot));
+    }
+
+    void ItemCostIndex::remove(ItemCost::IdType id)
+    {
+        std::lock_guard<std::mutex> lock{mWriteMutex};
+
+        const auto current = getSnapshot();
+        auto snapshot = std::make_shared<Snapshot>(*current);
+
+        for (auto &characterCosts : snapshot->mCharacterCosts)
+        {
+            const auto cost = std::find_if(std::begin(*characterCosts.second), std::end(*characterCosts.second), [=](const auto &entry) {
+                return entry.second->getId() == id;
+            });
+
+            if (cost != std::end(*characterCosts.second))
+            {
+                auto costs = std::make_shared<CostList>(*characterCosts.second);
+                costs->erase(std::next(std::begin(*costs), std::distance(std::begin(*characterCosts.second), cost)));
+
+                characterCosts.second = std::move(costs);
+                break;
+            }
+        }
+
+        // the next latest cost might be anyone's - reload shared costs on next use
+        snapshot->mSharedCosts.reset();
+
+        publish(std::move(snapshot));
+    }
+
+    void ItemCostIndex::removeForCharacter(Character::IdType characterId)
+    {
+        std::lock_guard<std::mutex> lock{mWriteMutex};
+
+        const auto current = getSnapshot();
+        auto snapshot = std::make_shared<Snapshot>(*current);
+
+        snapshot->mCharacterCosts[characterId] = std::make_shared<CostList>();
+        snapshot->mSharedCosts.reset();
+
+        publish(std::move(snapshot));
+    }
+
+    void ItemCostIndex::clear()
+    {
+        std::lock_guard<std::mutex> lock{mWriteMutex};
+        publish(std::make_shared<Snapshot>());
+    }
+
+    ItemCostIndex::CostListPtr ItemCostIndex::getCharacterCosts(Character::IdType characterId) const
+    {
+        {
+            const auto snapshot = getSnapshot();
+            const auto costs = snapshot->mCharacterCosts.find(characterId);
+            if (Q_LIKELY(costs != std::end(snapshot->mCharacterCosts)))
+                return costs->second;
+        }
+
+        // loading under write lock, so no store can slip in between fetching and publishing
+        std::lock_guard<std::mutex> lock{mWriteMutex};
+
+        const auto current = getSnapshot();
+        const auto costs = current->mCharacterCosts.find(characterId);
+        if (costs != std::end(current->mCharacterCosts))
+            return costs->second;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto loaded = makeList(mCostRepo.fetchForCharacter(characterId));
+
+        qDebug() << "Loaded" << loaded->size() << "item costs for" << characterId << "in" << timer.elapsed() << "ms.";
+
+        auto snapshot = std::make_shared<Snapshot>(*current);
+        snapshot->mCharacterCosts[characterId] = loaded;
+
+        publish(std::move(snapshot));
+        return loaded;
+    }
+
+    ItemCostIndex::CostListPtr ItemCostIndex::getSharedCosts() const
+    {
+        {
+            const auto snapshot = getSnapshot();
+            if (Q_LIKELY(snapshot->mSharedCosts))
+                return snapshot->mSharedCosts;
+        }
+
+        std::lock_guard<std::mutex> lock{mWriteMutex};
+
+        const auto current = getSnapshot();
+        if (current->mSharedCosts)
+            return current->mSharedCosts;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto loaded = makeList(mCostRepo.fetchLatest());
+
+        qDebug() << "Loaded" << loaded->size() << "shared item costs in" << timer.elapsed() << "ms.";
+
+        auto snapshot = std::make_shared<Snapshot>(*current);
+        snapshot->mSharedCosts = loaded;
+
+        publish(std::move(snapshot));
+        return loaded;
+    }
+
+    std::shared_ptr<const ItemCostIndex::Snapshot> ItemCostIndex::getSnapshot() const
+    {
+        return std::atomic_load(&mSnapshot);
+    }
+
+    void ItemCostIndex::publish(std::shared_ptr<const Snapshot> snapshot) const
+    {
+        std::atomic_store(&mSnapshot, std::move(snapshot));
+    }
+
+    ItemCostIndex::CostPtr ItemCostIndex::find(const CostList &costs, EveType::IdType typeId)
+    {
+        const auto cost = std::lower_bound(std::begin(costs), std::end(costs), typeId, typeLess);
+        return (cost != std::end(costs) && cost->first == typeId) ? (cost->second) : (CostPtr{});
+    }
+
+    ItemCostIndex::CostListPtr ItemCostIndex::makeList(std::vector<CostPtr> costs)
+    {
+        auto list = std::make_shared<CostList>();
+        list->reserve(costs.size());
+
+        for (auto &cost : costs)
+        {
+            const auto typeId = cost->getTypeId();
+            list->emplace_back(typeId, std::move(cost));
+        }
+
+        std::sort(std::begin(*list), std::end(*list), [](const auto &a, const auto &b) {
+            return a.first < b.first;
+        });
+
+        return list;
+    }
+
+    template<class Replace>
+    ItemCostIndex::CostListPtr ItemCostIndex::withCosts(const CostList &costs, const std::vector<CostPtr> &sortedCosts, Replace replace)
+    {
+        // single merge pass over both sorted sequences
+        auto list = std::make_shared<CostList>();
+        list->reserve(costs.size() + sortedCosts.size());
+
+        auto existing = std::begin(costs);
+        auto cost = std::begin(sortedCosts);
+
+        while (cost != std::end(sortedCosts))
+        {
+            const auto typeId = (*cost)->getTypeId();
+            for (; existing != std::end(costs) && existing->first < typeId; ++existing)
+                list->emplace_back(*existing);
+
+            CostPtr result;
+            if (existing != std::end(costs) && existing->first == typeId)
+            {
+                result = existing->second;
+                ++existing;
+            }
+
+            for (; cost != std::end(sortedCosts) && (*cost)->getTypeId() == typeId; ++cost)
+            {
+                if (!result || replace(result, *cost))
+                    result = *cost;
+            }
+
+            list->emplace_back(typeId, std::move(result));
+        }
+
+        list->insert(std::end(*list), existing, std::end(costs));
+        return list;
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+#include "ItemCost.h"
+
+namespace Evernus
+{
+    class ItemCostRepository;
+
+    // flat per-character and shared (latest per type) cost lookup, bulk loaded on first use
+    // readers work on immutable snapshots and never wait for writers (apart from the short lock std::atomic_load can take
+    // internally), so worker threads can use it freely
+    class ItemCostIndex final
+    {
+    public:
+        typedef std::shared_ptr<ItemCost> CostPtr;
+
+        explicit ItemCostIndex(const ItemCostRepository &costRepo);
+        ItemCostIndex(const ItemCostIndex &) = delete;
+        ItemCostIndex(ItemCostIndex &&) = delete;
+        ~ItemCostIndex() = default;
+
+        // empty if none
+        CostPtr find(Character::IdType characterId, EveType::IdType typeId) const;
+        CostPtr findShared(EveType::IdType typeId) const;
+
+        // keep index coherent with the db - call after changing the repository
+        void store(const CostPtr &cost);
+        // single snapshot for many costs - use for imports
+        void store(const std::vector<CostPtr> &costs);
+        void remove(ItemCost::IdType id);
+        void removeForCharacter(Character::IdType characterId);
+        void clear();
+
+        ItemCostIndex &operator =(const ItemCostIndex &) = delete;
+        ItemCostIndex &operator =(ItemCostIndex &&) = delete;
+
+    private:
+        // sorted by type id
+        typedef std::vector<std::pair<EveType::IdType, CostPtr>> CostList;
+        typedef std::shared_ptr<const CostList> CostListPtr;
+
+        struct Snapshot
+        {
+            std::unordered_map<Character::IdType, CostListPtr> mCharacterCosts;
+            CostListPtr mSharedCosts;
+        };
+
+        const ItemCostRepository &mCostRepo;
+
+        // only touched through std::atomic_load/std::atomic_store
+        mutable std::shared_ptr<const Snapshot> mSnapshot;
+        mutable std::mutex mWriteMutex;
+
+        CostListPtr getCharacterCosts(Character::IdType characterId) const;
+        CostListPtr getSharedCosts() const;
+
+        std::shared_ptr<const Snapshot> getSnapshot() const;
+        void publish(std::shared_ptr<const Snapshot> snapshot) const;
+
+        static CostPtr find(const CostList &costs, EveType::IdType typeId);
+        static CostListPtr makeList(std::vector<CostPtr> costs);
+        // sortedCosts must be sorted by type id; for the same type, later ones replace earlier ones if replace() says so
+        template<class Replace>
+        static CostListPtr withCosts(const CostList &costs, const std::vector<CostPtr> &sortedCosts, Replace replace);
+    };
+}
@@ -14,6 +14,7 @@
  */
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -34,10 +35,12 @@ namespace Evernus
         virtual std::shared_ptr<ItemCost> fetchForCharacterAndType(Character::IdType characterId, EveType::IdType typeId) const = 0;
         virtual CostList fetchForCharacter(Character::IdType characterId) const = 0;
         virtual void setForCharacterAndType(Character::IdType characterId, EveType::IdType typeId, double value) = 0;
+        virtual void setForCharacterAndTypes(Character::IdType characterId, const std::unordered_map<EveType::IdType, double> &values) = 0;
 
         virtual std::shared_ptr<ItemCost> findItemCost(ItemCost::IdType id) const = 0;
         virtual void removeItemCost(ItemCost::IdType id) const = 0;
         virtual void storeItemCost(ItemCost &cost) const = 0;
+        virtual void storeItemCosts(std::vector<ItemCost> &costs) const = 0;
         virtual void removeAllItemCosts(Character::IdType characterId) const = 0;
     };
 }
@@ -102,6 +102,23 @@ namespace Evernus
         return populate(query.record());
     }
 
+    ItemCostRepository::EntityList ItemCostRepository::fetchLatest() const
+    {
+        auto query = prepareCachedReadOnly(QStringLiteral("SELECT * FROM %1 WHERE id IN (SELECT max(id) FROM %1 GROUP BY type_id)").arg(getTableName()));
+        DatabaseUtils::execQuery(query);
+
+        EntityList result;
+
+        const auto size = query.size();
+        if (size > 0)
+            result.reserve(size);
+
+        while (query.next())
+            result.emplace_back(populate(query.record()));
+
+        return result;
+    }
+
     void ItemCostRepository::removeForCharacter(Character::IdType characterId) const
     {
         auto query = prepare(QString{"DELETE FROM %1 WHERE character_id = ?"}.arg(getTableName()));
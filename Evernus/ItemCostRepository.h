@@ -36,6 +36,8 @@ namespace Evernus
         EntityList fetchForCharacter(Character::IdType id) const;
         EntityPtr fetchForCharacterAndType(Character::IdType characterId, EveType::IdType typeId) const;
         EntityPtr fetchLatestForType(EveType::IdType typeId) const;
+        // latest cost for every type
+        EntityList fetchLatest() const;
 
         void removeForCharacter(Character::IdType characterId) const;
 
@@ -12,6 +12,8 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <vector>
+
 #include <QDoubleValidator>
 #include <QDoubleSpinBox>
 #include <QMessageBox>
@@ -251,6 +253,10 @@ namespace Evernus
         }
 
         const auto rows = model.rowCount();
+
+        std::vector<ItemCost> costs;
+        costs.reserve(rows);
+
         for (auto row = 0; row < rows; ++row)
         {
             const auto typeId = model.data(model.index(row, 0)).value<EveType::IdType>();
@@ -262,8 +268,10 @@ namespace Evernus
             cost.setTypeId(typeId);
             cost.setCost(model.data(model.index(row, 1)).toDouble());
 
-            mCostProvider.storeItemCost(cost);
+            costs.emplace_back(std::move(cost));
         }
+
+        mCostProvider.storeItemCosts(costs);
     }
 
     void ItemCostWidget::exportCsv()
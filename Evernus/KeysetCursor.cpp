@@ -0,0 +1,73 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QSqlRecord>
+#include <QSqlQuery>
+
+#include "KeysetCursor.h"
+
+namespace Evernus
+{
+    KeysetCursor::KeysetCursor(Qt::SortOrder order)
+        : mOrder{order}
+    {
+    }
+
+    Qt::SortOrder KeysetCursor::getOrder() const noexcept
+    {
+        return mOrder;
+    }
+
+    bool KeysetCursor::isAtEnd() const noexcept
+    {
+        return mAtEnd;
+    }
+
+    QString KeysetCursor::getCondition(const QString &keyExpression, const QString &idColumn) const
+    {
+        if (mLastId.isNull())
+            return {};
+
+        return QStringLiteral(" AND (%1, %2) %3 (?, ?)")
+            .arg(keyExpression)
+            .arg(idColumn)
+            .arg((mOrder == Qt::AscendingOrder) ? (QStringLiteral(">")) : (QStringLiteral("<")));
+    }
+
+    QString KeysetCursor::getOrderBy(const QString &keyExpression, const QString &idColumn) const
+    {
+        const auto order = (mOrder == Qt::AscendingOrder) ? (QStringLiteral("ASC")) : (QStringLiteral("DESC"));
+        return QStringLiteral(" ORDER BY %1 %3, %2 %3").arg(keyExpression).arg(idColumn).arg(order);
+    }
+
+    void KeysetCursor::bindValues(QSqlQuery &query) const
+    {
+        if (mLastId.isNull())
+            return;
+
+        query.addBindValue(mLastKey);
+        query.addBindValue(mLastId);
+    }
+
+    void KeysetCursor::advance(const QSqlRecord &lastRecord, const QString &idColumn, uint rows, uint limit)
+    {
+        if (rows > 0)
+        {
+            mLastKey = lastRecord.value(QStringLiteral("sort_key"));
+            mLastId = lastRecord.value(idColumn);
+        }
+
+        mAtEnd = limit == 0 || rows < limit;
+    }
+}
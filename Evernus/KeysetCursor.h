@@ -0,0 +1,55 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QVariant>
+#include <QString>
+
+class QSqlRecord;
+class QSqlQuery;
+
+namespace Evernus
+{
+    // position in a query paginated by (sort key, id), so further pages don't have to skip over previous ones
+    // the query has to select its sort key as sort_key
+    class KeysetCursor final
+    {
+    public:
+        explicit KeysetCursor(Qt::SortOrder order = Qt::DescendingOrder);
+        KeysetCursor(const KeysetCursor &) = default;
+        KeysetCursor(KeysetCursor &&) = default;
+        ~KeysetCursor() = default;
+
+        Qt::SortOrder getOrder() const noexcept;
+        bool isAtEnd() const noexcept;
+
+        // empty for the first page, otherwise " AND (key, id) > (?, ?)" with the comparison following sort order
+        QString getCondition(const QString &keyExpression, const QString &idColumn) const;
+        QString getOrderBy(const QString &keyExpression, const QString &idColumn) const;
+        void bindValues(QSqlQuery &query) const;
+
+        // moves past the last record of a page; a page shorter than the limit is the last one
+        void advance(const QSqlRecord &lastRecord, const QString &idColumn, uint rows, uint limit);
+
+        KeysetCursor &operator =(const KeysetCursor &) = default;
+        KeysetCursor &operator =(KeysetCursor &&) = default;
+
+    private:
+        Qt::SortOrder mOrder = Qt::DescendingOrder;
+        QVariant mLastKey;
+        QVariant mLastId;
+        bool mAtEnd = false;
+    };
+}
@@ -13,8 +13,6 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <stdexcept>
-#include <sstream>
-#include <thread>
 
 #include <boost/throw_exception.hpp>
 
@@ -23,6 +21,7 @@
 #include <QSettings>
 #include <QSqlQuery>
 
+#include "ThreadDatabaseConnection.h"
 #include "DatabaseUtils.h"
 #include "DbSettings.h"
 
@@ -30,36 +29,89 @@
 
 namespace Evernus
 {
+    namespace
+    {
+        // handles are opened by and never leave their thread, so only the first call goes through Qt connection registry
+        thread_local ThreadDatabaseConnection readWriteConnection;
+        thread_local ThreadDatabaseConnection readOnlyConnection;
+    }
+
     QSqlDatabase MainDatabaseConnectionProvider::getConnection() const
     {
-        std::ostringstream tid;
-        tid << std::this_thread::get_id();
+        if (Q_UNLIKELY(!readWriteConnection.isOpen()))
+            readWriteConnection.setDatabase(openConnection(false));
 
-        const auto connName = QStringLiteral("main-%1").arg(QString::fromStdString(tid.str()));
+        return readWriteConnection.getDatabase();
+    }
 
-        auto db = QSqlDatabase::database(connName, false);
-        if (!db.isValid())
+    QSqlDatabase MainDatabaseConnectionProvider::getReadOnlyConnection() const
+    {
+        if (Q_UNLIKELY(!readOnlyConnection.isOpen()))
         {
-            db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
-            db.setConnectOptions(QStringLiteral("QSQLITE_BUSY_TIMEOUT=10000000"));
-            db.setDatabaseName(DatabaseUtils::getDbFilePath(QStringLiteral("main.db")));
+            // readers can't create the file or switch journal mode
+            getConnection();
+            readOnlyConnection.setDatabase(openConnection(true));
+        }
+
+        return readOnlyConnection.getDatabase();
+    }
+
+    DatabaseConnectionProvider::StatementCache &MainDatabaseConnectionProvider::getStatementCache() const
+    {
+        return readWriteConnection.getStatementCache();
+    }
 
-            if (!db.open())
-                BOOST_THROW_EXCEPTION(std::runtime_error{QCoreApplication::translate("MainDatabaseConnectionProvider", "Error opening DB!").toStdString()});
+    DatabaseConnectionProvider::StatementCache &MainDatabaseConnectionProvider::getReadOnlyStatementCache() const
+    {
+        return readOnlyConnection.getStatementCache();
+    }
+
+    QSqlDatabase MainDatabaseConnectionProvider::openConnection(bool readOnly)
+    {
+        const auto connName = ThreadDatabaseConnection::getUniqueConnectionName(
+            (readOnly) ? (QStringLiteral("main-ro")) : (QStringLiteral("main")));
 
-            db.exec(QStringLiteral("PRAGMA foreign_keys = ON"));
+        auto db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+        db.setConnectOptions((readOnly) ?
+                             (QStringLiteral("QSQLITE_BUSY_TIMEOUT=10000000;QSQLITE_OPEN_READONLY")) :
+                             (QStringLiteral("QSQLITE_BUSY_TIMEOUT=10000000")));
+        db.setDatabaseName(DatabaseUtils::getDbFilePath(QStringLiteral("main.db")));
 
-            QSettings settings;
+        if (!db.open())
+        {
+            db = QSqlDatabase{};
+            QSqlDatabase::removeDatabase(connName);
 
-            // disable syncing changes to the disk between
-            // each transaction. This means the database can become
-            // corrupted in the event of a power failure or OS crash
-            // but NOT in the event of an application error
-            db.exec(QStringLiteral("PRAGMA synchronous = %1").arg(
-                settings.value(DbSettings::synchronousKey, DbSettings::synchronousDefault).toInt()
-            ));
+            BOOST_THROW_EXCEPTION(std::runtime_error{QCoreApplication::translate("MainDatabaseConnectionProvider", "Error opening DB!").toStdString()});
         }
 
+        QSettings settings;
+
+        // negative value means KiB instead of pages
+        db.exec(QStringLiteral("PRAGMA cache_size = -%1").arg(
+            settings.value(DbSettings::cacheSizeKey, DbSettings::cacheSizeDefault).toULongLong() * 1024
+        ));
+        db.exec(QStringLiteral("PRAGMA mmap_size = %1").arg(
+            settings.value(DbSettings::mmapSizeKey, DbSettings::mmapSizeDefault).toULongLong() * 1024 * 1024
+        ));
+
+        if (readOnly)
+            return db;
+
+        db.exec(QStringLiteral("PRAGMA foreign_keys = ON"));
+
+        // with write-ahead log readers don't wait for writers (and the other way around), so bulk imports don't block the UI
+        // the mode is persistent, so this only converts the file once
+        db.exec(QStringLiteral("PRAGMA journal_mode = WAL"));
+
+        // disable syncing changes to the disk between
+        // each transaction. This means the database can become
+        // corrupted in the event of a power failure or OS crash
+        // but NOT in the event of an application error
+        db.exec(QStringLiteral("PRAGMA synchronous = %1").arg(
+            settings.value(DbSettings::synchronousKey, DbSettings::synchronousDefault).toInt()
+        ));
+
         return db;
     }
 }
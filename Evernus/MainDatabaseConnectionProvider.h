@@ -28,8 +28,15 @@ namespace Evernus
         virtual ~MainDatabaseConnectionProvider() = default;
 
         virtual QSqlDatabase getConnection() const override;
+        virtual QSqlDatabase getReadOnlyConnection() const override;
+
+        virtual StatementCache &getStatementCache() const override;
+        virtual StatementCache &getReadOnlyStatementCache() const override;
 
         MainDatabaseConnectionProvider &operator =(const MainDatabaseConnectionProvider &) = default;
         MainDatabaseConnectionProvider &operator =(MainDatabaseConnectionProvider &&) = default;
+
+    private:
+        static QSqlDatabase openConnection(bool readOnly);
     };
 }
@@ -28,6 +28,7 @@
 #include <QSettings>
 #include <QMenuBar>
 #include <QTabBar>
+#include <QFile>
 #include <QLabel>
 
 #ifdef Q_OS_WIN
@@ -59,6 +60,7 @@
 #include "IndustryWidget.h"
 #include "ContractWidget.h"
 #include "ItemCostWidget.h"
+#include "DatabaseUtils.h"
 #include "ImportSettings.h"
 #include "ClickableLabel.h"
 #include "MenuBarWidget.h"
@@ -517,9 +519,20 @@ namespace Evernus
     void MainWindow::performSync()
     {
 #ifdef EVERNUS_DROPBOX_ENABLED
+        // only the main file gets uploaded, and it must not change while being read
+        const auto snapshotPath = SyncDialog::getUploadSnapshotPath();
+        if (!DatabaseUtils::snapshotDatabase(mRepositoryProvider.getCharacterRepository().getDatabase(), snapshotPath))
+        {
+            QFile::remove(snapshotPath);
+            QMessageBox::warning(this, tr("Synchronization"), tr("Database is in use right now. Please try synchronizing again later."));
+            return;
+        }
+
         SyncDialog syncDlg{SyncDialog::Mode::Upload};
         syncDlg.exec();
 
+        QFile::remove(snapshotPath);
+
         utimbuf buf;
         time(&buf.actime);
         buf.modtime = buf.actime;
@@ -772,9 +785,9 @@ namespace Evernus
         connect(orderTab, &MarketOrderWidget::fpcExecutorChanged, &mFPCController, &FPCController::changeExecutor);
         connect(this, &MainWindow::characterMarketOrdersChanged, orderTab, &MarketOrderWidget::updateData);
         connect(this, &MainWindow::corpMarketOrdersChanged, orderTab, &MarketOrderWidget::updateData);
-        connect(this, &MainWindow::externalOrdersChanged, orderTab, &MarketOrderWidget::updateData);
-        connect(this, &MainWindow::citadelsChanged, orderTab, &MarketOrderWidget::updateData);
-        connect(this, &MainWindow::itemCostsChanged, orderTab, &MarketOrderWidget::updateData);
+        connect(this, &MainWindow::externalOrdersChanged, orderTab, &MarketOrderWidget::updateMarketData);
+        connect(this, &MainWindow::citadelsChanged, orderTab, &MarketOrderWidget::updateMarketData);
+        connect(this, &MainWindow::itemCostsChanged, orderTab, &MarketOrderWidget::updateMarketData);
         connect(this, &MainWindow::charactersChanged, orderTab, &MarketOrderWidget::updateCharacters);
 
         auto journalTab = new WalletJournalWidget{mRepositoryProvider.getWalletJournalEntryRepository(),
@@ -853,9 +866,9 @@ namespace Evernus
         connect(corpOrderTab, &MarketOrderWidget::showExternalOrders, this, &MainWindow::showMarketBrowser);
         connect(corpOrderTab, &MarketOrderWidget::fpcExecutorChanged, &mFPCController, &FPCController::changeExecutor);
         connect(this, &MainWindow::corpMarketOrdersChanged, corpOrderTab, &MarketOrderWidget::updateData);
-        connect(this, &MainWindow::externalOrdersChanged, corpOrderTab, &MarketOrderWidget::updateData);
-        connect(this, &MainWindow::citadelsChanged, corpOrderTab, &MarketOrderWidget::updateData);
-        connect(this, &MainWindow::itemCostsChanged, corpOrderTab, &MarketOrderWidget::updateData);
+        connect(this, &MainWindow::externalOrdersChanged, corpOrderTab, &MarketOrderWidget::updateMarketData);
+        connect(this, &MainWindow::citadelsChanged, corpOrderTab, &MarketOrderWidget::updateMarketData);
+        connect(this, &MainWindow::itemCostsChanged, corpOrderTab, &MarketOrderWidget::updateMarketData);
         connect(this, &MainWindow::charactersChanged, corpOrderTab, &MarketOrderWidget::updateCharacters);
 
         auto corpJournalTab = new WalletJournalWidget{mRepositoryProvider.getCorpWalletJournalEntryRepository(),
@@ -957,6 +970,7 @@ namespace Evernus
                                                           mRepositoryProvider.getCharacterRepository(),
                                                           mRepositoryProvider.getRegionTypePresetRepository(),
                                                           mRepositoryProvider.getRegionStationPresetRepository(),
+                                                          mRepositoryProvider.getMarketHistoryRepository(),
                                                           this};
         connect(marketAnalysisTab, &MarketAnalysisWidget::updateExternalOrders, this, &MainWindow::updateExternalOrders);
         connect(marketAnalysisTab, &MarketAnalysisWidget::showInEve, this, &MainWindow::showInEve);
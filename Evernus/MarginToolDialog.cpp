@@ -16,15 +16,16 @@
 #include <algorithm>
 #include <memory>
 #include <thread>
+#include <chrono>
 #include <cmath>
 
 #include <QDialogButtonBox>
-#include <QStringBuilder>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
 #include <QDesktopWidget>
 #include <QApplication>
 #include <QRadioButton>
 #include <QTableWidget>
-#include <QDirIterator>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QHBoxLayout>
@@ -33,19 +34,19 @@
 #include <QPushButton>
 #include <QClipboard>
 #include <QTabWidget>
-#include <QDateTime>
+#include <QtConcurrent>
 #include <QSettings>
 #include <QCheckBox>
+#include <QFileInfo>
 #include <QGroupBox>
 #include <QLineEdit>
 #include <QSpinBox>
-#include <QRegExp>
 #include <QLabel>
 #include <QtDebug>
 #include <QFont>
 #include <QFile>
-#include <QDir>
 
+#include "MarketLogExternalOrderImporterThread.h"
 #include "MarginToolSettings.h"
 #include "ItemCostProvider.h"
 #include "EveDataProvider.h"
@@ -107,7 +108,7 @@ namespace Evernus
         });
 
         setUpWatcher();
-        connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, &MarginToolDialog::refreshData);
+        connect(&mLogWatcher, &MarketLogDumpWatcher::logReady, this, &MarginToolDialog::refreshData);
 
         setWindowTitle(tr("Margin tool"));
         setAttribute(Qt::WA_DeleteOnClose);
@@ -172,174 +173,55 @@ namespace Evernus
         setGeometry(geom);
     }
 
-    void MarginToolDialog::refreshData(const QString &path)
+    void MarginToolDialog::refreshData(const QString &logFile)
     {
-        const auto targetFile = getNewFile(path);
-        if (targetFile.isEmpty())
+        if (mIsOwnOrderLog && mIsOwnOrderLog(QFileInfo{logFile}.fileName()))
             return;
 
-        mKnownFiles << targetFile;
-
-        const QString logFile = path % "/" % targetFile;
-
         qDebug() << "Calculating margin from file: " << logFile;
 
-        QSettings settings;
-        QFile file{logFile};
-        QFileInfo info{file};
-
-#ifdef Q_OS_WIN
-        if (settings.value(PriceSettings::priceAltImportKey, PriceSettings::priceAltImportDefault).toBool())
-        {
-            while (!file.open(QIODevice::ReadWrite))
-                std::this_thread::sleep_for(std::chrono::milliseconds{10});
-        }
-        else
-        {
-#endif
-            const auto modTimeDelay = settings.value(PriceSettings::importLogWaitTimeKey, PriceSettings::importLogWaitTimeDefault).toUInt();
-
-            // wait for Eve to finish dumping data
-            forever
-            {
-                const auto modTime = info.lastModified();
-                if (modTime.msecsTo(QDateTime::currentDateTime()) >= modTimeDelay)
-                    break;
-            }
-
-            if (!file.open(QIODevice::ReadOnly))
-                return;
-#ifdef Q_OS_WIN
-        }
-#endif
-
-        file.readLine();
-
-        auto buy = -1.;
-        auto sell = -1.;
-
-        uint buyVol = 0, buyInit = 0;
-        uint sellVol = 0, sellInit = 0;
-
-        auto buyCount = 0u;
-        auto sellCount = 0u;
-        auto buyout = 0.;
-
-        QString name;
-        const auto priceTime = info.created();
+        QElapsedTimer latencyTimer;
+        latencyTimer.start();
 
-        auto typeId = EveType::invalidId;
-
-        const auto logColumns = 14;
-
-        const auto volRemainingColumn = 1;
-        const auto volEnteredColumn = 5;
-        const auto jumpsColumn = 13;
+        QSettings settings;
 
         const auto ignoreMinVolume
             = settings.value(PriceSettings::ignoreOrdersWithMinVolumeKey, PriceSettings::ignoreOrdersWithMinVolumeDefault).toBool();
-
+        const auto deleteLog = settings.value(PathSettings::deleteLogsKey, PathSettings::deleteLogsDefault).toBool();
         const auto rangeThreshold = mRangeThresholdEdit->value();
 
-        std::vector<ExternalOrder> parsedOrders;
-
-        while (!file.atEnd())
-        {
-            const QString line = file.readLine();
-            const auto values = line.split(',');
-
-            if (values.count() >= logColumns)
-            {
-                ExternalOrder order = ExternalOrder::parseLogLine(values);
-
-                if (ignoreMinVolume && order.getMinVolume() > 1)
-                    continue;
-
-                order.setUpdateTime(priceTime);
-
-                if (typeId == EveType::invalidId)
-                {
-                    typeId = order.getTypeId();
-                    name = mDataProvider.getTypeName(typeId);
-                }
-
-                const auto jumps = values[jumpsColumn].toInt();
-
-                if (order.getType() == ExternalOrder::Type::Buy)
-                {
-                    // warning: this does not take into account orders in the same system, but different station -
-                    //          there's no way to check if the station matches
-                    if (jumps != 0)
-                    {
-                        const int range = order.getRange();
-                        if (jumps - std::max(range, 0) > rangeThreshold)
-                        {
-                            parsedOrders.emplace_back(std::move(order));
-                            continue;
-                        }
-                    }
-
-                    if (order.getPrice() > buy)
-                        buy = order.getPrice();
-
-                    buyVol += static_cast<uint>(values[volRemainingColumn].toDouble());
-                    buyInit += static_cast<uint>(values[volEnteredColumn].toDouble());
-
-                    ++buyCount;
-                }
-                else if (jumps <= rangeThreshold)
-                {
-                    const auto price = order.getPrice();
-                    if (price < sell || sell < 0.)
-                        sell = price;
+#ifdef Q_OS_WIN
+        const auto waitForLock = settings.value(PriceSettings::priceAltImportKey, PriceSettings::priceAltImportDefault).toBool();
+#else
+        const auto waitForLock = false;
+#endif
 
-                    const auto remaining = static_cast<uint>(values[volRemainingColumn].toDouble());
+        const auto sequence = ++mLogSequence;
 
-                    buyout += remaining * price;
-                    sellVol += remaining;
-                    sellInit += static_cast<uint>(values[volEnteredColumn].toDouble());
+        using Watcher = QFutureWatcher<LogData>;
 
-                    ++sellCount;
-                }
+        auto watcher = new Watcher{this};
+        connect(watcher, &Watcher::finished, this, [=] {
+            watcher->deleteLater();
 
-                parsedOrders.emplace_back(std::move(order));
-            }
-        }
+            auto data = watcher->result();
+            if (!data.mValid)
+                return;
 
-        mDataProvider.updateExternalOrders(parsedOrders);
+            mDataProvider.updateExternalOrders(data.mOrders);
 
-        if (settings.value(PathSettings::deleteLogsKey, PathSettings::deleteLogsDefault).toBool())
-        {
-            mWatcher.blockSignals(true);
-            file.remove();
-            mWatcher.blockSignals(false);
-        }
-
-        if (mItemCostSourceBtn->isChecked())
-        {
-            const auto cost = mItemCostProvider.fetchForCharacterAndType(mCharacterId, typeId);
-            if (!cost->isNew())
-                buy = cost->getAdjustedCost() - PriceUtils::getPriceDelta();
-        }
-        else if (mStationSourceBtn->isChecked())
-        {
-            const auto station = mStationView->getStationId();
-            if (station == 0)
-                buy = 0.;
-            else
-                buy = mDataProvider.getTypeBuyPrice(typeId, station)->getPrice();
-        }
+            // a newer log is on its way
+            if (sequence != mLogSequence)
+                return;
 
-        const auto curLocale = locale();
+            showLogData(data);
 
-        mNameLabel->setText(name);
-        mBuyOrdersLabel->setText(curLocale.toString(buyCount));
-        mSellOrdersLabel->setText(curLocale.toString(sellCount));
-        mBuyVolLabel->setText(QString{"%1/%2"}.arg(curLocale.toString(buyVol)).arg(curLocale.toString(buyInit - buyVol)));
-        mSellVolLabel->setText(QString{"%1/%2"}.arg(curLocale.toString(sellVol)).arg(curLocale.toString(sellInit - sellVol)));
-        mBuyoutLabel->setText(TextUtils::currencyToString(buyout, curLocale));
+            qDebug() << "Margin displayed" << latencyTimer.elapsed() << "ms after log dump.";
+        });
 
-        updateInfo(buy, sell, true);
+        watcher->setFuture(QtConcurrent::run([=] {
+            return parseLog(logFile, rangeThreshold, ignoreMinVolume, waitForLock, deleteLog);
+        }));
     }
 
     void MarginToolDialog::refreshDataByEdits()
@@ -809,10 +691,39 @@ namespace Evernus
         }
     }
 
-    void MarginToolDialog::setUpWatcher()
+    void MarginToolDialog::showLogData(const LogData &data)
     {
-        mWatcher.removePaths(mWatcher.directories());
+        auto buy = data.mBuy;
 
+        if (mItemCostSourceBtn->isChecked())
+        {
+            const auto cost = mItemCostProvider.fetchForCharacterAndType(mCharacterId, data.mTypeId);
+            if (!cost->isNew())
+                buy = cost->getAdjustedCost() - PriceUtils::getPriceDelta();
+        }
+        else if (mStationSourceBtn->isChecked())
+        {
+            const auto station = mStationView->getStationId();
+            if (station == 0)
+                buy = 0.;
+            else
+                buy = mDataProvider.getTypeBuyPrice(data.mTypeId, station)->getPrice();
+        }
+
+        const auto curLocale = locale();
+
+        mNameLabel->setText((data.mTypeId == EveType::invalidId) ? (QString{}) : (mDataProvider.getTypeName(data.mTypeId)));
+        mBuyOrdersLabel->setText(curLocale.toString(data.mBuyCount));
+        mSellOrdersLabel->setText(curLocale.toString(data.mSellCount));
+        mBuyVolLabel->setText(QString{"%1/%2"}.arg(curLocale.toString(data.mBuyVol)).arg(curLocale.toString(data.mBuyInit - data.mBuyVol)));
+        mSellVolLabel->setText(QString{"%1/%2"}.arg(curLocale.toString(data.mSellVol)).arg(curLocale.toString(data.mSellInit - data.mSellVol)));
+        mBuyoutLabel->setText(TextUtils::currencyToString(data.mBuyout, curLocale));
+
+        updateInfo(buy, data.mSell, true);
+    }
+
+    void MarginToolDialog::setUpWatcher()
+    {
         const auto logPath = PathUtils::getMarketLogsPath();
 
         qDebug() << "Using market log path:" << logPath;
@@ -823,56 +734,24 @@ namespace Evernus
                                  tr("Margin tool error"),
                                  tr("Could not determine market log path. Please enter log path in settings."));
         }
-        else if (!mWatcher.addPath(logPath))
+        else if (!mLogWatcher.setPath(logPath))
         {
             QMessageBox::warning(this,
                                  tr("Margin tool error"),
                                  tr("Could not start watching market log path. Make sure the path exists (eg. export some logs) and try again."));
         }
-        else
-        {
-            mKnownFiles = getKnownFiles(logPath);
-        }
-    }
-
-    QString MarginToolDialog::getNewFile(const QString &path) const
-    {
-        QDirIterator files{path, { QStringLiteral("*.txt") }, QDir::Files | QDir::Readable};
-        if (!files.hasNext())
-            return {};
 
         QSettings settings;
 
-        const QRegExp charLogWildcard{
-            settings.value(PathSettings::characterLogWildcardKey, PathSettings::characterLogWildcardDefault).toString(),
-            Qt::CaseInsensitive,
-            QRegExp::Wildcard};
-        const QRegExp corpLogWildcard{
-            settings.value(PathSettings::corporationLogWildcardKey, PathSettings::corporationLogWildcardDefault).toString(),
-            Qt::CaseInsensitive,
-            QRegExp::Wildcard};
-
-        QString file;
-        QDateTime bestModified;
-
-        while (files.hasNext())
-        {
-            files.next();
-
-            const auto fileName = files.fileName();
-
-            if (mKnownFiles.contains(fileName) || charLogWildcard.exactMatch(fileName) || corpLogWildcard.exactMatch(fileName))
-                continue;
-
-            const auto lastModified = files.fileInfo().lastModified();
-            if (lastModified > bestModified)
-            {
-                file = fileName;
-                bestModified = lastModified;
-            }
-        }
+#ifdef Q_OS_WIN
+        // Eve keeps the file locked while writing, so the parser can simply wait for the lock
+        if (settings.value(PriceSettings::priceAltImportKey, PriceSettings::priceAltImportDefault).toBool())
+            mLogWatcher.setSettleTime(0);
+        else
+#endif
+            mLogWatcher.setSettleTime(settings.value(PriceSettings::importLogWaitTimeKey, PriceSettings::importLogWaitTimeDefault).toUInt());
 
-        return file;
+        mIsOwnOrderLog = MarketLogExternalOrderImporterThread::getOwnOrderLogFilter();
     }
 
     void MarginToolDialog::fillSampleData(QTableWidget &table, double revenue, double cos, int multiplier)
@@ -898,31 +777,109 @@ namespace Evernus
         table.resizeColumnsToContents();
     }
 
-    MarginToolDialog::FileList MarginToolDialog::getKnownFiles(const QString &path)
+    MarginToolDialog::LogData MarginToolDialog::parseLog(const QString &logFile,
+                                                         int rangeThreshold,
+                                                         bool ignoreMinVolume,
+                                                         bool waitForLock,
+                                                         bool deleteLog)
     {
-        const QDir basePath{path};
-        const auto files = basePath.entryList(QStringList{"*.txt"}, QDir::Files | QDir::Readable);
+        LogData data;
 
-        QSettings settings;
+        QFile file{logFile};
+        if (waitForLock)
+        {
+            while (!file.open(QIODevice::ReadWrite))
+            {
+                if (!file.exists())
+                    return data;
 
-        const QRegExp charLogWildcard{
-            settings.value(PathSettings::characterLogWildcardKey, PathSettings::characterLogWildcardDefault).toString(),
-            Qt::CaseInsensitive,
-            QRegExp::Wildcard};
-        const QRegExp corpLogWildcard{
-            settings.value(PathSettings::corporationLogWildcardKey, PathSettings::corporationLogWildcardDefault).toString(),
-            Qt::CaseInsensitive,
-            QRegExp::Wildcard};
-
-        FileList out;
-        for (const auto &file : files)
+                std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            }
+        }
+        else if (!file.open(QIODevice::ReadOnly))
         {
-            if (charLogWildcard.exactMatch(file) || corpLogWildcard.exactMatch(file))
+            return data;
+        }
+
+        data.mValid = true;
+
+        const auto priceTime = QFileInfo{file}.created();
+
+        const auto content = QString::fromUtf8(file.readAll());
+        const auto lines = content.splitRef(QLatin1Char('\n'), QString::SkipEmptyParts);
+
+        const auto logColumns = 14;
+
+        const auto volRemainingColumn = 1;
+        const auto volEnteredColumn = 5;
+        const auto jumpsColumn = 13;
+
+        data.mOrders.reserve(lines.size());
+
+        // first line is the header
+        for (auto line = 1; line < lines.size(); ++line)
+        {
+            const auto values = lines[line].split(QLatin1Char(','));
+            if (values.count() < logColumns)
                 continue;
 
-            out << file;
+            auto order = ExternalOrder::parseLogLine(values);
+
+            if (ignoreMinVolume && order.getMinVolume() > 1)
+                continue;
+
+            order.setUpdateTime(priceTime);
+
+            if (data.mTypeId == EveType::invalidId)
+                data.mTypeId = order.getTypeId();
+
+            const auto jumps = values[jumpsColumn].toInt();
+
+            if (order.getType() == ExternalOrder::Type::Buy)
+            {
+                // warning: this does not take into account orders in the same system, but different station -
+                //          there's no way to check if the station matches
+                if (jumps != 0)
+                {
+                    const int range = order.getRange();
+                    if (jumps - std::max(range, 0) > rangeThreshold)
+                    {
+                        data.mOrders.emplace_back(std::move(order));
+                        continue;
+                    }
+                }
+
+                if (order.getPrice() > data.mBuy)
+                    data.mBuy = order.getPrice();
+
+                data.mBuyVol += static_cast<uint>(values[volRemainingColumn].toDouble());
+                data.mBuyInit += static_cast<uint>(values[volEnteredColumn].toDouble());
+
+                ++data.mBuyCount;
+            }
+            else if (jumps <= rangeThreshold)
+            {
+                const auto price = order.getPrice();
+                if (price < data.mSell || data.mSell < 0.)
+                    data.mSell = price;
+
+                const auto remaining = static_cast<uint>(values[volRemainingColumn].toDouble());
+
+                data.mBuyout += remaining * price;
+                data.mSellVol += remaining;
+                data.mSellInit += static_cast<uint>(values[volEnteredColumn].toDouble());
+
+                ++data.mSellCount;
+            }
+
+            data.mOrders.emplace_back(std::move(order));
         }
 
-        return out;
+        file.close();
+
+        if (deleteLog)
+            file.remove();
+
+        return data;
     }
 }
@@ -15,13 +15,12 @@
 #pragma once
 
 #include <unordered_set>
+#include <functional>
 #include <vector>
 
-#include <QFileSystemWatcher>
-#include <QDateTime>
 #include <QDialog>
-#include <QSet>
 
+#include "MarketLogDumpWatcher.h"
 #include "ExternalOrder.h"
 #include "Character.h"
 
@@ -68,7 +67,7 @@ namespace Evernus
     private slots:
         void toggleAlwaysOnTop(int state);
 
-        void refreshData(const QString &path);
+        void refreshData(const QString &logFile);
         void refreshDataByEdits();
 
         void saveCopyMode();
@@ -78,7 +77,17 @@ namespace Evernus
         virtual void closeEvent(QCloseEvent *event) override;
 
     private:
-        using FileList = QSet<QString>;
+        struct LogData
+        {
+            bool mValid = false;
+            std::vector<ExternalOrder> mOrders;
+            EveType::IdType mTypeId = EveType::invalidId;
+            double mBuy = -1., mSell = -1.;
+            uint mBuyVol = 0, mBuyInit = 0;
+            uint mSellVol = 0, mSellInit = 0;
+            uint mBuyCount = 0, mSellCount = 0;
+            double mBuyout = 0.;
+        };
 
         static const auto samples = 100000000;
 
@@ -88,7 +97,8 @@ namespace Evernus
         const ItemCostProvider &mItemCostProvider;
         EveDataProvider &mDataProvider;
 
-        QFileSystemWatcher mWatcher;
+        MarketLogDumpWatcher mLogWatcher;
+        std::function<bool (const QString &)> mIsOwnOrderLog;
 
         QLabel *mNameLabel = nullptr;
         QLineEdit *mBestBuyEdit = nullptr;
@@ -121,7 +131,7 @@ namespace Evernus
 
         StationView *mStationView = nullptr;
 
-        FileList mKnownFiles;
+        quint64 mLogSequence = 0;
 
         Character::IdType mCharacterId = Character::invalidId;
 
@@ -135,13 +145,13 @@ namespace Evernus
         QWidget *createDataSourceTab();
 
         void updateInfo(double buy, double sell, bool updatePriceEdits);
+        void showLogData(const LogData &data);
 
         void setUpWatcher();
 
-        QString getNewFile(const QString &path) const;
-
         static void fillSampleData(QTableWidget &table, double revenue, double cos, int multiplier);
 
-        static FileList getKnownFiles(const QString &path);
+        // runs on a worker thread
+        static LogData parseLog(const QString &logFile, int rangeThreshold, bool ignoreMinVolume, bool waitForLock, bool deleteLog);
     };
 }
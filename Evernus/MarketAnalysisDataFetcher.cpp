@@ -12,18 +12,22 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <stdexcept>
 #include <algorithm>
 
 #include <boost/scope_exit.hpp>
 
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <QDateTime>
 #include <QSettings>
 #include <QtDebug>
 
+#include "MarketHistoryRepository.h"
+#include "ESIInterfaceManager.h"
 #include "EveDataProvider.h"
 #include "ImportSettings.h"
 #include "OrderSettings.h"
-#include "SSOUtils.h"
 
 #include "MarketAnalysisDataFetcher.h"
 
@@ -31,12 +35,17 @@ namespace Evernus
 {
     MarketAnalysisDataFetcher::MarketAnalysisDataFetcher(const EveDataProvider &dataProvider,
                                                          ESIInterfaceManager &interfaceManager,
+                                                         const MarketHistoryRepository &historyRepo,
                                                          QObject *parent)
         : QObject{parent}
         , mDataProvider{dataProvider}
+        , mHistoryRepo{historyRepo}
+        , mImportPlanner{interfaceManager.getMarketImportPlanner()}
         , mESIManager{mDataProvider, interfaceManager}
     {
         connect(&mESIManager, &ESIManager::error, this, &MarketAnalysisDataFetcher::genericError);
+
+        mHistoryStorePool.setMaxThreadCount(1);
     }
 
     bool MarketAnalysisDataFetcher::hasPendingOrderRequests() const noexcept
@@ -73,15 +82,26 @@ namespace Evernus
         QSettings settings;
         const auto marketImportType = static_cast<ImportSettings::MarketOrderImportType>(
             settings.value(ImportSettings::marketOrderImportTypeKey, static_cast<int>(ImportSettings::marketOrderImportTypeDefault)).toInt());
-        auto useWholeMarketImport = marketImportType == ImportSettings::MarketOrderImportType::Whole;
 
-        if (!useWholeMarketImport && marketImportType == ImportSettings::MarketOrderImportType::Auto)
-            useWholeMarketImport = SSOUtils::useWholeMarketImport(pairs, mDataProvider);
+        const auto storedHistory = loadStoredHistory(pairs, ignored);
+
+        if (marketImportType == ImportSettings::MarketOrderImportType::Auto)
+        {
+            const auto plan = mImportPlanner.plan(pairs, [](auto regionId) {
+                return static_cast<uint>(regionId);
+            });
 
-        if (useWholeMarketImport)
-            importWholeMarketData(pairs, ignored);
+            importWholeMarketData(plan.mWholeImport, ignored, storedHistory);
+            importIndividualData(plan.mIndividualImport, ignored, storedHistory);
+        }
+        else if (marketImportType == ImportSettings::MarketOrderImportType::Whole)
+        {
+            importWholeMarketData(pairs, ignored, storedHistory);
+        }
         else
-            importIndividualData(pairs, ignored);
+        {
+            importIndividualData(pairs, ignored, storedHistory);
+        }
 
         if (settings.value(OrderSettings::importFromCitadelsKey, OrderSettings::importFromCitadelsDefault).toBool())
             importCitadelData(pairs, ignored, charId);
@@ -123,8 +143,11 @@ namespace Evernus
             finishOrderImport();
     }
 
-    void MarketAnalysisDataFetcher
-    ::processHistory(uint regionId, EveType::IdType typeId, std::map<QDate, MarketHistoryEntry> &&history, const QString &errorText)
+    void MarketAnalysisDataFetcher::processHistory(uint regionId,
+                                                   EveType::IdType typeId,
+                                                   std::map<QDate, MarketHistoryEntry> &&history,
+                                                   const QString &errorText,
+                                                   const QDateTime &expires)
     {
         if (mHistoryCounter.advanceAndCheckBatch())
             emit historyStatusUpdated(tr("Waiting for %1 history server replies...").arg(mHistoryCounter.getCount()));
@@ -141,14 +164,73 @@ namespace Evernus
             return;
         }
 
+        mPendingHistoryStores.push_back({regionId, typeId, history, expires});
+        if (mPendingHistoryStores.size() >= historyStoreBatchSize)
+        {
+            using Watcher = QFutureWatcher<QString>;
+
+            // the pool runs stores in order, so this is reported before the import ends
+            auto watcher = new Watcher{this};
+            connect(watcher, &Watcher::finished, this, [=] {
+                watcher->deleteLater();
+
+                const auto error = watcher->result();
+                if (!error.isEmpty())
+                    mAggregatedHistoryErrors << error;
+            });
+
+            watcher->setFuture(storePendingHistory());
+        }
+
         (*mHistory)[regionId][typeId] = std::move(history);
 
         if (mHistoryCounter.isEmpty() && !mPreparingRequests)
             finishHistoryImport();
     }
 
+    TypeLocationPairs MarketAnalysisDataFetcher::loadStoredHistory(const TypeLocationPairs &pairs, const TypeLocationPairs &ignored)
+    {
+        TypeLocationPairs result;
+        std::unordered_map<uint, std::unordered_set<EveType::IdType>> freshTypes;
+
+        const auto now = QDateTime::currentDateTimeUtc();
+        const auto expiries = mHistoryRepo.fetchExpiries();
+
+        for (const auto &pair : pairs)
+        {
+            if (ignored.find(pair) != std::end(ignored))
+                continue;
+
+            const auto expiry = expiries.find(pair);
+            if (expiry != std::end(expiries) && expiry->second > now)
+                freshTypes[pair.second].insert(pair.first);
+        }
+
+        // ESI returns roughly 13 months of history - don't give the analysis more than it would get from the network
+        const auto from = QDate::currentDate().addMonths(-13);
+
+        for (const auto &region : freshTypes)
+        {
+            auto history = mHistoryRepo.fetchForRegion(region.first, region.second, from);
+            auto &regionHistory = (*mHistory)[region.first];
+
+            for (const auto typeId : region.second)
+            {
+                result.insert(std::make_pair(typeId, region.first));
+                regionHistory[typeId] = std::move(history[typeId]);
+            }
+
+            processEvents();
+        }
+
+        qDebug() << "Loaded" << result.size() << "fresh history entries from disk.";
+
+        return result;
+    }
+
     void MarketAnalysisDataFetcher::importWholeMarketData(const TypeLocationPairs &pairs,
-                                                          const TypeLocationPairs &ignored)
+                                                          const TypeLocationPairs &ignored,
+                                                          const TypeLocationPairs &storedHistory)
     {
         std::unordered_set<uint> regions;
         for (const auto &pair : pairs)
@@ -156,13 +238,16 @@ namespace Evernus
             if (ignored.find(pair) != std::end(ignored))
                 continue;
 
+            regions.insert(pair.second);
+
+            if (storedHistory.find(pair) != std::end(storedHistory))
+                continue;
+
             mHistoryCounter.incCount();
             mESIManager.fetchMarketHistory(pair.second, pair.first, [=](auto &&history, const auto &error, const auto &expires) {
-                Q_UNUSED(expires);
-                processHistory(pair.second, pair.first, std::move(history), error);
+                processHistory(pair.second, pair.first, std::move(history), error, expires);
             });
 
-            regions.insert(pair.second);
             processEvents();
         }
 
@@ -182,7 +267,8 @@ namespace Evernus
     }
 
     void MarketAnalysisDataFetcher::importIndividualData(const TypeLocationPairs &pairs,
-                                                         const TypeLocationPairs &ignored)
+                                                         const TypeLocationPairs &ignored,
+                                                         const TypeLocationPairs &storedHistory)
     {
         for (const auto &pair : pairs)
         {
@@ -190,17 +276,19 @@ namespace Evernus
                 continue;
 
             mOrderCounter.incCount();
-            mHistoryCounter.incCount();
 
             mESIManager.fetchMarketOrders(pair.second, pair.first, [=](auto &&orders, const auto &error, const auto &expires) {
                 Q_UNUSED(expires);
                 processOrders(std::move(orders), error);
             });
 
-            mESIManager.fetchMarketHistory(pair.second, pair.first, [=](auto &&history, const auto &error, const auto &expires) {
-                Q_UNUSED(expires);
-                processHistory(pair.second, pair.first, std::move(history), error);
-            });
+            if (storedHistory.find(pair) == std::end(storedHistory))
+            {
+                mHistoryCounter.incCount();
+                mESIManager.fetchMarketHistory(pair.second, pair.first, [=](auto &&history, const auto &error, const auto &expires) {
+                    processHistory(pair.second, pair.first, std::move(history), error, expires);
+                });
+            }
 
             processEvents();
         }
@@ -254,8 +342,43 @@ namespace Evernus
     {
         qDebug() << "Finished history import at" << QDateTime::currentDateTime() << mHistory->size();
 
-        emit historyImportEnded(mHistory, mAggregatedHistoryErrors.join("\n"));
-        mAggregatedHistoryErrors.clear();
+        using Watcher = QFutureWatcher<QString>;
+
+        // the import is over only when everything is stored - otherwise the next one wouldn't see fresh history
+        auto watcher = new Watcher{this};
+        connect(watcher, &Watcher::finished, this, [=, history = mHistory] {
+            watcher->deleteLater();
+
+            const auto error = watcher->result();
+            if (!error.isEmpty())
+                mAggregatedHistoryErrors << error;
+
+            emit historyImportEnded(history, mAggregatedHistoryErrors.join("\n"));
+            mAggregatedHistoryErrors.clear();
+        });
+
+        watcher->setFuture(storePendingHistory());
+    }
+
+    QFuture<QString> MarketAnalysisDataFetcher::storePendingHistory()
+    {
+        // empty stores still go through the pool, so the result waits for the earlier ones
+        auto future = QtConcurrent::run(&mHistoryStorePool, [&repo = mHistoryRepo, histories = std::move(mPendingHistoryStores)] {
+            try
+            {
+                repo.store(histories);
+            }
+            catch (const std::exception &e)
+            {
+                qWarning() << "Error storing market history:" << e.what();
+                return tr("Error storing market history: %1").arg(QString::fromStdString(e.what()));
+            }
+
+            return QString{};
+        });
+
+        mPendingHistoryStores.clear();
+        return future;
     }
 
     void MarketAnalysisDataFetcher::processEvents()
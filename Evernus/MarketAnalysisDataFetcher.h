@@ -19,12 +19,15 @@
 #include <map>
 
 #include <QStringList>
+#include <QThreadPool>
 #include <QObject>
+#include <QFuture>
 #include <QString>
 #include <QDate>
 
 #include "TypeAggregatedMarketDataModel.h"
 #include "AggregatedEventProcessor.h"
+#include "MarketHistoryRepository.h"
 #include "MarketOrderRepository.h"
 #include "MarketHistoryEntry.h"
 #include "ProgressiveCounter.h"
@@ -35,6 +38,8 @@
 
 namespace Evernus
 {
+    class MarketImportPlanner;
+
     class MarketAnalysisDataFetcher
         : public QObject
     {
@@ -46,6 +51,7 @@ namespace Evernus
 
         MarketAnalysisDataFetcher(const EveDataProvider &dataProvider,
                                   ESIInterfaceManager &interfaceManager,
+                                  const MarketHistoryRepository &historyRepo,
                                   QObject *parent = nullptr);
         virtual ~MarketAnalysisDataFetcher() = default;
 
@@ -67,7 +73,12 @@ namespace Evernus
                         Character::IdType charId);
 
     private:
+        static const std::size_t historyStoreBatchSize = 500;
+
         const EveDataProvider &mDataProvider;
+        const MarketHistoryRepository &mHistoryRepo;
+
+        const MarketImportPlanner &mImportPlanner;
 
         ESIManager mESIManager;
 
@@ -79,15 +90,28 @@ namespace Evernus
         OrderResultType mOrders;
         HistoryResultType mHistory;
 
+        std::vector<MarketHistoryRepository::PendingHistory> mPendingHistoryStores;
+
         AggregatedEventProcessor mEventProcessor;
 
+        // stores run one after another, so they never compete for the write lock
+        QThreadPool mHistoryStorePool;
+
         void processOrders(std::vector<ExternalOrder> &&orders, const QString &errorText);
-        void processHistory(uint regionId, EveType::IdType typeId, std::map<QDate, MarketHistoryEntry> &&history, const QString &errorText);
+        void processHistory(uint regionId,
+                            EveType::IdType typeId,
+                            std::map<QDate, MarketHistoryEntry> &&history,
+                            const QString &errorText,
+                            const QDateTime &expires);
+
+        TypeLocationPairs loadStoredHistory(const TypeLocationPairs &pairs, const TypeLocationPairs &ignored);
 
         void importWholeMarketData(const TypeLocationPairs &pairs,
-                                   const TypeLocationPairs &ignored);
+                                   const TypeLocationPairs &ignored,
+                                   const TypeLocationPairs &storedHistory);
         void importIndividualData(const TypeLocationPairs &pairs,
-                                  const TypeLocationPairs &ignored);
+                                  const TypeLocationPairs &ignored,
+                                  const TypeLocationPairs &storedHistory);
         void importCitadelData(const TypeLocationPairs &pairs,
                                const TypeLocationPairs &ignored,
                                Character::IdType charId);
@@ -95,6 +119,9 @@ namespace Evernus
         void finishOrderImport();
         void finishHistoryImport();
 
+        // resolves to an error message, if any
+        QFuture<QString> storePendingHistory();
+
         void processEvents();
 
         static void filterOrders(std::vector<ExternalOrder> &orders, const TypeLocationPairs &pairs);
@@ -53,6 +53,7 @@ namespace Evernus
                                                const CharacterRepository &characterRepo,
                                                const RegionTypePresetRepository &regionTypePresetRepo,
                                                const RegionStationPresetRepository &regionStationPresetRepository,
+                                               const MarketHistoryRepository &historyRepo,
                                                QWidget *parent)
         : QWidget{parent}
         , MarketDataProvider{}
@@ -66,7 +67,7 @@ namespace Evernus
         , mRegionTypePresetRepo{regionTypePresetRepo}
         , mOrders{std::make_shared<MarketAnalysisDataFetcher::OrderResultType::element_type>()}
         , mHistory{std::make_shared<MarketAnalysisDataFetcher::HistoryResultType::element_type>()}
-        , mDataFetcher{mDataProvider, interfaceManager}
+        , mDataFetcher{mDataProvider, interfaceManager, historyRepo}
     {
         connect(&mDataFetcher, &MarketAnalysisDataFetcher::orderStatusUpdated,
                 this, &MarketAnalysisWidget::updateOrderTask);
@@ -239,6 +240,12 @@ namespace Evernus
         tabs->addTab(mScrapmetalReprocessingArbitrageWidget, tr("Scrapmetal reprocessing arbitrage"));
     }
 
+    MarketAnalysisWidget::~MarketAnalysisWidget()
+    {
+        // child widgets outlive our data, so stop anything still working on it
+        mInterRegionAnalysisWidget->cancelCalculation();
+    }
+
     const MarketAnalysisWidget::HistoryMap *MarketAnalysisWidget::getHistory(uint regionId) const
     {
         if (!mHistory)
@@ -258,6 +265,11 @@ namespace Evernus
         return (mOrders) ? (mOrders.get()) : (nullptr);
     }
 
+    const ExternalOrderBook *MarketAnalysisWidget::getOrderBook() const
+    {
+        return &mOrderBook;
+    }
+
     void MarketAnalysisWidget::setCharacter(Character::IdType id)
     {
         qDebug() << "Setting market analysis character to" << id;
@@ -283,14 +295,16 @@ namespace Evernus
 
     void MarketAnalysisWidget::importData(const TypeLocationPairs &pairs)
     {
-        mOrders = std::make_shared<MarketAnalysisDataFetcher::OrderResultType::element_type>();
-        mHistory = std::make_shared<MarketAnalysisDataFetcher::HistoryResultType::element_type>();
-
-        mInterRegionAnalysisWidget->clearData();
+        // inter-region data might still be calculated from current orders
+        mInterRegionAnalysisWidget->cancelCalculation();
         mImportingAnalysisWidget->clearData();
         mOreReprocessingArbitrageWidget->clearData();
         mScrapmetalReprocessingArbitrageWidget->clearData();
 
+        mOrders = std::make_shared<MarketAnalysisDataFetcher::OrderResultType::element_type>();
+        mOrderBook = ExternalOrderBook{};
+        mHistory = std::make_shared<MarketAnalysisDataFetcher::HistoryResultType::element_type>();
+
         if (!mDataFetcher.hasPendingOrderRequests() && !mDataFetcher.hasPendingHistoryRequests())
         {
             const auto mainTask = mTaskManager.startTask(tr("Importing data for analysis..."));
@@ -346,7 +360,11 @@ namespace Evernus
     void MarketAnalysisWidget::endOrderTask(const MarketAnalysisDataFetcher::OrderResultType &orders, const QString &error)
     {
         Q_ASSERT(orders);
+
+        mInterRegionAnalysisWidget->cancelCalculation();
+
         mOrders = orders;
+        mOrderBook = ExternalOrderBook{*mOrders};
 
         if (error.isEmpty())
         {
@@ -370,6 +388,8 @@ namespace Evernus
     void MarketAnalysisWidget::endHistoryTask(const MarketAnalysisDataFetcher::HistoryResultType &history, const QString &error)
     {
         Q_ASSERT(history);
+
+        mInterRegionAnalysisWidget->cancelCalculation();
         mHistory = history;
 
         if (error.isEmpty())
@@ -18,6 +18,7 @@
 
 #include "MarketAnalysisDataFetcher.h"
 #include "ExternalOrderImporter.h"
+#include "ExternalOrderBook.h"
 #include "MarketDataProvider.h"
 #include "ExternalOrder.h"
 #include "TaskConstants.h"
@@ -35,6 +36,7 @@ namespace Evernus
     class RegionTypePresetRepository;
     class InterRegionAnalysisWidget;
     class ImportingAnalysisWidget;
+    class MarketHistoryRepository;
     class MarketOrderRepository;
     class MarketGroupRepository;
     class RegionAnalysisWidget;
@@ -61,12 +63,14 @@ namespace Evernus
                              const CharacterRepository &characterRepo,
                              const RegionTypePresetRepository &regionTypePresetRepo,
                              const RegionStationPresetRepository &regionStationPresetRepository,
+                             const MarketHistoryRepository &historyRepo,
                              QWidget *parent = nullptr);
-        virtual ~MarketAnalysisWidget() = default;
+        virtual ~MarketAnalysisWidget();
 
         virtual const HistoryMap *getHistory(uint regionId) const override;
         virtual const HistoryRegionMap *getHistory() const override;
         virtual const OrderResultType *getOrders() const override;
+        virtual const ExternalOrderBook *getOrderBook() const override;
 
     signals:
         void updateExternalOrders(const std::vector<ExternalOrder> &orders);
@@ -115,6 +119,7 @@ namespace Evernus
         uint mHistorySubtask = TaskConstants::invalidTask;
 
         MarketAnalysisDataFetcher::OrderResultType mOrders;
+        ExternalOrderBook mOrderBook;
         MarketAnalysisDataFetcher::HistoryResultType mHistory;
 
         MarketAnalysisDataFetcher mDataFetcher;
@@ -23,6 +23,7 @@
 
 namespace Evernus
 {
+    class ExternalOrderBook;
     class ExternalOrder;
 
     class MarketDataProvider
@@ -42,6 +43,7 @@ namespace Evernus
         virtual const HistoryMap *getHistory(uint regionId) const = 0;
         virtual const HistoryRegionMap *getHistory() const = 0;
         virtual const OrderResultType *getOrders() const = 0;
+        virtual const ExternalOrderBook *getOrderBook() const = 0;
 
         MarketDataProvider &operator =(const MarketDataProvider &) = default;
         MarketDataProvider &operator =(MarketDataProvider &&) = default;
@@ -0,0 +1,54 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QDate>
+
+#include "MarketHistoryEntry.h"
+#include "EveType.h"
+#include "Entity.h"
+
+namespace Evernus
+{
+    // single stored day of (region, type) history
+    class MarketHistoryDay
+        : public Entity<QDate>
+    {
+    public:
+        using Entity::Entity;
+
+        MarketHistoryDay() = default;
+        MarketHistoryDay(const MarketHistoryDay &) = default;
+        MarketHistoryDay(MarketHistoryDay &&) = default;
+        virtual ~MarketHistoryDay() = default;
+
+        uint getRegionId() const noexcept;
+        void setRegionId(uint id) noexcept;
+
+        EveType::IdType getTypeId() const noexcept;
+        void setTypeId(EveType::IdType id) noexcept;
+
+        const MarketHistoryEntry &getEntry() const noexcept;
+        void setEntry(const MarketHistoryEntry &entry) noexcept;
+
+        MarketHistoryDay &operator =(const MarketHistoryDay &) = default;
+        MarketHistoryDay &operator =(MarketHistoryDay &&) = default;
+
+    private:
+        uint mRegionId = 0;
+        EveType::IdType mTypeId = EveType::invalidId;
+        MarketHistoryEntry mEntry;
+    };
+}
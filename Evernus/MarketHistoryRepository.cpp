@@ -0,0 +1,242 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <iterator>
+
+#include <QSqlRecord>
+#include <QSqlQuery>
+
+#include "MarketHistoryRepository.h"
+
+namespace Evernus
+{
+    QString MarketHistoryRepository::getTableName() const
+    {
+        return QStringLiteral("market_history");
+    }
+
+    QString MarketHistoryRepository::getIdColumn() const
+    {
+        return QStringLiteral("date");
+    }
+
+    QString MarketHistoryRepository::getStateTableName() const
+    {
+        return QStringLiteral("market_history_state");
+    }
+
+    MarketHistoryRepository::EntityPtr MarketHistoryRepository::populate(const QSqlRecord &record) const
+    {
+        MarketHistoryEntry entry;
+        entry.mOrders = record.value(QStringLiteral("orders")).toUInt();
+        entry.mVolume = record.value(QStringLiteral("volume")).toULongLong();
+        entry.mLowPrice = record.value(QStringLiteral("low_price")).toDouble();
+        entry.mHighPrice = record.value(QStringLiteral("high_price")).toDouble();
+        entry.mAvgPrice = record.value(QStringLiteral("avg_price")).toDouble();
+
+        auto day = std::make_shared<MarketHistoryDay>(record.value(QStringLiteral("date")).toDate());
+        day->setRegionId(record.value(QStringLiteral("region_id")).toUInt());
+        day->setTypeId(record.value(QStringLiteral("type_id")).value<EveType::IdType>());
+        day->setEntry(entry);
+        day->setNew(false);
+
+        return day;
+    }
+
+    void MarketHistoryRepository::create() const
+    {
+        exec(QStringLiteral("CREATE TABLE IF NOT EXISTS %1 ("
+            "region_id INTEGER NOT NULL,"
+            "type_id INTEGER NOT NULL,"
+            "date DATE NOT NULL,"
+            "orders INTEGER NOT NULL,"
+            "volume BIGINT NOT NULL,"
+            "low_price DOUBLE NOT NULL,"
+            "high_price DOUBLE NOT NULL,"
+            "avg_price DOUBLE NOT NULL,"
+            "PRIMARY KEY (region_id, type_id, date)"
+        ") WITHOUT ROWID").arg(getTableName()));
+
+        exec(QStringLiteral("CREATE TABLE IF NOT EXISTS %1 ("
+            "region_id INTEGER NOT NULL,"
+            "type_id INTEGER NOT NULL,"
+            "last_date DATE NULL,"
+            "expires DATETIME NOT NULL,"
+            "PRIMARY KEY (region_id, type_id)"
+        ")").arg(getStateTableName()));
+    }
+
+    MarketHistoryRepository::ExpiryMap MarketHistoryRepository::fetchExpiries() const
+    {
+        auto query = prepare(QStringLiteral("SELECT type_id, region_id, expires FROM %1").arg(getStateTableName()));
+        DatabaseUtils::execQuery(query);
+
+        ExpiryMap result;
+
+        const auto size = query.size();
+        if (size > 0)
+            result.reserve(size);
+
+        while (query.next())
+        {
+            auto expires = query.value(2).toDateTime();
+            expires.setTimeSpec(Qt::UTC);
+
+            result.emplace(std::make_pair(query.value(0).value<EveType::IdType>(), query.value(1).toULongLong()), expires);
+        }
+
+        return result;
+    }
+
+    MarketHistoryRepository::TypeHistoryMap MarketHistoryRepository::fetchForRegion(uint regionId,
+                                                                                    const std::unordered_set<EveType::IdType> &types,
+                                                                                    const QDate &from) const
+    {
+        auto query = prepare(QStringLiteral(
+            "SELECT type_id, date, orders, volume, low_price, high_price, avg_price FROM %1 WHERE region_id = ? AND date >= ?"
+        ).arg(getTableName()));
+        query.addBindValue(regionId);
+        query.addBindValue(from);
+
+        DatabaseUtils::execQuery(query);
+
+        TypeHistoryMap result;
+        while (query.next())
+        {
+            const auto typeId = query.value(0).value<EveType::IdType>();
+            if (types.find(typeId) == std::end(types))
+                continue;
+
+            MarketHistoryEntry entry;
+            entry.mOrders = query.value(2).toUInt();
+            entry.mVolume = query.value(3).toULongLong();
+            entry.mLowPrice = query.value(4).toDouble();
+            entry.mHighPrice = query.value(5).toDouble();
+            entry.mAvgPrice = query.value(6).toDouble();
+
+            result[typeId].emplace(query.value(1).toDate(), entry);
+        }
+
+        return result;
+    }
+
+    void MarketHistoryRepository::store(const std::vector<PendingHistory> &histories) const
+    {
+        if (histories.empty())
+            return;
+
+        // take the write lock up front - a read transaction can't always be upgraded to a write one later (busy snapshot)
+        auto db = getDatabase();
+        exec(QStringLiteral("BEGIN IMMEDIATE"));
+
+        try
+        {
+            std::vector<MarketHistoryDay> days;
+
+            auto stateQuery = prepareCached(QStringLiteral("REPLACE INTO %1 (region_id, type_id, last_date, expires) VALUES (?, ?, ?, ?)")
+                .arg(getStateTableName()));
+
+            for (const auto &pending : histories)
+            {
+                const auto lastDate = fetchLastDate(pending.mRegionId, pending.mTypeId);
+                const auto &history = pending.mHistory;
+
+                // history days are final once published, so only the ones past what we have are appended
+                const auto first = (lastDate.isValid()) ? (history.upper_bound(lastDate)) : (std::begin(history));
+                for (auto it = first; it != std::end(history); ++it)
+                {
+                    MarketHistoryDay day{it->first};
+                    day.setRegionId(pending.mRegionId);
+                    day.setTypeId(pending.mTypeId);
+                    day.setEntry(it->second);
+
+                    days.emplace_back(std::move(day));
+                }
+
+                stateQuery.addBindValue(pending.mRegionId);
+                stateQuery.addBindValue(pending.mTypeId);
+                stateQuery.addBindValue((history.empty()) ? (lastDate) : (std::max(lastDate, std::prev(std::end(history))->first)));
+                stateQuery.addBindValue(pending.mExpires.toUTC());
+
+                DatabaseUtils::execQuery(stateQuery);
+            }
+
+            batchStore(days, true, false);
+        }
+        catch (...)
+        {
+            db.rollback();
+            throw;
+        }
+
+        db.commit();
+    }
+
+    QDate MarketHistoryRepository::fetchLastDate(uint regionId, EveType::IdType typeId) const
+    {
+        auto query = prepareCached(QStringLiteral("SELECT last_date FROM %1 WHERE region_id = ? AND type_id = ?").arg(getStateTableName()));
+        query.addBindValue(regionId);
+        query.addBindValue(typeId);
+
+        DatabaseUtils::execQuery(query);
+
+        const auto lastDate = (query.next()) ? (query.value(0).toDate()) : (QDate{});
+        query.finish();
+
+        return lastDate;
+    }
+
+    QStringList MarketHistoryRepository::getColumns() const
+    {
+        return {
+            QStringLiteral("region_id"),
+            QStringLiteral("type_id"),
+            QStringLiteral("date"),
+            QStringLiteral("orders"),
+            QStringLiteral("volume"),
+            QStringLiteral("low_price"),
+            QStringLiteral("high_price"),
+            QStringLiteral("avg_price"),
+        };
+    }
+
+    void MarketHistoryRepository::bindValues(const MarketHistoryDay &entity, QSqlQuery &query) const
+    {
+        const auto &entry = entity.getEntry();
+
+        query.bindValue(QStringLiteral(":region_id"), entity.getRegionId());
+        query.bindValue(QStringLiteral(":type_id"), entity.getTypeId());
+        query.bindValue(QStringLiteral(":date"), entity.getId());
+        query.bindValue(QStringLiteral(":orders"), entry.mOrders);
+        query.bindValue(QStringLiteral(":volume"), entry.mVolume);
+        query.bindValue(QStringLiteral(":low_price"), entry.mLowPrice);
+        query.bindValue(QStringLiteral(":high_price"), entry.mHighPrice);
+        query.bindValue(QStringLiteral(":avg_price"), entry.mAvgPrice);
+    }
+
+    void MarketHistoryRepository::bindPositionalValues(const MarketHistoryDay &entity, QSqlQuery &query) const
+    {
+        const auto &entry = entity.getEntry();
+
+        query.addBindValue(entity.getRegionId());
+        query.addBindValue(entity.getTypeId());
+        query.addBindValue(entity.getId());
+        query.addBindValue(entry.mOrders);
+        query.addBindValue(entry.mVolume);
+        query.addBindValue(entry.mLowPrice);
+        query.addBindValue(entry.mHighPrice);
+        query.addBindValue(entry.mAvgPrice);
+    }
+}
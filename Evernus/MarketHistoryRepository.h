@@ -0,0 +1,85 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <map>
+
+#include <QDateTime>
+#include <QString>
+#include <QDate>
+
+#include "MarketHistoryEntry.h"
+#include "TypeLocationPairs.h"
+#include "MarketHistoryDay.h"
+#include "Repository.h"
+#include "EveType.h"
+
+namespace Evernus
+{
+    // append-only store of market history keyed by (region, type, date)
+    // new days are appended after the last stored one; each (region, type) pair
+    // keeps the ESI expiry time, so fresh pairs can be served without network
+    class MarketHistoryRepository final
+        : public Repository<MarketHistoryDay>
+    {
+    public:
+        using HistoryMap = std::map<QDate, MarketHistoryEntry>;
+        using TypeHistoryMap = std::unordered_map<EveType::IdType, HistoryMap>;
+        // key is (type id, region id) - same as TypeLocationPairs
+        using ExpiryMap = std::unordered_map<TypeLocationPair, QDateTime, boost::hash<TypeLocationPair>>;
+
+        struct PendingHistory
+        {
+            uint mRegionId = 0;
+            EveType::IdType mTypeId = EveType::invalidId;
+            HistoryMap mHistory;
+            QDateTime mExpires;
+        };
+
+        using Repository::Repository;
+        MarketHistoryRepository(const MarketHistoryRepository &) = delete;
+        MarketHistoryRepository(MarketHistoryRepository &&) = delete;
+        virtual ~MarketHistoryRepository() = default;
+
+        virtual QString getTableName() const override;
+        virtual QString getIdColumn() const override;
+        QString getStateTableName() const;
+
+        virtual EntityPtr populate(const QSqlRecord &record) const override;
+
+        void create() const;
+
+        ExpiryMap fetchExpiries() const;
+        TypeHistoryMap fetchForRegion(uint regionId,
+                                      const std::unordered_set<EveType::IdType> &types,
+                                      const QDate &from) const;
+
+        // whole batch goes in a single transaction
+        void store(const std::vector<PendingHistory> &histories) const;
+
+        MarketHistoryRepository &operator =(const MarketHistoryRepository &) = delete;
+        MarketHistoryRepository &operator =(MarketHistoryRepository &&) = delete;
+
+    private:
+        virtual QStringList getColumns() const override;
+        virtual void bindValues(const MarketHistoryDay &entity, QSqlQuery &query) const override;
+        virtual void bindPositionalValues(const MarketHistoryDay &entity, QSqlQuery &query) const override;
+
+        QDate fetchLastDate(uint regionId, EveType::IdType typeId) const;
+    };
+}
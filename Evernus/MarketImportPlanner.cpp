@@ -0,0 +1,125 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <unordered_set>
+
+#include <QDataStream>
+#include <QtDebug>
+
+#include "MarketImportPlanner.h"
+
+namespace Evernus
+{
+    namespace
+    {
+        double smoothLatency(double current, qint64 latency, double factor) noexcept
+        {
+            return (current <= 0.) ? (latency) : (current + factor * (latency - current));
+        }
+    }
+
+    void MarketImportPlanner::recordRegionImport(uint regionId, uint pages, qint64 latency)
+    {
+        std::lock_guard<std::mutex> lock{mStatsMutex};
+
+        auto &stats = mRegionStats[regionId];
+        stats.mPages = pages;
+        stats.mPageLatency = smoothLatency(stats.mPageLatency, latency, latencySmoothing);
+    }
+
+    void MarketImportPlanner::recordTypeImport(uint regionId, qint64 latency)
+    {
+        std::lock_guard<std::mutex> lock{mStatsMutex};
+
+        auto &stats = mRegionStats[regionId];
+        stats.mTypeLatency = smoothLatency(stats.mTypeLatency, latency, latencySmoothing);
+    }
+
+    MarketImportPlanner::Plan MarketImportPlanner::plan(const TypeLocationPairs &target, const RegionGetter &getRegionId) const
+    {
+        // the same type in many stations of a region is still a single per-type request
+        std::unordered_map<uint, std::unordered_set<EveType::IdType>> regionTypes;
+        for (const auto &pair : target)
+            regionTypes[getRegionId(pair.second)].insert(pair.first);
+
+        std::lock_guard<std::mutex> lock{mStatsMutex};
+
+        Plan plan;
+        for (const auto &pair : target)
+        {
+            const auto regionId = getRegionId(pair.second);
+            if (regionId != 0 && useWholeImport(regionId, regionTypes[regionId].size()))
+                plan.mWholeImport.insert(pair);
+            else
+                plan.mIndividualImport.insert(pair);
+        }
+
+        qDebug() << "Market import plan:" << plan.mWholeImport.size() << "whole," << plan.mIndividualImport.size() << "individual.";
+
+        return plan;
+    }
+
+    bool MarketImportPlanner::useWholeImport(uint regionId, std::size_t typeCount) const
+    {
+        // compare total request time of both approaches; without latency data assume equal request costs
+        auto pages = defaultPages;
+        auto pageLatency = 1., typeLatency = 1.;
+
+        const auto stats = mRegionStats.find(regionId);
+        if (stats != std::end(mRegionStats))
+        {
+            if (stats->second.mPages > 0)
+                pages = stats->second.mPages;
+
+            if (stats->second.mPageLatency > 0. && stats->second.mTypeLatency > 0.)
+            {
+                pageLatency = stats->second.mPageLatency;
+                typeLatency = stats->second.mTypeLatency;
+            }
+        }
+
+        return pages * pageLatency < typeCount * typeLatency;
+    }
+
+    QDataStream &operator <<(QDataStream &stream, const MarketImportPlanner &planner)
+    {
+        std::lock_guard<std::mutex> lock{planner.mStatsMutex};
+
+        stream << static_cast<quint32>(planner.mRegionStats.size());
+        for (const auto &stats : planner.mRegionStats)
+            stream << static_cast<quint32>(stats.first) << stats.second.mPages << stats.second.mPageLatency << stats.second.mTypeLatency;
+
+        return stream;
+    }
+
+    QDataStream &operator >>(QDataStream &stream, MarketImportPlanner &planner)
+    {
+        std::lock_guard<std::mutex> lock{planner.mStatsMutex};
+
+        quint32 count = 0;
+        stream >> count;
+
+        planner.mRegionStats.clear();
+        for (auto i = 0u; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            quint32 regionId = 0;
+            MarketImportPlanner::RegionStats stats;
+
+            stream >> regionId >> stats.mPages >> stats.mPageLatency >> stats.mTypeLatency;
+            planner.mRegionStats.emplace(regionId, stats);
+        }
+
+        return stream;
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+
+#include "TypeLocationPairs.h"
+
+class QDataStream;
+
+namespace Evernus
+{
+    // chooses between whole region and per-type market imports, based on page counts and latencies seen so far
+    class MarketImportPlanner final
+    {
+    public:
+        struct Plan
+        {
+            TypeLocationPairs mWholeImport;
+            TypeLocationPairs mIndividualImport;
+        };
+
+        using RegionGetter = std::function<uint (quint64 locationId)>;
+
+        MarketImportPlanner() = default;
+        MarketImportPlanner(const MarketImportPlanner &) = delete;
+        MarketImportPlanner(MarketImportPlanner &&) = delete;
+        ~MarketImportPlanner() = default;
+
+        void recordRegionImport(uint regionId, uint pages, qint64 latency);
+        void recordTypeImport(uint regionId, qint64 latency);
+
+        // targets can point at stations or regions, hence the getter
+        Plan plan(const TypeLocationPairs &target, const RegionGetter &getRegionId) const;
+
+        MarketImportPlanner &operator =(const MarketImportPlanner &) = delete;
+        MarketImportPlanner &operator =(MarketImportPlanner &&) = delete;
+
+    private:
+        struct RegionStats
+        {
+            quint32 mPages = 0;
+            double mPageLatency = 0.;
+            double mTypeLatency = 0.;
+        };
+
+        static const quint32 defaultPages = 30; // regions not seen yet are assumed to be as busy as The Forge
+        static constexpr double latencySmoothing = 0.2;
+
+        std::unordered_map<uint, RegionStats> mRegionStats;
+        mutable std::mutex mStatsMutex;
+
+        bool useWholeImport(uint regionId, std::size_t typeCount) const;
+
+        friend QDataStream &operator <<(QDataStream &stream, const MarketImportPlanner &planner);
+        friend QDataStream &operator >>(QDataStream &stream, MarketImportPlanner &planner);
+    };
+}
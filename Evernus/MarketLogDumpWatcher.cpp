@@ -0,0 +1,208 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef Q_OS_LINUX
+#   include <sys/inotify.h>
+#   include <unistd.h>
+#   include <cerrno>
+#endif
+
+#include <QSocketNotifier>
+#include <QFileInfo>
+#include <QtDebug>
+#include <QFile>
+#include <QDir>
+
+#include "MarketLogDumpWatcher.h"
+
+namespace Evernus
+{
+    MarketLogDumpWatcher::MarketLogDumpWatcher(QObject *parent)
+        : QObject{parent}
+    {
+        mSettleTimer.setInterval(settleCheckInterval);
+
+        connect(&mSettleTimer, &QTimer::timeout, this, &MarketLogDumpWatcher::checkPendingLogs);
+        connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, &MarketLogDumpWatcher::scanDirectory);
+    }
+
+    MarketLogDumpWatcher::~MarketLogDumpWatcher()
+    {
+        stopNotifications();
+    }
+
+    bool MarketLogDumpWatcher::setPath(const QString &path)
+    {
+        stopNotifications();
+
+        const auto directories = mWatcher.directories();
+        if (!directories.isEmpty())
+            mWatcher.removePaths(directories);
+
+        mSettleTimer.stop();
+        mPendingLogs.clear();
+
+        mPath = path;
+        if (mPath.isEmpty())
+            return false;
+
+        if (startNotifications())
+            return true;
+
+        if (!mWatcher.addPath(mPath))
+            return false;
+
+        mKnownLogs = getCurrentLogs();
+        return true;
+    }
+
+    void MarketLogDumpWatcher::setSettleTime(uint msecs) noexcept
+    {
+        mSettleTime = msecs;
+    }
+
+    void MarketLogDumpWatcher::scanDirectory()
+    {
+        auto currentLogs = getCurrentLogs();
+        for (auto log = std::begin(currentLogs); log != std::end(currentLogs); ++log)
+        {
+            const auto known = mKnownLogs.constFind(log.key());
+            if (known != mKnownLogs.constEnd() && known->mSize == log->mSize && known->mModified == log->mModified)
+                continue;
+
+            auto &pending = mPendingLogs[log.key()];
+            pending.mState = log.value();
+            pending.mStableTimer.start();
+        }
+
+        mKnownLogs = std::move(currentLogs);
+
+        if (!mPendingLogs.isEmpty() && !mSettleTimer.isActive())
+            mSettleTimer.start();
+    }
+
+    void MarketLogDumpWatcher::checkPendingLogs()
+    {
+        for (auto log = std::begin(mPendingLogs); log != std::end(mPendingLogs);)
+        {
+            const QFileInfo info{log.key()};
+            if (!info.exists())
+            {
+                log = mPendingLogs.erase(log);
+                continue;
+            }
+
+            if (info.size() != log->mState.mSize || info.lastModified() != log->mState.mModified)
+            {
+                // still being written
+                log->mState.mSize = info.size();
+                log->mState.mModified = info.lastModified();
+                log->mStableTimer.start();
+            }
+            else if (log->mStableTimer.elapsed() >= static_cast<qint64>(mSettleTime))
+            {
+                mKnownLogs[log.key()] = log->mState;
+
+                emit logReady(log.key());
+
+                log = mPendingLogs.erase(log);
+                continue;
+            }
+
+            ++log;
+        }
+
+        if (mPendingLogs.isEmpty())
+            mSettleTimer.stop();
+    }
+
+    void MarketLogDumpWatcher::readNotifications()
+    {
+#ifdef Q_OS_LINUX
+        alignas(inotify_event) char buffer[4096];
+
+        while (true)
+        {
+            const auto length = read(mNotifyFd, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                if (length < 0 && errno != EAGAIN && errno != EINTR)
+                    qWarning() << "Error reading market log notifications:" << errno;
+
+                break;
+            }
+
+            for (auto ptr = buffer; ptr < buffer + length;)
+            {
+                const auto event = reinterpret_cast<const inotify_event *>(ptr);
+                if (event->len > 0)
+                {
+                    const auto fileName = QString::fromLocal8Bit(event->name);
+                    if (fileName.endsWith(QStringLiteral(".txt"), Qt::CaseInsensitive))
+                        emit logReady(QDir{mPath}.filePath(fileName));
+                }
+
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+#endif
+    }
+
+    bool MarketLogDumpWatcher::startNotifications()
+    {
+#ifdef Q_OS_LINUX
+        mNotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mNotifyFd == -1)
+            return false;
+
+        // Eve writes a log in one go, so a close after writing means it's complete
+        if (inotify_add_watch(mNotifyFd, QFile::encodeName(mPath).constData(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+        {
+            stopNotifications();
+            return false;
+        }
+
+        mNotifier = std::make_unique<QSocketNotifier>(mNotifyFd, QSocketNotifier::Read);
+        connect(mNotifier.get(), &QSocketNotifier::activated, this, &MarketLogDumpWatcher::readNotifications);
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void MarketLogDumpWatcher::stopNotifications()
+    {
+        mNotifier.reset();
+
+#ifdef Q_OS_LINUX
+        if (mNotifyFd != -1)
+        {
+            close(mNotifyFd);
+            mNotifyFd = -1;
+        }
+#endif
+    }
+
+    QHash<QString, MarketLogDumpWatcher::FileState> MarketLogDumpWatcher::getCurrentLogs() const
+    {
+        QHash<QString, FileState> result;
+
+        const auto files = QDir{mPath}.entryInfoList(QStringList{"*.txt"}, QDir::Files | QDir::Readable);
+        for (const auto &file : files)
+            result.insert(file.absoluteFilePath(), { file.size(), file.lastModified() });
+
+        return result;
+    }
+}
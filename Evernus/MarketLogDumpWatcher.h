@@ -0,0 +1,92 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+
+#include <QFileSystemWatcher>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QHash>
+
+class QSocketNotifier;
+
+namespace Evernus
+{
+    // reports market logs once Eve has finished writing them
+    // on Linux we get inotify close-write events, elsewhere we wait for file size and time to settle
+    class MarketLogDumpWatcher final
+        : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit MarketLogDumpWatcher(QObject *parent = nullptr);
+        MarketLogDumpWatcher(const MarketLogDumpWatcher &) = delete;
+        MarketLogDumpWatcher(MarketLogDumpWatcher &&) = delete;
+        virtual ~MarketLogDumpWatcher();
+
+        // files already in the directory are not reported; empty path stops watching
+        bool setPath(const QString &path);
+        // how long a file must stay unchanged to be considered complete, when there are no close events
+        void setSettleTime(uint msecs) noexcept;
+
+        MarketLogDumpWatcher &operator =(const MarketLogDumpWatcher &) = delete;
+        MarketLogDumpWatcher &operator =(MarketLogDumpWatcher &&) = delete;
+
+    signals:
+        void logReady(const QString &filePath);
+
+    private slots:
+        void scanDirectory();
+        void checkPendingLogs();
+        void readNotifications();
+
+    private:
+        struct FileState
+        {
+            qint64 mSize = 0;
+            QDateTime mModified;
+        };
+
+        struct PendingLog
+        {
+            FileState mState;
+            QElapsedTimer mStableTimer;
+        };
+
+        static const auto settleCheckInterval = 20;
+
+        QString mPath;
+        uint mSettleTime = 1000;
+
+        QFileSystemWatcher mWatcher;
+        QTimer mSettleTimer;
+
+        QHash<QString, FileState> mKnownLogs;
+        QHash<QString, PendingLog> mPendingLogs;
+
+        int mNotifyFd = -1;
+        std::unique_ptr<QSocketNotifier> mNotifier;
+
+        bool startNotifications();
+        void stopNotifications();
+
+        QHash<QString, FileState> getCurrentLogs() const;
+    };
+}
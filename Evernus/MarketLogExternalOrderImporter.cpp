@@ -12,12 +12,35 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QFileInfo>
+#include <QSettings>
+
+#include <QtDebug>
+
+#include "PriceSettings.h"
+#include "PathSettings.h"
 #include "ExternalOrder.h"
+#include "PathUtils.h"
 
 #include "MarketLogExternalOrderImporter.h"
 
 namespace Evernus
 {
+    MarketLogExternalOrderImporter::MarketLogExternalOrderImporter(QObject *parent)
+        : ExternalOrderImporter{parent}
+    {
+        // many logs can come at once, e.g. when going through a list of items - they are all stored (and valued) together
+        mLogBatchTimer.setSingleShot(true);
+        mLogBatchTimer.setInterval(logBatchDelay);
+
+        connect(&mLogBatchTimer, &QTimer::timeout, this, &MarketLogExternalOrderImporter::parseReadyLogs);
+        connect(&mLogWatcher, &MarketLogDumpWatcher::logReady, this, &MarketLogExternalOrderImporter::addReadyLog);
+
+        handleNewPreferences();
+    }
+
     MarketLogExternalOrderImporter::~MarketLogExternalOrderImporter()
     {
         try
@@ -49,6 +72,32 @@ namespace Evernus
         mScanningThreads.emplace_back(std::move(thread));
     }
 
+    void MarketLogExternalOrderImporter::handleNewPreferences()
+    {
+        mLogBatchTimer.stop();
+        mReadyLogs.clear();
+
+        QSettings settings;
+        if (!settings.value(PathSettings::watchLogsKey, PathSettings::watchLogsDefault).toBool())
+        {
+            mLogWatcher.setPath(QString{});
+            return;
+        }
+
+        mLogWatcher.setSettleTime(settings.value(PriceSettings::importLogWaitTimeKey, PriceSettings::importLogWaitTimeDefault).toUInt());
+        mIsOwnOrderLog = MarketLogExternalOrderImporterThread::getOwnOrderLogFilter();
+
+        // whatever is there already is left for regular imports
+        const auto logPath = PathUtils::getMarketLogsPath();
+        if (logPath.isEmpty() || !mLogWatcher.setPath(logPath))
+        {
+            qWarning() << "Cannot watch market logs in:" << logPath;
+            return;
+        }
+
+        qDebug() << "Watching market logs in:" << logPath;
+    }
+
     void MarketLogExternalOrderImporter::threadFinished(const ExternalOrderList &orders)
     {
         deleteThread(static_cast<MarketLogExternalOrderImporterThread *>(sender()));
@@ -61,6 +110,58 @@ namespace Evernus
         emit externalOrdersChanged(info, {});
     }
 
+    void MarketLogExternalOrderImporter::addReadyLog(const QString &filePath)
+    {
+        if (mIsOwnOrderLog && mIsOwnOrderLog(QFileInfo{filePath}.fileName()))
+            return;
+
+        mReadyLogs.insert(filePath);
+
+        if (!mLogBatchTimer.isActive())
+            mLogBatchTimer.start();
+    }
+
+    void MarketLogExternalOrderImporter::parseReadyLogs()
+    {
+        if (mReadyLogs.isEmpty())
+            return;
+
+        qDebug() << "Parsing" << mReadyLogs.size() << "new market logs.";
+
+        std::vector<MarketLogExternalOrderImporterThread::LogFile> logs;
+        logs.reserve(mReadyLogs.size());
+
+        for (const auto &path : mReadyLogs)
+        {
+            MarketLogExternalOrderImporterThread::LogFile log;
+            log.mPath = path;
+
+            logs.emplace_back(std::move(log));
+        }
+
+        mReadyLogs.clear();
+
+        using Watcher = QFutureWatcher<ExternalOrderList>;
+
+        auto watcher = new Watcher{this};
+        connect(watcher, &Watcher::finished, this, [=] {
+            watcher->deleteLater();
+
+            const auto orders = watcher->result();
+            if (!orders.empty())
+                emit externalOrdersUpdated(orders);
+        });
+
+        watcher->setFuture(QtConcurrent::run([logs = std::move(logs)]() mutable {
+            // the margin tool might be reading the same logs, so deleting them is left to it and to regular imports
+            QtConcurrent::blockingMap(logs, [](auto &log) {
+                MarketLogExternalOrderImporterThread::parseLogFile(log, false);
+            });
+
+            return MarketLogExternalOrderImporterThread::getNewestOrders(logs);
+        }));
+    }
+
     void MarketLogExternalOrderImporter::deleteThread(MarketLogExternalOrderImporterThread *thread)
     {
         thread->deleteLater();
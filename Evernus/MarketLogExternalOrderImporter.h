@@ -17,8 +17,12 @@
 #include <memory>
 #include <list>
 
+#include <QTimer>
+#include <QSet>
+
 #include "MarketLogExternalOrderImporterThread.h"
 #include "ExternalOrderImporter.h"
+#include "MarketLogDumpWatcher.h"
 
 namespace Evernus
 {
@@ -30,18 +34,32 @@ namespace Evernus
     public:
         using ExternalOrderList = MarketLogExternalOrderImporterThread::ExternalOrderList;
 
-        using ExternalOrderImporter::ExternalOrderImporter;
+        explicit MarketLogExternalOrderImporter(QObject *parent = nullptr);
         virtual ~MarketLogExternalOrderImporter();
 
         virtual void fetchExternalOrders(Character::IdType id, const TypeLocationPairs &target) const override;
 
+        virtual void handleNewPreferences() override;
+
     private slots:
         void threadFinished(const ExternalOrderList &orders);
         void threadError(const QString &info);
 
+        void addReadyLog(const QString &filePath);
+        void parseReadyLogs();
+
     private:
+        static const int logBatchDelay = 100;
+
         mutable std::list<std::unique_ptr<MarketLogExternalOrderImporterThread>> mScanningThreads;
 
+        // watch mode - only complete new or modified logs are parsed, and logs which come together are pushed together
+        MarketLogDumpWatcher mLogWatcher;
+        QTimer mLogBatchTimer;
+        QSet<QString> mReadyLogs;
+
+        std::function<bool (const QString &)> mIsOwnOrderLog;
+
         void deleteThread(MarketLogExternalOrderImporterThread *thread);
     };
 }
@@ -12,13 +12,20 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <iterator>
+
 #include <QStringBuilder>
+#include <QElapsedTimer>
+#include <QtConcurrent>
 #include <QFileInfo>
 #include <QSettings>
 #include <QRegExp>
 #include <QFile>
 #include <QDir>
 
+#include <QtDebug>
+
 #include "PathSettings.h"
 #include "PathUtils.h"
 
@@ -35,76 +42,120 @@ namespace Evernus
             return;
         }
 
+        QElapsedTimer timer;
+        timer.start();
+
         const QDir basePath{logPath};
         const auto files = basePath.entryList(QStringList{"*.txt"}, QDir::Files | QDir::Readable);
 
-        ExternalOrderList result;
-
-        QSettings settings;
-        const auto deleteLogs = settings.value(PathSettings::deleteLogsKey, PathSettings::deleteLogsDefault).toBool();
-
-        const QRegExp charLogWildcard{
-            settings.value(PathSettings::characterLogWildcardKey, PathSettings::characterLogWildcardDefault).toString(),
-            Qt::CaseInsensitive,
-            QRegExp::Wildcard};
-        const QRegExp corpLogWildcard{
-            settings.value(PathSettings::corporationLogWildcardKey, PathSettings::corporationLogWildcardDefault).toString(),
-            Qt::CaseInsensitive,
-            QRegExp::Wildcard};
-
-        LogTimeMap timeMap;
+        const auto isOwnOrderLog = getOwnOrderLogFilter();
 
+        std::vector<LogFile> logs;
         for (const auto &file : files)
         {
-            if (isInterruptionRequested())
-                break;
-
-            if (charLogWildcard.exactMatch(file) || corpLogWildcard.exactMatch(file))
+            if (isOwnOrderLog(file))
                 continue;
 
-            getExternalOrder(logPath % "/" % file, result, deleteLogs, timeMap);
+            LogFile log;
+            log.mPath = logPath % "/" % file;
+
+            logs.emplace_back(std::move(log));
         }
 
+        if (isInterruptionRequested())
+            return;
+
+        QSettings settings;
+        const auto deleteLogs = settings.value(PathSettings::deleteLogsKey, PathSettings::deleteLogsDefault).toBool();
+
+        QtConcurrent::blockingMap(logs, [=](auto &log) {
+            parseLogFile(log, deleteLogs);
+        });
+
+        const auto result = getNewestOrders(logs);
+
+        qDebug() << "Parsed" << logs.size() << "market logs in" << timer.elapsed() << "ms.";
+
         emit finished(result);
     }
 
-    void MarketLogExternalOrderImporterThread::getExternalOrder(const QString &logPath, ExternalOrderList &orders, bool deleteLog, LogTimeMap &timeMap)
+    void MarketLogExternalOrderImporterThread::parseLogFile(LogFile &log, bool deleteLog)
     {
-        QFile file{logPath};
+        QFile file{log.mPath};
         if (!file.open(QIODevice::ReadOnly))
             return;
 
-        file.readLine();
-
-        QFileInfo info{file};
+        log.mPriceTime = QFileInfo{file}.created().toUTC();
 
-        const auto priceTime = info.created().toUTC();
+        // one read and one conversion per file; lines and values only reference the content
+        const auto content = QString::fromUtf8(file.readAll());
+        const auto lines = content.splitRef(QLatin1Char('\n'), QString::SkipEmptyParts);
         const auto logColumns = 14;
 
-        while (!file.atEnd())
+        // first line is the header
+        for (auto line = 1; line < lines.size(); ++line)
         {
-            const QString line = file.readLine();
-            const auto values = line.split(',');
-
+            const auto values = lines[line].split(QLatin1Char(','));
             if (values.count() >= logColumns)
             {
                 auto order = ExternalOrder::parseLogLine(values);
                 if (order.getId() == ExternalOrder::invalidId)
                     continue;
 
-                const auto it = timeMap.find(order.getTypeId());
-                if (it != std::end(timeMap) && priceTime < it->second)
-                    return;
+                order.setUpdateTime(log.mPriceTime);
 
-                timeMap[order.getTypeId()] = priceTime;
-
-                order.setUpdateTime(priceTime);
-
-                orders.emplace_back(std::move(order));
+                log.mOrders.emplace_back(std::move(order));
             }
         }
 
+        file.close();
+
         if (deleteLog)
             file.remove();
     }
+
+    MarketLogExternalOrderImporterThread::ExternalOrderList MarketLogExternalOrderImporterThread::getNewestOrders(std::vector<LogFile> &logs)
+    {
+        LogTimeMap timeMap;
+        for (const auto &log : logs)
+        {
+            for (const auto &order : log.mOrders)
+            {
+                auto &time = timeMap[order.getTypeId()];
+                if (time < log.mPriceTime)
+                    time = log.mPriceTime;
+            }
+        }
+
+        ExternalOrderList result;
+        for (auto &log : logs)
+        {
+            std::copy_if(std::make_move_iterator(std::begin(log.mOrders)),
+                         std::make_move_iterator(std::end(log.mOrders)),
+                         std::back_inserter(result),
+                         [&](const auto &order) {
+                return timeMap[order.getTypeId()] == log.mPriceTime;
+            });
+        }
+
+        return result;
+    }
+
+    std::function<bool (const QString &)> MarketLogExternalOrderImporterThread::getOwnOrderLogFilter()
+    {
+        QSettings settings;
+
+        const QRegExp charLogWildcard{
+            settings.value(PathSettings::characterLogWildcardKey, PathSettings::characterLogWildcardDefault).toString(),
+            Qt::CaseInsensitive,
+            QRegExp::Wildcard};
+        const QRegExp corpLogWildcard{
+            settings.value(PathSettings::corporationLogWildcardKey, PathSettings::corporationLogWildcardDefault).toString(),
+            Qt::CaseInsensitive,
+            QRegExp::Wildcard};
+
+        return [=](const QString &fileName) {
+            return charLogWildcard.exactMatch(fileName) || corpLogWildcard.exactMatch(fileName);
+        };
+    }
 }
@@ -15,8 +15,10 @@
 #pragma once
 
 #include <unordered_map>
+#include <functional>
 #include <vector>
 
+#include <QDateTime>
 #include <QThread>
 
 #include "ExternalOrder.h"
@@ -33,9 +35,23 @@ namespace Evernus
     public:
         typedef std::vector<ExternalOrder> ExternalOrderList;
 
+        struct LogFile
+        {
+            QString mPath;
+            QDateTime mPriceTime;
+            ExternalOrderList mOrders;
+        };
+
         using QThread::QThread;
         virtual ~MarketLogExternalOrderImporterThread() = default;
 
+        // fills in time and orders of a log with given path; different logs can be parsed concurrently
+        static void parseLogFile(LogFile &log, bool deleteLog);
+        // orders from the newest log of each type
+        static ExternalOrderList getNewestOrders(std::vector<LogFile> &logs);
+        // matches character and corporation order logs, which are not market data
+        static std::function<bool (const QString &)> getOwnOrderLogFilter();
+
     signals:
         void finished(const ExternalOrderList &orders);
         void error(const QString &info);
@@ -45,8 +61,6 @@ namespace Evernus
 
     private:
         typedef std::unordered_map<EveType::IdType, QDateTime> LogTimeMap;
-
-        static void getExternalOrder(const QString &logPath, ExternalOrderList &prices, bool deleteLog, LogTimeMap &timeMap);
     };
 }
 
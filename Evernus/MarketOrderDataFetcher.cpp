@@ -21,10 +21,10 @@
 #include <QSettings>
 #include <QtDebug>
 
+#include "ESIInterfaceManager.h"
 #include "EveDataProvider.h"
 #include "ImportSettings.h"
 #include "OrderSettings.h"
-#include "SSOUtils.h"
 
 #include "MarketOrderDataFetcher.h"
 
@@ -35,6 +35,7 @@ namespace Evernus
                                                    QObject *parent)
         : QObject{parent}
         , mDataProvider{dataProvider}
+        , mImportPlanner{interfaceManager.getMarketImportPlanner()}
         , mESIManager{mDataProvider, interfaceManager}
     {
         connect(&mESIManager, &ESIManager::error, this, &MarketOrderDataFetcher::genericError);
@@ -61,15 +62,24 @@ namespace Evernus
         QSettings settings;
         const auto marketImportType = static_cast<ImportSettings::MarketOrderImportType>(
             settings.value(ImportSettings::marketOrderImportTypeKey, static_cast<int>(ImportSettings::marketOrderImportTypeDefault)).toInt());
-        auto useWholeMarketImport = marketImportType == ImportSettings::MarketOrderImportType::Whole;
 
-        if (!useWholeMarketImport && marketImportType == ImportSettings::MarketOrderImportType::Auto)
-            useWholeMarketImport = SSOUtils::useWholeMarketImport(pairs, mDataProvider);
+        if (marketImportType == ImportSettings::MarketOrderImportType::Auto)
+        {
+            const auto plan = mImportPlanner.plan(pairs, [](auto regionId) {
+                return static_cast<uint>(regionId);
+            });
 
-        if (useWholeMarketImport)
+            importWholeMarketData(plan.mWholeImport);
+            importIndividualData(plan.mIndividualImport);
+        }
+        else if (marketImportType == ImportSettings::MarketOrderImportType::Whole)
+        {
             importWholeMarketData(pairs);
+        }
         else
+        {
             importIndividualData(pairs);
+        }
 
         if (settings.value(OrderSettings::importFromCitadelsKey, OrderSettings::importFromCitadelsDefault).toBool())
             importCitadelData(pairs, charId);
@@ -34,6 +34,8 @@
 
 namespace Evernus
 {
+    class MarketImportPlanner;
+
     class MarketOrderDataFetcher
         : public QObject
     {
@@ -61,6 +63,8 @@ namespace Evernus
     private:
         const EveDataProvider &mDataProvider;
 
+        const MarketImportPlanner &mImportPlanner;
+
         ESIManager mESIManager;
 
         ProgressiveCounter mOrderCounter;
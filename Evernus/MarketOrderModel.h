@@ -18,6 +18,7 @@
 #include <QDateTime>
 
 #include "WalletTransactionsModel.h"
+#include "IncrementalItemModel.h"
 #include "Character.h"
 
 namespace Evernus
@@ -25,7 +26,7 @@ namespace Evernus
     class MarketOrder;
 
     class MarketOrderModel
-        : public QAbstractItemModel
+        : public IncrementalItemModel<QAbstractItemModel>
     {
     public:
         struct Range
@@ -64,7 +65,7 @@ namespace Evernus
             Sell,
         };
 
-        using QAbstractItemModel::QAbstractItemModel;
+        using IncrementalItemModel::IncrementalItemModel;
         virtual ~MarketOrderModel() = default;
 
         virtual size_t getOrderCount() const = 0;
@@ -352,6 +352,32 @@ namespace Evernus
         return populate(query);
     }
 
+    MarketOrderRepository::EntityList MarketOrderRepository
+    ::fetchArchivedForCharacter(Character::IdType characterId, const QDateTime &from, const QDateTime &to) const
+    {
+        auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE character_id = ? AND last_seen BETWEEN ? AND ? ORDER BY last_seen").arg(getTableName()));
+        query.addBindValue(characterId);
+        query.addBindValue(from);
+        query.addBindValue(to);
+
+        DatabaseUtils::execQuery(query);
+
+        return populate(query);
+    }
+
+    MarketOrderRepository::EntityList MarketOrderRepository
+    ::fetchArchivedForCorporation(uint corporationId, const QDateTime &from, const QDateTime &to) const
+    {
+        auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE corporation_id = ? AND last_seen BETWEEN ? AND ? ORDER BY last_seen").arg(getTableName()));
+        query.addBindValue(corporationId);
+        query.addBindValue(from);
+        query.addBindValue(to);
+
+        DatabaseUtils::execQuery(query);
+
+        return populate(query);
+    }
+
     MarketOrderRepository::EntityList MarketOrderRepository::fetchFulfilled(const QDate &from, const QDate &to) const
     {
         auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE first_seen BETWEEN ? AND ? AND last_seen IS NOT NULL AND state = ?").arg(getTableName()));
@@ -98,6 +98,9 @@ namespace Evernus
         EntityList fetchForCorporation(uint corporationId, MarketOrder::Type type) const;
         EntityList fetchArchivedForCharacter(Character::IdType characterId) const;
         EntityList fetchArchivedForCorporation(uint corporationId) const;
+        // range scans on last_seen, ordered by it
+        EntityList fetchArchivedForCharacter(Character::IdType characterId, const QDateTime &from, const QDateTime &to) const;
+        EntityList fetchArchivedForCorporation(uint corporationId, const QDateTime &from, const QDateTime &to) const;
         EntityList fetchFulfilled(const QDate &from,
                                   const QDate &to) const;
         EntityList fetchFulfilledForCharacter(const QDate &from,
@@ -20,6 +20,36 @@
 
 namespace Evernus
 {
+    namespace
+    {
+        bool isSameOrder(const MarketOrder &a, const MarketOrder &b)
+        {
+            return a.getId() == b.getId() &&
+                   a.getCharacterId() == b.getCharacterId() &&
+                   a.getStationId() == b.getStationId() &&
+                   a.getCustomStationId() == b.getCustomStationId() &&
+                   a.getVolumeEntered() == b.getVolumeEntered() &&
+                   a.getVolumeRemaining() == b.getVolumeRemaining() &&
+                   a.getMinVolume() == b.getMinVolume() &&
+                   a.getDelta() == b.getDelta() &&
+                   a.getState() == b.getState() &&
+                   a.getTypeId() == b.getTypeId() &&
+                   a.getRange() == b.getRange() &&
+                   a.getAccountKey() == b.getAccountKey() &&
+                   a.getDuration() == b.getDuration() &&
+                   a.getEscrow() == b.getEscrow() &&
+                   a.getPrice() == b.getPrice() &&
+                   a.getType() == b.getType() &&
+                   a.getIssued() == b.getIssued() &&
+                   a.getFirstSeen() == b.getFirstSeen() &&
+                   a.getLastSeen() == b.getLastSeen() &&
+                   a.getCorporationId() == b.getCorporationId() &&
+                   a.getNotes() == b.getNotes() &&
+                   a.getColorTag() == b.getColorTag() &&
+                   a.isArchived() == b.isArchived();
+        }
+    }
+
     void MarketOrderTreeModel::TreeItem::appendChild(std::unique_ptr<TreeItem> &&child)
     {
         child->mParentItem = this;
@@ -41,11 +71,21 @@ namespace Evernus
         return static_cast<int>(mChildItems.size());
     }
 
+    std::vector<std::unique_ptr<MarketOrderTreeModel::TreeItem>> &MarketOrderTreeModel::TreeItem::children() noexcept
+    {
+        return mChildItems;
+    }
+
     const MarketOrder *MarketOrderTreeModel::TreeItem::getOrder() const noexcept
     {
         return mOrder.get();
     }
 
+    std::shared_ptr<MarketOrder> MarketOrderTreeModel::TreeItem::getSharedOrder() const noexcept
+    {
+        return mOrder;
+    }
+
     void MarketOrderTreeModel::TreeItem::setOrder(const std::shared_ptr<MarketOrder> &order) noexcept
     {
         mOrder = order;
@@ -66,6 +106,16 @@ namespace Evernus
         mGroupName = std::move(name);
     }
 
+    quintptr MarketOrderTreeModel::TreeItem::getGroupId() const noexcept
+    {
+        return mGroupId;
+    }
+
+    void MarketOrderTreeModel::TreeItem::setGroupId(quintptr id) noexcept
+    {
+        mGroupId = id;
+    }
+
     int MarketOrderTreeModel::TreeItem::row() const
     {
         if (mParentItem != nullptr)
@@ -88,6 +138,11 @@ namespace Evernus
         return mParentItem;
     }
 
+    void MarketOrderTreeModel::TreeItem::setParent(TreeItem *parent) noexcept
+    {
+        mParentItem = parent;
+    }
+
     MarketOrderTreeModel::MarketOrderTreeModel(const EveDataProvider &dataProvider,
                                                QObject *parent)
         : MarketOrderModel{parent}
@@ -259,18 +314,16 @@ namespace Evernus
 
     void MarketOrderTreeModel::reset()
     {
-        beginResetModel();
-
         const auto data = (mAllCharacters) ? (getOrdersForAllCharacters()) : (getOrders(mCharacterId));
 
-        mRootItem.clearChildren();
-
         mTotalOrders = 0;
         mVolumeRemaining = 0;
         mVolumeEntered = 0;
         mTotalISK = 0.;
         mTotalSize = 0.;
 
+        // build new items aside and bring current ones up to date with them, so views keep selection and expanded groups
+        std::vector<std::unique_ptr<TreeItem>> items;
         std::unordered_map<quintptr, TreeItem *> groupItems;
 
         for (const auto &order : data)
@@ -287,9 +340,11 @@ namespace Evernus
                 {
                     auto item = std::make_unique<TreeItem>();
                     item->setGroupName(getGroupingData(*order));
+                    item->setGroupId(id);
+                    item->setParent(&mRootItem);
 
                     auto itemPtr = item.get();
-                    mRootItem.appendChild(std::move(item));
+                    items.emplace_back(std::move(item));
 
                     it = groupItems.emplace(id, itemPtr).first;
                 }
@@ -298,7 +353,8 @@ namespace Evernus
             }
             else
             {
-                mRootItem.appendChild(std::move(item));
+                item->setParent(&mRootItem);
+                items.emplace_back(std::move(item));
             }
 
             if (order->getState() != MarketOrder::State::Active)
@@ -312,7 +368,31 @@ namespace Evernus
             ++mTotalOrders;
         }
 
-        endResetModel();
+        if (mGrouping != mRowGrouping)
+        {
+            beginResetModel();
+
+            mRowGrouping = mGrouping;
+            mRootItem.children() = std::move(items);
+
+            endResetModel();
+        }
+        else if (mGrouping == Grouping::None)
+        {
+            updateOrderItems(mRootItem, std::move(items), QModelIndex{}, true);
+        }
+        else
+        {
+            updateRows(mRootItem.children(), std::move(items), [](const auto &item) {
+                return item->getGroupId();
+            }, [](const auto &a, const auto &b) {
+                return a->getGroupName() == b->getGroupName();
+            }, QModelIndex{}, [this](auto &item, auto &&newItem) {
+                item->setGroupName(newItem->getGroupName());
+                // the outer update is still running, so children can't reset the model
+                updateOrderItems(*item, std::move(newItem->children()), createIndex(item->row(), 0, item.get()), false);
+            });
+        }
     }
 
     QString MarketOrderTreeModel::getGroupName(EveType::IdType typeId) const
@@ -359,4 +439,41 @@ namespace Evernus
             return QString{};
         }
     }
+
+    void MarketOrderTreeModel::refreshMarketData()
+    {
+        emitDataChanged(mRootItem, QModelIndex{});
+    }
+
+    void MarketOrderTreeModel::updateOrderItems(TreeItem &parentItem, std::vector<std::unique_ptr<TreeItem>> &&items, const QModelIndex &parent, bool allowReset)
+    {
+        // new items must point at their final parent before they get inserted
+        for (auto &item : items)
+            item->setParent(&parentItem);
+
+        // market data changes are signalled separately - see refreshMarketData()
+        updateRows(parentItem.children(), std::move(items), [](const auto &item) {
+            return item->getOrder()->getId();
+        }, [](const auto &a, const auto &b) {
+            return isSameOrder(*a->getOrder(), *b->getOrder());
+        }, parent, [](auto &item, auto &&newItem) {
+            item->setOrder(newItem->getSharedOrder());
+        }, allowReset);
+    }
+
+    void MarketOrderTreeModel::emitDataChanged(const TreeItem &parentItem, const QModelIndex &parent)
+    {
+        const auto rows = parentItem.childCount();
+        if (rows == 0)
+            return;
+
+        emit dataChanged(index(0, 0, parent), index(rows - 1, columnCount(parent) - 1, parent));
+
+        for (auto row = 0; row < rows; ++row)
+        {
+            const auto child = parentItem.child(row);
+            if (child->childCount() > 0)
+                emitDataChanged(*child, createIndex(row, 0, child));
+        }
+    }
 }
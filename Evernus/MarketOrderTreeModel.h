@@ -52,6 +52,8 @@ namespace Evernus
         void setGrouping(Grouping grouping);
 
         void reset();
+        // prices, costs and locations shown along with orders changed, while the orders might have not
+        void refreshMarketData();
 
     protected:
         class TreeItem
@@ -67,22 +69,30 @@ namespace Evernus
 
             int childCount() const;
 
+            std::vector<std::unique_ptr<TreeItem>> &children() noexcept;
+
             const MarketOrder *getOrder() const noexcept;
+            std::shared_ptr<MarketOrder> getSharedOrder() const noexcept;
             void setOrder(const std::shared_ptr<MarketOrder> &order) noexcept;
 
             QString getGroupName() const;
             void setGroupName(const QString &name);
             void setGroupName(QString &&name);
 
+            quintptr getGroupId() const noexcept;
+            void setGroupId(quintptr id) noexcept;
+
             int row() const;
 
             TreeItem *parent() const;
+            void setParent(TreeItem *parent) noexcept;
 
         private:
             std::vector<std::unique_ptr<TreeItem>> mChildItems;
             TreeItem *mParentItem = nullptr;
             std::shared_ptr<MarketOrder> mOrder;
             QString mGroupName;
+            quintptr mGroupId = 0;
         };
 
         typedef std::vector<std::shared_ptr<MarketOrder>> OrderList;
@@ -107,6 +117,9 @@ namespace Evernus
         Character::IdType mCharacterId = Character::invalidId;
         bool mAllCharacters = false;
 
+        // grouping of current rows, which can only be updated in place when it stays the same
+        Grouping mRowGrouping = Grouping::None;
+
         virtual OrderList getOrders(Character::IdType characterId) const = 0;
         virtual OrderList getOrdersForAllCharacters() const = 0;
 
@@ -116,5 +129,8 @@ namespace Evernus
 
         quintptr getGroupingId(const MarketOrder &order) const;
         QString getGroupingData(const MarketOrder &order) const;
+
+        void updateOrderItems(TreeItem &parentItem, std::vector<std::unique_ptr<TreeItem>> &&items, const QModelIndex &parent, bool allowReset);
+        void emitDataChanged(const TreeItem &parentItem, const QModelIndex &parent);
     };
 }
@@ -293,6 +293,15 @@ namespace Evernus
         expandAll();
     }
 
+    void MarketOrderWidget::updateMarketData()
+    {
+        updateData();
+
+        mSellModel.refreshMarketData();
+        mBuyModel.refreshMarketData();
+        mArchiveModel.refreshMarketData();
+    }
+
     void MarketOrderWidget::updateCharacters()
     {
         mSellView->updateCharacters();
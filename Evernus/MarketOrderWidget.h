@@ -75,6 +75,7 @@ namespace Evernus
 
     public slots:
         void updateData();
+        void updateMarketData();
         void updateCharacters();
 
     private slots:
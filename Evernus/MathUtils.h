@@ -40,6 +40,9 @@ namespace Evernus::MathUtils
                           bool discardBogusOrders,
                           double bogusOrderThreshold);
 
+    template<class T>
+    quint64 calcTotalVolume(const T &orders);
+
     template<class T>
     std::size_t batchSize(T value) noexcept;
 
@@ -64,6 +64,16 @@ namespace Evernus::MathUtils
         return result / maxVolume;
     }
 
+    template<class T>
+    quint64 calcTotalVolume(const T &orders)
+    {
+        quint64 volume = 0;
+        for (const auto &order : orders)
+            volume += order.get().getVolumeRemaining();
+
+        return volume;
+    }
+
     template<class T>
     std::size_t batchSize(T value) noexcept
     {
@@ -107,6 +107,22 @@ namespace Evernus
         mMaxRetriesEdit->setValue(
             settings.value(NetworkSettings::maxRetriesKey, NetworkSettings::maxRetriesDefault).toUInt());
 
+        mMaxConcurrentESIRequestsEdit = new QSpinBox{this};
+        miscGroupLayout->addRow(tr("Max. concurrent ESI requests:"), mMaxConcurrentESIRequestsEdit);
+        mMaxConcurrentESIRequestsEdit->setRange(1, 200);
+        mMaxConcurrentESIRequestsEdit->setToolTip(tr("Takes effect after restart."));
+        mMaxConcurrentESIRequestsEdit->setValue(
+            settings.value(NetworkSettings::maxConcurrentESIRequestsKey, NetworkSettings::maxConcurrentESIRequestsDefault).toUInt());
+
+        mESICacheSizeEdit = new QSpinBox{this};
+        miscGroupLayout->addRow(tr("ESI response cache size:"), mESICacheSizeEdit);
+        mESICacheSizeEdit->setRange(0, 100000);
+        mESICacheSizeEdit->setSuffix(tr(" MB"));
+        mESICacheSizeEdit->setSpecialValueText(tr("disabled"));
+        mESICacheSizeEdit->setToolTip(tr("Unchanged ESI replies are served from this cache. Takes effect after restart."));
+        mESICacheSizeEdit->setValue(
+            settings.value(NetworkSettings::esiCacheSizeKey, NetworkSettings::esiCacheSizeDefault).toUInt());
+
         mIgnoreSslErrors = new QCheckBox{tr("Ignore certificate errors"), this};
         miscGroupLayout->addRow(mIgnoreSslErrors);
         mIgnoreSslErrors->setChecked(
@@ -162,6 +178,8 @@ namespace Evernus
 
         settings.setValue(NetworkSettings::maxReplyTimeKey, mMaxReplyTimeEdit->value());
         settings.setValue(NetworkSettings::maxRetriesKey, mMaxRetriesEdit->value());
+        settings.setValue(NetworkSettings::maxConcurrentESIRequestsKey, mMaxConcurrentESIRequestsEdit->value());
+        settings.setValue(NetworkSettings::esiCacheSizeKey, mESICacheSizeEdit->value());
         settings.setValue(NetworkSettings::ignoreSslErrorsKey, mIgnoreSslErrors->isChecked());
         settings.setValue(NetworkSettings::logESIRepliesKey, mLogESIReplies->isChecked());
         settings.setValue(NetworkSettings::useHTTP2Key, mUseHTTP2->isChecked());
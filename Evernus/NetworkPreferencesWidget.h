@@ -53,6 +53,8 @@ namespace Evernus
 
         QSpinBox *mMaxReplyTimeEdit = nullptr;
         QSpinBox *mMaxRetriesEdit = nullptr;
+        QSpinBox *mMaxConcurrentESIRequestsEdit = nullptr;
+        QSpinBox *mESICacheSizeEdit = nullptr;
         QCheckBox *mIgnoreSslErrors = nullptr;
         QCheckBox *mLogESIReplies = nullptr;
         QCheckBox *mUseHTTP2 = nullptr;
@@ -29,6 +29,8 @@ namespace Evernus
         const auto maxRetriesDefault = 3u;
         const auto logESIRepliesDefault = false;
         const auto useHTTP2Default = true;
+        const auto maxConcurrentESIRequestsDefault = 20u;
+        const auto esiCacheSizeDefault = 512u;
 
         const auto cryptKey = Q_UINT64_C(0x468c4a0e33a6fe01);
 
@@ -43,5 +45,7 @@ namespace Evernus
         const auto maxRetriesKey = QStringLiteral("network/maxRetries");
         const auto logESIRepliesKey = QStringLiteral("network/logESIReplies");
         const auto useHTTP2Key = QStringLiteral("network/useHTTP2");
+        const auto maxConcurrentESIRequestsKey = QStringLiteral("network/maxConcurrentESIRequests");
+        const auto esiCacheSizeKey = QStringLiteral("network/esiCacheSize");
     }
 }
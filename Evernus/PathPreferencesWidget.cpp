@@ -61,6 +61,10 @@ namespace Evernus
         marketLogGroupLayout->addRow(mDeleteLogsBtn);
         mDeleteLogsBtn->setChecked(settings.value(PathSettings::deleteLogsKey, PathSettings::deleteLogsDefault).toBool());
 
+        mWatchLogsBtn = new QCheckBox{tr("Import new logs as soon as they appear"), this};
+        marketLogGroupLayout->addRow(mWatchLogsBtn);
+        mWatchLogsBtn->setChecked(settings.value(PathSettings::watchLogsKey, PathSettings::watchLogsDefault).toBool());
+
         mCharacterLogWildcardEdit = new QLineEdit{
             settings.value(PathSettings::characterLogWildcardKey, PathSettings::characterLogWildcardDefault).toString(), this};
         marketLogGroupLayout->addRow(tr("Character log file name wildcard:"), mCharacterLogWildcardEdit);
@@ -77,6 +81,7 @@ namespace Evernus
         QSettings settings;
         settings.setValue(PathSettings::marketLogsPathKey, mMarketLogPathEdit->text());
         settings.setValue(PathSettings::deleteLogsKey, mDeleteLogsBtn->isChecked());
+        settings.setValue(PathSettings::watchLogsKey, mWatchLogsBtn->isChecked());
         settings.setValue(PathSettings::characterLogWildcardKey, mCharacterLogWildcardEdit->text());
         settings.setValue(PathSettings::corporationLogWildcardKey, mCorporationLogWildcardEdit->text());
     }
@@ -39,6 +39,7 @@ namespace Evernus
     private:
         QLineEdit *mMarketLogPathEdit = nullptr;
         QCheckBox *mDeleteLogsBtn = nullptr;
+        QCheckBox *mWatchLogsBtn = nullptr;
         QLineEdit *mCharacterLogWildcardEdit = nullptr;
         QLineEdit *mCorporationLogWildcardEdit = nullptr;
     };
@@ -23,9 +23,11 @@ namespace Evernus
         const auto characterLogWildcardDefault = QStringLiteral("My Orders-*.txt");
         const auto corporationLogWildcardDefault = QStringLiteral("Corporation Orders-*.txt");
         const auto deleteLogsDefault = true;
+        const auto watchLogsDefault = false;
 
         const auto marketLogsPathKey = QStringLiteral("path/marketLogs/path");
         const auto deleteLogsKey = QStringLiteral("path/marketLogs/delete");
+        const auto watchLogsKey = QStringLiteral("path/marketLogs/watch");
         const auto characterLogWildcardKey = QStringLiteral("path/marketLogs/characterWildcard");
         const auto corporationLogWildcardKey = QStringLiteral("path/marketLogs/corporationWildcard");
     }
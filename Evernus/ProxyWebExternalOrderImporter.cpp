@@ -14,9 +14,12 @@
  */
 #include <QSettings>
 
-#include "ProxyWebExternalOrderImporter.h"
+#include "ESIInterfaceManager.h"
+#include "ExternalOrder.h"
 #include "SSOUtils.h"
 
+#include "ProxyWebExternalOrderImporter.h"
+
 namespace Evernus
 {
     ProxyWebExternalOrderImporter::ProxyWebExternalOrderImporter(const EveDataProvider &dataProvider,
@@ -24,6 +27,7 @@ namespace Evernus
                                                                  QObject *parent)
         : ExternalOrderImporter{parent}
         , mDataProvider{dataProvider}
+        , mImportPlanner{interfaceManager.getMarketImportPlanner()}
         , mESIIndividualImporter{
             std::make_unique<ESIIndividualExternalOrderImporter>(mDataProvider, interfaceManager, parent)
         }
@@ -41,10 +45,22 @@ namespace Evernus
     {
         if (mCurrentOrderImportType == ImportSettings::MarketOrderImportType::Auto)
         {
-            if (SSOUtils::useWholeMarketImport(target, mDataProvider))
+            const auto plan = SSOUtils::planMarketImport(target, mDataProvider, mImportPlanner);
+            if (plan.mIndividualImport.empty())
+            {
                 mESIWholeImporter->fetchExternalOrders(id, target);
-            else
+            }
+            else if (plan.mWholeImport.empty())
+            {
                 mESIIndividualImporter->fetchExternalOrders(id, target);
+            }
+            else
+            {
+                mPendingImports = 2;
+
+                mESIWholeImporter->fetchExternalOrders(id, plan.mWholeImport);
+                mESIIndividualImporter->fetchExternalOrders(id, plan.mIndividualImport);
+            }
         }
         else if (mCurrentOrderImportType == ImportSettings::MarketOrderImportType::Individual)
         {
@@ -61,11 +77,33 @@ namespace Evernus
         setCurrentImporter();
     }
 
+    void ProxyWebExternalOrderImporter::processImporterResult(const QString &info, const std::vector<ExternalOrder> &orders)
+    {
+        if (mPendingImports == 0)
+        {
+            emit externalOrdersChanged(info, orders);
+            return;
+        }
+
+        if (!info.isEmpty())
+            mAggregatedInfo << info;
+
+        mAggregatedOrders.insert(std::end(mAggregatedOrders), std::begin(orders), std::end(orders));
+
+        if (--mPendingImports == 0)
+        {
+            emit externalOrdersChanged(mAggregatedInfo.join(QStringLiteral("\n")), mAggregatedOrders);
+
+            mAggregatedInfo.clear();
+            mAggregatedOrders.clear();
+        }
+    }
+
     template<class T>
     void ProxyWebExternalOrderImporter::connectImporter(T &importer)
     {
         connect(&importer, &T::externalOrdersChanged,
-                this, &ProxyWebExternalOrderImporter::externalOrdersChanged);
+                this, &ProxyWebExternalOrderImporter::processImporterResult);
         connect(&importer, &T::statusChanged,
                 this, &ProxyWebExternalOrderImporter::statusChanged);
     }
@@ -14,6 +14,10 @@
  */
 #pragma once
 
+#include <vector>
+
+#include <QStringList>
+
 #include "ESIIndividualExternalOrderImporter.h"
 #include "ESIWholeExternalOrderImporter.h"
 #include "ImportSettings.h"
@@ -21,6 +25,7 @@
 namespace Evernus
 {
     class ESIInterfaceManager;
+    class MarketImportPlanner;
     class EveDataProvider;
 
     class ProxyWebExternalOrderImporter
@@ -39,14 +44,23 @@ namespace Evernus
     public slots:
         void handleNewPreferences();
 
+    private slots:
+        void processImporterResult(const QString &info, const std::vector<ExternalOrder> &orders);
+
     private:
         const EveDataProvider &mDataProvider;
+        const MarketImportPlanner &mImportPlanner;
 
         std::unique_ptr<ESIIndividualExternalOrderImporter> mESIIndividualImporter;
         std::unique_ptr<ESIWholeExternalOrderImporter> mESIWholeImporter;
 
         ImportSettings::MarketOrderImportType mCurrentOrderImportType = ImportSettings::marketOrderImportTypeDefault;
 
+        // mixed imports are reported once both importers are done
+        mutable uint mPendingImports = 0;
+        mutable QStringList mAggregatedInfo;
+        mutable std::vector<ExternalOrder> mAggregatedOrders;
+
         template<class T>
         void connectImporter(T &importer);
         void setCurrentImporter();
@@ -392,7 +392,7 @@ namespace Evernus
         if (history == nullptr)
             history = &mEmptyHistory;
 
-        auto orders = mMarketDataProvider.getOrders();
+        auto orders = mMarketDataProvider.getOrderBook();
         if (orders == nullptr)
             orders = &mEmptyOrders;
 
@@ -19,6 +19,7 @@
 #include "TypeAggregatedMarketDataModel.h"
 #include "StandardModelProxyWidget.h"
 #include "ExternalOrderImporter.h"
+#include "ExternalOrderBook.h"
 #include "MarketDataProvider.h"
 #include "ExternalOrder.h"
 #include "TaskConstants.h"
@@ -73,7 +74,7 @@ namespace Evernus
         void showDetailsForCurrent();
 
     private:
-        using HistoryOrdersPair = std::pair<const MarketDataProvider::HistoryMap *, const MarketDataProvider::OrderResultType *>;
+        using HistoryOrdersPair = std::pair<const MarketDataProvider::HistoryMap *, const ExternalOrderBook *>;
 
         static const auto waitingLabelIndex = 0;
 
@@ -101,7 +102,7 @@ namespace Evernus
         QCheckBox *mIgnorePricePercentilesBtn = nullptr;
 
         MarketDataProvider::HistoryMap mEmptyHistory;
-        MarketDataProvider::OrderResultType mEmptyOrders;
+        ExternalOrderBook mEmptyOrders;
 
         TypeAggregatedMarketDataModel mTypeDataModel;
         TypeAggregatedMarketDataFilterProxyModel mTypeViewProxy;
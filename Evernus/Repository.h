@@ -18,11 +18,12 @@
 #include <memory>
 
 #include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include "DatabaseConnectionProvider.h"
 
 namespace Evernus
 {
-    class DatabaseConnectionProvider;
-
     template<class T>
     class Repository
     {
@@ -42,6 +43,10 @@ namespace Evernus
 
         QSqlQuery exec(const QString &query) const;
         QSqlQuery prepare(const QString &queryStr) const;
+        // statement is compiled once per connection and reused on later calls - finish() reads which don't reach the end
+        QSqlQuery prepareCached(const QString &queryStr) const;
+        // same as above, on a connection which never waits for writers; for plain reads outside transactions
+        QSqlQuery prepareCachedReadOnly(const QString &queryStr) const;
         void store(T &entity) const;
 
         template<class U>
@@ -56,6 +61,7 @@ namespace Evernus
         EntityPtr find(Id &&id) const;
 
         QSqlDatabase getDatabase() const;
+        QSqlDatabase getReadOnlyDatabase() const;
 
         typename T::IdType getLastInsertId() const;
 
@@ -65,6 +71,9 @@ namespace Evernus
     private:
         const DatabaseConnectionProvider &mConnectionProvider;
 
+        QSqlQuery prepare(const QSqlDatabase &db, const QString &queryStr) const;
+        QSqlQuery prepareCached(const QSqlDatabase &db, DatabaseConnectionProvider::StatementCache &cache, const QString &queryStr) const;
+
         void insert(T &entity) const;
         void update(const T &entity) const;
 
@@ -22,6 +22,7 @@
 
 #include "DatabaseConnectionProvider.h"
 #include "DatabaseUtils.h"
+#include "LogCategories.h"
 
 namespace Evernus
 {
@@ -34,7 +35,7 @@ namespace Evernus
     template<class T>
     QSqlQuery Repository<T>::exec(const QString &query) const
     {
-        qDebug() << "SQL:" << query;
+        qCDebug(sqlLog) << "SQL:" << query;
 
         const auto db = getDatabase();
 
@@ -55,16 +56,19 @@ namespace Evernus
     template<class T>
     QSqlQuery Repository<T>::prepare(const QString &queryStr) const
     {
-        QSqlQuery query{getDatabase()};
-        if (!query.prepare(queryStr))
-        {
-            const auto error = query.lastError().text();
+        return prepare(getDatabase(), queryStr);
+    }
 
-            qCritical() << error;
-            throw std::runtime_error{error.toStdString()};
-        }
+    template<class T>
+    QSqlQuery Repository<T>::prepareCached(const QString &queryStr) const
+    {
+        return prepareCached(getDatabase(), mConnectionProvider.getStatementCache(), queryStr);
+    }
 
-        return query;
+    template<class T>
+    QSqlQuery Repository<T>::prepareCachedReadOnly(const QString &queryStr) const
+    {
+        return prepareCached(getReadOnlyDatabase(), mConnectionProvider.getReadOnlyStatementCache(), queryStr);
     }
 
     template<class T>
@@ -125,15 +129,18 @@ namespace Evernus
 
         try
         {
-            for (auto batch = 0u; batch < batches; ++batch)
+            if (batches > 0)
             {
-                auto query = prepare(batchQueryStr);
-
-                const auto end = std::next(std::begin(entities), (batch + 1) * maxRowsPerInsert);
-                for (auto row = std::next(std::begin(entities), batch * maxRowsPerInsert); row != end; ++row)
-                    bindPositionalValues(*row, query);
-
-                DatabaseUtils::execQuery(query);
+                // full batches all share one statement
+                auto query = prepareCached(batchQueryStr);
+                for (auto batch = 0u; batch < batches; ++batch)
+                {
+                    const auto end = std::next(std::begin(entities), (batch + 1) * maxRowsPerInsert);
+                    for (auto row = std::next(std::begin(entities), batch * maxRowsPerInsert); row != end; ++row)
+                        bindPositionalValues(*row, query);
+
+                    DatabaseUtils::execQuery(query);
+                }
             }
 
             const auto reminder = totalRows % maxRowsPerInsert;
@@ -168,7 +175,7 @@ namespace Evernus
     template<class Id>
     void Repository<T>::remove(Id &&id) const
     {
-        auto query = prepare(QStringLiteral("DELETE FROM %1 WHERE %2 = :id").arg(getTableName()).arg(getIdColumn()));
+        auto query = prepareCached(QStringLiteral("DELETE FROM %1 WHERE %2 = :id").arg(getTableName()).arg(getIdColumn()));
         query.bindValue(QStringLiteral(":id"), id);
         DatabaseUtils::execQuery(query);
     }
@@ -193,14 +200,17 @@ namespace Evernus
     template<class Id>
     typename Repository<T>::EntityPtr Repository<T>::find(Id &&id) const
     {
-        auto query = prepare(QStringLiteral("SELECT * FROM %1 WHERE %2 = :id").arg(getTableName()).arg(getIdColumn()));
+        auto query = prepareCached(QStringLiteral("SELECT * FROM %1 WHERE %2 = :id").arg(getTableName()).arg(getIdColumn()));
         query.bindValue(QStringLiteral(":id"), id);
         DatabaseUtils::execQuery(query);
 
         if (!query.next())
             throw NotFoundException{};
 
-        return populate(query.record());
+        const auto entity = populate(query.record());
+        query.finish();
+
+        return entity;
     }
 
     template<class T>
@@ -209,6 +219,40 @@ namespace Evernus
         return mConnectionProvider.getConnection();
     }
 
+    template<class T>
+    QSqlDatabase Repository<T>::getReadOnlyDatabase() const
+    {
+        return mConnectionProvider.getReadOnlyConnection();
+    }
+
+    template<class T>
+    QSqlQuery Repository<T>::prepare(const QSqlDatabase &db, const QString &queryStr) const
+    {
+        QSqlQuery query{db};
+        if (!query.prepare(queryStr))
+        {
+            const auto error = query.lastError().text();
+
+            qCritical() << error;
+            throw std::runtime_error{error.toStdString()};
+        }
+
+        return query;
+    }
+
+    template<class T>
+    QSqlQuery Repository<T>::prepareCached(const QSqlDatabase &db, DatabaseConnectionProvider::StatementCache &cache, const QString &queryStr) const
+    {
+        // the cache belongs to this thread's connection, so there's nothing to lock
+        auto query = cache.find(queryStr);
+        if (query == cache.end())
+            query = cache.insert(queryStr, prepare(db, queryStr));
+        else
+            query->finish();
+
+        return *query;
+    }
+
     template<class T>
     void Repository<T>::insert(T &entity) const
     {
@@ -230,7 +274,7 @@ namespace Evernus
             .arg(columns.join(QStringLiteral(", ")))
             .arg(prefixedColumns.join(QStringLiteral(", ")));
 
-        auto query = prepare(queryStr);
+        auto query = prepareCached(queryStr);
         bindValues(entity, query);
         DatabaseUtils::execQuery(query);
 
@@ -239,12 +283,13 @@ namespace Evernus
             const auto rowId = query.lastInsertId();
             if (!rowId.isNull())
             {
-                auto query = prepare(QStringLiteral("SELECT %1 FROM %2 WHERE ROWID = :id").arg(getIdColumn()).arg(getTableName()));
+                auto query = prepareCached(QStringLiteral("SELECT %1 FROM %2 WHERE ROWID = :id").arg(getIdColumn()).arg(getTableName()));
                 query.bindValue(QStringLiteral(":id"), rowId);
                 DatabaseUtils::execQuery(query);
                 query.next();
 
                 entity.setId(query.value(0).template value<typename T::IdType>());
+                query.finish();
             }
         }
     }
@@ -263,7 +308,7 @@ namespace Evernus
             .arg(updateList.join(", "))
             .arg(getIdColumn());
 
-        auto query = prepare(queryStr);
+        auto query = prepareCached(queryStr);
         query.bindValue(QStringLiteral(":id_for_update"), entity.getOriginalId());
 
         bindValues(entity, query);
@@ -32,6 +32,7 @@ namespace Evernus
     class ExternalOrderRepository;
     class FavoriteItemRepository;
     class MiningLedgerRepository;
+    class MarketHistoryRepository;
     class MarketOrderRepository;
     class OrderScriptRepository;
     class MarketGroupRepository;
@@ -80,5 +81,6 @@ namespace Evernus
         virtual const RegionStationPresetRepository &getRegionStationPresetRepository() const noexcept = 0;
         virtual const IndustryManufacturingSetupRepository &getIndustryManufacturingSetupRepository() const noexcept = 0;
         virtual const MiningLedgerRepository &getMiningLedgerRepository() const noexcept = 0;
+        virtual const MarketHistoryRepository &getMarketHistoryRepository() const noexcept = 0;
     };
 }
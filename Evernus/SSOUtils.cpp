@@ -26,25 +26,13 @@ namespace Evernus
 {
     namespace SSOUtils
     {
-        bool useWholeMarketImport(const TypeLocationPairs &target,
-                                  const EveDataProvider &dataProvider)
+        MarketImportPlanner::Plan planMarketImport(const TypeLocationPairs &target,
+                                                   const EveDataProvider &dataProvider,
+                                                   const MarketImportPlanner &planner)
         {
-            std::unordered_set<uint> regions;
-            TypeLocationPairs typeRegions;
-
-            for (const auto &pair : target)
-            {
-                const auto regionId = dataProvider.getStationRegionId(pair.second);
-
-                regions.insert(regionId);
-                typeRegions.insert(std::make_pair(pair.first, regionId));
-            }
-
-            const auto requestsPerRegion = 30; // assuming 30 requests typical worst case, as with The Forge
-            const auto wholeImportScore = regions.size() * requestsPerRegion;
-
-            qDebug() << "Auto importer values:" << wholeImportScore << "vs" << typeRegions.size();
-            return wholeImportScore < typeRegions.size();
+            return planner.plan(target, [&](auto stationId) {
+                return dataProvider.getStationRegionId(stationId);
+            });
         }
 
         void clearRefreshTokens()
@@ -17,6 +17,7 @@
 #include <QVariant>
 
 #include "ExternalOrderImporter.h"
+#include "MarketImportPlanner.h"
 
 namespace Evernus
 {
@@ -24,8 +25,10 @@ namespace Evernus
 
     namespace SSOUtils
     {
-        bool useWholeMarketImport(const TypeLocationPairs &target,
-                                  const EveDataProvider &dataProvider);
+        // splits type-station pairs between whole region and per-type imports
+        MarketImportPlanner::Plan planMarketImport(const TypeLocationPairs &target,
+                                                   const EveDataProvider &dataProvider,
+                                                   const MarketImportPlanner &planner);
         void clearRefreshTokens();
 
         QVariantMap parseAuthorizationCode(const QByteArray &rawQuery);
@@ -12,12 +12,13 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <QJSEngine>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+#include <boost/functional/hash.hpp>
 
 #include "ItemCostProvider.h"
-#include "CommonScriptAPI.h"
-#include "EveDataProvider.h"
-#include "ScriptUtils.h"
 
 #include "ScriptOrderProcessingModel.h"
 
@@ -27,9 +28,11 @@ namespace Evernus
                                                            const ItemCostProvider &itemCostProvider,
                                                            QObject *parent)
         : QAbstractTableModel{parent}
-        , mDataProvider{dataProvider}
         , mItemCostProvider{itemCostProvider}
+        , mProcessingThread{dataProvider}
     {
+        connect(&mProcessingThread, &ScriptOrderProcessingThread::rowsReady, this, &ScriptOrderProcessingModel::addRows);
+        connect(&mProcessingThread, &ScriptOrderProcessingThread::error, this, &ScriptOrderProcessingModel::showError);
     }
 
     int ScriptOrderProcessingModel::columnCount(const QModelIndex &parent) const
@@ -42,8 +45,9 @@ namespace Evernus
         if (!index.isValid())
             return QVariant{};
 
+        // rows can be shorter than the widest one
         if (role == Qt::DisplayRole)
-            return mData[index.row()].at(index.column());
+            return mData[index.row()].value(index.column());
 
         return QVariant{};
     }
@@ -55,6 +59,9 @@ namespace Evernus
 
     void ScriptOrderProcessingModel::clear()
     {
+        mProcessingThread.cancel();
+        ++mCurrentJobId;
+
         beginResetModel();
 
         mMaxColumns = 0;
@@ -63,73 +70,77 @@ namespace Evernus
         endResetModel();
     }
 
-    void ScriptOrderProcessingModel::reset(const MarketOrderRepository::EntityList &orders, const QString &script, Mode mode)
+    void ScriptOrderProcessingModel::reset(MarketOrderRepository::EntityList orders, const QString &script, Mode mode)
     {
-        beginResetModel();
+        clear();
 
-        mMaxColumns = 0;
-        mData.clear();
+        auto costs = fetchItemCosts(orders);
 
-        QJSEngine engine;
-        CommonScriptAPI::insertAPI(engine, mDataProvider);
+        if (!mProcessingThread.isRunning())
+            mProcessingThread.start(QThread::LowPriority);
 
-        if (mode == Mode::ForEach)
-        {
-            auto processFunction = engine.evaluate("(function process(order) {\n" + script + "\n})");
-            if (processFunction.isError())
-            {
-                endResetModel();
-                emit error(processFunction.toString());
-                return;
-            }
+        mProcessingThread.process(++mCurrentJobId, std::move(orders), std::move(costs), script, mode);
+    }
 
-            for (const auto &order : orders)
-            {
-                const auto value
-                    = processFunction.call(QJSValueList{} << ScriptUtils::wrapMarketOrder(engine, *order, mItemCostProvider.fetchForCharacterAndType(order->getCharacterId(), order->getTypeId())));
-                if (value.isError())
-                {
-                    endResetModel();
-                    emit error(value.toString());
-                    return;
-                }
-
-                auto array = value.toVariant().toList();
-                const auto size = array.size();
-                if (size > mMaxColumns)
-                    mMaxColumns = size;
-
-                mData.emplace_back(std::move(array));
-            }
+    void ScriptOrderProcessingModel::addRows(quint64 jobId, const ScriptOrderProcessingThread::RowList &rows)
+    {
+        if (jobId != mCurrentJobId || rows.empty())
+            return;
+
+        const auto maxColumns = std::max_element(std::begin(rows), std::end(rows), [](const auto &a, const auto &b) {
+            return a.size() < b.size();
+        })->size();
+        if (maxColumns > mMaxColumns)
+        {
+            beginInsertColumns(QModelIndex{}, mMaxColumns, maxColumns - 1);
+            mMaxColumns = maxColumns;
+            endInsertColumns();
         }
-        else
+
+        const auto size = static_cast<int>(mData.size());
+
+        beginInsertRows(QModelIndex{}, size, size + static_cast<int>(rows.size()) - 1);
+        mData.insert(std::end(mData), std::begin(rows), std::end(rows));
+        endInsertRows();
+    }
+
+    void ScriptOrderProcessingModel::showError(quint64 jobId, const QString &message)
+    {
+        if (jobId == mCurrentJobId)
+            emit error(message);
+    }
+
+    ScriptOrderProcessingThread::CostList ScriptOrderProcessingModel::fetchItemCosts(const MarketOrderRepository::EntityList &orders) const
+    {
+        // one query per character instead of one per order; the provider handles anything not found, e.g. shared costs
+        std::unordered_map<std::pair<Character::IdType, EveType::IdType>, std::shared_ptr<ItemCost>, boost::hash<std::pair<Character::IdType, EveType::IdType>>> costs;
+        std::unordered_set<Character::IdType> characters;
+
+        for (const auto &order : orders)
         {
-            auto processFunction = engine.evaluate("(function process(orders) {\n" + script + "\n})");
-            if (processFunction.isError())
+            const auto characterId = order->getCharacterId();
+            if (characters.insert(characterId).second)
             {
-                endResetModel();
-                emit error(processFunction.toString());
-                return;
+                const auto characterCosts = mItemCostProvider.fetchForCharacter(characterId);
+                for (const auto &cost : characterCosts)
+                    costs.emplace(std::make_pair(characterId, cost->getTypeId()), cost);
             }
+        }
 
-            auto arguments = engine.newArray(static_cast<uint>(orders.size()));
-            for (auto i = 0u; i < orders.size(); ++i)
-                arguments.setProperty(i, ScriptUtils::wrapMarketOrder(engine, *orders[i], mItemCostProvider.fetchForCharacterAndType(orders[i]->getCharacterId(), orders[i]->getTypeId())));
+        ScriptOrderProcessingThread::CostList result;
+        result.reserve(orders.size());
 
-            const auto value = processFunction.call(QJSValueList{} << arguments);
-            if (value.isError())
-            {
-                endResetModel();
-                emit error(value.toString());
-                return;
-            }
+        for (const auto &order : orders)
+        {
+            const auto key = std::make_pair(order->getCharacterId(), order->getTypeId());
 
-            auto array = value.toVariant().toList();
+            auto cost = costs.find(key);
+            if (cost == std::end(costs))
+                cost = costs.emplace(key, mItemCostProvider.fetchForCharacterAndType(key.first, key.second)).first;
 
-            mMaxColumns = array.size();
-            mData.emplace_back(std::move(array));
+            result.emplace_back(cost->second);
         }
 
-        endResetModel();
+        return result;
     }
 }
@@ -16,6 +16,7 @@
 
 #include <QAbstractTableModel>
 
+#include "ScriptOrderProcessingThread.h"
 #include "MarketOrderRepository.h"
 
 namespace Evernus
@@ -29,11 +30,7 @@ namespace Evernus
         Q_OBJECT
 
     public:
-        enum class Mode
-        {
-            ForEach,
-            Aggregate
-        };
+        using Mode = ScriptOrderProcessingThread::Mode;
 
         ScriptOrderProcessingModel(const EveDataProvider &dataProvider,
                                    const ItemCostProvider &itemCostProvider,
@@ -45,16 +42,25 @@ namespace Evernus
         virtual int rowCount(const QModelIndex &parent = QModelIndex{}) const override;
 
         void clear();
-        void reset(const MarketOrderRepository::EntityList &orders, const QString &script, Mode mode);
+        // rows are added in chunks as the script runs in the background
+        void reset(MarketOrderRepository::EntityList orders, const QString &script, Mode mode);
 
     signals:
         void error(const QString &message);
 
+    private slots:
+        void addRows(quint64 jobId, const ScriptOrderProcessingThread::RowList &rows);
+        void showError(quint64 jobId, const QString &message);
+
     private:
-        const EveDataProvider &mDataProvider;
         const ItemCostProvider &mItemCostProvider;
 
         std::vector<QVariantList> mData;
         int mMaxColumns = 0;
+
+        ScriptOrderProcessingThread mProcessingThread;
+        quint64 mCurrentJobId = 0;
+
+        ScriptOrderProcessingThread::CostList fetchItemCosts(const MarketOrderRepository::EntityList &orders) const;
     };
 }
@@ -0,0 +1,214 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <map>
+
+#include <QElapsedTimer>
+#include <QJSEngine>
+#include <QtDebug>
+
+#include "CommonScriptAPI.h"
+#include "ScriptUtils.h"
+
+#include "ScriptOrderProcessingThread.h"
+
+namespace Evernus
+{
+    ScriptOrderProcessingThread::ScriptOrderProcessingThread(const EveDataProvider &dataProvider, QObject *parent)
+        : QThread{parent}
+        , mDataProvider{dataProvider}
+    {
+    }
+
+    ScriptOrderProcessingThread::~ScriptOrderProcessingThread()
+    {
+        stop();
+        wait();
+    }
+
+    void ScriptOrderProcessingThread::process(quint64 jobId, MarketOrderRepository::EntityList orders, CostList costs, QString script, Mode mode)
+    {
+        Q_ASSERT(orders.size() == costs.size());
+
+        {
+            std::lock_guard<std::mutex> lock{mJobMutex};
+
+            Job job;
+            job.mId = jobId;
+            job.mOrders = std::move(orders);
+            job.mCosts = std::move(costs);
+            job.mScript = std::move(script);
+            job.mMode = mode;
+
+            mPendingJob = std::move(job);
+            mActiveJobId = jobId;
+        }
+
+        mJobCondition.notify_one();
+    }
+
+    void ScriptOrderProcessingThread::cancel()
+    {
+        std::lock_guard<std::mutex> lock{mJobMutex};
+
+        mPendingJob.reset();
+        mActiveJobId = 0;
+    }
+
+    void ScriptOrderProcessingThread::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mJobMutex};
+
+            mPendingJob.reset();
+            mActiveJobId = 0;
+            mStopRequested = true;
+        }
+
+        mJobCondition.notify_one();
+    }
+
+    void ScriptOrderProcessingThread::run()
+    {
+        struct CompiledScript
+        {
+            std::unique_ptr<QJSEngine> mEngine;
+            // declared after the engine, so it goes away first
+            QJSValue mFunction;
+            quint64 mLastUsed = 0;
+        };
+
+        std::map<std::pair<Mode, QString>, CompiledScript> scripts;
+        quint64 useCounter = 0;
+
+        while (true)
+        {
+            Job job;
+
+            {
+                std::unique_lock<std::mutex> lock{mJobMutex};
+                mJobCondition.wait(lock, [=] {
+                    return mStopRequested || mPendingJob;
+                });
+
+                if (mStopRequested)
+                    break;
+
+                job = std::move(*mPendingJob);
+                mPendingJob.reset();
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+
+            auto key = std::make_pair(job.mMode, job.mScript);
+            auto script = scripts.find(key);
+            if (script == std::end(scripts))
+            {
+                if (scripts.size() >= maxCachedScripts)
+                {
+                    scripts.erase(std::min_element(std::begin(scripts), std::end(scripts), [](const auto &a, const auto &b) {
+                        return a.second.mLastUsed < b.second.mLastUsed;
+                    }));
+                }
+
+                CompiledScript compiled;
+                compiled.mEngine = std::make_unique<QJSEngine>();
+                CommonScriptAPI::insertAPI(*compiled.mEngine, mDataProvider);
+
+                const auto argument = (job.mMode == Mode::ForEach) ? (QStringLiteral("order")) : (QStringLiteral("orders"));
+                compiled.mFunction
+                    = compiled.mEngine->evaluate(QStringLiteral("(function process(") + argument + QStringLiteral(") {\n") + job.mScript + QStringLiteral("\n})"));
+                if (compiled.mFunction.isError())
+                {
+                    emit error(job.mId, compiled.mFunction.toString());
+                    continue;
+                }
+
+                script = scripts.emplace(std::move(key), std::move(compiled)).first;
+            }
+
+            auto &compiled = script->second;
+            compiled.mLastUsed = ++useCounter;
+
+            const auto processed = (job.mMode == Mode::ForEach) ?
+                                   (processEach(job, *compiled.mEngine, compiled.mFunction)) :
+                                   (processAggregate(job, *compiled.mEngine, compiled.mFunction));
+
+            // wrapped orders are garbage now
+            compiled.mEngine->collectGarbage();
+
+            if (processed)
+            {
+                qDebug() << "Processed" << job.mOrders.size() << "orders with script in" << timer.elapsed() << "ms.";
+                emit jobFinished(job.mId);
+            }
+        }
+    }
+
+    bool ScriptOrderProcessingThread::processEach(const Job &job, QJSEngine &engine, QJSValue &function)
+    {
+        RowList rows;
+        rows.reserve(std::min(rowChunkSize, job.mOrders.size()));
+
+        for (auto i = 0u; i < job.mOrders.size(); ++i)
+        {
+            // superseded by another job
+            if (mActiveJobId != job.mId)
+                return false;
+
+            const auto value = function.call(QJSValueList{} << ScriptUtils::wrapMarketOrder(engine, *job.mOrders[i], job.mCosts[i]));
+            if (value.isError())
+            {
+                emit error(job.mId, value.toString());
+                return false;
+            }
+
+            rows.emplace_back(value.toVariant().toList());
+            if (rows.size() == rowChunkSize)
+            {
+                emit rowsReady(job.mId, rows);
+                rows.clear();
+            }
+        }
+
+        if (!rows.empty())
+            emit rowsReady(job.mId, rows);
+
+        return true;
+    }
+
+    bool ScriptOrderProcessingThread::processAggregate(const Job &job, QJSEngine &engine, QJSValue &function)
+    {
+        auto arguments = engine.newArray(static_cast<uint>(job.mOrders.size()));
+        for (auto i = 0u; i < job.mOrders.size(); ++i)
+        {
+            if (mActiveJobId != job.mId)
+                return false;
+
+            arguments.setProperty(i, ScriptUtils::wrapMarketOrder(engine, *job.mOrders[i], job.mCosts[i]));
+        }
+
+        const auto value = function.call(QJSValueList{} << arguments);
+        if (value.isError())
+        {
+            emit error(job.mId, value.toString());
+            return false;
+        }
+
+        emit rowsReady(job.mId, RowList{value.toVariant().toList()});
+        return true;
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <optional>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include <QVariantList>
+#include <QThread>
+
+#include "MarketOrderRepository.h"
+
+class QJSEngine;
+class QJSValue;
+
+namespace Evernus
+{
+    class EveDataProvider;
+    class ItemCost;
+
+    // runs order scripts off the GUI thread, keeping compiled scripts around between runs
+    // engines are created and used only by this thread
+    class ScriptOrderProcessingThread
+        : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        enum class Mode
+        {
+            ForEach,
+            Aggregate
+        };
+
+        using CostList = std::vector<std::shared_ptr<ItemCost>>;
+        using RowList = std::vector<QVariantList>;
+
+        explicit ScriptOrderProcessingThread(const EveDataProvider &dataProvider, QObject *parent = nullptr);
+        virtual ~ScriptOrderProcessingThread();
+
+        // costs must match orders by index; replaces any pending or running job
+        void process(quint64 jobId, MarketOrderRepository::EntityList orders, CostList costs, QString script, Mode mode);
+        void cancel();
+        void stop();
+
+    signals:
+        void rowsReady(quint64 jobId, const RowList &rows);
+        void jobFinished(quint64 jobId);
+        void error(quint64 jobId, const QString &message);
+
+    protected:
+        virtual void run() override;
+
+    private:
+        struct Job
+        {
+            quint64 mId = 0;
+            MarketOrderRepository::EntityList mOrders;
+            CostList mCosts;
+            QString mScript;
+            Mode mMode = Mode::ForEach;
+        };
+
+        static const std::size_t rowChunkSize = 1000;
+        static const std::size_t maxCachedScripts = 8;
+
+        const EveDataProvider &mDataProvider;
+
+        std::optional<Job> mPendingJob;
+        std::atomic<quint64> mActiveJobId{0};
+        bool mStopRequested = false;
+
+        std::mutex mJobMutex;
+        std::condition_variable mJobCondition;
+
+        bool processEach(const Job &job, QJSEngine &engine, QJSValue &function);
+        bool processAggregate(const Job &job, QJSEngine &engine, QJSValue &function);
+    };
+}
+
+Q_DECLARE_METATYPE(Evernus::ScriptOrderProcessingThread::RowList);
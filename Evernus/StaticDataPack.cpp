@@ -0,0 +1,583 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSaveFile>
+#include <QSqlQuery>
+#include <QRegExp>
+#include <QHash>
+
+#include <QtDebug>
+
+#include "StaticDataPack.h"
+
+namespace Evernus
+{
+    namespace
+    {
+        // offset 0 is always the empty string
+        class StringPool final
+        {
+        public:
+            StringPool()
+            {
+                add(QString{});
+            }
+
+            quint32 add(const QString &str)
+            {
+                const auto it = mOffsets.constFind(str);
+                if (it != mOffsets.constEnd())
+                    return *it;
+
+                const auto utf8 = str.toUtf8();
+                const auto offset = static_cast<quint32>(mData.size());
+                const auto size = static_cast<quint32>(utf8.size());
+
+                mData.append(reinterpret_cast<const char *>(&size), sizeof(size));
+                mData.append(utf8);
+
+                mOffsets.insert(str, offset);
+                return offset;
+            }
+
+            const QByteArray &getData() const noexcept
+            {
+                return mData;
+            }
+
+            int getCount() const noexcept
+            {
+                return mOffsets.size();
+            }
+
+        private:
+            QByteArray mData;
+            QHash<QString, quint32> mOffsets;
+        };
+
+        void alignImage(QByteArray &image)
+        {
+            // every section starts on 8 bytes, so records can be used directly from the mapping
+            while (image.size() % 8 != 0)
+                image.append('\0');
+        }
+    }
+
+    template<class T>
+    const T *StaticDataPack::Table<T>::find(quint64 id) const noexcept
+    {
+        if (id > std::numeric_limits<quint32>::max())
+            return nullptr;
+
+        const auto end = mIds + mSize;
+        const auto it = std::lower_bound(mIds, end, static_cast<quint32>(id));
+
+        return (it != end && *it == id) ? (mRecords + (it - mIds)) : (nullptr);
+    }
+
+    template<class T>
+    bool StaticDataPack::attachTable(const Header &header, Section idSection, Section recordSection, Table<T> &table) const noexcept
+    {
+        const auto &ids = header.mSections[idSection];
+        const auto &records = header.mSections[recordSection];
+
+        const auto isValidSection = [=](const auto &section, auto alignment, auto elementSize) {
+            return section.mOffset <= mImageSize &&
+                   section.mSize <= mImageSize - section.mOffset &&
+                   section.mSize % elementSize == 0 &&
+                   reinterpret_cast<quintptr>(mImage + section.mOffset) % alignment == 0;
+        };
+
+        if (!isValidSection(ids, alignof(quint32), sizeof(quint32)) || !isValidSection(records, alignof(T), sizeof(T)))
+            return false;
+
+        const auto size = ids.mSize / sizeof(quint32);
+        if (size != records.mSize / sizeof(T) || size > std::numeric_limits<quint32>::max())
+            return false;
+
+        table.mIds = reinterpret_cast<const quint32 *>(mImage + ids.mOffset);
+        table.mRecords = reinterpret_cast<const T *>(mImage + records.mOffset);
+        table.mSize = static_cast<quint32>(size);
+
+        return true;
+    }
+
+    void StaticDataPack::build(const QSqlDatabase &db)
+    {
+        clear();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        StringPool strings;
+
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        header.mMagic = fileMagic;
+        header.mVersion = fileVersion;
+
+        QByteArray image{static_cast<int>(sizeof(header)), '\0'};
+
+        const auto appendSection = [&](Section section, const auto &data) {
+            alignImage(image);
+
+            const auto size = data.size() * sizeof(data[0]);
+
+            header.mSections[section].mOffset = image.size();
+            header.mSections[section].mSize = size;
+
+            image.append(reinterpret_cast<const char *>(data.data()), static_cast<int>(size));
+        };
+
+        std::vector<quint32> marketGroupIds;
+        std::vector<MarketGroupRecord> marketGroups;
+        std::unordered_map<quint32, quint32> marketGroupIndices;
+
+        {
+            std::vector<quint32> parentIds;
+
+            auto query = db.exec(QStringLiteral("SELECT marketGroupID, parentGroupID, marketGroupName FROM invMarketGroups ORDER BY marketGroupID"));
+            while (query.next())
+            {
+                const auto id = query.value(0).toUInt();
+
+                marketGroupIndices.emplace(id, static_cast<quint32>(marketGroupIds.size()));
+                marketGroupIds.emplace_back(id);
+                parentIds.emplace_back(query.value(1).toUInt());
+                marketGroups.emplace_back(MarketGroupRecord{strings.add(query.value(2).toString()), invalidIndex});
+            }
+
+            for (auto i = 0u; i < marketGroups.size(); ++i)
+            {
+                const auto parent = marketGroupIndices.find(parentIds[i]);
+                if (parent != std::end(marketGroupIndices))
+                    marketGroups[i].mParent = parent->second;
+            }
+        }
+
+        {
+            std::vector<quint32> ids;
+            std::vector<TypeRecord> types;
+
+            auto query = db.exec(QStringLiteral(
+                "SELECT t.typeID, t.typeName, t.groupID, t.volume, t.marketGroupID, g.metaGroupName "
+                "FROM invTypes t "
+                "LEFT JOIN invMetaTypes m ON m.typeID = t.typeID "
+                "LEFT JOIN invMetaGroups g ON g.metaGroupID = m.metaGroupID "
+                "ORDER BY t.typeID"
+            ));
+            while (query.next())
+            {
+                TypeRecord type;
+                type.mVolume = query.value(3).toDouble();
+                type.mName = strings.add(query.value(1).toString());
+                type.mGroupId = query.value(2).toUInt();
+                type.mMarketGroup = invalidIndex;
+                type.mMetaGroupName = strings.add(query.value(5).toString());
+
+                const auto marketGroupId = query.value(4);
+                if (!marketGroupId.isNull())
+                {
+                    const auto marketGroup = marketGroupIndices.find(marketGroupId.toUInt());
+                    if (marketGroup != std::end(marketGroupIndices))
+                        type.mMarketGroup = marketGroup->second;
+                }
+
+                ids.emplace_back(query.value(0).toUInt());
+                types.emplace_back(type);
+            }
+
+            appendSection(TypeIds, ids);
+            appendSection(Types, types);
+        }
+
+        appendSection(MarketGroupIds, marketGroupIds);
+        appendSection(MarketGroups, marketGroups);
+
+        {
+            std::vector<quint32> ids;
+            std::vector<RegionRecord> regions;
+
+            auto query = db.exec(QStringLiteral("SELECT regionID, regionName FROM mapRegions ORDER BY regionID"));
+            while (query.next())
+            {
+                ids.emplace_back(query.value(0).toUInt());
+                regions.emplace_back(RegionRecord{strings.add(query.value(1).toString())});
+            }
+
+            appendSection(RegionIds, ids);
+            appendSection(Regions, regions);
+        }
+
+        {
+            std::vector<quint32> ids;
+            std::vector<SolarSystemRecord> systems;
+
+            auto query = db.exec(QStringLiteral("SELECT solarSystemID, solarSystemName, regionID, constellationID, security FROM mapSolarSystems ORDER BY solarSystemID"));
+            while (query.next())
+            {
+                SolarSystemRecord system;
+                system.mSecurity = query.value(4).toDouble();
+                system.mName = strings.add(query.value(1).toString());
+                system.mRegionId = query.value(2).toUInt();
+                system.mConstellationId = query.value(3).toUInt();
+                system.mPadding = 0;
+
+                ids.emplace_back(query.value(0).toUInt());
+                systems.emplace_back(system);
+            }
+
+            appendSection(SolarSystemIds, ids);
+            appendSection(SolarSystems, systems);
+        }
+
+        const auto buildLocations = [&](const QString &queryStr, Section idSection, Section recordSection) {
+            std::vector<quint32> ids;
+            std::vector<LocationRecord> locations;
+
+            auto query = db.exec(queryStr);
+            while (query.next())
+            {
+                ids.emplace_back(query.value(0).toUInt());
+                locations.emplace_back(LocationRecord{
+                    strings.add(query.value(1).toString()),
+                    query.value(2).toUInt(),
+                    query.value(3).toUInt()
+                });
+            }
+
+            appendSection(idSection, ids);
+            appendSection(recordSection, locations);
+        };
+
+        buildLocations(QStringLiteral("SELECT stationID, stationName, solarSystemID, regionID FROM staStations ORDER BY stationID"), StationIds, Stations);
+        buildLocations(QStringLiteral("SELECT itemID, itemName, solarSystemID, regionID FROM mapDenormalize ORDER BY itemID"), MapItemIds, MapItems);
+
+        alignImage(image);
+
+        header.mSections[Strings].mOffset = image.size();
+        header.mSections[Strings].mSize = strings.getData().size();
+
+        image.append(strings.getData());
+
+        std::memcpy(image.data(), &header, sizeof(header));
+
+        mData = std::move(image);
+        if (!attach(reinterpret_cast<const uchar *>(mData.constData()), mData.size()))
+        {
+            qWarning() << "Error building static data pack.";
+            clear();
+            return;
+        }
+
+        qDebug() << "Built static data pack in" << timer.elapsed() << "ms:"
+                 << mTypes.mSize << "types," << mSolarSystems.mSize << "systems," << mStations.mSize << "stations,"
+                 << strings.getCount() << "strings," << mImageSize << "bytes.";
+    }
+
+    bool StaticDataPack::load(const QString &fileName, const QString &sdeVersion)
+    {
+        clear();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        mMappedFile.setFileName(fileName);
+        if (!mMappedFile.open(QIODevice::ReadOnly))
+            return false;
+
+        const auto size = mMappedFile.size();
+        if (size < static_cast<qint64>(sizeof(Header)))
+        {
+            qWarning() << "Corrupted static data pack:" << fileName;
+            clear();
+            return false;
+        }
+
+        const auto image = mMappedFile.map(0, size);
+        if (image == nullptr)
+        {
+            qWarning() << "Error mapping static data pack:" << mMappedFile.errorString();
+            clear();
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, image, sizeof(header));
+
+        if (header.mMagic != fileMagic || header.mVersion != fileVersion)
+        {
+            qDebug() << "Ignoring static data pack with unknown format:" << fileName;
+            clear();
+            return false;
+        }
+
+        const QByteArray fileSdeVersion{header.mSdeVersion, static_cast<int>(qstrnlen(header.mSdeVersion, sdeVersionSize))};
+        if (fileSdeVersion != sdeVersion.toUtf8().left(sdeVersionSize - 1))
+        {
+            qDebug() << "Ignoring static data pack for SDE version" << fileSdeVersion;
+            clear();
+            return false;
+        }
+
+        if (!attach(image, size))
+        {
+            qWarning() << "Corrupted static data pack:" << fileName;
+            clear();
+            return false;
+        }
+
+        qDebug() << "Mapped static data pack in" << timer.elapsed() << "ms:" << mTypes.mSize << "types," << mImageSize << "bytes.";
+        return true;
+    }
+
+    bool StaticDataPack::save(const QString &fileName, const QString &sdeVersion) const
+    {
+        if (!isValid())
+            return false;
+
+        // the pack is mapped on next start, so it must never be seen half-written
+        QSaveFile file{fileName};
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        Header header;
+        std::memcpy(&header, mImage, sizeof(header));
+        std::memset(header.mSdeVersion, 0, sizeof(header.mSdeVersion));
+
+        const auto version = sdeVersion.toUtf8().left(sdeVersionSize - 1);
+        std::memcpy(header.mSdeVersion, version.constData(), version.size());
+
+        const auto headerSize = static_cast<qint64>(sizeof(header));
+        const auto bodySize = static_cast<qint64>(mImageSize) - headerSize;
+
+        return file.write(reinterpret_cast<const char *>(&header), headerSize) == headerSize &&
+               file.write(reinterpret_cast<const char *>(mImage) + headerSize, bodySize) == bodySize &&
+               file.commit();
+    }
+
+    bool StaticDataPack::isValid() const noexcept
+    {
+        return mImage != nullptr;
+    }
+
+    QString StaticDataPack::getTypeName(EveType::IdType id) const
+    {
+        const auto type = mTypes.find(id);
+        return (type != nullptr) ? (getString(type->mName)) : (QString{});
+    }
+
+    uint StaticDataPack::getTypeGroupId(EveType::IdType id) const noexcept
+    {
+        const auto type = mTypes.find(id);
+        return (type != nullptr) ? (type->mGroupId) : (0);
+    }
+
+    double StaticDataPack::getTypeVolume(EveType::IdType id) const noexcept
+    {
+        const auto type = mTypes.find(id);
+        return (type != nullptr) ? (type->mVolume) : (0.);
+    }
+
+    QString StaticDataPack::getTypeMetaGroupName(EveType::IdType id) const
+    {
+        const auto type = mTypes.find(id);
+        return (type != nullptr) ? (getString(type->mMetaGroupName)) : (QString{});
+    }
+
+    MarketGroup::IdType StaticDataPack::getTypeMarketGroupId(EveType::IdType id) const noexcept
+    {
+        return getMarketGroupId(getTypeMarketGroup(id));
+    }
+
+    QString StaticDataPack::getTypeMarketGroupName(EveType::IdType id) const
+    {
+        const auto group = getTypeMarketGroup(id);
+        return (group != nullptr) ? (getString(group->mName)) : (QString{});
+    }
+
+    MarketGroup::IdType StaticDataPack::getTypeMarketGroupParentId(EveType::IdType id) const noexcept
+    {
+        return getMarketGroupId(getTypeMarketGroupParent(id));
+    }
+
+    QString StaticDataPack::getTypeMarketGroupParentName(EveType::IdType id) const
+    {
+        const auto group = getTypeMarketGroupParent(id);
+        return (group != nullptr) ? (getString(group->mName)) : (QString{});
+    }
+
+    QString StaticDataPack::getRegionName(uint id) const
+    {
+        const auto region = mRegions.find(id);
+        return (region != nullptr) ? (getString(region->mName)) : (QString{});
+    }
+
+    QString StaticDataPack::getSolarSystemName(uint id) const
+    {
+        const auto system = mSolarSystems.find(id);
+        return (system != nullptr) ? (getString(system->mName)) : (QString{});
+    }
+
+    uint StaticDataPack::getSolarSystemRegionId(uint id) const noexcept
+    {
+        const auto system = mSolarSystems.find(id);
+        return (system != nullptr) ? (system->mRegionId) : (0);
+    }
+
+    uint StaticDataPack::getSolarSystemConstellationId(uint id) const noexcept
+    {
+        const auto system = mSolarSystems.find(id);
+        return (system != nullptr) ? (system->mConstellationId) : (0);
+    }
+
+    double StaticDataPack::getSolarSystemSecurityStatus(uint id) const noexcept
+    {
+        const auto system = mSolarSystems.find(id);
+        return (system != nullptr) ? (system->mSecurity) : (0.);
+    }
+
+    QString StaticDataPack::getStationName(quint64 id) const
+    {
+        const auto station = mStations.find(id);
+        return (station != nullptr) ? (getString(station->mName)) : (QString{});
+    }
+
+    uint StaticDataPack::getStationSolarSystemId(quint64 id) const noexcept
+    {
+        const auto station = mStations.find(id);
+        return (station != nullptr) ? (station->mSolarSystemId) : (0);
+    }
+
+    uint StaticDataPack::getStationRegionId(quint64 id) const noexcept
+    {
+        const auto station = mStations.find(id);
+        return (station != nullptr) ? (station->mRegionId) : (0);
+    }
+
+    QString StaticDataPack::getMapItemName(quint64 id) const
+    {
+        const auto item = mMapItems.find(id);
+        return (item != nullptr) ? (getString(item->mName)) : (QString{});
+    }
+
+    uint StaticDataPack::getMapItemSolarSystemId(quint64 id) const noexcept
+    {
+        const auto item = mMapItems.find(id);
+        return (item != nullptr) ? (item->mSolarSystemId) : (0);
+    }
+
+    uint StaticDataPack::getMapItemRegionId(quint64 id) const noexcept
+    {
+        const auto item = mMapItems.find(id);
+        return (item != nullptr) ? (item->mRegionId) : (0);
+    }
+
+    std::vector<quint64> StaticDataPack::findLocationIds(const QRegExp &filter) const
+    {
+        std::vector<quint64> result;
+        for (auto i = 0u; i < mStations.mSize; ++i)
+        {
+            if (filter.indexIn(getString(mStations.mRecords[i].mName)) != -1)
+                result.emplace_back(mStations.mIds[i]);
+        }
+
+        return result;
+    }
+
+    void StaticDataPack::clear()
+    {
+        mTypes = Table<TypeRecord>{};
+        mMarketGroups = Table<MarketGroupRecord>{};
+        mRegions = Table<RegionRecord>{};
+        mSolarSystems = Table<SolarSystemRecord>{};
+        mStations = Table<LocationRecord>{};
+        mMapItems = Table<LocationRecord>{};
+
+        mStrings = nullptr;
+        mStringsSize = 0;
+
+        mImage = nullptr;
+        mImageSize = 0;
+
+        mMappedFile.close();
+        mData.clear();
+    }
+
+    bool StaticDataPack::attach(const uchar *image, quint64 size)
+    {
+        Header header;
+        std::memcpy(&header, image, sizeof(header));
+
+        mImage = image;
+        mImageSize = size;
+
+        const auto &strings = header.mSections[Strings];
+        if (strings.mOffset > size || strings.mSize > size - strings.mOffset)
+            return false;
+
+        mStrings = reinterpret_cast<const char *>(image + strings.mOffset);
+        mStringsSize = strings.mSize;
+
+        return attachTable(header, TypeIds, Types, mTypes) &&
+               attachTable(header, MarketGroupIds, MarketGroups, mMarketGroups) &&
+               attachTable(header, RegionIds, Regions, mRegions) &&
+               attachTable(header, SolarSystemIds, SolarSystems, mSolarSystems) &&
+               attachTable(header, StationIds, Stations, mStations) &&
+               attachTable(header, MapItemIds, MapItems, mMapItems);
+    }
+
+    const StaticDataPack::MarketGroupRecord *StaticDataPack::getTypeMarketGroup(EveType::IdType id) const noexcept
+    {
+        const auto type = mTypes.find(id);
+        if (type == nullptr || type->mMarketGroup >= mMarketGroups.mSize)
+            return nullptr;
+
+        return mMarketGroups.mRecords + type->mMarketGroup;
+    }
+
+    const StaticDataPack::MarketGroupRecord *StaticDataPack::getTypeMarketGroupParent(EveType::IdType id) const noexcept
+    {
+        const auto group = getTypeMarketGroup(id);
+        if (group == nullptr || group->mParent >= mMarketGroups.mSize)
+            return nullptr;
+
+        return mMarketGroups.mRecords + group->mParent;
+    }
+
+    MarketGroup::IdType StaticDataPack::getMarketGroupId(const MarketGroupRecord *group) const noexcept
+    {
+        return (group != nullptr) ? (mMarketGroups.mIds[group - mMarketGroups.mRecords]) : (MarketGroup::invalidId);
+    }
+
+    QString StaticDataPack::getString(quint32 offset) const
+    {
+        quint32 size = 0;
+        if (offset > mStringsSize || mStringsSize - offset < sizeof(size))
+            return QString{};
+
+        std::memcpy(&size, mStrings + offset, sizeof(size));
+        if (mStringsSize - offset - sizeof(size) < size)
+            return QString{};
+
+        return QString::fromUtf8(mStrings + offset + sizeof(size), static_cast<int>(size));
+    }
+}
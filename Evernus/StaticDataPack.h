@@ -0,0 +1,198 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+
+#include "MarketGroup.h"
+#include "EveType.h"
+
+class QSqlDatabase;
+class QRegExp;
+
+namespace Evernus
+{
+    // names and map relations from the SDE, compiled into one flat image which gets mmapped on startup
+    // every table is a sorted id array with a parallel array of fixed size records; strings are interned
+    // in a single pool and referenced by offset, cross-table references use dense record indices
+    // once built or loaded, the pack is read-only, so lookups don't need any locking
+    class StaticDataPack final
+    {
+    public:
+        StaticDataPack() = default;
+        StaticDataPack(const StaticDataPack &) = delete;
+        StaticDataPack(StaticDataPack &&) = delete;
+        ~StaticDataPack() = default;
+
+        void build(const QSqlDatabase &db);
+
+        bool load(const QString &fileName, const QString &sdeVersion);
+        bool save(const QString &fileName, const QString &sdeVersion) const;
+
+        bool isValid() const noexcept;
+
+        // all lookups return empty values for unknown ids
+        QString getTypeName(EveType::IdType id) const;
+        uint getTypeGroupId(EveType::IdType id) const noexcept;
+        double getTypeVolume(EveType::IdType id) const noexcept;
+        QString getTypeMetaGroupName(EveType::IdType id) const;
+
+        MarketGroup::IdType getTypeMarketGroupId(EveType::IdType id) const noexcept;
+        QString getTypeMarketGroupName(EveType::IdType id) const;
+        MarketGroup::IdType getTypeMarketGroupParentId(EveType::IdType id) const noexcept;
+        QString getTypeMarketGroupParentName(EveType::IdType id) const;
+
+        QString getRegionName(uint id) const;
+
+        QString getSolarSystemName(uint id) const;
+        uint getSolarSystemRegionId(uint id) const noexcept;
+        uint getSolarSystemConstellationId(uint id) const noexcept;
+        double getSolarSystemSecurityStatus(uint id) const noexcept;
+
+        // staStations
+        QString getStationName(quint64 id) const;
+        uint getStationSolarSystemId(quint64 id) const noexcept;
+        uint getStationRegionId(quint64 id) const noexcept;
+
+        // mapDenormalize
+        QString getMapItemName(quint64 id) const;
+        uint getMapItemSolarSystemId(quint64 id) const noexcept;
+        uint getMapItemRegionId(quint64 id) const noexcept;
+
+        // stations only - map items are never trade locations and there are too many to search on every keystroke
+        std::vector<quint64> findLocationIds(const QRegExp &filter) const;
+
+        StaticDataPack &operator =(const StaticDataPack &) = delete;
+        StaticDataPack &operator =(StaticDataPack &&) = delete;
+
+    private:
+        static constexpr quint32 fileMagic = 0x45534450; // ESDP - Evernus Static Data Pack
+        static constexpr quint32 fileVersion = 1;
+
+        static constexpr quint32 invalidIndex = 0xffffffff;
+        static constexpr int sdeVersionSize = 64;
+
+        enum Section
+        {
+            TypeIds,
+            Types,
+            MarketGroupIds,
+            MarketGroups,
+            RegionIds,
+            Regions,
+            SolarSystemIds,
+            SolarSystems,
+            StationIds,
+            Stations,
+            MapItemIds,
+            MapItems,
+            Strings,
+
+            SectionCount
+        };
+
+        struct SectionInfo
+        {
+            quint64 mOffset;
+            quint64 mSize;
+        };
+
+        struct Header
+        {
+            quint32 mMagic;
+            quint32 mVersion;
+            char mSdeVersion[sdeVersionSize];
+            SectionInfo mSections[SectionCount];
+        };
+
+        struct TypeRecord
+        {
+            double mVolume;
+            quint32 mName;
+            quint32 mGroupId;
+            quint32 mMarketGroup;
+            quint32 mMetaGroupName;
+        };
+
+        struct MarketGroupRecord
+        {
+            quint32 mName;
+            quint32 mParent;
+        };
+
+        struct RegionRecord
+        {
+            quint32 mName;
+        };
+
+        struct SolarSystemRecord
+        {
+            double mSecurity;
+            quint32 mName;
+            quint32 mRegionId;
+            quint32 mConstellationId;
+            quint32 mPadding;
+        };
+
+        struct LocationRecord
+        {
+            quint32 mName;
+            quint32 mSolarSystemId;
+            quint32 mRegionId;
+        };
+
+        template<class T>
+        struct Table
+        {
+            const quint32 *mIds = nullptr;
+            const T *mRecords = nullptr;
+            quint32 mSize = 0;
+
+            const T *find(quint64 id) const noexcept;
+        };
+
+        // built image; empty when mapped from file
+        QByteArray mData;
+        QFile mMappedFile;
+
+        const uchar *mImage = nullptr;
+        quint64 mImageSize = 0;
+
+        Table<TypeRecord> mTypes;
+        Table<MarketGroupRecord> mMarketGroups;
+        Table<RegionRecord> mRegions;
+        Table<SolarSystemRecord> mSolarSystems;
+        Table<LocationRecord> mStations;
+        Table<LocationRecord> mMapItems;
+
+        const char *mStrings = nullptr;
+        quint64 mStringsSize = 0;
+
+        void clear();
+        bool attach(const uchar *image, quint64 size);
+
+        const MarketGroupRecord *getTypeMarketGroup(EveType::IdType id) const noexcept;
+        const MarketGroupRecord *getTypeMarketGroupParent(EveType::IdType id) const noexcept;
+        MarketGroup::IdType getMarketGroupId(const MarketGroupRecord *group) const noexcept;
+
+        QString getString(quint32 offset) const;
+
+        template<class T>
+        bool attachTable(const Header &header, Section idSection, Section recordSection, Table<T> &table) const noexcept;
+    };
+}
@@ -12,6 +12,7 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <optional>
 #include <future>
 
 #include <QNetworkRequest>
@@ -106,6 +107,8 @@ namespace Evernus
     };
 
     const QString SyncDialog::mainDbPath = "/sandbox/main.db";
+    const QString SyncDialog::mainDbManifestPath = "/sandbox/main.db.manifest";
+    const QString SyncDialog::chunkPath = "/sandbox/chunks";
     const QString SyncDialog::redirectLink = "https://slysmoke.github.io/evernus-auth/index.html#/";
     const QString SyncDialog::localRedirectLink = QStringLiteral("http://localhost:%1").arg(localPort);
 
@@ -115,6 +118,8 @@ namespace Evernus
         : QDialog(parent)
         , mMode(mode)
         , mCrypt(Q_UINT64_C(0x4630e0cc6a00124b))
+        , mStorage(mDb)
+        , mChunkedSync(mStorage, mainDbManifestPath, chunkPath)
         , mAuthState(QUuid::createUuid().toString())
         , mAuthWebService(new DropboxWebService(&mAuthServer, mAuthState, this))
     {
@@ -140,6 +145,9 @@ namespace Evernus
 
         mCancelBtn = new QPushButton{tr("Cancel"), this};
         infoLayout->addWidget(mCancelBtn);
+        connect(mCancelBtn, &QPushButton::clicked, this, [=] {
+            mChunkedSync.cancel();
+        });
         connect(mCancelBtn, &QPushButton::clicked, this, &SyncDialog::reject);
 
         mProgress = new QProgressBar{this};
@@ -200,6 +208,13 @@ namespace Evernus
         connect(&mDb, &QDropbox2::signal_errorOccurred, this, &SyncDialog::showError);
         connect(mAuthWebService, &DropboxWebService::codeAcquired, this, &SyncDialog::requestToken);
 
+        // called from the sync thread
+        mChunkedSync.setProgressCallback([=](auto current, auto total) {
+            QMetaObject::invokeMethod(this, [=] {
+                updateProgress(current, total);
+            }, Qt::QueuedConnection);
+        });
+
         QMetaObject::invokeMethod(this, "startSync", Qt::QueuedConnection);
     }
 
@@ -389,6 +404,22 @@ namespace Evernus
     {
         qDebug() << "Requesting metadata...";
 
+        QDropbox2File manifest{mainDbManifestPath, &mDb};
+
+        const auto manifestMetadata = manifest.metadata();
+        if (manifest.error() == QDropbox2::Error::NoError)
+        {
+            processMetadata(manifestMetadata);
+            return;
+        }
+
+        if (manifest.error() != QDropbox2::Error::FileNotFound)
+        {
+            showError(manifest.error(), manifest.errorString());
+            return;
+        }
+
+        // nothing was synchronized in chunks yet - look for a whole file uploaded by older versions
         QDropbox2File file{mainDbPath, &mDb};
         connect(&file, &QDropbox2File::signal_errorOccurred, this, &SyncDialog::showError);
 
@@ -403,6 +434,73 @@ namespace Evernus
 
         mStarted = true;
 
+        std::optional<ChunkedSync::Manifest> manifest;
+        try
+        {
+            asyncExec([&] {
+                manifest = mChunkedSync.fetchManifest();
+            });
+        }
+        catch (const std::exception &e)
+        {
+            failSync(QString::fromStdString(e.what()));
+            return;
+        }
+
+        if (!manifest)
+        {
+            downloadLegacyFiles();
+            return;
+        }
+
+        DatabaseUtils::backupDatabase(getMainDbPath());
+
+        QSaveFile file{getMainDbPath()};
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            failSync(tr("Couldn't open file for writing!"));
+            return;
+        }
+
+        // unchanged chunks are copied from the current file while the rest is fetched
+        auto finished = false;
+        try
+        {
+            asyncExec([&] {
+                finished = mChunkedSync.download(*manifest, getMainDbPath(), file);
+            });
+        }
+        catch (const std::exception &e)
+        {
+            failSync(QString::fromStdString(e.what()));
+            return;
+        }
+
+        if (!finished)
+        {
+            QMetaObject::invokeMethod(this, "reject", Qt::QueuedConnection);
+            return;
+        }
+
+        if (!file.commit())
+        {
+            failSync(tr("Couldn't write destination file!"));
+            return;
+        }
+
+        // log left from the previous session belongs to the old file
+        QFile::remove(getMainDbPath() + QStringLiteral("-wal"));
+        QFile::remove(getMainDbPath() + QStringLiteral("-shm"));
+
+        mLastSyncTime = QDropbox2File{mainDbManifestPath, &mDb}.metadata().clientModified();
+
+        QMetaObject::invokeMethod(this, "accept", Qt::QueuedConnection);
+    }
+
+    void SyncDialog::downloadLegacyFiles()
+    {
+        qDebug() << "Downloading whole main db...";
+
         QDropbox2File mainDb{mainDbPath, &mDb};
         connect(&mainDb, &QDropbox2File::signal_downloadProgress, this, &SyncDialog::updateProgress);
         connect(&mainDb, &QDropbox2File::signal_errorOccurred, this, &SyncDialog::showError);
@@ -418,8 +516,7 @@ namespace Evernus
             QSaveFile file{getMainDbPath()};
             if (!file.open(QIODevice::WriteOnly))
             {
-                QMessageBox::warning(this, tr("Synchronization"), tr("Couldn't open file for writing! Synchronization failed."));
-                QMetaObject::invokeMethod(this, "reject", Qt::QueuedConnection);
+                failSync(tr("Couldn't open file for writing!"));
                 return;
             }
 
@@ -430,12 +527,15 @@ namespace Evernus
 
             if (file.commit())
             {
+                // log left from the previous session belongs to the old file
+                QFile::remove(getMainDbPath() + QStringLiteral("-wal"));
+                QFile::remove(getMainDbPath() + QStringLiteral("-shm"));
+
                 mLastSyncTime = mainDb.metadata().clientModified();
             }
             else
             {
-                QMessageBox::warning(this, tr("Synchronization"), tr("Couldn't write destination file! Synchronization failed."));
-                QMetaObject::invokeMethod(this, "reject", Qt::QueuedConnection);
+                failSync(tr("Couldn't write destination file!"));
             }
         }
 
@@ -447,44 +547,49 @@ namespace Evernus
         qDebug() << "Uploading files...";
 
         mStarted = true;
-        mCancelBtn->setEnabled(false);
 
-        QDropbox2File mainDb{mainDbPath, &mDb};
-        mainDb.setOverwrite(true);
-        connect(&mainDb, &QDropbox2File::signal_uploadProgress, this, &SyncDialog::updateProgress);
-        connect(mCancelBtn, &QPushButton::clicked, &mainDb, &QDropbox2File::slot_abort);
-
-        if (!mainDb.open(QIODevice::WriteOnly))
+        auto finished = false;
+        try
         {
-            QMessageBox::warning(this, tr("Synchronization"), tr("Couldn't open remote file! Synchronization failed."));
-            QMetaObject::invokeMethod(this, "reject", Qt::QueuedConnection);
+            asyncExec([&] {
+                const auto remoteManifest = mChunkedSync.fetchManifest();
+                finished = mChunkedSync.upload(getUploadSnapshotPath(), (remoteManifest) ? (*remoteManifest) : (ChunkedSync::Manifest{}));
+            });
+        }
+        catch (const std::exception &e)
+        {
+            failSync(QString::fromStdString(e.what()));
             return;
         }
 
-        QFile localMainDb{getMainDbPath()};
-        if (!localMainDb.open(QIODevice::ReadOnly))
+        if (!finished)
         {
-            QMessageBox::warning(this, tr("Synchronization"), tr("Couldn't open local file! Synchronization failed."));
             QMetaObject::invokeMethod(this, "reject", Qt::QueuedConnection);
             return;
         }
 
-        asyncExec([&] {
-            const auto data = qCompress(localMainDb.readAll(), 9);
-            mainDb.write(data);
-        });
-        mCancelBtn->setEnabled(true);
-
-        mainDb.close();
+        // don't let older versions pick up a stale copy
+        QDropbox2File{mainDbPath, &mDb}.remove();
 
         QSettings settings;
         settings.setValue(SyncSettings::firstSyncKey, false);
 
-        mLastSyncTime = mainDb.metadata().clientModified();
+        mLastSyncTime = QDropbox2File{mainDbManifestPath, &mDb}.metadata().clientModified();
 
         QMetaObject::invokeMethod(this, "accept", Qt::QueuedConnection);
     }
 
+    void SyncDialog::failSync(const QString &message)
+    {
+        QMessageBox::warning(this, tr("Synchronization"), tr("%1 Synchronization failed.").arg(message));
+        QMetaObject::invokeMethod(this, "reject", Qt::QueuedConnection);
+    }
+
+    QString SyncDialog::getUploadSnapshotPath()
+    {
+        return DatabaseUtils::getDbPath() + "main.db.sync";
+    }
+
     QString SyncDialog::getMainDbPath()
     {
         return DatabaseUtils::getDbPath() + "main.db";
@@ -496,6 +601,8 @@ namespace Evernus
         auto future = std::async(std::launch::async, std::forward<T>(func));
         while (future.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
             qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
+
+        future.get();
     }
 }
 
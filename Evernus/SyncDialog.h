@@ -21,6 +21,8 @@
 #include "qxthttpsessionmanager.h"
 #include "qdropbox2.h"
 
+#include "DropboxSyncStorage.h"
+#include "ChunkedSync.h"
 #include "SimpleCrypt.h"
 
 class QProgressBar;
@@ -47,6 +49,8 @@ namespace Evernus
         virtual ~SyncDialog() = default;
 
         static bool performedSync();
+        // uploads read the database from here, not from the live file
+        static QString getUploadSnapshotPath();
 
     private slots:
         void startSync();
@@ -62,6 +66,8 @@ namespace Evernus
         static const quint16 localPort = 62345;
 
         static const QString mainDbPath;
+        static const QString mainDbManifestPath;
+        static const QString chunkPath;
         static const QString redirectLink;
         static const QString localRedirectLink;
 
@@ -72,6 +78,8 @@ namespace Evernus
 
         SimpleCrypt mCrypt;
         QDropbox2 mDb;
+        DropboxSyncStorage mStorage;
+        ChunkedSync mChunkedSync;
 
         QPushButton *mCancelBtn = nullptr;
         QProgressBar *mProgress = nullptr;
@@ -94,8 +102,11 @@ namespace Evernus
 
         void requestMetadata();
         void downloadFiles();
+        void downloadLegacyFiles();
         void uploadFiles();
 
+        void failSync(const QString &message);
+
         static QString getMainDbPath();
 
         template<class T>
@@ -0,0 +1,37 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <optional>
+
+#include <QByteArray>
+#include <QString>
+
+namespace Evernus
+{
+    // remote file store used for synchronization
+    // paths are absolute within the store; failures other than a missing file throw
+    class SyncStorage
+    {
+    public:
+        SyncStorage() = default;
+        virtual ~SyncStorage() = default;
+
+        // empty if the file doesn't exist
+        virtual std::optional<QByteArray> read(const QString &path) = 0;
+        virtual void write(const QString &path, const QByteArray &data) = 0;
+        virtual void remove(const QString &path) = 0;
+    };
+}
@@ -0,0 +1,235 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <limits>
+
+#include <QDataStream>
+#include <QSaveFile>
+#include <QtDebug>
+
+#include "SystemDistanceTable.h"
+
+namespace Evernus
+{
+    void SystemDistanceTable::build(const JumpMap &jumpMap)
+    {
+        clear();
+
+        mRegions.reserve(jumpMap.size());
+
+        for (const auto &region : jumpMap)
+        {
+            std::vector<uint> systems;
+            for (const auto &jump : region.second)
+            {
+                systems.emplace_back(jump.first);
+                systems.emplace_back(jump.second);
+            }
+
+            std::sort(std::begin(systems), std::end(systems));
+            systems.erase(std::unique(std::begin(systems), std::end(systems)), std::end(systems));
+
+            const auto regionIndex = static_cast<quint32>(mRegions.size());
+            const auto size = static_cast<quint32>(systems.size());
+
+            for (auto i = 0u; i < size; ++i)
+                mSystemIndices.emplace(systems[i], SystemIndex{regionIndex, i});
+
+            std::vector<std::vector<quint32>> neighbors(size);
+            for (const auto &jump : region.second)
+                neighbors[mSystemIndices[jump.first].mIndex].emplace_back(mSystemIndices[jump.second].mIndex);
+
+            const auto offset = static_cast<quint32>(mDistances.size());
+            mRegions.emplace_back(RegionInfo{offset, size});
+            mDistances.resize(mDistances.size() + size * size, unreachable);
+
+            // plain BFS from every system - regions are small, so this is cheap compared to doing it on every lookup
+            std::vector<quint32> queue;
+            queue.reserve(size);
+
+            for (auto source = 0u; source < size; ++source)
+            {
+                const auto row = std::next(std::begin(mDistances), offset + source * size);
+                row[source] = 0;
+
+                queue.clear();
+                queue.emplace_back(source);
+
+                for (auto head = 0u; head < queue.size(); ++head)
+                {
+                    const auto current = queue[head];
+                    const auto depth = row[current] + 1;
+                    if (depth >= unreachable)
+                        break;
+
+                    for (const auto neighbor : neighbors[current])
+                    {
+                        if (row[neighbor] != unreachable)
+                            continue;
+
+                        row[neighbor] = static_cast<quint8>(depth);
+                        queue.emplace_back(neighbor);
+                    }
+                }
+            }
+        }
+
+        mDistanceData = mDistances.data();
+
+        qDebug() << "Built distance table for" << mSystemIndices.size() << "systems," << mDistances.size() << "bytes.";
+    }
+
+    bool SystemDistanceTable::load(const QString &fileName, const QString &sdeVersion)
+    {
+        clear();
+
+        mMappedFile.setFileName(fileName);
+        if (!mMappedFile.open(QIODevice::ReadOnly))
+            return false;
+
+        QDataStream stream{&mMappedFile};
+        stream.setVersion(QDataStream::Qt_5_12);
+
+        quint32 magic = 0, version = 0;
+        stream >> magic >> version;
+
+        if (magic != fileMagic || version != fileVersion)
+        {
+            qDebug() << "Ignoring distance table with unknown format:" << fileName;
+            mMappedFile.close();
+            return false;
+        }
+
+        QString fileSdeVersion;
+        stream >> fileSdeVersion;
+
+        if (fileSdeVersion != sdeVersion)
+        {
+            qDebug() << "Ignoring distance table for SDE version" << fileSdeVersion;
+            mMappedFile.close();
+            return false;
+        }
+
+        quint32 systemCount = 0;
+        stream >> systemCount;
+
+        mSystemIndices.reserve(systemCount);
+        for (auto i = 0u; i < systemCount; ++i)
+        {
+            quint32 systemId = 0;
+            SystemIndex index;
+
+            stream >> systemId >> index.mRegion >> index.mIndex;
+            mSystemIndices.emplace(systemId, index);
+        }
+
+        quint32 regionCount = 0;
+        stream >> regionCount;
+
+        mRegions.reserve(regionCount);
+        for (auto i = 0u; i < regionCount; ++i)
+        {
+            RegionInfo region;
+            stream >> region.mOffset >> region.mSize;
+            mRegions.emplace_back(region);
+        }
+
+        quint32 distanceSize = 0;
+        stream >> distanceSize;
+
+        const auto dataOffset = mMappedFile.pos();
+        if (stream.status() != QDataStream::Ok || mMappedFile.size() - dataOffset != distanceSize)
+        {
+            qWarning() << "Corrupted distance table:" << fileName;
+            clear();
+            return false;
+        }
+
+        if (distanceSize > 0)
+        {
+            mDistanceData = mMappedFile.map(dataOffset, distanceSize);
+            if (mDistanceData == nullptr)
+            {
+                qWarning() << "Error mapping distance table:" << mMappedFile.errorString();
+                clear();
+                return false;
+            }
+        }
+
+        qDebug() << "Mapped distance table for" << mSystemIndices.size() << "systems.";
+        return true;
+    }
+
+    bool SystemDistanceTable::save(const QString &fileName, const QString &sdeVersion) const
+    {
+        // the old file stays in place (and mapped) until the new one is complete
+        QSaveFile file{fileName};
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        QDataStream stream{&file};
+        stream.setVersion(QDataStream::Qt_5_12);
+
+        stream << fileMagic << fileVersion << sdeVersion;
+
+        stream << static_cast<quint32>(mSystemIndices.size());
+        for (const auto &system : mSystemIndices)
+            stream << static_cast<quint32>(system.first) << system.second.mRegion << system.second.mIndex;
+
+        stream << static_cast<quint32>(mRegions.size());
+        for (const auto &region : mRegions)
+            stream << region.mOffset << region.mSize;
+
+        stream << static_cast<quint32>(mDistances.size());
+        stream.writeRawData(reinterpret_cast<const char *>(mDistances.data()), static_cast<int>(mDistances.size()));
+
+        return stream.status() == QDataStream::Ok && file.commit();
+    }
+
+    uint SystemDistanceTable::getDistance(uint startSystem, uint endSystem) const noexcept
+    {
+        if (startSystem == endSystem)
+            return 0;
+
+        const auto start = mSystemIndices.find(startSystem);
+        if (start == std::end(mSystemIndices))
+            return std::numeric_limits<uint>::max();
+
+        const auto end = mSystemIndices.find(endSystem);
+        if (end == std::end(mSystemIndices) || end->second.mRegion != start->second.mRegion)
+            return std::numeric_limits<uint>::max();
+
+        Q_ASSERT(mDistanceData != nullptr);
+
+        const auto &region = mRegions[start->second.mRegion];
+        const auto distance = mDistanceData[region.mOffset + start->second.mIndex * region.mSize + end->second.mIndex];
+
+        return (distance == unreachable) ? (std::numeric_limits<uint>::max()) : (distance);
+    }
+
+    void SystemDistanceTable::clear()
+    {
+        if (mDistanceData != nullptr && mDistances.empty())
+            mMappedFile.unmap(const_cast<uchar *>(mDistanceData));
+
+        mSystemIndices.clear();
+        mRegions.clear();
+        mDistances.clear();
+        mDistanceData = nullptr;
+
+        if (mMappedFile.isOpen())
+            mMappedFile.close();
+    }
+}
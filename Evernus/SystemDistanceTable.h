@@ -0,0 +1,74 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <QFile>
+
+namespace Evernus
+{
+    // all-pairs jump distances within each region
+    // systems get dense per-region indices and every region stores a square matrix of 8-bit hop counts;
+    // once built or loaded, the table is read-only, so lookups don't need any locking
+    class SystemDistanceTable final
+    {
+    public:
+        using JumpMap = std::unordered_map<uint, std::unordered_multimap<uint, uint>>;
+
+        SystemDistanceTable() = default;
+        SystemDistanceTable(const SystemDistanceTable &) = delete;
+        SystemDistanceTable(SystemDistanceTable &&) = delete;
+        ~SystemDistanceTable() = default;
+
+        void build(const JumpMap &jumpMap);
+
+        bool load(const QString &fileName, const QString &sdeVersion);
+        bool save(const QString &fileName, const QString &sdeVersion) const;
+
+        uint getDistance(uint startSystem, uint endSystem) const noexcept;
+
+        SystemDistanceTable &operator =(const SystemDistanceTable &) = delete;
+        SystemDistanceTable &operator =(SystemDistanceTable &&) = delete;
+
+    private:
+        static constexpr quint32 fileMagic = 0x45444954; // EDIT - Evernus DIsTances
+        static constexpr quint32 fileVersion = 1;
+
+        static constexpr quint8 unreachable = 255;
+
+        struct SystemIndex
+        {
+            quint32 mRegion;
+            quint32 mIndex;
+        };
+
+        struct RegionInfo
+        {
+            quint32 mOffset;
+            quint32 mSize;
+        };
+
+        std::unordered_map<uint, SystemIndex> mSystemIndices;
+        std::vector<RegionInfo> mRegions;
+
+        std::vector<quint8> mDistances;
+        QFile mMappedFile;
+        const uchar *mDistanceData = nullptr;
+
+        void clear();
+    };
+}
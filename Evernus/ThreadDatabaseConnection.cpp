@@ -0,0 +1,68 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+
+#include "ThreadDatabaseConnection.h"
+
+namespace Evernus
+{
+    ThreadDatabaseConnection::~ThreadDatabaseConnection()
+    {
+        close();
+    }
+
+    bool ThreadDatabaseConnection::isOpen() const
+    {
+        return mDatabase.isOpen();
+    }
+
+    QSqlDatabase ThreadDatabaseConnection::getDatabase() const
+    {
+        return mDatabase;
+    }
+
+    void ThreadDatabaseConnection::setDatabase(const QSqlDatabase &db)
+    {
+        close();
+        mDatabase = db;
+    }
+
+    DatabaseConnectionProvider::StatementCache &ThreadDatabaseConnection::getStatementCache() noexcept
+    {
+        return mStatements;
+    }
+
+    QString ThreadDatabaseConnection::getUniqueConnectionName(const QString &prefix)
+    {
+        static std::atomic_uint counter{0};
+        return QStringLiteral("%1-%2").arg(prefix).arg(++counter);
+    }
+
+    void ThreadDatabaseConnection::close()
+    {
+        // statements hold on to the connection, so they have to go first
+        mStatements.clear();
+
+        if (!mDatabase.isValid())
+            return;
+
+        const auto name = mDatabase.connectionName();
+
+        mDatabase.close();
+        mDatabase = QSqlDatabase{};     // the registry won't let go while a handle is still around
+
+        QSqlDatabase::removeDatabase(name);
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QSqlDatabase>
+#include <QString>
+
+#include "DatabaseConnectionProvider.h"
+
+namespace Evernus
+{
+    // connection which is opened by and never leaves a single thread, along with the statements prepared on it
+    // meant to be thread_local, so both are closed and removed from Qt registry when the thread ends
+    class ThreadDatabaseConnection final
+    {
+    public:
+        ThreadDatabaseConnection() = default;
+        ThreadDatabaseConnection(const ThreadDatabaseConnection &) = delete;
+        ThreadDatabaseConnection(ThreadDatabaseConnection &&) = delete;
+        ~ThreadDatabaseConnection();
+
+        bool isOpen() const;
+
+        QSqlDatabase getDatabase() const;
+        void setDatabase(const QSqlDatabase &db);
+
+        DatabaseConnectionProvider::StatementCache &getStatementCache() noexcept;
+
+        ThreadDatabaseConnection &operator =(const ThreadDatabaseConnection &) = delete;
+        ThreadDatabaseConnection &operator =(ThreadDatabaseConnection &&) = delete;
+
+        // thread ids get reused, so names are unique per opened connection instead
+        static QString getUniqueConnectionName(const QString &prefix);
+
+    private:
+        QSqlDatabase mDatabase;
+        DatabaseConnectionProvider::StatementCache mStatements;
+
+        void close();
+    };
+}
@@ -12,9 +12,9 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <unordered_set>
 #include <functional>
-#include <set>
+#include <algorithm>
+#include <iterator>
 
 #include <QSettings>
 #include <QLocale>
@@ -22,11 +22,10 @@
 #include <QIcon>
 
 #include <boost/range/adaptor/reversed.hpp>
-#include <boost/scope_exit.hpp>
 
 #include "MarketAnalysisSettings.h"
 #include "EveDataProvider.h"
-#include "ExternalOrder.h"
+#include "ExternalOrderBook.h"
 #include "PriceUtils.h"
 #include "MathUtils.h"
 #include "TextUtils.h"
@@ -36,7 +35,7 @@
 namespace Evernus
 {
     TypeAggregatedMarketDataModel::TypeAggregatedMarketDataModel(const EveDataProvider &dataProvider, QObject *parent)
-        : QAbstractTableModel{parent}
+        : IncrementalItemModel{parent}
         , ModelWithTypes{}
         , mDataProvider{dataProvider}
     {
@@ -154,67 +153,21 @@ namespace Evernus
         return (parent.isValid()) ? (0) : (static_cast<int>(mData.size()));
     }
 
-    void TypeAggregatedMarketDataModel::setOrderData(const std::vector<ExternalOrder> &orders,
+    void TypeAggregatedMarketDataModel::setOrderData(const ExternalOrderBook &orders,
                                                      const HistoryMap &history,
                                                      uint region,
                                                      PriceType srcType,
                                                      PriceType dstType,
                                                      uint solarSystem)
     {
-        beginResetModel();
-
-        BOOST_SCOPE_EXIT(this_) {
-            this_->endResetModel();
-        } BOOST_SCOPE_EXIT_END
+        std::vector<TypeData> newData;
 
-        mData.clear();
+        // price columns switch meaning, so there's nothing to keep
+        const auto priceTypesChanged = mSrcPriceType != srcType || mDstPriceType != dstType;
 
         mSrcPriceType = srcType;
         mDstPriceType = dstType;
 
-        struct LowToHigh
-        {
-            bool operator ()(const ExternalOrder &a, const ExternalOrder &b) const noexcept
-            {
-                return a.getPrice() < b.getPrice();
-            }
-        };
-
-        struct HighToLow
-        {
-            bool operator ()(const ExternalOrder &a, const ExternalOrder &b) const noexcept
-            {
-                return a.getPrice() > b.getPrice();
-            }
-        };
-
-        TypeMap<std::multiset<std::reference_wrapper<const ExternalOrder>, LowToHigh>> sellOrders;
-        TypeMap<std::multiset<std::reference_wrapper<const ExternalOrder>, HighToLow>> buyOrders;
-
-        TypeMap<uint> sellVolumes, buyVolumes;
-
-        std::unordered_set<EveType::IdType> usedTypes;
-
-        for (const auto &order : orders)
-        {
-            if (order.getRegionId() != region || (solarSystem != 0 && order.getSolarSystemId() != solarSystem))
-                continue;
-
-            const auto typeId = order.getTypeId();
-            if (order.getType() == ExternalOrder::Type::Buy)
-            {
-                buyOrders[typeId].insert(std::cref(order));
-                buyVolumes[typeId] += order.getVolumeRemaining();
-            }
-            else
-            {
-                sellOrders[typeId].insert(std::cref(order));
-                sellVolumes[typeId] += order.getVolumeRemaining();
-            }
-
-            usedTypes.insert(typeId);
-        }
-
         const auto historyLimit = QDate::currentDate().addDays(-static_cast<int>(mAvgPeriod) + 1);
         PriceUtils::Taxes taxes;
 
@@ -225,8 +178,10 @@ namespace Evernus
         if (useSkillsForDifference)
             taxes = PriceUtils::calculateTaxes(*mCharacter);
 
-        for (const auto type : usedTypes)
-        {
+        const auto addType = [&](auto type, const auto &typeBuyOrders, const auto &typeSellOrders) {
+            if (typeBuyOrders.empty() && typeSellOrders.empty())
+                return;
+
             TypeData data;
             auto avgPrice = 0.;
 
@@ -246,27 +201,24 @@ namespace Evernus
                 avgPrice /= mAvgPeriod;
             }
 
-            const auto &typeBuyOrders = buyOrders[type];
-            const auto &typeSellOrders = sellOrders[type];
-
             data.mId = type;
             data.mBuyOrderCount = typeBuyOrders.size();
             data.mSellOrderCount = typeSellOrders.size();
 
             if (mIgnorePercentiles)
             {
-                data.mBuyPrice = (typeBuyOrders.empty()) ? (0.) : (std::cbegin(typeBuyOrders)->get().getPrice());
-                data.mSellPrice = (typeSellOrders.empty()) ? (0.) : (std::cbegin(typeSellOrders)->get().getPrice());
+                data.mBuyPrice = (typeBuyOrders.empty()) ? (0.) : (std::begin(typeBuyOrders)->get().getPrice());
+                data.mSellPrice = (typeSellOrders.empty()) ? (0.) : (std::begin(typeSellOrders)->get().getPrice());
             }
             else
             {
                 data.mBuyPrice = MathUtils::calcPercentile(typeBuyOrders,
-                                                           buyVolumes[type] * 0.05,
+                                                           MathUtils::calcTotalVolume(typeBuyOrders) * 0.05,
                                                            avgPrice,
                                                            mDiscardBogusOrders,
                                                            mBogusOrderThreshold);
                 data.mSellPrice = MathUtils::calcPercentile(typeSellOrders,
-                                                            sellVolumes[type] * 0.05,
+                                                            MathUtils::calcTotalVolume(typeSellOrders) * 0.05,
                                                             avgPrice,
                                                             mDiscardBogusOrders,
                                                             mBogusOrderThreshold);
@@ -287,7 +239,47 @@ namespace Evernus
             data.mDifference = realSellPrice - realBuyPrice;
             data.mMargin = (qFuzzyIsNull(realSellPrice)) ? (0.) : (100. * data.mDifference / realSellPrice);
 
-            mData.emplace_back(std::move(data));
+            newData.emplace_back(std::move(data));
+        };
+
+        // book slices are already sorted best price first, so only the solar system filter needs a copy
+        std::vector<ExternalOrderBook::OrderRef> buyOrders, sellOrders;
+
+        for (const auto type : orders.getTypeIds())
+        {
+            const auto typeBuyOrders = orders.getOrders(type, PriceType::Buy, region);
+            const auto typeSellOrders = orders.getOrders(type, PriceType::Sell, region);
+
+            if (solarSystem == 0)
+            {
+                addType(type, typeBuyOrders, typeSellOrders);
+                continue;
+            }
+
+            const auto inSolarSystem = [=](const auto &order) {
+                return order.getSolarSystemId() == solarSystem;
+            };
+
+            buyOrders.clear();
+            sellOrders.clear();
+
+            std::copy_if(std::begin(typeBuyOrders), std::end(typeBuyOrders), std::back_inserter(buyOrders), inSolarSystem);
+            std::copy_if(std::begin(typeSellOrders), std::end(typeSellOrders), std::back_inserter(sellOrders), inSolarSystem);
+
+            addType(type, buyOrders, sellOrders);
+        }
+
+        if (priceTypesChanged)
+        {
+            beginResetModel();
+            mData = std::move(newData);
+            endResetModel();
+        }
+        else
+        {
+            updateRows(mData, std::move(newData), [](const auto &data) {
+                return data.mId;
+            }, std::equal_to<>{});
         }
     }
 
@@ -366,4 +358,16 @@ namespace Evernus
     {
         return dstPriceColumn;
     }
+
+    bool TypeAggregatedMarketDataModel::TypeData::operator ==(const TypeData &other) const noexcept
+    {
+        return mId == other.mId &&
+               mBuyPrice == other.mBuyPrice &&
+               mSellPrice == other.mSellPrice &&
+               mDifference == other.mDifference &&
+               mVolume == other.mVolume &&
+               mMargin == other.mMargin &&
+               mBuyOrderCount == other.mBuyOrderCount &&
+               mSellOrderCount == other.mSellOrderCount;
+    }
 }
@@ -21,6 +21,7 @@
 
 #include <QAbstractTableModel>
 
+#include "IncrementalItemModel.h"
 #include "ModelWithTypes.h"
 #include "MarketHistory.h"
 #include "Character.h"
@@ -32,10 +33,10 @@ class QColor;
 namespace Evernus
 {
     class EveDataProvider;
-    class ExternalOrder;
+    class ExternalOrderBook;
 
     class TypeAggregatedMarketDataModel
-        : public QAbstractTableModel
+        : public IncrementalItemModel<QAbstractTableModel>
         , public ModelWithTypes
     {
         Q_OBJECT
@@ -53,7 +54,7 @@ namespace Evernus
         virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
         virtual int rowCount(const QModelIndex &parent = QModelIndex{}) const override;
 
-        void setOrderData(const std::vector<ExternalOrder> &orders,
+        void setOrderData(const ExternalOrderBook &orders,
                           const HistoryMap &history,
                           uint region,
                           PriceType srcType,
@@ -104,6 +105,8 @@ namespace Evernus
             double mMargin = 0.;
             quint64 mBuyOrderCount = 0;
             quint64 mSellOrderCount = 0;
+
+            bool operator ==(const TypeData &other) const noexcept;
         };
 
         const EveDataProvider &mDataProvider;
@@ -24,7 +24,6 @@
 #include "CharacterRepository.h"
 #include "WalletTransaction.h"
 #include "EveDataProvider.h"
-#include "DatabaseUtils.h"
 #include "TextUtils.h"
 
 #include "TypePerformanceModel.h"
@@ -151,72 +150,6 @@ namespace Evernus
 
         mData.clear();
 
-        QSqlQuery query{mCharacterRepository.getDatabase()};
-
-        if (combineCharacters && combineCorp)
-        {
-            query.prepare(QStringLiteral(R"(
-SELECT type_id, type, price, quantity
-    FROM (
-        SELECT type_id, price, type, quantity FROM %1 WHERE ignored = 0 AND timestamp BETWEEN ? AND ?
-        UNION
-        SELECT type_id, price, type, quantity FROM %2 WHERE ignored = 0 AND timestamp BETWEEN ? AND ?
-    )
-    GROUP BY type_id, type
-            )")
-                .arg(mTransactionRepository.getTableName())
-                .arg(mCorpTransactionRepository.getTableName())
-            );
-
-            query.addBindValue(from);
-            query.addBindValue(to);
-            query.addBindValue(from);
-            query.addBindValue(to);
-        }
-        else if (combineCharacters)
-        {
-            query.prepare(QStringLiteral("SELECT type_id, type, price, quantity FROM %1 WHERE ignored = 0 AND timestamp BETWEEN ? AND ?")
-                .arg(mTransactionRepository.getTableName())
-            );
-
-            query.addBindValue(from);
-            query.addBindValue(to);
-        }
-        else if (combineCorp)
-        {
-            query.prepare(QStringLiteral(R"(
-SELECT type_id, type, price, quantity
-    FROM (
-        SELECT type_id, price, type, quantity FROM %1 WHERE character_id = ? AND ignored = 0 AND timestamp BETWEEN ? AND ?
-        UNION
-        SELECT type_id, price, type, quantity FROM %2 WHERE corporation_id = ? AND ignored = 0 AND timestamp BETWEEN ? AND ?
-    )
-    GROUP BY type_id, type
-            )")
-                .arg(mTransactionRepository.getTableName())
-                .arg(mCorpTransactionRepository.getTableName())
-            );
-
-            query.addBindValue(characterId);
-            query.addBindValue(from);
-            query.addBindValue(to);
-            query.addBindValue(mCharacterRepository.getCorporationId(characterId));
-            query.addBindValue(from);
-            query.addBindValue(to);
-        }
-        else
-        {
-            query.prepare(QStringLiteral("SELECT type_id, type, price, quantity FROM %1 WHERE character_id = ? AND ignored = 0 AND timestamp BETWEEN ? AND ?")
-                .arg(mTransactionRepository.getTableName())
-            );
-
-            query.addBindValue(characterId);
-            query.addBindValue(from);
-            query.addBindValue(to);
-        }
-
-        DatabaseUtils::execQuery(query);
-
         struct IntermediateData
         {
             quint64 mSellVolume = 0;
@@ -227,23 +160,32 @@ SELECT type_id, type, price, quantity
 
         std::unordered_map<EveType::IdType, IntermediateData> itemData;
 
-        while (query.next())
-        {
-            auto &data = itemData[query.value(0).value<EveType::IdType>()];
-
-            const auto quantity = query.value(3).toULongLong();
-            const auto price = query.value(2).toDouble();
-
-            if (static_cast<WalletTransaction::Type>(query.value(1).toInt()) == WalletTransaction::Type::Buy)
-            {
-                data.mBuyVolume += quantity;
-                data.mTotalOutcome += price * quantity;
-            }
-            else
+        const auto addTotals = [&](const auto &totals) {
+            for (const auto &total : totals)
             {
-                data.mSellVolume += quantity;
-                data.mTotalIncome += price * quantity;
+                auto &data = itemData[total.mTypeId];
+                if (total.mType == WalletTransaction::Type::Buy)
+                {
+                    data.mBuyVolume += total.mQuantity;
+                    data.mTotalOutcome += total.mValue;
+                }
+                else
+                {
+                    data.mSellVolume += total.mQuantity;
+                    data.mTotalIncome += total.mValue;
+                }
             }
+        };
+
+        addTotals((combineCharacters) ?
+                  (mTransactionRepository.fetchDailyTypeTotals(from, to)) :
+                  (mTransactionRepository.fetchDailyTypeTotalsForCharacter(characterId, from, to)));
+
+        if (combineCorp)
+        {
+            addTotals((combineCharacters) ?
+                      (mCorpTransactionRepository.fetchDailyTypeTotals(from, to)) :
+                      (mCorpTransactionRepository.fetchDailyTypeTotalsForCorporation(mCharacterRepository.getCorporationId(characterId), from, to)));
         }
 
         mData.reserve(itemData.size());
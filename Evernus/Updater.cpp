@@ -592,6 +592,7 @@ namespace Evernus
     {
         const auto update = [&](const auto &repo) {
             safelyExecQuery(repo, QStringLiteral("DROP TABLE %1").arg(repo.getTableName()));
+            safelyExecQuery(repo, QStringLiteral("DROP TABLE IF EXISTS %1").arg(repo.getDailyRollupTableName()));
             repo.create(characterRepo);
         };
 
@@ -646,6 +647,8 @@ namespace Evernus
     {
         safelyExecQuery(walletTransactionRepo, QStringLiteral("DROP TABLE IF EXISTS %1").arg(walletTransactionRepo.getTableName()));
         safelyExecQuery(corpWalletTransactionRepo, QStringLiteral("DROP TABLE IF EXISTS %1").arg(corpWalletTransactionRepo.getTableName()));
+        safelyExecQuery(walletTransactionRepo, QStringLiteral("DROP TABLE IF EXISTS %1").arg(walletTransactionRepo.getDailyRollupTableName()));
+        safelyExecQuery(corpWalletTransactionRepo, QStringLiteral("DROP TABLE IF EXISTS %1").arg(corpWalletTransactionRepo.getDailyRollupTableName()));
 
         walletTransactionRepo.create(characterRepo);
         corpWalletTransactionRepo.create(characterRepo);
@@ -12,9 +12,13 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <QElapsedTimer>
 #include <QSqlRecord>
 #include <QSqlQuery>
 
+#include "WalletRollupUtils.h"
+#include "KeysetCursor.h"
+
 #include "WalletJournalEntryRepository.h"
 
 namespace Evernus
@@ -35,6 +39,11 @@ namespace Evernus
         return QStringLiteral("id");
     }
 
+    QString WalletJournalEntryRepository::getDailyRollupTableName() const
+    {
+        return getTableName() + QStringLiteral("_daily");
+    }
+
     WalletJournalEntryRepository::EntityPtr WalletJournalEntryRepository::populate(const QSqlRecord &record) const
     {
         const auto taxReceiverId = record.value(QStringLiteral("tax_receiver_id"));
@@ -105,6 +114,47 @@ namespace Evernus
             // ignore - versions < 1.9 do not have this column
             qDebug() << "SQL errors ignored";
         }
+
+        const auto hasRollups = getDatabase().tables().contains(getDailyRollupTableName());
+
+        exec(QStringLiteral("CREATE TABLE IF NOT EXISTS %1 ("
+            "character_id BIGINT NOT NULL %2,"
+            "day DATE NOT NULL,"
+            "corporation_id BIGINT NOT NULL,"
+            "income NUMERIC NOT NULL,"
+            "outcome NUMERIC NOT NULL,"
+            "PRIMARY KEY (character_id, day, corporation_id)"
+        ")").arg(getDailyRollupTableName()).arg(
+            (mCorp) ? (QString{}) : (QStringLiteral("REFERENCES %2(%3) ON UPDATE CASCADE ON DELETE CASCADE").arg(characterRepo.getTableName()).arg(characterRepo.getIdColumn()))));
+
+        exec(QStringLiteral("CREATE INDEX IF NOT EXISTS %1_day ON %1(day)").arg(getDailyRollupTableName()));
+        exec(QStringLiteral("CREATE INDEX IF NOT EXISTS %1_corporation_day ON %1(corporation_id, day)").arg(getDailyRollupTableName()));
+
+        if (!hasRollups)
+        {
+            // existing history gets rolled up once, later on only touched days are rebuilt
+            QElapsedTimer timer;
+            timer.start();
+
+            try
+            {
+                exec(QStringLiteral(
+                    "INSERT INTO %1 (character_id, day, corporation_id, income, outcome) "
+                    "SELECT character_id, substr(timestamp, 1, 10), corporation_id, "
+                    "TOTAL(CASE WHEN amount >= 0 THEN amount ELSE 0 END), TOTAL(CASE WHEN amount < 0 THEN -amount ELSE 0 END) "
+                    "FROM %2 WHERE ignored = 0 GROUP BY character_id, substr(timestamp, 1, 10), corporation_id"
+                ).arg(getDailyRollupTableName()).arg(getTableName()));
+            }
+            catch (const std::exception &)
+            {
+                // versions < 1.9 do not have all the columns yet - try again after the update
+                qDebug() << "SQL errors ignored";
+                exec(QStringLiteral("DROP TABLE %1").arg(getDailyRollupTableName()));
+                return;
+            }
+
+            qDebug() << "Rolled up" << getTableName() << "in" << timer.elapsed() << "ms.";
+        }
     }
 
     WalletJournalEntry::IdType WalletJournalEntryRepository::getLatestEntryId(Character::IdType characterId) const
@@ -125,6 +175,20 @@ namespace Evernus
         query.bindValue(1, id);
 
         DatabaseUtils::execQuery(query);
+
+        query = prepare(QStringLiteral("SELECT %1, timestamp FROM %2 WHERE %3 = ?").arg(getRollupOwnerColumn()).arg(getTableName()).arg(getIdColumn()));
+        query.bindValue(0, id);
+
+        DatabaseUtils::execQuery(query);
+
+        if (query.next())
+        {
+            auto timestamp = query.value(1).toDateTime();
+            timestamp.setTimeSpec(Qt::UTC);
+
+            const auto day = timestamp.date();
+            rebuildDailyRollups(day, day, query.value(0).value<quint64>());
+        }
     }
 
     void WalletJournalEntryRepository::deleteOldEntries(const QDateTime &from) const
@@ -133,11 +197,40 @@ namespace Evernus
         query.bindValue(0, from);
 
         DatabaseUtils::execQuery(query);
+
+        const auto firstDay = from.toUTC().date();
+
+        query = prepare(QStringLiteral("DELETE FROM %1 WHERE day < ?").arg(getDailyRollupTableName()));
+        query.bindValue(0, firstDay);
+
+        DatabaseUtils::execQuery(query);
+
+        // first day might have lost only a part of its entries
+        rebuildDailyRollups(firstDay, firstDay);
     }
 
     void WalletJournalEntryRepository::deleteAll() const
     {
         exec(QStringLiteral("DELETE FROM %1").arg(getTableName()));
+        exec(QStringLiteral("DELETE FROM %1").arg(getDailyRollupTableName()));
+    }
+
+    void WalletJournalEntryRepository::updateDailyRollups(const WalletJournal &entries, bool wrapInTransaction) const
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto owners = WalletRollupUtils::updateDailyRollups(getDatabase(), entries, wrapInTransaction, [=](const auto &entry) {
+            return (mCorp) ? (entry.getCorporationId()) : (entry.getCharacterId());
+        }, [=](const auto &from, const auto &to, auto ownerId) {
+            rebuildDailyRollups(from, to, ownerId);
+#ifndef NDEBUG
+            checkDailyRollups(from, to, ownerId);
+#endif
+        });
+
+        if (owners > 0)
+            qDebug() << "Updated" << getDailyRollupTableName() << "for" << owners << ((mCorp) ? ("corporations") : ("characters")) << "in" << timer.elapsed() << "ms.";
     }
 
     WalletJournalEntryRepository::EntityList WalletJournalEntryRepository
@@ -185,6 +278,128 @@ namespace Evernus
         return fetchForColumnInRange(corporationId, from, till, type, QStringLiteral("corporation_id"));
     }
 
+    WalletJournalEntryRepository::EntityList WalletJournalEntryRepository
+    ::fetchPage(const PageFilter &filter, SortColumn column, KeysetCursor &cursor, uint limit) const
+    {
+        if (filter.mOwnerIds.empty() || cursor.isAtEnd())
+            return {};
+
+        QString key;
+        switch (column) {
+        case SortColumn::Ignored:
+            key = QStringLiteral("ignored");
+            break;
+        case SortColumn::RefType:
+            key = QStringLiteral("COALESCE(ref_type, '')");
+            break;
+        case SortColumn::FirstParty:
+            key = QStringLiteral("COALESCE(first_party_id, 0)");
+            break;
+        case SortColumn::SecondParty:
+            key = QStringLiteral("COALESCE(second_party_id, 0)");
+            break;
+        case SortColumn::Context:
+            key = QStringLiteral("COALESCE(context_id, 0)");
+            break;
+        case SortColumn::Amount:
+            key = QStringLiteral("COALESCE(amount, 0)");
+            break;
+        case SortColumn::Balance:
+            key = QStringLiteral("COALESCE(balance, 0)");
+            break;
+        case SortColumn::Reason:
+            key = QStringLiteral("COALESCE(reason, '')");
+            break;
+        default:
+            key = QStringLiteral("timestamp");
+        }
+
+        auto queryStr = QStringLiteral("SELECT *, %1 AS sort_key FROM %2 WHERE %3 IN (%4) AND timestamp BETWEEN ? AND ?")
+            .arg(key)
+            .arg(getTableName())
+            .arg((mCorp) ? (QStringLiteral("corporation_id")) : (QStringLiteral("character_id")))
+            .arg(DatabaseUtils::joinIds(filter.mOwnerIds));
+
+        switch (filter.mType) {
+        case EntryType::Incomig:
+            queryStr += QStringLiteral(" AND amount >= 0");
+            break;
+        case EntryType::Outgoing:
+            queryStr += QStringLiteral(" AND amount < 0");
+            break;
+        default:
+            break;
+        }
+
+        if (!filter.mText.isEmpty())
+        {
+            queryStr += QStringLiteral(" AND (REPLACE(ref_type, '_', ' ') LIKE ? ESCAPE '\\' OR reason LIKE ? ESCAPE '\\' OR (context_id_type || ': ' || context_id) LIKE ? ESCAPE '\\'");
+
+            if (!filter.mTextPartyIds.empty())
+            {
+                const auto ids = DatabaseUtils::joinIds(filter.mTextPartyIds);
+                queryStr += QStringLiteral(" OR first_party_id IN (%1) OR second_party_id IN (%1)").arg(ids);
+            }
+
+            queryStr += QLatin1Char(')');
+        }
+
+        queryStr += cursor.getCondition(key, getIdColumn());
+        queryStr += cursor.getOrderBy(key, getIdColumn());
+
+        if (limit > 0)
+            queryStr += QStringLiteral(" LIMIT %1").arg(limit);
+
+        auto query = prepare(queryStr);
+        query.addBindValue(filter.mFrom);
+        query.addBindValue(filter.mTill);
+
+        if (!filter.mText.isEmpty())
+        {
+            const auto pattern = DatabaseUtils::wildcardToLikePattern(filter.mText);
+            query.addBindValue(pattern);
+            query.addBindValue(pattern);
+            query.addBindValue(pattern);
+        }
+
+        cursor.bindValues(query);
+
+        DatabaseUtils::execQuery(query);
+
+        EntityList result;
+        if (limit > 0)
+            result.reserve(limit);
+
+        QSqlRecord record;
+        while (query.next())
+        {
+            record = query.record();
+            result.emplace_back(populate(record));
+        }
+
+        cursor.advance(record, getIdColumn(), static_cast<uint>(result.size()), limit);
+
+        return result;
+    }
+
+    std::vector<WalletJournalEntryRepository::DayTotal> WalletJournalEntryRepository
+    ::fetchDayTotals(const QDate &from, const QDate &to) const
+    {
+        return fetchDayTotalsForColumn(QString{}, 0, from, to);
+    }
+
+    std::vector<WalletJournalEntryRepository::DayTotal> WalletJournalEntryRepository
+    ::fetchDayTotalsForCharacter(Character::IdType characterId, const QDate &from, const QDate &to) const
+    {
+        return fetchDayTotalsForColumn(QStringLiteral("character_id"), characterId, from, to);
+    }
+
+    std::vector<WalletJournalEntryRepository::DayTotal> WalletJournalEntryRepository
+    ::fetchDayTotalsForCorporation(quint64 corporationId, const QDate &from, const QDate &to) const
+    {
+        return fetchDayTotalsForColumn(QStringLiteral("corporation_id"), corporationId, from, to);
+    }
+
     QStringList WalletJournalEntryRepository::getColumns() const
     {
         return {
@@ -264,6 +479,101 @@ namespace Evernus
         query.addBindValue(entity.getContextIdType());
     }
 
+    QString WalletJournalEntryRepository::getRollupOwnerColumn() const
+    {
+        return (mCorp) ? (QStringLiteral("corporation_id")) : (QStringLiteral("character_id"));
+    }
+
+    void WalletJournalEntryRepository::rebuildDailyRollups(const QDate &from, const QDate &to, quint64 ownerId) const
+    {
+        const auto ownerCondition = (ownerId == 0) ? (QString{}) : (QStringLiteral(" AND %1 = ?").arg(getRollupOwnerColumn()));
+
+        auto query = prepare(QStringLiteral("DELETE FROM %1 WHERE day BETWEEN ? AND ?%2").arg(getDailyRollupTableName()).arg(ownerCondition));
+        query.addBindValue(from);
+        query.addBindValue(to);
+
+        if (ownerId != 0)
+            query.addBindValue(ownerId);
+
+        DatabaseUtils::execQuery(query);
+
+        query = prepare(QStringLiteral(
+            "INSERT INTO %1 (character_id, day, corporation_id, income, outcome) "
+            "SELECT character_id, substr(timestamp, 1, 10), corporation_id, "
+            "TOTAL(CASE WHEN amount >= 0 THEN amount ELSE 0 END), TOTAL(CASE WHEN amount < 0 THEN -amount ELSE 0 END) "
+            "FROM %2 WHERE timestamp >= ? AND timestamp < ? AND ignored = 0%3 "
+            "GROUP BY character_id, substr(timestamp, 1, 10), corporation_id"
+        ).arg(getDailyRollupTableName()).arg(getTableName()).arg(ownerCondition));
+        query.addBindValue(from);
+        query.addBindValue(to.addDays(1));
+
+        if (ownerId != 0)
+            query.addBindValue(ownerId);
+
+        DatabaseUtils::execQuery(query);
+    }
+
+#ifndef NDEBUG
+    void WalletJournalEntryRepository::checkDailyRollups(const QDate &from, const QDate &to, quint64 ownerId) const
+    {
+        auto query = prepare(QStringLiteral(
+            "SELECT (SELECT TOTAL(amount) FROM %1 WHERE timestamp >= ? AND timestamp < ? AND ignored = 0 AND %3 = ?), "
+            "(SELECT TOTAL(income) - TOTAL(outcome) FROM %2 WHERE day BETWEEN ? AND ? AND %3 = ?)"
+        ).arg(getTableName()).arg(getDailyRollupTableName()).arg(getRollupOwnerColumn()));
+        query.addBindValue(from);
+        query.addBindValue(to.addDays(1));
+        query.addBindValue(ownerId);
+        query.addBindValue(from);
+        query.addBindValue(to);
+        query.addBindValue(ownerId);
+
+        DatabaseUtils::execQuery(query);
+        query.next();
+
+        const auto entryTotal = query.value(0).toDouble();
+        const auto rollupTotal = query.value(1).toDouble();
+
+        if (qAbs(entryTotal - rollupTotal) > 0.01)
+        {
+            qWarning() << getDailyRollupTableName() << "doesn't match" << getTableName() << "for" << ownerId << "between" << from << "and" << to << ":" << rollupTotal << "vs" << entryTotal;
+            Q_ASSERT(false);
+        }
+    }
+#endif
+
+    std::vector<WalletJournalEntryRepository::DayTotal> WalletJournalEntryRepository
+    ::fetchDayTotalsForColumn(const QString &column, quint64 id, const QDate &from, const QDate &to) const
+    {
+        auto queryStr = QStringLiteral("SELECT day, SUM(income), SUM(outcome) FROM %1 WHERE day BETWEEN ? AND ?").arg(getDailyRollupTableName());
+
+        if (!column.isEmpty())
+            queryStr += QStringLiteral(" AND %1 = ?").arg(column);
+
+        queryStr += QStringLiteral(" GROUP BY day ORDER BY day");
+
+        auto query = prepare(queryStr);
+        query.addBindValue(from);
+        query.addBindValue(to);
+
+        if (!column.isEmpty())
+            query.addBindValue(id);
+
+        DatabaseUtils::execQuery(query);
+
+        std::vector<DayTotal> result;
+        while (query.next())
+        {
+            DayTotal total;
+            total.mDay = query.value(0).toDate();
+            total.mIncome = query.value(1).toDouble();
+            total.mOutcome = query.value(2).toDouble();
+
+            result.emplace_back(total);
+        }
+
+        return result;
+    }
+
     template<class T>
     WalletJournalEntryRepository::EntityList WalletJournalEntryRepository::fetchForColumnInRange(T id,
                                                                                                  const QDateTime &from,
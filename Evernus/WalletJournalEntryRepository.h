@@ -14,11 +14,16 @@
  */
 #pragma once
 
-#include "WalletJournalEntry.h"
+#include <vector>
+
+#include <QDate>
+
+#include "WalletJournal.h"
 #include "Repository.h"
 
 namespace Evernus
 {
+    class KeysetCursor;
     class Character;
 
     class WalletJournalEntryRepository
@@ -32,12 +37,44 @@ namespace Evernus
             Outgoing
         };
 
+        enum class SortColumn
+        {
+            Timestamp,
+            Ignored,
+            RefType,
+            FirstParty,
+            SecondParty,
+            Context,
+            Amount,
+            Balance,
+            Reason
+        };
+
+        struct PageFilter
+        {
+            std::vector<quint64> mOwnerIds; // characters or, for corp journal, corporations
+            QDateTime mFrom;
+            QDateTime mTill;
+            EntryType mType = EntryType::All;
+            QString mText;                  // wildcard matched against text columns
+            std::vector<quint64> mTextPartyIds;    // parties with names matching the text
+        };
+
+        struct DayTotal
+        {
+            QDate mDay;
+            double mIncome = 0.;
+            double mOutcome = 0.;
+        };
+
         WalletJournalEntryRepository(bool corp, const DatabaseConnectionProvider &connectionProvider);
         virtual ~WalletJournalEntryRepository() = default;
 
         virtual QString getTableName() const override;
         virtual QString getIdColumn() const override;
 
+        QString getDailyRollupTableName() const;
+
         virtual EntityPtr populate(const QSqlRecord &record) const override;
 
         void create(const Repository<Character> &characterRepo) const;
@@ -48,6 +85,9 @@ namespace Evernus
         void deleteOldEntries(const QDateTime &from) const;
         void deleteAll() const;
 
+        // recomputes daily rollups of the days touched by given entries
+        void updateDailyRollups(const WalletJournal &entries, bool wrapInTransaction = true) const;
+
         EntityList fetchInRange(const QDateTime &from,
                                 const QDateTime &till,
                                 EntryType type) const;
@@ -61,6 +101,14 @@ namespace Evernus
                                               const QDateTime &till,
                                               EntryType type) const;
 
+        // limit 0 fetches everything that's left
+        EntityList fetchPage(const PageFilter &filter, SortColumn column, KeysetCursor &cursor, uint limit) const;
+
+        // answered from daily rollups - ignored entries are left out and days are in EVE (UTC) time
+        std::vector<DayTotal> fetchDayTotals(const QDate &from, const QDate &to) const;
+        std::vector<DayTotal> fetchDayTotalsForCharacter(Character::IdType characterId, const QDate &from, const QDate &to) const;
+        std::vector<DayTotal> fetchDayTotalsForCorporation(quint64 corporationId, const QDate &from, const QDate &to) const;
+
     private:
         bool mCorp = false;
 
@@ -68,6 +116,18 @@ namespace Evernus
         virtual void bindValues(const WalletJournalEntry &entity, QSqlQuery &query) const override;
         virtual void bindPositionalValues(const WalletJournalEntry &entity, QSqlQuery &query) const override;
 
+        // corp entries are stored under whichever character imported them last, so corp rollups are kept per corporation
+        QString getRollupOwnerColumn() const;
+
+        // owner is a character or a corporation (see above); 0 rebuilds given days for everyone
+        void rebuildDailyRollups(const QDate &from, const QDate &to, quint64 ownerId = 0) const;
+#ifndef NDEBUG
+        // rollups must add up to the entries they cover, no matter who imported them
+        void checkDailyRollups(const QDate &from, const QDate &to, quint64 ownerId) const;
+#endif
+
+        std::vector<DayTotal> fetchDayTotalsForColumn(const QString &column, quint64 id, const QDate &from, const QDate &to) const;
+
         template<class T>
         EntityList fetchForColumnInRange(T id,
                                          const QDateTime &from,
@@ -12,8 +12,11 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+
 #include <QRegularExpression>
 #include <QTextDocument>
+#include <QRegExp>
 #include <QLocale>
 #include <QColor>
 #include <QHash>
@@ -163,6 +166,39 @@ namespace Evernus
         return 0;
     }
 
+    bool WalletJournalModel::canFetchMore(const QModelIndex &parent) const
+    {
+        return !parent.isValid() && !mPageFilter.mOwnerIds.empty() && !mCursor.isAtEnd();
+    }
+
+    void WalletJournalModel::fetchMore(const QModelIndex &parent)
+    {
+        if (parent.isValid())
+            return;
+
+        const auto entries = mJournalRepository.fetchPage(mPageFilter, getSortColumn(), mCursor, pageSize);
+        if (entries.empty())
+            return;
+
+        const auto row = rowCount();
+
+        beginInsertRows(QModelIndex{}, row, row + static_cast<int>(entries.size()) - 1);
+        processData(entries);
+        endInsertRows();
+    }
+
+    void WalletJournalModel::sort(int column, Qt::SortOrder order)
+    {
+        // without lazy loading, sorting is up to the proxy model
+        if (!mLazy || (column == mSortColumn && order == mSortOrder))
+            return;
+
+        mSortColumn = column;
+        mSortOrder = order;
+
+        reset();
+    }
+
     void WalletJournalModel::setFilter(Character::IdType id, const QDate &from, const QDate &till, EntryType type, bool combineCharacters)
     {
         mCharacterId = id;
@@ -180,70 +216,31 @@ namespace Evernus
         reset();
     }
 
+    void WalletJournalModel::setLazyLoading(bool flag)
+    {
+        mLazy = flag;
+    }
+
+    void WalletJournalModel::setTextFilter(const QString &text)
+    {
+        mTextFilter = text;
+    }
+
     void WalletJournalModel::reset()
     {
         beginResetModel();
 
         mData.clear();
-        if (Q_LIKELY(mCharacterId != Character::invalidId || mCombineCharacters))
+        mCursor = KeysetCursor{(mLazy) ? (mSortOrder) : (Qt::DescendingOrder)};
+
+        try
         {
-            try
-            {
-                WalletJournalEntryRepository::EntityList entries;
-                if (mCombineCharacters)
-                {
-                    const auto idName = mCharacterRepository.getIdColumn();
-                    auto query = mCharacterRepository.getEnabledQuery();
-
-                    while (query.next())
-                    {
-                        const auto id = query.value(idName).value<Character::IdType>();
-
-                        WalletJournalEntryRepository::EntityList newEntries;
-                        if (mCorp)
-                        {
-                            newEntries = mJournalRepository.fetchForCorporationInRange(mCharacterRepository.getCorporationId(id),
-                                                                                       QDateTime{mFrom}.toUTC(),
-                                                                                       QDateTime{mTill}.addDays(1).toUTC(),
-                                                                                       mType);
-                        }
-                        else
-                        {
-                            newEntries = mJournalRepository.fetchForCharacterInRange(id,
-                                                                                     QDateTime{mFrom}.toUTC(),
-                                                                                     QDateTime{mTill}.addDays(1).toUTC(),
-                                                                                     mType);
-                        }
-
-                        entries.reserve(entries.size() + newEntries.size());
-                        entries.insert(std::end(entries),
-                                       std::make_move_iterator(std::begin(newEntries)),
-                                       std::make_move_iterator(std::end(newEntries)));
-                    }
-                }
-                else
-                {
-                    if (mCorp)
-                    {
-                        entries = mJournalRepository.fetchForCorporationInRange(mCharacterRepository.getCorporationId(mCharacterId),
-                                                                                QDateTime{mFrom}.toUTC(),
-                                                                                QDateTime{mTill}.addDays(1).toUTC(),
-                                                                                mType);
-                    }
-                    else
-                    {
-                        entries = mJournalRepository.fetchForCharacterInRange(mCharacterId,
-                                                                              QDateTime{mFrom}.toUTC(),
-                                                                              QDateTime{mTill}.addDays(1).toUTC(),
-                                                                              mType);
-                    }
-                }
-
-                processData(entries);
-            }
-            catch (const CharacterRepository::NotFoundException &)
-            {
-            }
+            mPageFilter = getPageFilter();
+            processData(mJournalRepository.fetchPage(mPageFilter, getSortColumn(), mCursor, (mLazy) ? (pageSize) : (0u)));
+        }
+        catch (const CharacterRepository::NotFoundException &)
+        {
+            mPageFilter = WalletJournalEntryRepository::PageFilter{};
         }
 
         endResetModel();
@@ -256,7 +253,7 @@ namespace Evernus
 
     void WalletJournalModel::processData(const WalletJournalEntryRepository::EntityList &entries)
     {
-        mData.reserve(entries.size());
+        mData.reserve(mData.size() + entries.size());
 
         QRegularExpression re{QStringLiteral("^DESC: ")};
 
@@ -288,6 +285,70 @@ namespace Evernus
         }
     }
 
+    WalletJournalEntryRepository::PageFilter WalletJournalModel::getPageFilter() const
+    {
+        WalletJournalEntryRepository::PageFilter filter;
+        filter.mFrom = QDateTime{mFrom}.toUTC();
+        filter.mTill = QDateTime{mTill}.addDays(1).toUTC();
+        filter.mType = mType;
+
+        const auto addOwner = [&](auto id) {
+            filter.mOwnerIds.emplace_back((mCorp) ? (mCharacterRepository.getCorporationId(id)) : (id));
+        };
+
+        if (mCombineCharacters)
+        {
+            const auto idName = mCharacterRepository.getIdColumn();
+            auto query = mCharacterRepository.getEnabledQuery();
+
+            while (query.next())
+                addOwner(query.value(idName).value<Character::IdType>());
+
+            // characters can share a corporation
+            std::sort(std::begin(filter.mOwnerIds), std::end(filter.mOwnerIds));
+            filter.mOwnerIds.erase(std::unique(std::begin(filter.mOwnerIds), std::end(filter.mOwnerIds)), std::end(filter.mOwnerIds));
+        }
+        else if (mCharacterId != Character::invalidId)
+        {
+            addOwner(mCharacterId);
+        }
+
+        if (mLazy && !mTextFilter.isEmpty())
+        {
+            filter.mText = mTextFilter;
+            filter.mTextPartyIds = mDataProvider.findGenericNameIds(QRegExp{mTextFilter, Qt::CaseInsensitive, QRegExp::Wildcard});
+        }
+
+        return filter;
+    }
+
+    WalletJournalEntryRepository::SortColumn WalletJournalModel::getSortColumn() const noexcept
+    {
+        if (!mLazy)
+            return WalletJournalEntryRepository::SortColumn::Timestamp;
+
+        switch (mSortColumn) {
+        case ignoredColumn:
+            return WalletJournalEntryRepository::SortColumn::Ignored;
+        case typeColumn:
+            return WalletJournalEntryRepository::SortColumn::RefType;
+        case firstPartyColumn:
+            return WalletJournalEntryRepository::SortColumn::FirstParty;
+        case secondPartyColumn:
+            return WalletJournalEntryRepository::SortColumn::SecondParty;
+        case contextColumn:
+            return WalletJournalEntryRepository::SortColumn::Context;
+        case amountColumn:
+            return WalletJournalEntryRepository::SortColumn::Amount;
+        case balanceColumn:
+            return WalletJournalEntryRepository::SortColumn::Balance;
+        case reasonColumn:
+            return WalletJournalEntryRepository::SortColumn::Reason;
+        default:
+            return WalletJournalEntryRepository::SortColumn::Timestamp;
+        }
+    }
+
     QString WalletJournalModel::translateRefType(QString type)
     {
         return type.replace('_', ' ');
@@ -21,6 +21,7 @@
 #include <QDate>
 
 #include "WalletJournalEntryRepository.h"
+#include "KeysetCursor.h"
 #include "Character.h"
 
 namespace Evernus
@@ -49,10 +50,18 @@ namespace Evernus
         virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
         virtual bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
         virtual int rowCount(const QModelIndex &parent = QModelIndex{}) const override;
+        virtual bool canFetchMore(const QModelIndex &parent) const override;
+        virtual void fetchMore(const QModelIndex &parent) override;
+        virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
         void setFilter(Character::IdType id, const QDate &from, const QDate &till, EntryType type, bool combineCharacters);
         void setCombineCharacters(bool flag);
 
+        // lazy model loads entries page by page, sorted and filtered by the database - use it without a proxy model
+        void setLazyLoading(bool flag);
+        // lazy mode only; takes effect on next reset
+        void setTextFilter(const QString &text);
+
         void reset();
 
     private slots:
@@ -74,6 +83,8 @@ namespace Evernus
             idColumn,
         };
 
+        static const auto pageSize = 500u;
+
         const WalletJournalEntryRepository &mJournalRepository;
         const CharacterRepository &mCharacterRepository;
         const EveDataProvider &mDataProvider;
@@ -83,6 +94,14 @@ namespace Evernus
         EntryType mType = EntryType::All;
         bool mCombineCharacters = false;
 
+        bool mLazy = false;
+        QString mTextFilter;
+        int mSortColumn = timestampColumn;
+        Qt::SortOrder mSortOrder = Qt::DescendingOrder;
+
+        WalletJournalEntryRepository::PageFilter mPageFilter;
+        KeysetCursor mCursor;
+
         std::vector<QVariantList> mData;
 
         QStringList mColumns;
@@ -91,6 +110,9 @@ namespace Evernus
 
         void processData(const WalletJournalEntryRepository::EntityList &entries);
 
+        WalletJournalEntryRepository::PageFilter getPageFilter() const;
+        WalletJournalEntryRepository::SortColumn getSortColumn() const noexcept;
+
         static QString translateRefType(QString type);
     };
 }
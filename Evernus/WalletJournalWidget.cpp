@@ -12,7 +12,6 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <QSortFilterProxyModel>
 #include <QHeaderView>
 #include <QVBoxLayout>
 #include <QCheckBox>
@@ -71,15 +70,12 @@ namespace Evernus
         auto &warningBar = getWarningBarWidget();
         mainLayout->addWidget(&warningBar);
 
-        mFilterModel = new QSortFilterProxyModel{this};
-        mFilterModel->setSortRole(Qt::UserRole);
-        mFilterModel->setFilterKeyColumn(-1);
-        mFilterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-        mFilterModel->setSourceModel(&mModel);
+        // journals can span years - let the database sort and filter, and load only what's visible
+        mModel.setLazyLoading(true);
 
         mView = new StyledTreeView{(corp) ? (QStringLiteral("corpJournalView")) : (QStringLiteral("journalView")), this};
         mainLayout->addWidget(mView, 1);
-        mView->setModel(mFilterModel);
+        mView->setModel(&mModel);
         mView->sortByColumn(1, Qt::DescendingOrder);
     }
 
@@ -91,8 +87,8 @@ namespace Evernus
 
     void WalletJournalWidget::updateFilter(const QDate &from, const QDate &to, const QString &filter, int type)
     {
+        mModel.setTextFilter(filter);
         mModel.setFilter(getCharacterId(), from, to, static_cast<EntryType>(type), mCombineBtn->isChecked());
-        mFilterModel->setFilterWildcard(filter);
     }
 
     void WalletJournalWidget::handleNewCharacter(Character::IdType id)
@@ -106,6 +102,7 @@ namespace Evernus
         mFilter->setFilter(fromDate, tillDate, QString{}, static_cast<int>(EntryType::All));
         mFilter->blockSignals(false);
 
+        mModel.setTextFilter(QString{});
         mModel.setFilter(id, fromDate, tillDate, EntryType::All, mCombineBtn->isChecked());
 
         mView->header()->resizeSections(QHeaderView::ResizeToContents);
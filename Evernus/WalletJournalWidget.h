@@ -17,7 +17,6 @@
 #include "CharacterBoundWidget.h"
 #include "WalletJournalModel.h"
 
-class QSortFilterProxyModel;
 class QCheckBox;
 
 namespace Evernus
@@ -54,7 +53,6 @@ namespace Evernus
 
     private:
         WalletJournalModel mModel;
-        QSortFilterProxyModel *mFilterModel = nullptr;
 
         WalletEntryFilterWidget *mFilter = nullptr;
         QCheckBox *mCombineBtn = nullptr;
@@ -0,0 +1,29 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+
+class QSqlDatabase;
+
+namespace Evernus::WalletRollupUtils
+{
+    // recomputes daily rollups of the days touched by given entries (anything with getTimestamp()), grouped by
+    // getOwnerId(entry), calling rebuild(from, to, ownerId) once per owner; returns the number of owners affected
+    template<class Entries, class GetOwnerId, class Rebuild>
+    std::size_t updateDailyRollups(QSqlDatabase db, const Entries &entries, bool wrapInTransaction, GetOwnerId getOwnerId, Rebuild rebuild);
+}
+
+#include "WalletRollupUtils.inl"
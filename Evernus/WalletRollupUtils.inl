@@ -0,0 +1,71 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+
+#include <QSqlDatabase>
+#include <QDateTime>
+#include <QDate>
+
+namespace Evernus::WalletRollupUtils
+{
+    template<class Entries, class GetOwnerId, class Rebuild>
+    std::size_t updateDailyRollups(QSqlDatabase db, const Entries &entries, bool wrapInTransaction, GetOwnerId getOwnerId, Rebuild rebuild)
+    {
+        // new entries usually cover a few recent days, so rebuilding the whole span per owner is cheap
+        std::unordered_map<quint64, std::pair<QDate, QDate>> ranges;
+        for (const auto &entry : entries)
+        {
+            const auto day = entry.getTimestamp().toUTC().date();
+            const auto ownerId = getOwnerId(entry);
+
+            const auto range = ranges.find(ownerId);
+            if (range == std::end(ranges))
+            {
+                ranges.emplace(ownerId, std::make_pair(day, day));
+            }
+            else
+            {
+                range->second.first = std::min(range->second.first, day);
+                range->second.second = std::max(range->second.second, day);
+            }
+        }
+
+        if (ranges.empty())
+            return 0;
+
+        if (wrapInTransaction)
+            db.transaction();
+
+        try
+        {
+            for (const auto &range : ranges)
+                rebuild(range.second.first, range.second.second, range.first);
+        }
+        catch (...)
+        {
+            if (wrapInTransaction)
+                db.rollback();
+
+            throw;
+        }
+
+        if (wrapInTransaction)
+            db.commit();
+
+        return ranges.size();
+    }
+}
@@ -12,9 +12,16 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <iterator>
+
+#include <QElapsedTimer>
 #include <QSqlRecord>
 #include <QSqlQuery>
 
+#include "WalletRollupUtils.h"
+#include "KeysetCursor.h"
+
 #include "WalletTransactionRepository.h"
 
 namespace Evernus
@@ -35,6 +42,11 @@ namespace Evernus
         return QStringLiteral("id");
     }
 
+    QString WalletTransactionRepository::getDailyRollupTableName() const
+    {
+        return getTableName() + QStringLiteral("_daily");
+    }
+
     WalletTransactionRepository::EntityPtr WalletTransactionRepository::populate(const QSqlRecord &record) const
     {
         auto timestamp = record.value(QStringLiteral("timestamp")).toDateTime();
@@ -95,6 +107,49 @@ namespace Evernus
             // ignore - versions < 1.9 do not have this column
             qDebug() << "SQL errors ignored";
         }
+
+        const auto hasRollups = getDatabase().tables().contains(getDailyRollupTableName());
+
+        exec(QStringLiteral("CREATE TABLE IF NOT EXISTS %1 ("
+            "character_id BIGINT NOT NULL %2,"
+            "day DATE NOT NULL,"
+            "type_id INTEGER NOT NULL,"
+            "type TINYINT NOT NULL,"
+            "corporation_id BIGINT NOT NULL,"
+            "count INTEGER NOT NULL,"
+            "quantity INTEGER NOT NULL,"
+            "value NUMERIC NOT NULL,"
+            "PRIMARY KEY (character_id, day, type_id, type, corporation_id)"
+        ")").arg(getDailyRollupTableName()).arg(
+            (mCorp) ? (QString{}) : (QStringLiteral("REFERENCES %2(%3) ON UPDATE CASCADE ON DELETE CASCADE").arg(characterRepo.getTableName()).arg(characterRepo.getIdColumn()))));
+
+        exec(QStringLiteral("CREATE INDEX IF NOT EXISTS %1_day ON %1(day)").arg(getDailyRollupTableName()));
+        exec(QStringLiteral("CREATE INDEX IF NOT EXISTS %1_corporation_day ON %1(corporation_id, day)").arg(getDailyRollupTableName()));
+
+        if (!hasRollups)
+        {
+            // existing history gets rolled up once, later on only touched days are rebuilt
+            QElapsedTimer timer;
+            timer.start();
+
+            try
+            {
+                exec(QStringLiteral(
+                    "INSERT INTO %1 (character_id, day, type_id, type, corporation_id, count, quantity, value) "
+                    "SELECT character_id, substr(timestamp, 1, 10), type_id, type, corporation_id, COUNT(*), SUM(quantity), SUM(price * quantity) "
+                    "FROM %2 WHERE ignored = 0 GROUP BY character_id, substr(timestamp, 1, 10), type_id, type, corporation_id"
+                ).arg(getDailyRollupTableName()).arg(getTableName()));
+            }
+            catch (const std::exception &)
+            {
+                // versions < 1.9 do not have all the columns yet - try again after the update
+                qDebug() << "SQL errors ignored";
+                exec(QStringLiteral("DROP TABLE %1").arg(getDailyRollupTableName()));
+                return;
+            }
+
+            qDebug() << "Rolled up" << getTableName() << "in" << timer.elapsed() << "ms.";
+        }
     }
 
     WalletTransaction::IdType WalletTransactionRepository::getLatestEntryId(Character::IdType characterId) const
@@ -115,6 +170,20 @@ namespace Evernus
         query.bindValue(1, id);
 
         DatabaseUtils::execQuery(query);
+
+        query = prepare(QStringLiteral("SELECT %1, timestamp FROM %2 WHERE %3 = ?").arg(getRollupOwnerColumn()).arg(getTableName()).arg(getIdColumn()));
+        query.bindValue(0, id);
+
+        DatabaseUtils::execQuery(query);
+
+        if (query.next())
+        {
+            auto timestamp = query.value(1).toDateTime();
+            timestamp.setTimeSpec(Qt::UTC);
+
+            const auto day = timestamp.date();
+            rebuildDailyRollups(day, day, query.value(0).value<quint64>());
+        }
     }
 
     void WalletTransactionRepository::deleteOldEntries(const QDateTime &from) const
@@ -123,11 +192,40 @@ namespace Evernus
         query.bindValue(0, from);
 
         DatabaseUtils::execQuery(query);
+
+        const auto firstDay = from.toUTC().date();
+
+        query = prepare(QStringLiteral("DELETE FROM %1 WHERE day < ?").arg(getDailyRollupTableName()));
+        query.bindValue(0, firstDay);
+
+        DatabaseUtils::execQuery(query);
+
+        // first day might have lost only a part of its transactions
+        rebuildDailyRollups(firstDay, firstDay);
     }
 
     void WalletTransactionRepository::deleteAll() const
     {
         exec(QStringLiteral("DELETE FROM %1").arg(getTableName()));
+        exec(QStringLiteral("DELETE FROM %1").arg(getDailyRollupTableName()));
+    }
+
+    void WalletTransactionRepository::updateDailyRollups(const WalletTransactions &transactions, bool wrapInTransaction) const
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto owners = WalletRollupUtils::updateDailyRollups(getDatabase(), transactions, wrapInTransaction, [=](const auto &entry) {
+            return (mCorp) ? (entry.getCorporationId()) : (entry.getCharacterId());
+        }, [=](const auto &from, const auto &to, auto ownerId) {
+            rebuildDailyRollups(from, to, ownerId);
+#ifndef NDEBUG
+            checkDailyRollups(from, to, ownerId);
+#endif
+        });
+
+        if (owners > 0)
+            qDebug() << "Updated" << getDailyRollupTableName() << "for" << owners << ((mCorp) ? ("corporations") : ("characters")) << "in" << timer.elapsed() << "ms.";
     }
 
     WalletTransactionRepository::EntityList WalletTransactionRepository
@@ -229,6 +327,144 @@ namespace Evernus
         return result;
     }
 
+    WalletTransactionRepository::EntityList WalletTransactionRepository
+    ::fetchPage(const PageFilter &filter, SortColumn column, KeysetCursor &cursor, uint limit) const
+    {
+        if (filter.mOwnerIds.empty() || cursor.isAtEnd())
+            return {};
+
+        fillTextLocationScope(filter);
+
+        QString key;
+        switch (column) {
+        case SortColumn::Ignored:
+            key = QStringLiteral("ignored");
+            break;
+        case SortColumn::Type:
+            key = QStringLiteral("type");
+            break;
+        case SortColumn::Quantity:
+            key = QStringLiteral("quantity");
+            break;
+        case SortColumn::TypeId:
+            key = QStringLiteral("type_id");
+            break;
+        case SortColumn::Price:
+            key = QStringLiteral("price");
+            break;
+        case SortColumn::Character:
+            key = QStringLiteral("character_id");
+            break;
+        case SortColumn::Client:
+            key = QStringLiteral("client_id");
+            break;
+        case SortColumn::Location:
+            key = QStringLiteral("location_id");
+            break;
+        default:
+            key = QStringLiteral("timestamp");
+        }
+
+        auto queryStr = QStringLiteral("SELECT *, %1 AS sort_key FROM %2 WHERE %3")
+            .arg(key)
+            .arg(getTableName())
+            .arg(getPageFilterCondition(filter));
+
+        queryStr += cursor.getCondition(key, getIdColumn());
+        queryStr += cursor.getOrderBy(key, getIdColumn());
+
+        if (limit > 0)
+            queryStr += QStringLiteral(" LIMIT %1").arg(limit);
+
+        auto query = prepare(queryStr);
+        bindPageFilter(filter, query);
+        cursor.bindValues(query);
+
+        DatabaseUtils::execQuery(query);
+
+        EntityList result;
+        if (limit > 0)
+            result.reserve(limit);
+
+        QSqlRecord record;
+        while (query.next())
+        {
+            record = query.record();
+            result.emplace_back(populate(record));
+        }
+
+        cursor.advance(record, getIdColumn(), static_cast<uint>(result.size()), limit);
+
+        return result;
+    }
+
+    std::vector<WalletTransactionRepository::TypeTotal> WalletTransactionRepository::fetchTypeTotals(const PageFilter &filter) const
+    {
+        if (filter.mOwnerIds.empty())
+            return {};
+
+        fillTextLocationScope(filter);
+
+        auto query = prepare(QStringLiteral(
+            "SELECT type_id, type, ignored, COUNT(*), SUM(quantity), SUM(price * quantity) FROM %1 WHERE %2 GROUP BY type_id, type, ignored"
+        ).arg(getTableName()).arg(getPageFilterCondition(filter)));
+        bindPageFilter(filter, query);
+
+        DatabaseUtils::execQuery(query);
+
+        std::vector<TypeTotal> result;
+        while (query.next())
+        {
+            TypeTotal total;
+            total.mTypeId = query.value(0).value<EveType::IdType>();
+            total.mType = static_cast<WalletTransaction::Type>(query.value(1).toInt());
+            total.mIgnored = query.value(2).toBool();
+            total.mCount = query.value(3).toULongLong();
+            total.mQuantity = query.value(4).toULongLong();
+            total.mValue = query.value(5).toDouble();
+
+            result.emplace_back(total);
+        }
+
+        return result;
+    }
+
+    std::vector<WalletTransactionRepository::TypeTotal> WalletTransactionRepository
+    ::fetchDailyTypeTotals(const QDate &from, const QDate &to) const
+    {
+        return fetchDailyTypeTotalsForColumn(QString{}, 0, from, to);
+    }
+
+    std::vector<WalletTransactionRepository::TypeTotal> WalletTransactionRepository
+    ::fetchDailyTypeTotalsForCharacter(Character::IdType characterId, const QDate &from, const QDate &to) const
+    {
+        return fetchDailyTypeTotalsForColumn(QStringLiteral("character_id"), characterId, from, to);
+    }
+
+    std::vector<WalletTransactionRepository::TypeTotal> WalletTransactionRepository
+    ::fetchDailyTypeTotalsForCorporation(quint64 corporationId, const QDate &from, const QDate &to) const
+    {
+        return fetchDailyTypeTotalsForColumn(QStringLiteral("corporation_id"), corporationId, from, to);
+    }
+
+    std::vector<WalletTransactionRepository::DayTotal> WalletTransactionRepository
+    ::fetchDayTotals(const QDate &from, const QDate &to) const
+    {
+        return fetchDayTotalsForColumn(QString{}, 0, from, to);
+    }
+
+    std::vector<WalletTransactionRepository::DayTotal> WalletTransactionRepository
+    ::fetchDayTotalsForCharacter(Character::IdType characterId, const QDate &from, const QDate &to) const
+    {
+        return fetchDayTotalsForColumn(QStringLiteral("character_id"), characterId, from, to);
+    }
+
+    std::vector<WalletTransactionRepository::DayTotal> WalletTransactionRepository
+    ::fetchDayTotalsForCorporation(quint64 corporationId, const QDate &from, const QDate &to) const
+    {
+        return fetchDayTotalsForColumn(QStringLiteral("corporation_id"), corporationId, from, to);
+    }
+
     QStringList WalletTransactionRepository::getColumns() const
     {
         return {
@@ -283,6 +519,249 @@ namespace Evernus
         query.addBindValue(entity.isIgnored());
     }
 
+    QString WalletTransactionRepository::getPageFilterCondition(const PageFilter &filter) const
+    {
+        auto condition = QStringLiteral("%1 IN (%2) AND timestamp BETWEEN ? AND ?")
+            .arg((mCorp) ? (QStringLiteral("corporation_id")) : (QStringLiteral("character_id")))
+            .arg(DatabaseUtils::joinIds(filter.mOwnerIds));
+
+        if (filter.mType != EntryType::All)
+            condition += QStringLiteral(" AND type = ?");
+        if (filter.mTypeId != EveType::invalidId)
+            condition += QStringLiteral(" AND type_id = ?");
+
+        if (filter.mHasText)
+        {
+            QStringList textConditions;
+            if (!filter.mTextTypeIds.empty())
+                textConditions << QStringLiteral("type_id IN (%1)").arg(DatabaseUtils::joinIds(filter.mTextTypeIds));
+            if (!filter.mTextNameIds.empty())
+            {
+                const auto ids = DatabaseUtils::joinIds(filter.mTextNameIds);
+                textConditions << QStringLiteral("character_id IN (%1) OR client_id IN (%1)").arg(ids);
+            }
+            if (isTextLocationScopeNeeded(filter))
+                textConditions << QStringLiteral("location_id IN (SELECT id FROM %1)").arg(getTextLocationScopeTable());
+            else if (!filter.mTextLocationIds.empty())
+                textConditions << QStringLiteral("location_id IN (%1)").arg(DatabaseUtils::joinIds(filter.mTextLocationIds));
+
+            condition += (textConditions.isEmpty()) ? (QStringLiteral(" AND 0")) : (QStringLiteral(" AND (%1)").arg(textConditions.join(QStringLiteral(" OR "))));
+        }
+
+        return condition;
+    }
+
+    void WalletTransactionRepository::bindPageFilter(const PageFilter &filter, QSqlQuery &query) const
+    {
+        query.addBindValue(filter.mFrom);
+        query.addBindValue(filter.mTill);
+
+        if (filter.mType != EntryType::All)
+            query.addBindValue(static_cast<int>((filter.mType == EntryType::Buy) ? (WalletTransaction::Type::Buy) : (WalletTransaction::Type::Sell)));
+        if (filter.mTypeId != EveType::invalidId)
+            query.addBindValue(filter.mTypeId);
+    }
+
+    QString WalletTransactionRepository::getTextLocationScopeTable() const
+    {
+        return getTableName() + QStringLiteral("_text_locations");
+    }
+
+    bool WalletTransactionRepository::isTextLocationScopeNeeded(const PageFilter &filter) const noexcept
+    {
+        return filter.mHasText && filter.mTextLocationIds.size() > maxInlineTextLocationIds;
+    }
+
+    void WalletTransactionRepository::fillTextLocationScope(const PageFilter &filter) const
+    {
+        if (!isTextLocationScopeNeeded(filter))
+            return;
+
+        const auto scopeTable = getTextLocationScopeTable();
+
+        // temp tables live per connection, so they have to be checked every time
+        exec(QStringLiteral("CREATE TEMP TABLE IF NOT EXISTS %1 (id INTEGER PRIMARY KEY)").arg(scopeTable));
+
+        // pages are fetched one after another with the same filter
+        if (filter.mTextLocationIds == mTextLocationScopeIds)
+            return;
+
+        auto db = getDatabase();
+
+        db.transaction();
+
+        try
+        {
+            exec(QStringLiteral("DELETE FROM %1").arg(scopeTable));
+
+            const auto &ids = filter.mTextLocationIds;
+            for (auto first = std::begin(ids); first != std::end(ids);)
+            {
+                const auto last = std::next(first, std::min<std::size_t>(maxSqliteBoundVariables, std::distance(first, std::end(ids))));
+
+                QStringList rowBindings;
+                for (auto it = first; it != last; ++it)
+                    rowBindings << QStringLiteral("(?)");
+
+                const auto queryStr = QStringLiteral("INSERT OR IGNORE INTO %1 (id) VALUES %2")
+                    .arg(scopeTable)
+                    .arg(rowBindings.join(QStringLiteral(", ")));
+                auto query = (static_cast<std::size_t>(rowBindings.size()) == maxSqliteBoundVariables) ? (prepareCached(queryStr)) : (prepare(queryStr));
+
+                for (auto it = first; it != last; ++it)
+                    query.addBindValue(*it);
+
+                DatabaseUtils::execQuery(query);
+
+                first = last;
+            }
+        }
+        catch (...)
+        {
+            db.rollback();
+            mTextLocationScopeIds.clear();
+            throw;
+        }
+
+        db.commit();
+
+        mTextLocationScopeIds = filter.mTextLocationIds;
+    }
+
+    QString WalletTransactionRepository::getRollupOwnerColumn() const
+    {
+        return (mCorp) ? (QStringLiteral("corporation_id")) : (QStringLiteral("character_id"));
+    }
+
+    void WalletTransactionRepository::rebuildDailyRollups(const QDate &from, const QDate &to, quint64 ownerId) const
+    {
+        const auto ownerCondition = (ownerId == 0) ? (QString{}) : (QStringLiteral(" AND %1 = ?").arg(getRollupOwnerColumn()));
+
+        auto query = prepare(QStringLiteral("DELETE FROM %1 WHERE day BETWEEN ? AND ?%2").arg(getDailyRollupTableName()).arg(ownerCondition));
+        query.addBindValue(from);
+        query.addBindValue(to);
+
+        if (ownerId != 0)
+            query.addBindValue(ownerId);
+
+        DatabaseUtils::execQuery(query);
+
+        query = prepare(QStringLiteral(
+            "INSERT INTO %1 (character_id, day, type_id, type, corporation_id, count, quantity, value) "
+            "SELECT character_id, substr(timestamp, 1, 10), type_id, type, corporation_id, COUNT(*), SUM(quantity), SUM(price * quantity) "
+            "FROM %2 WHERE timestamp >= ? AND timestamp < ? AND ignored = 0%3 "
+            "GROUP BY character_id, substr(timestamp, 1, 10), type_id, type, corporation_id"
+        ).arg(getDailyRollupTableName()).arg(getTableName()).arg(ownerCondition));
+        query.addBindValue(from);
+        query.addBindValue(to.addDays(1));
+
+        if (ownerId != 0)
+            query.addBindValue(ownerId);
+
+        DatabaseUtils::execQuery(query);
+    }
+
+#ifndef NDEBUG
+    void WalletTransactionRepository::checkDailyRollups(const QDate &from, const QDate &to, quint64 ownerId) const
+    {
+        auto query = prepare(QStringLiteral(
+            "SELECT (SELECT COUNT(*) FROM %1 WHERE timestamp >= ? AND timestamp < ? AND ignored = 0 AND %3 = ?), "
+            "(SELECT TOTAL(count) FROM %2 WHERE day BETWEEN ? AND ? AND %3 = ?)"
+        ).arg(getTableName()).arg(getDailyRollupTableName()).arg(getRollupOwnerColumn()));
+        query.addBindValue(from);
+        query.addBindValue(to.addDays(1));
+        query.addBindValue(ownerId);
+        query.addBindValue(from);
+        query.addBindValue(to);
+        query.addBindValue(ownerId);
+
+        DatabaseUtils::execQuery(query);
+        query.next();
+
+        const auto entryTotal = query.value(0).toDouble();
+        const auto rollupTotal = query.value(1).toDouble();
+
+        if (qAbs(entryTotal - rollupTotal) > 0.01)
+        {
+            qWarning() << getDailyRollupTableName() << "doesn't match" << getTableName() << "for" << ownerId << "between" << from << "and" << to << ":" << rollupTotal << "vs" << entryTotal;
+            Q_ASSERT(false);
+        }
+    }
+#endif
+
+    std::vector<WalletTransactionRepository::TypeTotal> WalletTransactionRepository
+    ::fetchDailyTypeTotalsForColumn(const QString &column, quint64 id, const QDate &from, const QDate &to) const
+    {
+        auto queryStr = QStringLiteral("SELECT type_id, type, SUM(count), SUM(quantity), SUM(value) FROM %1 WHERE day BETWEEN ? AND ?")
+            .arg(getDailyRollupTableName());
+
+        if (!column.isEmpty())
+            queryStr += QStringLiteral(" AND %1 = ?").arg(column);
+
+        queryStr += QStringLiteral(" GROUP BY type_id, type");
+
+        auto query = prepare(queryStr);
+        query.addBindValue(from);
+        query.addBindValue(to);
+
+        if (!column.isEmpty())
+            query.addBindValue(id);
+
+        DatabaseUtils::execQuery(query);
+
+        std::vector<TypeTotal> result;
+        while (query.next())
+        {
+            TypeTotal total;
+            total.mTypeId = query.value(0).value<EveType::IdType>();
+            total.mType = static_cast<WalletTransaction::Type>(query.value(1).toInt());
+            total.mCount = query.value(2).toULongLong();
+            total.mQuantity = query.value(3).toULongLong();
+            total.mValue = query.value(4).toDouble();
+
+            result.emplace_back(total);
+        }
+
+        return result;
+    }
+
+    std::vector<WalletTransactionRepository::DayTotal> WalletTransactionRepository
+    ::fetchDayTotalsForColumn(const QString &column, quint64 id, const QDate &from, const QDate &to) const
+    {
+        auto queryStr = QStringLiteral(
+            "SELECT day, SUM(CASE WHEN type = ? THEN value ELSE 0 END), SUM(CASE WHEN type = ? THEN 0 ELSE value END) FROM %1 WHERE day BETWEEN ? AND ?"
+        ).arg(getDailyRollupTableName());
+
+        if (!column.isEmpty())
+            queryStr += QStringLiteral(" AND %1 = ?").arg(column);
+
+        queryStr += QStringLiteral(" GROUP BY day ORDER BY day");
+
+        auto query = prepare(queryStr);
+        query.addBindValue(static_cast<int>(WalletTransaction::Type::Buy));
+        query.addBindValue(static_cast<int>(WalletTransaction::Type::Buy));
+        query.addBindValue(from);
+        query.addBindValue(to);
+
+        if (!column.isEmpty())
+            query.addBindValue(id);
+
+        DatabaseUtils::execQuery(query);
+
+        std::vector<DayTotal> result;
+        while (query.next())
+        {
+            DayTotal total;
+            total.mDay = query.value(0).toDate();
+            total.mBuyValue = query.value(1).toDouble();
+            total.mSellValue = query.value(2).toDouble();
+
+            result.emplace_back(total);
+        }
+
+        return result;
+    }
+
     template<class T>
     WalletTransactionRepository::EntityList WalletTransactionRepository::fetchForColumnInRange(T id,
                                                                                                const QDateTime &from,
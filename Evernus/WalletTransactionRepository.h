@@ -14,11 +14,17 @@
  */
 #pragma once
 
-#include "WalletTransaction.h"
+#include <vector>
+
+#include <QDate>
+
+#include "WalletTransactions.h"
 #include "Repository.h"
 
 namespace Evernus
 {
+    class KeysetCursor;
+
     class WalletTransactionRepository
         : public Repository<WalletTransaction>
     {
@@ -30,12 +36,58 @@ namespace Evernus
             Sell
         };
 
+        enum class SortColumn
+        {
+            Timestamp,
+            Ignored,
+            Type,
+            Quantity,
+            TypeId,
+            Price,
+            Character,
+            Client,
+            Location
+        };
+
+        struct PageFilter
+        {
+            std::vector<quint64> mOwnerIds; // characters or, for corp transactions, corporations
+            QDateTime mFrom;
+            QDateTime mTill;
+            EntryType mType = EntryType::All;
+            EveType::IdType mTypeId = EveType::invalidId;
+            // there are no text columns - a text filter is resolved to ids with matching names
+            bool mHasText = false;
+            std::vector<EveType::IdType> mTextTypeIds;
+            std::vector<quint64> mTextNameIds;
+            std::vector<quint64> mTextLocationIds;
+        };
+
+        struct TypeTotal
+        {
+            EveType::IdType mTypeId = EveType::invalidId;
+            WalletTransaction::Type mType = WalletTransaction::Type::Buy;
+            bool mIgnored = false;
+            quint64 mCount = 0;
+            quint64 mQuantity = 0;
+            double mValue = 0.;
+        };
+
+        struct DayTotal
+        {
+            QDate mDay;
+            double mBuyValue = 0.;
+            double mSellValue = 0.;
+        };
+
         WalletTransactionRepository(bool corp, const DatabaseConnectionProvider &connectionProvider);
         virtual ~WalletTransactionRepository() = default;
 
         virtual QString getTableName() const override;
         virtual QString getIdColumn() const override;
 
+        QString getDailyRollupTableName() const;
+
         virtual EntityPtr populate(const QSqlRecord &record) const override;
 
         void create(const Repository<Character> &characterRepo) const;
@@ -46,6 +98,9 @@ namespace Evernus
         void deleteOldEntries(const QDateTime &from) const;
         void deleteAll() const;
 
+        // recomputes daily rollups of the days touched by given transactions
+        void updateDailyRollups(const WalletTransactions &transactions, bool wrapInTransaction = true) const;
+
         EntityList fetchInRange(const QDateTime &from,
                                 const QDateTime &till,
                                 EntryType type,
@@ -65,13 +120,51 @@ namespace Evernus
         EntityList fetchForTypeId(EveType::IdType typeId) const;
         EntityList fetchForTypeIdAndCharacter(EveType::IdType typeId, Character::IdType characterId) const;
 
+        // limit 0 fetches everything that's left
+        EntityList fetchPage(const PageFilter &filter, SortColumn column, KeysetCursor &cursor, uint limit) const;
+        // per type and transaction type, so totals don't need every transaction loaded
+        std::vector<TypeTotal> fetchTypeTotals(const PageFilter &filter) const;
+
+        // answered from daily rollups - ignored transactions are left out and days are in EVE (UTC) time
+        std::vector<TypeTotal> fetchDailyTypeTotals(const QDate &from, const QDate &to) const;
+        std::vector<TypeTotal> fetchDailyTypeTotalsForCharacter(Character::IdType characterId, const QDate &from, const QDate &to) const;
+        std::vector<TypeTotal> fetchDailyTypeTotalsForCorporation(quint64 corporationId, const QDate &from, const QDate &to) const;
+
+        std::vector<DayTotal> fetchDayTotals(const QDate &from, const QDate &to) const;
+        std::vector<DayTotal> fetchDayTotalsForCharacter(Character::IdType characterId, const QDate &from, const QDate &to) const;
+        std::vector<DayTotal> fetchDayTotalsForCorporation(quint64 corporationId, const QDate &from, const QDate &to) const;
+
     private:
         bool mCorp = false;
 
+        // broad text filters match thousands of locations - those are joined from a temp table instead of listed inline
+        const std::size_t maxInlineTextLocationIds = 500;
+        mutable std::vector<quint64> mTextLocationScopeIds;
+
         virtual QStringList getColumns() const override;
         virtual void bindValues(const WalletTransaction &entity, QSqlQuery &query) const override;
         virtual void bindPositionalValues(const WalletTransaction &entity, QSqlQuery &query) const override;
 
+        QString getPageFilterCondition(const PageFilter &filter) const;
+        void bindPageFilter(const PageFilter &filter, QSqlQuery &query) const;
+
+        QString getTextLocationScopeTable() const;
+        bool isTextLocationScopeNeeded(const PageFilter &filter) const noexcept;
+        void fillTextLocationScope(const PageFilter &filter) const;
+
+        // corp entries are stored under whichever character imported them last, so corp rollups are kept per corporation
+        QString getRollupOwnerColumn() const;
+
+        // owner is a character or a corporation (see above); 0 rebuilds given days for everyone
+        void rebuildDailyRollups(const QDate &from, const QDate &to, quint64 ownerId = 0) const;
+#ifndef NDEBUG
+        // rollups must add up to the entries they cover, no matter who imported them
+        void checkDailyRollups(const QDate &from, const QDate &to, quint64 ownerId) const;
+#endif
+
+        std::vector<TypeTotal> fetchDailyTypeTotalsForColumn(const QString &column, quint64 id, const QDate &from, const QDate &to) const;
+        std::vector<DayTotal> fetchDayTotalsForColumn(const QString &column, quint64 id, const QDate &from, const QDate &to) const;
+
         template<class T>
         EntityList fetchForColumnInRange(T id,
                                          const QDateTime &from,
@@ -222,8 +222,11 @@ namespace Evernus
             data.mPrice += quantity * mModel->getPrice(row);
         }
 
+        std::unordered_map<EveType::IdType, double> values;
         for (const auto &data : aggrData)
-            mItemCostProvider.setForCharacterAndType(characterId, data.first, data.second.mPrice / data.second.mQuantity);
+            values.emplace(data.first, data.second.mPrice / data.second.mQuantity);
+
+        mItemCostProvider.setForCharacterAndTypes(characterId, values);
     }
 
     QString WalletTransactionView::getDefaultCopySuggestedPriceText()
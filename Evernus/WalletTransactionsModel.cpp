@@ -12,8 +12,11 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+
 #include <QLocale>
 #include <QColor>
+#include <QRegExp>
 #include <QFont>
 #include <QSettings>
 
@@ -214,6 +217,39 @@ namespace Evernus
         return 0;
     }
 
+    bool WalletTransactionsModel::canFetchMore(const QModelIndex &parent) const
+    {
+        return !parent.isValid() && !mPageFilter.mOwnerIds.empty() && !mCursor.isAtEnd();
+    }
+
+    void WalletTransactionsModel::fetchMore(const QModelIndex &parent)
+    {
+        if (parent.isValid())
+            return;
+
+        const auto entries = mTransactionsRepository.fetchPage(mPageFilter, getSortColumn(), mCursor, pageSize);
+        if (entries.empty())
+            return;
+
+        const auto row = rowCount();
+
+        beginInsertRows(QModelIndex{}, row, row + static_cast<int>(entries.size()) - 1);
+        processData(entries);
+        endInsertRows();
+    }
+
+    void WalletTransactionsModel::sort(int column, Qt::SortOrder order)
+    {
+        // without lazy loading, sorting is up to the proxy model
+        if (!mLazy || (column == mSortColumn && order == mSortOrder))
+            return;
+
+        mSortColumn = column;
+        mSortOrder = order;
+
+        reset();
+    }
+
     EveType::IdType WalletTransactionsModel::getTypeId(int row) const
     {
         return mData[row][typeIdColumn].value<EveType::IdType>();
@@ -239,6 +275,11 @@ namespace Evernus
         return mData[row][characterColumn].toUInt();
     }
 
+    quint64 WalletTransactionsModel::getTotalCount() const noexcept
+    {
+        return mTotalCount;
+    }
+
     quint64 WalletTransactionsModel::getTotalQuantity() const noexcept
     {
         return mTotalQuantity;
@@ -283,81 +324,34 @@ namespace Evernus
         reset();
     }
 
+    void WalletTransactionsModel::setLazyLoading(bool flag)
+    {
+        mLazy = flag;
+    }
+
+    void WalletTransactionsModel::setTextFilter(const QString &text)
+    {
+        mTextFilter = text;
+    }
+
     void WalletTransactionsModel::reset()
     {
         beginResetModel();
 
-        mTotalQuantity = 0;
-        mTotalSize = 0.;
-        mTotalIncome = 0.;
-        mTotalCost = 0.;
-        mTotalProfit = 0.;
-
         mData.clear();
-        if (Q_LIKELY(mCharacterId != Character::invalidId || mCombineCharacters))
-        {
-            try
-            {
-                WalletTransactionRepository::EntityList entries;
-                if (mCombineCharacters)
-                {
-                    const auto idName = mCharacterRepository.getIdColumn();
-                    auto query = mCharacterRepository.getEnabledQuery();
-
-                    while (query.next())
-                    {
-                        const auto id = query.value(idName).value<Character::IdType>();
-
-                        WalletTransactionRepository::EntityList newEntries;
-                        if (mCorp)
-                        {
-                            newEntries = mTransactionsRepository.fetchForCorporationInRange(mCharacterRepository.getCorporationId(id),
-                                                                                            QDateTime{mFrom}.toUTC(),
-                                                                                            QDateTime{mTill}.addDays(1).toUTC(),
-                                                                                            mType,
-                                                                                            mTypeId);
-                        }
-                        else
-                        {
-                            newEntries = mTransactionsRepository.fetchForCharacterInRange(id,
-                                                                                          QDateTime{mFrom}.toUTC(),
-                                                                                          QDateTime{mTill}.addDays(1).toUTC(),
-                                                                                          mType,
-                                                                                          mTypeId);
-                        }
-
-                        entries.reserve(entries.size() + newEntries.size());
-                                        entries.insert(std::end(entries),
-                                                       std::make_move_iterator(std::begin(newEntries)),
-                                                       std::make_move_iterator(std::end(newEntries)));
-                    }
-                }
-                else
-                {
-                    if (mCorp)
-                    {
-                        entries = mTransactionsRepository.fetchForCorporationInRange(mCharacterRepository.getCorporationId(mCharacterId),
-                                                                                     QDateTime{mFrom}.toUTC(),
-                                                                                     QDateTime{mTill}.addDays(1).toUTC(),
-                                                                                     mType,
-                                                                                     mTypeId);
-                    }
-                    else
-                    {
-                        entries = mTransactionsRepository.fetchForCharacterInRange(mCharacterId,
-                                                                                   QDateTime{mFrom}.toUTC(),
-                                                                                   QDateTime{mTill}.addDays(1).toUTC(),
-                                                                                   mType,
-                                                                                   mTypeId);
-                    }
-                }
+        mCursor = KeysetCursor{(mLazy) ? (mSortOrder) : (Qt::DescendingOrder)};
 
-                processData(entries);
-            }
-            catch (const CharacterRepository::NotFoundException &)
-            {
-            }
+        try
+        {
+            mPageFilter = getPageFilter();
+            processData(mTransactionsRepository.fetchPage(mPageFilter, getSortColumn(), mCursor, (mLazy) ? (pageSize) : (0u)));
         }
+        catch (const CharacterRepository::NotFoundException &)
+        {
+            mPageFilter = WalletTransactionRepository::PageFilter{};
+        }
+
+        computeTotals();
 
         endResetModel();
     }
@@ -365,7 +359,10 @@ namespace Evernus
     void WalletTransactionsModel::clear()
     {
         beginResetModel();
+
         mData.clear();
+        mPageFilter = WalletTransactionRepository::PageFilter{};
+
         endResetModel();
     }
 
@@ -377,43 +374,132 @@ namespace Evernus
 
     void WalletTransactionsModel::processData(const WalletTransactionRepository::EntityList &entries)
     {
-        mData.reserve(entries.size());
+        mData.reserve(mData.size() + entries.size());
 
         for (const auto &entry : entries)
         {
             mData.emplace_back();
             auto &data = mData.back();
 
-            const auto quantity = entry->getQuantity();
-
             data
                 << entry->isIgnored()
                 << entry->getTimestamp()
                 << static_cast<int>(entry->getType())
-                << quantity
+                << entry->getQuantity()
                 << entry->getTypeId()
                 << entry->getPrice()
                 << entry->getCharacterId()
                 << entry->getClientId()
                 << mDataProvider.getLocationName(entry->getLocationId())
                 << entry->getId();
+        }
+    }
+
+    void WalletTransactionsModel::computeTotals()
+    {
+        mTotalCount = 0;
+        mTotalQuantity = 0;
+        mTotalSize = 0.;
+        mTotalIncome = 0.;
+        mTotalCost = 0.;
+        mTotalProfit = 0.;
+
+        const auto totals = mTransactionsRepository.fetchTypeTotals(mPageFilter);
+        for (const auto &total : totals)
+        {
+            mTotalCount += total.mCount;
 
-            if (!entry->isIgnored())
+            if (total.mIgnored)
+                continue;
+
+            mTotalQuantity += total.mQuantity;
+            mTotalSize += mDataProvider.getTypeVolume(total.mTypeId) * total.mQuantity;
+
+            if (total.mType == WalletTransaction::Type::Buy)
             {
-                mTotalQuantity += quantity;
-                mTotalSize += mDataProvider.getTypeVolume(entry->getTypeId()) * quantity;
+                mTotalCost += total.mValue;
+            }
+            else
+            {
+                mTotalIncome += total.mValue;
+                mTotalProfit +=
+                    total.mValue - mItemCostProvider.fetchForCharacterAndType(mCharacterId, total.mTypeId)->getAdjustedCost() * total.mQuantity;
+            }
+        }
+    }
 
-                if (entry->getType() == WalletTransaction::Type::Buy)
-                {
-                    mTotalCost += entry->getPrice() * quantity;
-                }
-                else
-                {
-                    mTotalIncome += entry->getPrice() * quantity;
-                    mTotalProfit +=
-                        (entry->getPrice() - mItemCostProvider.fetchForCharacterAndType(mCharacterId, entry->getTypeId())->getAdjustedCost()) * quantity;
-                }
+    WalletTransactionRepository::PageFilter WalletTransactionsModel::getPageFilter() const
+    {
+        WalletTransactionRepository::PageFilter filter;
+        filter.mFrom = QDateTime{mFrom}.toUTC();
+        filter.mTill = QDateTime{mTill}.addDays(1).toUTC();
+        filter.mType = mType;
+        filter.mTypeId = mTypeId;
+
+        const auto addOwner = [&](auto id) {
+            filter.mOwnerIds.emplace_back((mCorp) ? (mCharacterRepository.getCorporationId(id)) : (id));
+        };
+
+        if (mCombineCharacters)
+        {
+            const auto idName = mCharacterRepository.getIdColumn();
+            auto query = mCharacterRepository.getEnabledQuery();
+
+            while (query.next())
+                addOwner(query.value(idName).value<Character::IdType>());
+
+            // characters can share a corporation
+            std::sort(std::begin(filter.mOwnerIds), std::end(filter.mOwnerIds));
+            filter.mOwnerIds.erase(std::unique(std::begin(filter.mOwnerIds), std::end(filter.mOwnerIds)), std::end(filter.mOwnerIds));
+        }
+        else if (mCharacterId != Character::invalidId)
+        {
+            addOwner(mCharacterId);
+        }
+
+        if (mLazy && !mTextFilter.isEmpty())
+        {
+            const QRegExp textFilter{mTextFilter, Qt::CaseInsensitive, QRegExp::Wildcard};
+
+            filter.mHasText = true;
+            filter.mTextNameIds = mDataProvider.findGenericNameIds(textFilter);
+            filter.mTextLocationIds = mDataProvider.findLocationIds(textFilter);
+
+            const auto &typeNames = mDataProvider.getAllTradeableTypeNames();
+            for (const auto &type : typeNames)
+            {
+                if (textFilter.indexIn(type.second) != -1)
+                    filter.mTextTypeIds.emplace_back(type.first);
             }
         }
+
+        return filter;
+    }
+
+    WalletTransactionRepository::SortColumn WalletTransactionsModel::getSortColumn() const noexcept
+    {
+        if (!mLazy)
+            return WalletTransactionRepository::SortColumn::Timestamp;
+
+        switch (mSortColumn) {
+        case ignoredColumn:
+            return WalletTransactionRepository::SortColumn::Ignored;
+        case typeColumn:
+            return WalletTransactionRepository::SortColumn::Type;
+        case quantityColumn:
+            return WalletTransactionRepository::SortColumn::Quantity;
+        case typeIdColumn:
+            return WalletTransactionRepository::SortColumn::TypeId;
+        case priceColumn:
+            return WalletTransactionRepository::SortColumn::Price;
+        case characterColumn:
+            return WalletTransactionRepository::SortColumn::Character;
+        case clientColumn:
+            return WalletTransactionRepository::SortColumn::Client;
+        case locationColumn:
+            return WalletTransactionRepository::SortColumn::Location;
+        default:
+            return WalletTransactionRepository::SortColumn::Timestamp;
+        }
     }
 }
@@ -20,6 +20,7 @@
 #include <QDate>
 
 #include "WalletTransactionRepository.h"
+#include "KeysetCursor.h"
 #include "Character.h"
 
 namespace Evernus
@@ -50,6 +51,9 @@ namespace Evernus
         virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
         virtual bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
         virtual int rowCount(const QModelIndex &parent = QModelIndex{}) const override;
+        virtual bool canFetchMore(const QModelIndex &parent) const override;
+        virtual void fetchMore(const QModelIndex &parent) override;
+        virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
         EveType::IdType getTypeId(int row) const;
         uint getQuantity(int row) const;
@@ -57,6 +61,8 @@ namespace Evernus
         WalletTransaction::Type getType(int row) const;
         Character::IdType getOwnerId(int row) const;
 
+        // totals cover all matching transactions, not only the loaded ones
+        quint64 getTotalCount() const noexcept;
         quint64 getTotalQuantity() const noexcept;
         double getTotalSize() const noexcept;
         double getTotalIncome() const noexcept;
@@ -66,6 +72,11 @@ namespace Evernus
         void setFilter(Character::IdType id, const QDate &from, const QDate &till, EntryType type, bool combineCharacters, EveType::IdType typeId = EveType::invalidId);
         void setCombineCharacters(bool flag);
 
+        // lazy model loads transactions page by page, sorted and filtered by the database - use it without a proxy model
+        void setLazyLoading(bool flag);
+        // lazy mode only; takes effect on next reset
+        void setTextFilter(const QString &text);
+
         void reset();
         void clear();
 
@@ -87,6 +98,8 @@ namespace Evernus
             idColumn
         };
 
+        static const auto pageSize = 500u;
+
         const WalletTransactionRepository &mTransactionsRepository;
         const CharacterRepository &mCharacterRepository;
         const EveDataProvider &mDataProvider;
@@ -98,12 +111,21 @@ namespace Evernus
         EveType::IdType mTypeId = EveType::invalidId;
         bool mCombineCharacters = false;
 
+        bool mLazy = false;
+        QString mTextFilter;
+        int mSortColumn = timestampColumn;
+        Qt::SortOrder mSortOrder = Qt::DescendingOrder;
+
+        WalletTransactionRepository::PageFilter mPageFilter;
+        KeysetCursor mCursor;
+
         std::vector<QVariantList> mData;
 
         QStringList mColumns;
 
         bool mCorp = false;
 
+        quint64 mTotalCount = 0;
         quint64 mTotalQuantity = 0;
         double mTotalSize = 0.;
         double mTotalIncome = 0.;
@@ -111,5 +133,9 @@ namespace Evernus
         double mTotalProfit = 0.;
 
         void processData(const WalletTransactionRepository::EntityList &entries);
+        void computeTotals();
+
+        WalletTransactionRepository::PageFilter getPageFilter() const;
+        WalletTransactionRepository::SortColumn getSortColumn() const noexcept;
     };
 }
@@ -12,7 +12,6 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <QSortFilterProxyModel>
 #include <QApplication>
 #include <QHeaderView>
 #include <QVBoxLayout>
@@ -79,11 +78,8 @@ namespace Evernus
         auto &warningBar = getWarningBarWidget();
         mainLayout->addWidget(&warningBar);
 
-        mFilterModel = new QSortFilterProxyModel{this};
-        mFilterModel->setSortRole(Qt::UserRole);
-        mFilterModel->setFilterKeyColumn(-1);
-        mFilterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-        mFilterModel->setSourceModel(&mModel);
+        // let the database sort and filter, and load only what's visible
+        mModel.setLazyLoading(true);
 
         mView = new WalletTransactionView{(corp) ? ("corpTransactionsView") : ("transactionsView"),
                                           itemCostProvider,
@@ -91,7 +87,7 @@ namespace Evernus
                                           this};
         mainLayout->addWidget(mView, 1);
         connect(mView, &WalletTransactionView::showInEve, this, &WalletTransactionsWidget::showInEve);
-        mView->setModels(mFilterModel, &mModel);
+        mView->setModel(&mModel);
         mView->sortByColumn(1, Qt::DescendingOrder);
 
         QFont font;
@@ -162,8 +158,8 @@ namespace Evernus
 
     void WalletTransactionsWidget::updateFilter(const QDate &from, const QDate &to, const QString &filter, int type)
     {
+        mModel.setTextFilter(filter);
         mModel.setFilter(getCharacterId(), from, to, static_cast<EntryType>(type), mCombineBtn->isChecked());
-        mFilterModel->setFilterWildcard(filter);
 
         updateInfo();
     }
@@ -179,6 +175,7 @@ namespace Evernus
         mFilter->setFilter(fromDate, tillDate, QString{}, static_cast<int>(EntryType::All));
         mFilter->blockSignals(false);
 
+        mModel.setTextFilter(QString{});
         mModel.setFilter(id, fromDate, tillDate, EntryType::All, mCombineBtn->isChecked());
 
         mView->setCharacter(id);
@@ -202,7 +199,7 @@ namespace Evernus
                 label->setStyleSheet("color: red;");
         };
 
-        mTotalTransactionsLabel->setText(curLocale.toString(mModel.rowCount()));
+        mTotalTransactionsLabel->setText(curLocale.toString(mModel.getTotalCount()));
         mTotalQuantityLabel->setText(curLocale.toString(mModel.getTotalQuantity()));
         mTotalSizeLabel->setText(QString{"%1m³"}.arg(curLocale.toString(mModel.getTotalSize(), 'f', 2)));
         mTotalIncomeLabel->setText(TextUtils::currencyToString(income, curLocale));
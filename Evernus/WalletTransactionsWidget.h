@@ -17,7 +17,6 @@
 #include "WalletTransactionsModel.h"
 #include "CharacterBoundWidget.h"
 
-class QSortFilterProxyModel;
 class QItemSelection;
 class QCheckBox;
 class QLabel;
@@ -62,7 +61,6 @@ namespace Evernus
 
     private:
         WalletTransactionsModel mModel;
-        QSortFilterProxyModel *mFilterModel = nullptr;
 
         WalletEntryFilterWidget *mFilter = nullptr;
         QCheckBox *mCombineBtn = nullptr;
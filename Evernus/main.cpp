@@ -12,6 +12,8 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+
 #include <boost/exception/diagnostic_information.hpp>
 
 #include <QCommandLineParser>
@@ -40,6 +42,7 @@
 #include "MarketLogExternalOrderImporter.h"
 #include "ProxyWebExternalOrderImporter.h"
 #include "MarketOrderFilterProxyModel.h"
+#include "ScriptOrderProcessingThread.h"
 #include "ExternalOrderImporterNames.h"
 #include "IndustryManufacturingSetup.h"
 #include "MarketAnalysisDataFetcher.h"
@@ -193,6 +196,9 @@ int main(int argc, char *argv[])
             { Evernus::CommandLineOptions::clientSecretArg, QCoreApplication::translate("main", "SSO client secret"), QStringLiteral("secret"), EVERNUS_CLIENT_SECRET_TEXT },
             { Evernus::CommandLineOptions::maxLogFileSizeArg, QCoreApplication::translate("main", "Max. log file size"), QStringLiteral("size"), QStringLiteral("%1").arg(10 * 1014 * 1024) },
             { Evernus::CommandLineOptions::maxLogFilesArg, QCoreApplication::translate("main", "Max. log files"), QStringLiteral("n"), QStringLiteral("3") },
+            { Evernus::CommandLineOptions::syncLogArg, QCoreApplication::translate("main", "Write log messages synchronously") },
+            { Evernus::CommandLineOptions::logRateLimitArg, QCoreApplication::translate("main", "Max. SQL/ESI debug log messages per second (0 - unlimited)"), QStringLiteral("n"), QStringLiteral("200") },
+            { Evernus::CommandLineOptions::logSamplingArg, QCoreApplication::translate("main", "Log only every n-th SQL/ESI debug message"), QStringLiteral("n"), QStringLiteral("1") },
             { Evernus::CommandLineOptions::forceSDEUpdateArg, QCoreApplication::translate("main", "Force Eve database update") },
         });
 
@@ -204,8 +210,14 @@ int main(int argc, char *argv[])
         if (parser.isSet(QStringLiteral("help")))
             parser.showHelp();
 
-        Evernus::ChainableFileLogger::initialize(parser.value(Evernus::CommandLineOptions::maxLogFileSizeArg).toULongLong(),
-                                                 parser.value(Evernus::CommandLineOptions::maxLogFilesArg).toUInt());
+        Evernus::ChainableFileLogger::Settings logSettings;
+        logSettings.mMaxLogSize = parser.value(Evernus::CommandLineOptions::maxLogFileSizeArg).toULongLong();
+        logSettings.mMaxLogFiles = parser.value(Evernus::CommandLineOptions::maxLogFilesArg).toUInt();
+        logSettings.mAsync = !parser.isSet(Evernus::CommandLineOptions::syncLogArg);
+        logSettings.mRateLimit = parser.value(Evernus::CommandLineOptions::logRateLimitArg).toUInt();
+        logSettings.mSampling = std::max(parser.value(Evernus::CommandLineOptions::logSamplingArg).toUInt(), 1u);
+
+        Evernus::ChainableFileLogger::initialize(logSettings);
 
         qSetMessagePattern(QStringLiteral("[%{type}] %{time} %{threadid} %{message}"));
 
@@ -286,6 +298,8 @@ int main(int argc, char *argv[])
         qRegisterMetaType<Evernus::VolumeType>("VolumeType");
         qRegisterMetaType<Evernus::IndustryManufacturingSetup::InventorySource>("IndustryManufacturingSetup::InventorySource");
         qRegisterMetaType<Evernus::Citadel::IdType>("Citadel::IdType");
+        qRegisterMetaType<Evernus::ScriptOrderProcessingThread::RowList>("ScriptOrderProcessingThread::RowList");
+        qRegisterMetaType<Evernus::ScriptOrderProcessingThread::RowList>("RowList");
 
         // Eve database must be fetched before the main application starts
         if (Evernus::EveDatabaseUpdater::performUpdate(argc, argv, parser.isSet(Evernus::CommandLineOptions::forceSDEUpdateArg)) == Evernus::EveDatabaseUpdater::Status::Error)
@@ -29,4 +29,6 @@ sqlite3 << EOF
 EOF
 
 sqlite3 "$2" <<< "VACUUM;"
+
+# the compiled static data pack in the cache dir is tied to the db file, so it gets rebuilt on next start
 echo 'Done.'